@@ -40,6 +40,7 @@
 #include "comp_attach_pt_t.h"
 #include "interfaces/trc_tgt_mem_access_i.h"
 #include "interfaces/trc_instr_decode_i.h"
+#include "common/trc_state_blob.h"
 
 /*!
  * @class OcsdCodeFollower
@@ -84,6 +85,7 @@ public:
     const ocsd_vaddr_t getRangeSt() const;  //!< inclusive start address of decoded range (value passed in)
     const ocsd_vaddr_t getRangeEn() const;  //!< exclusive end address of decoded range (first instruction _not_ executed / potential next instruction).
     const bool hasRange() const;            //!< we have a valid range executed (may be false if nacc).
+    const uint32_t getNumInstr() const;     //!< number of instructions in the decoded range.
 
     const bool hasNextAddr() const;         //!< we have calulated the next address - otherwise this is needed from trace packets.
     const ocsd_vaddr_t getNextAddr() const; //!< next address - valid if hasNextAddr() true.
@@ -102,6 +104,10 @@ public:
     void clearNacc();                           //!< clear the nacc error flag
     const ocsd_vaddr_t getNaccAddr() const;     //!< get the nacc error address.
 
+    // decoder state save and restore
+    void saveState(TrcStateWriter &wr) const;
+    void restoreState(TrcStateReader &rd);
+
 private:
     bool initFollowerState();       //!< clear all the o/p data and flags, check init valid.
 
@@ -111,6 +117,7 @@ private:
 
     ocsd_vaddr_t m_st_range_addr;   //!< start of excuted range - inclusive address.
     ocsd_vaddr_t m_en_range_addr;   //!< end of executed range - exclusive address.
+    uint32_t m_num_instr;           //!< number of instructions in the executed range.
     ocsd_vaddr_t m_next_addr;       //!< calcuated next address (could be eo range of branch address, not set for indirect branches)
     bool m_b_next_valid;            //!< true if next address valid, false if need address from trace packets.
 
@@ -172,6 +179,11 @@ inline const bool OcsdCodeFollower::hasRange() const
     return m_st_range_addr < m_en_range_addr;
 }
 
+inline const uint32_t OcsdCodeFollower::getNumInstr() const
+{
+    return m_num_instr;
+}
+
 inline const bool OcsdCodeFollower::hasNextAddr() const
 {
     return m_b_next_valid;
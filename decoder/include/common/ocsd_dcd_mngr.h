@@ -73,6 +73,9 @@ public:
 // generate a Config object from opaque config struct pointer.
     virtual ocsd_err_t createConfigFromDataStruct(CSConfig **pConfigBase, const void *pDataStruct);
 
+// apply a new config to the pkt processor, and pkt decoder if present.
+    virtual ocsd_err_t setDecoderConfig(TraceComponent *pComponent, const CSConfig *p_config);
+
 // implemented by decoder handler derived classes
     virtual TraceComponent *createPktProc(const bool useInstID, const int instID) = 0;
     virtual TraceComponent *createPktDecode(const bool useInstID, const int instID) { return 0; };
@@ -116,7 +119,7 @@ ocsd_err_t  DecoderMngrBase<P,Pt,Pc>::createDecoder(const int create_flags, cons
         return OCSD_ERR_MEM;
 
     // set the op mode flags
-    pkt_proc->setComponentOpMode(create_flags & (OCSD_OPFLG_COMP_MODE_MASK | OCSD_OPFLG_PKTPROC_COMMON));
+    pkt_proc->setComponentOpMode(create_flags & (OCSD_OPFLG_COMP_MODE_MASK | OCSD_OPFLG_PKTPROC_COMMON | OCSD_OPFLG_PKTPROC_SKIM));
 
     // set the configuration
     TrcPktProcBase<P,Pt,Pc> *pProcBase = dynamic_cast< TrcPktProcBase<P,Pt,Pc> *>(pkt_proc);       
@@ -318,6 +321,35 @@ ocsd_err_t DecoderMngrBase<P,Pt,Pc>::createConfigFromDataStruct(CSConfig **pConf
     return OCSD_OK;
 }
 
+template <class P, class Pt, class Pc>
+ocsd_err_t DecoderMngrBase<P,Pt,Pc>::setDecoderConfig(TraceComponent *pComponent, const CSConfig *pConfig)
+{
+    ocsd_err_t err = OCSD_OK;
+    const Pc *pConf = dynamic_cast< const Pc * >(pConfig);
+    if(pConf == 0)
+        return OCSD_ERR_INVALID_PARAM_TYPE;
+
+    // find the packet processor, and the decoder if this is a pair
+    TraceComponent *pPktProc = pComponent;
+    TrcPktDecodeBase<P,Pc> *pBase = 0;
+    if(pComponent->getAssocComponent() != 0)
+    {
+        pPktProc = pComponent->getAssocComponent();
+        pBase = dynamic_cast< TrcPktDecodeBase<P,Pc> *>(pComponent);
+        if(pBase == 0)
+            return OCSD_ERR_INVALID_PARAM_TYPE;
+    }
+
+    TrcPktProcBase<P,Pt,Pc> *pProcBase = dynamic_cast< TrcPktProcBase<P,Pt,Pc> *>(pPktProc);
+    if(pProcBase == 0)
+        return OCSD_ERR_INVALID_PARAM_TYPE;
+
+    err = pProcBase->setProtocolConfig(pConf);
+    if((err == OCSD_OK) && pBase)
+        err = pBase->setProtocolConfig(pConf);
+    return err;
+}
+
 /****************************************************************************************************/
 /* Full decoder / packet process pair, templated base for creating decoder objects                  */
 /****************************************************************************************************/
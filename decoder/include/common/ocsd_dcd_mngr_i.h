@@ -91,6 +91,9 @@ public:
 // create configuration from data structure
     virtual ocsd_err_t createConfigFromDataStruct(CSConfig **pConfigBase, const void *pDataStruct) = 0;
 
+// reconfigure an existing decoder - default for decoders that do not support this.
+    virtual ocsd_err_t setDecoderConfig(TraceComponent *pComponent, const CSConfig *p_config) { return OCSD_ERR_DCD_INTERFACE_UNUSED; };
+
 };
 
 #endif // ARM_OCSD_DCD_MNGR_I_H_INCLUDED
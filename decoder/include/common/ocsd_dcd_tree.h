@@ -42,6 +42,8 @@
 #include "opencsd.h"
 #include "ocsd_dcd_tree_elem.h"
 
+class PullElemSink;
+
 /** @defgroup dcd_tree OpenCSD Library : Trace Decode Tree.
     @brief Create a multi source decode tree for a single trace capture buffer.
 
@@ -124,6 +126,17 @@ public:
                                                const uint8_t *pDataBlock,
                                                uint32_t *numBytesProcessed);
 
+    /** @brief Scatter-gather trace data input (ITrcDataIn)
+
+        Trace data supplied as a list of segments - e.g. the two parts of a wrapped 
+        ring buffer - is passed to the deformatter or decoder without copying.
+    */
+    virtual ocsd_datapath_resp_t TraceDataInSG(const ocsd_trc_index_t index,
+                                               const ocsd_trc_data_seg_t *segs,
+                                               const int num_segs,
+                                               const uint32_t seg_offset,
+                                               uint32_t *numBytesProcessed);
+
     /*!
      * @brief Decoded Trace output.
      *
@@ -139,6 +152,40 @@ public:
 
 /** @}*/
 
+/** @name Decode State Checkpoints
+@{*/
+
+    /*!
+     * Save the state of the deformatter and all decoders in the tree, appended to the checkpoint buffer.
+     *
+     * Call between TraceDataIn() data blocks - e.g. after every N blocks of a growing ring buffer - 
+     * and record the trace index the next block will start at. Decoders with elements still to 
+     * output after a WAIT return OCSD_ERR_DCD_STATE_BUSY; flush the tree and retry. 
+     * The built-in ETMv3, ETMv4 instruction, PTM and STM packet processors and decoders support
+     * state save; components without it return OCSD_ERR_DCD_INTERFACE_UNUSED.
+     *
+     * @param &checkpoint : buffer to append the checkpoint to. Unchanged on error.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t saveCheckpoint(std::vector<uint8_t> &checkpoint);
+
+    /*!
+     * Restore a checkpoint saved from a decode tree with the same source type and decoders,
+     * created with the same configuration. Trace data input resumes at the index recorded 
+     * when the checkpoint was saved.
+     *
+     * On error the tree is reset.
+     *
+     * @param *p_checkpoint : checkpoint data.
+     * @param size : size of data in bytes.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t restoreCheckpoint(const uint8_t *p_checkpoint, const size_t size);
+
+/** @}*/
+
 /** @name Decoder Management
 @{*/
 
@@ -168,6 +215,29 @@ public:
      */
     ocsd_err_t removeDecoder(const uint8_t CSID);
 
+    /*!
+     * Apply a new configuration to an existing decoder, and reset it to the initial state.
+     *
+     * The decoder is selected by the trace ID in the configuration, and must be the same type 
+     * as the configuration. Decoder allocations and attached interfaces are retained, 
+     * so this is cheaper than removing and re-creating the decoder.
+     *
+     * @param *pConfig : Pointer to a valid configuration structure for the decoder.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t reconfigureDecoder(const CSConfig *pConfig);
+
+    /*!
+     * Reset the deformatter and all decoders in the tree to the initial state, ready for a new 
+     * trace capture - e.g. the next perf AUX buffer chunk.
+     *
+     * Decoders, attached interfaces, filters and the memory accessor map are retained.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t resetDecodeTree();
+
 
 /* get decoder elements currently in use  */
 
@@ -209,6 +279,44 @@ public:
 
 /** @}*/
 
+/** @name Pull iterator
+@{*/
+
+    /*!
+     * Set a trace data source for pull mode decode. The tree reads data from the source 
+     * as required by nextElements(). 
+     *
+     * Replaces any generic element output interface set on the tree - elements are 
+     * only returned through nextElements(). Set to 0 to leave pull mode.
+     *
+     * @param *p_src : Pointer to the trace data source interface.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t setPullSource(ITrcDataSrc *p_src);
+
+    ITrcDataSrc *getPullSource() const { return m_i_pull_src; };  //!< get the current pull mode source.
+
+    /*!
+     * Get the next batch of generic trace elements, reading and decoding trace data from 
+     * the pull source as required. Decoding stops once the batch is full, and continues 
+     * from the same point on the next call.
+     *
+     * At the end of the source data, the end of trace is passed to the decoders, and all 
+     * the remaining elements returned. Subsequent calls return no elements.
+     *
+     * Extended data pointers in the returned elements are valid until the next call.
+     *
+     * @param *p_elems : Array to fill with element records.
+     * @param max_elems : Size of the array.
+     * @param *num_elems : Returned number of elements in the array. 0 at the end of the trace.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t nextElements(ocsd_gen_elem_rec_t *p_elems, const int max_elems, int *num_elems);
+
+/** @}*/
+
 /** @name Memory Access Mapper
 
     A memory mapper is used to organise a collection of memory accessor objects that contain the 
@@ -266,6 +374,14 @@ public:
 
     void logMappedRanges();     //!< Log the mapped memory ranges to the default message logger.
 
+    /*!
+     * Get the inclusive address ranges of all the memory accessors mapped in the tree.
+     * e.g. to set up the regions for a coverage map.
+     *
+     * @param &ranges : vector to add the ranges to.
+     */
+    void getMappedRanges(std::vector<TrcMemAccessorBase::addr_range_t> &ranges);
+
 /** @}*/
 
 /** @name Memory Accessors
@@ -345,6 +461,67 @@ public:
     ocsd_err_t addCallbackMemAcc(const ocsd_vaddr_t st_address, const ocsd_vaddr_t en_address, const ocsd_mem_space_acc_t mem_space, Fn_MemAcc_CB p_cb_func, const void *p_context); 
     ocsd_err_t addCallbackIDMemAcc(const ocsd_vaddr_t st_address, const ocsd_vaddr_t en_address, const ocsd_mem_space_acc_t mem_space, Fn_MemAccID_CB p_cb_func, const void *p_context);
 
+    /*!
+     * Creates a memory accessor for a shared, immutable memory image and adds to the current mapper.
+     * The image may be in use by accessors in any number of decode trees, on any thread.
+     *
+     * @param &image : Memory image.
+     * @param mem_space : Memory space
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t addImageMemAcc(const TrcMemImagePtr &image, const ocsd_mem_space_acc_t mem_space);
+
+    /*!
+     * Creates a memory accessor for the named image in the global memory image registry.
+     *
+     * @param &name : Name of the published image.
+     * @param mem_space : Memory space
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful. OCSD_ERR_INVALID_PARAM_VAL if no such image.
+     */
+    ocsd_err_t addImageMemAcc(const std::string &name, const ocsd_mem_space_acc_t mem_space);
+
+    /*!
+     * Creates a memory accessor for the executable PT_LOAD segments of an ELF file, and adds to 
+     * the current mapper. Segments are mapped at their virtual address plus the load bias, and 
+     * the segment data is loaded from the file on first access.
+     *
+     * @param &filepath : Path to the ELF file.
+     * @param load_bias : Added to the segment addresses - e.g. load address of a shared object.
+     * @param mem_space : Memory space
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t addElfFileMemAcc(const std::string &filepath, const ocsd_vaddr_t load_bias, const ocsd_mem_space_acc_t mem_space);
+
+    /*!
+     * Attach a precomputed basic block map to the memory accessor holding the mapped region.
+     * The region must be in a single accessor, and the contents match the map.
+     *
+     * PE decoders resolve instruction ranges starting in the region from the map, without
+     * reading or decoding the instructions.
+     *
+     * @param &map : Basic block map.
+     * @param address : Address of the mapped region.
+     * @param mem_space : Memory space
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful. OCSD_ERR_BB_MAP_INVALID if the contents do not match.
+     */
+    ocsd_err_t attachBBMap(const TrcBBMapPtr &map, const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space);
+
+    /*!
+     * Load the basic block maps in a sidecar file, and attach each at the link address of the 
+     * mapped region plus the load bias.
+     *
+     * @param &filepath : Path to the map file.
+     * @param load_bias : Added to the map region addresses.
+     * @param mem_space : Memory space
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t attachBBMapFile(const std::string &filepath, const ocsd_vaddr_t load_bias, const ocsd_mem_space_acc_t mem_space);
+
     /*!
      * Remove the memory accessor from the map, that begins at the given address, for the memory space provided.
      *
@@ -376,15 +553,70 @@ public:
 
     ocsd_err_t clearIDFilter(); //!< remove filter, all IDs will be decoded
 
+    /*! @brief PE filtering - sets the context and address filter on all PE decoders in the tree.
+
+        While outside the filter, PE decoders follow only address and context packets, and output 
+        a single OCSD_GEN_TRC_ELEM_FILTERED_OUT element in place of instruction ranges.
+        Applied to existing decoders and any created later. The ETMv3, ETMv4 and PTM decoders 
+        support the filter - ETMv3 and PTM trace carry no exception level other than Hyp, so 
+        EL predicates do not match. STM has no PE trace and ignores the filter. Other decoders 
+        decode all trace and a warning is logged.
+
+        @param &filter : filter to copy.
+    */
+    ocsd_err_t setPeFilter(const OcsdPeFilter &filter);
+
+    ocsd_err_t clearPeFilter(); //!< remove PE filter, all instruction trace will be decoded
+
+    /*! @brief Get the skim mode summary for a trace ID.
+
+        The packet processor must be created with OCSD_OPFLG_PKTPROC_SKIM in the creation flags.
+        Skim mode is supported by the ETMv4 instruction trace packet processor only.
+
+        @param CSID : Trace ID of the stream.
+        @param *p_summary : summary structure to fill in.
+    */
+    ocsd_err_t getSkimSummary(const uint8_t CSID, ocsd_skim_summary_t *p_summary);
+
+    /*! @brief Attach a batched packet sink to the packet processor for a trace ID.
+
+        Packets are copied into batches of the protocol C API packet structure, passed on when 
+        max_pkts are collected, or on flush or end of trace. A WAIT response from the sink applies 
+        to the batch - the packet processor stops when a batch is sent that returns WAIT.
+        The sink is independent of the main packet output, and may be used with a packet decoder.
+
+        @param CSID : Trace ID of the stream.
+        @param *pBatchSink : batch sink - 0 to detach the current sink.
+        @param max_pkts : maximum packets per batch.
+    */
+    ocsd_err_t attachPktBatchSink(const uint8_t CSID, IPktBatchIn *pBatchSink, const uint32_t max_pkts);
+
+    /*! @brief Get the accumulated decode stage times.
+
+        Times are only recorded if the library is built with OCSD_STAGE_TIMING defined,
+        otherwise all values are 0.
+
+        @param CSID : Trace ID of the stream - sums packet processor and decoder. 
+                      Use OCSD_BAD_CS_SRC_ID for the whole tree, including any deformatter.
+        @param *p_times : times structure to fill in.
+    */
+    ocsd_err_t getStageTimes(const uint8_t CSID, ocsd_stage_times_t *p_times);
+
+    void resetStageTimes();     //!< clear the stage times in all components in the tree.
+    void logStageTimes();       //!< Log the stage times per component to the default message logger.
+
 /** @}*/
 
 private:
     bool initialise(const ocsd_dcd_tree_src_t type, uint32_t formatterCfgFlags);
     const bool usingFormatter() const { return (bool)(m_dcd_tree_type ==  OCSD_TRC_SRC_FRAME_FORMATTED); };
     void setSingleRoot(TrcPktProcI *pComp);
+    TrcPktProcI *getPktProcessor(DecodeTreeElement *pElem);
     ocsd_err_t createDecodeElement(const uint8_t CSID);
     void destroyDecodeElement(const uint8_t CSID);
     void destroyMemAccMapper();
+    ocsd_err_t applyPeFilter(TraceComponent *pDecoder);
+    void resetPullState();
     ocsd_err_t initCallbackMemAcc(const ocsd_vaddr_t st_address, const ocsd_vaddr_t en_address, 
         const ocsd_mem_space_acc_t mem_space, void *p_cb_func, bool IDfn, const void *p_context);
 
@@ -408,6 +640,18 @@ private:
 
     std::vector<ItemPrinter *> m_printer_list;  //!< list of packet printers.
 
+    OcsdPeFilter m_pe_filter;       //!< PE filter applied to PE decoders.
+
+    /* pull iterator */
+    ITrcDataSrc *m_i_pull_src;          //!< trace data source for pull mode.
+    PullElemSink *m_pull_sink;          //!< element output in pull mode - fills the client batch.
+    const uint8_t *m_pull_block;        //!< current block of source data.
+    uint32_t m_pull_block_size;
+    uint32_t m_pull_block_used;
+    ocsd_trc_index_t m_pull_index;      //!< trace index of the next source byte.
+    ocsd_datapath_resp_t m_pull_resp;   //!< last data path response in pull mode.
+    bool m_pull_eot;                    //!< end of trace sent to the decoders.
+
     /* global error logger  - all sources */ 
     static ITraceErrorLog *s_i_error_logger;
     static std::list<DecodeTree *> s_trace_dcd_trees;
@@ -0,0 +1,108 @@
+/*
+ * \file       ocsd_dcd_tree_pool.h
+ * \brief      OpenCSD : Pool of pre-built decode trees.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_OCSD_DCD_TREE_POOL_H_INCLUDED
+#define ARM_OCSD_DCD_TREE_POOL_H_INCLUDED
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "opencsd/ocsd_if_types.h"
+
+class DecodeTree;
+
+/** @addtogroup dcd_tree
+@{*/
+
+/*!
+ * @class DecodeTreePool
+ * @brief Pool of pre-built decode trees that can be checked out by worker threads.
+ * 
+ *  Trees are created and configured by the client - decoders, memory accessors and output 
+ *  interfaces - and then added to the pool, which takes ownership. A worker checks out a tree,
+ *  decodes a trace capture with it, then checks it in again. Trees are reset on check in, 
+ *  retaining their decoders and memory map, so setup cost per capture is minimal.
+ * 
+ *  Pool operations are thread safe. Each checked out tree must only be used by one thread.
+ */
+class DecodeTreePool
+{
+public:
+    DecodeTreePool() {};
+    ~DecodeTreePool();  //!< destroys all trees in the pool - all must be checked in.
+
+    /*!
+     * Add a tree to the pool. The pool takes ownership and will destroy the tree.
+     *
+     * @param *p_tree : Tree created with DecodeTree::CreateDecodeTree().
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t addTree(DecodeTree *p_tree);
+
+    /*!
+     * Check out a tree from the pool.
+     *
+     * @param wait : if true, block until a tree is available.
+     *
+     * @return DecodeTree * : the tree, or 0 if none available (or the pool is empty).
+     */
+    DecodeTree *checkOut(const bool wait = false);
+
+    /*!
+     * Return a tree to the pool. The tree is reset to the initial state.
+     *
+     * @param *p_tree : Tree previously checked out of this pool.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t checkIn(DecodeTree *p_tree);
+
+    const int getNumTrees() const;  //!< number of trees owned by the pool.
+    const int getNumFree() const;   //!< number of trees available to check out.
+
+private:
+    mutable std::mutex m_lock;
+    std::condition_variable m_free_cond;    //!< signalled on check in.
+    std::vector<DecodeTree *> m_trees;      //!< all trees in the pool.
+    std::vector<DecodeTree *> m_free;       //!< trees available to check out.
+};
+
+/** @}*/
+
+#endif // ARM_OCSD_DCD_TREE_POOL_H_INCLUDED
+
+/* End of File ocsd_dcd_tree_pool.h */
@@ -37,12 +37,26 @@
 
 #include <string>
 #include <vector>
+#include <map>
 //#include <fstream>
 
 #include "interfaces/trc_error_log_i.h"
 #include "ocsd_error.h"
 #include "ocsd_msg_logger.h"
 
+/** compact record of a logged error, held in the error logger history */
+typedef struct _ocsd_err_log_rec {
+    ocsd_hndl_err_log_t handle;     /**< handle of the component logging the error */
+    ocsd_err_t code;                /**< error code */
+    ocsd_err_severity_t sev;        /**< error severity */
+    ocsd_trc_index_t idx;           /**< trace index of the first occurrence - OCSD_BAD_TRC_INDEX if none */
+    uint8_t chan_id;                /**< trace ID - OCSD_BAD_CS_SRC_ID if none */
+    uint32_t count;                 /**< number of consecutive occurrences */
+} ocsd_err_log_rec_t;
+
+#define OCSD_ERR_LOG_HIST_SIZE          256     /**< number of error records held in the history */
+#define OCSD_ERR_LOG_DEF_REPEAT_LIMIT   0       /**< default number of printed repeats of an error - 0 for no limit */
+
 class ocsdDefaultErrorLogger : public ITraceErrorLog
 {
 public:
@@ -68,9 +82,24 @@ public:
             return m_lastErrID[chan_id];
         return 0;
     };
-    
+
+    /*!
+     * Set the number of times an error with the same component, code and trace ID is printed. 
+     * Further repeats are counted but not printed. 0 for no limit.
+     */
+    void setRepeatLimit(const uint32_t limit) { m_repeat_limit = limit; };
+    const uint64_t getNumSuppressed() const { return m_num_suppressed; };  //!< number of errors not printed due to the repeat limit.
+    void logSuppressedErrors();     //!< print the count of suppressed errors for each repeated error.
+
+    /* history of logged errors - consecutive repeats are combined into a single record */
+    const int getNumErrRecords() const { return m_hist_count; };
+    const ocsd_err_log_rec_t *getErrRecord(const int n) const;     //!< get record n, 0 is oldest, 0 if n out of range.
+    const std::string getErrRecordString(const ocsd_err_log_rec_t *p_rec) const; //!< format the record as a string. 
+
 private:
     void CreateErrorObj(ocsdError **ppErr, const ocsdError *p_from);
+    const uint32_t recordError(const ocsd_hndl_err_log_t handle, const ocsdError *Error);
+    const std::string &getSourceName(const ocsd_hndl_err_log_t handle) const;
 
     ocsdError *m_lastErr;
     ocsdError *m_lastErrID[0x80];
@@ -81,6 +110,14 @@ private:
     bool m_created_output_logger;      // true if this class created it's own logger;
 
     std::vector<std::string> m_error_sources;
+
+    std::vector<ocsd_err_log_rec_t> m_err_hist;    //!< ring buffer of error records.
+    int m_hist_next;                                //!< next record to write.
+    int m_hist_count;                               //!< number of valid records.
+
+    std::map<uint64_t, uint32_t> m_repeat_counts;  //!< occurrences by component, code and trace ID.
+    uint32_t m_repeat_limit;
+    uint64_t m_num_suppressed;
 };
 
 
@@ -50,8 +50,10 @@
  * Last element(s) on this list can be marked pending to allow for later cancellation.
  * (This required for cancel element in ETMv3 exeception branch).
  * 
- * The "list" is actually a ring buffer - maintaining pointers to indicate current valid elements.
+ * The "list" is actually a ring buffer - maintaining indexes to indicate current valid elements.
+ * Elements are stored in a single contiguous array, so are sent with sequential memory access.
  * This buffer can increase on demand, but will only be released at the end of a decode session.
+ * Growing the buffer moves the elements - pointers from getNextElem() are only valid until the next call.
  */
 class OcsdGenElemList
 {
@@ -61,6 +63,7 @@ public:
 
     void initSendIf(componentAttachPt<ITrcGenElemIn> *pGenElemIf);
     void initCSID(const uint8_t CSID) { m_CSID = CSID; };
+    void initStageTime(ocsd_stage_time_t *p_out_time) { m_p_out_time = p_out_time; };  //!< decoder element output stage time.
 
     void reset();   //!< reset the element list.
 
@@ -86,14 +89,10 @@ private:
     const int getAdjustedIdx(int idxIn) const;  //!< get adjusted index into circular buffer.
 
 
-    // list element contains pointer and byte index in trace stream
-    typedef struct _elemPtr {
-        OcsdTraceElement *pElem;        //!< pointer to the listed trace element
-        ocsd_trc_index_t trc_pkt_idx;   //!< packet index in the trace stream
-    } elemPtr_t;
-
-    elemPtr_t *m_pElemArray;    //!< an array of pointers to elements.
-    int m_elemArraySize;        //!< number of element pointers in the array 
+    // elements held contiguously, with the packet index for each in a parallel array.
+    OcsdTraceElement *m_pElemArray;     //!< array of trace elements.
+    ocsd_trc_index_t *m_pIdxArray;      //!< packet index in the trace stream for each element.
+    int m_elemArraySize;                //!< number of elements in the array 
 
     int m_firstElemIdx;        //!< internal index in array of first element in use.
     int m_numUsed;             //!< number of elements in use
@@ -102,6 +101,7 @@ private:
     uint8_t m_CSID;
 
     componentAttachPt<ITrcGenElemIn> *m_sendIf; //!< element send interface.
+    ocsd_stage_time_t *m_p_out_time;            //!< time in the send interface, if stage timing.
 };
 
 inline const int OcsdGenElemList::getAdjustedIdx(int idxIn) const
@@ -40,6 +40,9 @@
   
    maintains the "current" element, which might be sent independently of this stack, and also
    ensures that persistent data in the output elements is maintained between elements.
+
+   Elements are held in a single contiguous array - adding an element may move them, so
+   references from getCurrElem() are only valid until the next addElem().
 */
 class OcsdGenElemStack
 {
@@ -49,6 +52,7 @@ public:
 
     void initSendIf(componentAttachPt<ITrcGenElemIn> *pGenElemIf);
     void initCSID(const uint8_t CSID) { m_CSID = CSID; };
+    void initStageTime(ocsd_stage_time_t *p_out_time) { m_p_out_time = p_out_time; };  //!< decoder element output stage time.
 
     OcsdTraceElement &getCurrElem();    //!< get the current element. 
     ocsd_err_t resetElemStack();        //!< set pointers to base of stack
@@ -60,19 +64,15 @@ public:
     const int numElemToSend() const;
 
 private:
-    typedef struct _elemPtr {
-        OcsdTraceElement *pElem;        //!< pointer to the listed trace element
-        ocsd_trc_index_t trc_pkt_idx;   //!< packet index in the trace stream
-    } elemPtr_t;
-
     const bool isInit();              //!< check correctly initialised.
 
     ocsd_err_t growArray();
     void copyPersistentData(int src, int dst);  //!< copy across persistent state data between elements
     void resetIndexes();    //!< clear down all indexes - reset or send complete.
 
-    elemPtr_t *m_pElemArray;    //!< an array of pointers to elements.
-    int m_elemArraySize;        //!< number of element pointers in the array 
+    OcsdTraceElement *m_pElemArray;     //!< contiguous array of elements.
+    ocsd_trc_index_t *m_pIdxArray;      //!< packet index in the trace stream for each element.
+    int m_elemArraySize;                //!< number of elements in the array 
 
     int m_elem_to_send;     //!< number of live elements in the stack - init to 1.
     int m_curr_elem_idx;    //!< index into the element array.
@@ -81,6 +81,7 @@ private:
     //!< send packet info
     uint8_t m_CSID;
     componentAttachPt<ITrcGenElemIn> *m_sendIf; //!< element send interface.
+    ocsd_stage_time_t *m_p_out_time;            //!< time in the send interface, if stage timing.
 
     bool m_is_init;
 };
@@ -97,12 +98,12 @@ inline void OcsdGenElemStack::initSendIf(componentAttachPt<ITrcGenElemIn> *pGenE
 
 inline void OcsdGenElemStack::setCurrElemIdx(const ocsd_trc_index_t trc_pkt_idx)
 {
-    m_pElemArray[m_curr_elem_idx].trc_pkt_idx = trc_pkt_idx;
+    m_pIdxArray[m_curr_elem_idx] = trc_pkt_idx;
 }
 
 inline OcsdTraceElement &OcsdGenElemStack::getCurrElem()
 {
-    return *(m_pElemArray[m_curr_elem_idx].pElem);
+    return m_pElemArray[m_curr_elem_idx];
 }
 
 
@@ -0,0 +1,136 @@
+/*
+ * \file       ocsd_pe_filter.h
+ * \brief      OpenCSD : PE state filter for instruction trace decode
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_OCSD_PE_FILTER_H_INCLUDED
+#define ARM_OCSD_PE_FILTER_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "opencsd/ocsd_if_types.h"
+
+/** @addtogroup ocsd_infrastructure
+@{*/
+
+/** Security state bits for OcsdPeFilter::setSecMask() */
+#define OCSD_PE_FILT_SEC_SECURE     0x1
+#define OCSD_PE_FILT_SEC_NONSECURE  0x2
+
+/*!
+ * @class OcsdPeFilter
+ * @brief Filter on PE context and address for instruction trace decode.
+ *
+ * Set on the decode tree and passed to each PE decoder. While the PE state is outside 
+ * the filter the decoder does not walk the program image - it follows only the address
+ * and context packets needed to resynchronise, and outputs a single 
+ * OCSD_GEN_TRC_ELEM_FILTERED_OUT element in place of the instruction ranges.
+ *
+ * Each set predicate must match. Empty sets and zero masks match all values.
+ * Address ranges are tested at the start of each traced range, so the filter resumes 
+ * at the next address packet inside a range after the PE has left it.
+ */
+class OcsdPeFilter
+{
+public:
+    OcsdPeFilter() : m_el_mask(0), m_sec_mask(0) {};
+    ~OcsdPeFilter() {};
+
+    void clear()
+    {
+        m_ctxt_ids.clear();
+        m_vmids.clear();
+        m_addr_ranges.clear();
+        m_el_mask = m_sec_mask = 0;
+    };
+
+    void addContextID(const uint32_t ctxt_id) { m_ctxt_ids.push_back(ctxt_id); };
+    void addVMID(const uint32_t vmid) { m_vmids.push_back(vmid); };
+    void setELMask(const uint8_t el_mask) { m_el_mask = el_mask; };     //!< bit N set to include ELN.
+    void setSecMask(const uint8_t sec_mask) { m_sec_mask = sec_mask; }; //!< OCSD_PE_FILT_SEC_ bits.
+    void addAddrRange(const ocsd_vaddr_t st_addr, const ocsd_vaddr_t en_addr) //!< inclusive start, exclusive end.
+    {
+        m_addr_ranges.push_back(addr_range_t(st_addr, en_addr));
+    };
+
+    /** true if any predicates are set */
+    const bool isActive() const 
+    {
+        return m_el_mask || m_sec_mask || m_ctxt_ids.size() || m_vmids.size() || m_addr_ranges.size();
+    };
+
+    /** true if context (ctxt ID, VMID, EL, security state) is inside the filter */
+    const bool matchContext(const uint32_t ctxt_id, const uint32_t vmid, 
+                            const ocsd_ex_level el, const ocsd_sec_level sec) const
+    {
+        if (m_el_mask && ((el < ocsd_EL0) || !(m_el_mask & (0x1 << el))))
+            return false;
+        if (m_sec_mask && !(m_sec_mask & ((sec == ocsd_sec_secure) ? OCSD_PE_FILT_SEC_SECURE : OCSD_PE_FILT_SEC_NONSECURE)))
+            return false;
+        if (m_ctxt_ids.size() && (std::find(m_ctxt_ids.begin(), m_ctxt_ids.end(), ctxt_id) == m_ctxt_ids.end()))
+            return false;
+        if (m_vmids.size() && (std::find(m_vmids.begin(), m_vmids.end(), vmid) == m_vmids.end()))
+            return false;
+        return true;
+    };
+
+    /** true if address is inside the filter */
+    const bool matchAddr(const ocsd_vaddr_t addr) const
+    {
+        if (!m_addr_ranges.size())
+            return true;
+        for (std::vector<addr_range_t>::const_iterator it = m_addr_ranges.begin(); it != m_addr_ranges.end(); it++)
+        {
+            if ((addr >= it->first) && (addr < it->second))
+                return true;
+        }
+        return false;
+    };
+
+private:
+    typedef std::pair<ocsd_vaddr_t, ocsd_vaddr_t> addr_range_t;
+
+    std::vector<uint32_t> m_ctxt_ids;
+    std::vector<uint32_t> m_vmids;
+    std::vector<addr_range_t> m_addr_ranges;
+    uint8_t m_el_mask;
+    uint8_t m_sec_mask;
+};
+
+/** @}*/
+
+#endif // ARM_OCSD_PE_FILTER_H_INCLUDED
+
+/* End of File ocsd_pe_filter.h */
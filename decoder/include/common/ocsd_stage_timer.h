@@ -0,0 +1,112 @@
+/*
+ * \file       ocsd_stage_timer.h
+ * \brief      OpenCSD : Scoped decode stage timer.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_OCSD_STAGE_TIMER_H_INCLUDED
+#define ARM_OCSD_STAGE_TIMER_H_INCLUDED
+
+#include "opencsd/ocsd_if_types.h"
+
+/*!
+ * Stage timers are compiled into the library only when built with OCSD_STAGE_TIMING 
+ * defined (make STAGE_TIMING=1). Otherwise OCSD_STAGE_TIMER() expands to nothing, and 
+ * component stage times remain zero.
+ */
+#ifdef OCSD_STAGE_TIMING
+
+#include <chrono>
+
+/*!
+ * @class OcsdStageTimer
+ * @brief Scoped timer adding the time in a scope to a decode stage.
+ *
+ * Timers nest on each thread - time in an inner timed stage is added to the total time 
+ * of the enclosing stage, but not to its self time. 
+ */
+class OcsdStageTimer
+{
+public:
+    OcsdStageTimer(ocsd_stage_time_t *p_stage) : 
+        m_p_stage(p_stage),
+        m_child_ns(0),
+        m_parent(s_active)
+    {
+        s_active = this;
+        m_start = now();
+    };
+
+    ~OcsdStageTimer()
+    {
+        uint64_t elapsed = now() - m_start;
+        if (m_p_stage)
+        {
+            m_p_stage->calls++;
+            m_p_stage->total_ns += elapsed;
+            m_p_stage->self_ns += elapsed - m_child_ns;
+        }
+        if (m_parent)
+            m_parent->m_child_ns += elapsed;
+        s_active = m_parent;
+    };
+
+private:
+    static uint64_t now()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+
+    ocsd_stage_time_t *m_p_stage;       //!< stage to update - may be 0 to only exclude the time from the enclosing stage.
+    uint64_t m_start;
+    uint64_t m_child_ns;                //!< time in timed stages called from this one.
+    OcsdStageTimer *m_parent;           //!< enclosing timer on this thread.
+
+    static thread_local OcsdStageTimer *s_active;   //!< innermost timer on this thread.
+};
+
+/** time the rest of the enclosing scope against a stage of this TraceComponent */
+#define OCSD_STAGE_TIMER(stage) OcsdStageTimer ocsd_stage_timer_(&stageTime(stage))
+
+/** time the rest of the enclosing scope against a stage time owned by another component */
+#define OCSD_STAGE_TIMER_PTR(p_stage_time) OcsdStageTimer ocsd_stage_timer_(p_stage_time)
+
+#else
+
+#define OCSD_STAGE_TIMER(stage)
+#define OCSD_STAGE_TIMER_PTR(p_stage_time)
+
+#endif // OCSD_STAGE_TIMING
+
+#endif // ARM_OCSD_STAGE_TIMER_H_INCLUDED
+
+/* End of File ocsd_stage_timer.h */
@@ -37,9 +37,11 @@
 #define ARM_TRC_COMPONENT_H_INCLUDED
 
 #include <string>
+#include <vector>
 #include "comp_attach_pt_t.h"
 #include "interfaces/trc_error_log_i.h"
 #include "ocsd_error.h"
+#include "ocsd_stage_timer.h"
 
 class errLogAttachMonitor;
 
@@ -118,10 +120,53 @@ public:
         LogMessage(m_errVerbosity, msg);
     }
 
+    /*!
+     * Save the current decode state of the component, appending a state blob to the buffer.
+     * State is saved between data or packet input calls, and allows a component with the same 
+     * configuration to continue decode from the same point in the trace stream.
+     *
+     * Base class does not support state save.
+     *
+     * @param &state : Buffer to append the state blob to.
+     *
+     * @return ocsd_err_t  : OCSD_OK on success, OCSD_ERR_DCD_INTERFACE_UNUSED if not supported by the component.
+     */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state) { return OCSD_ERR_DCD_INTERFACE_UNUSED; };
+
+    /*!
+     * Restore decode state previously saved by saveState().
+     *
+     * @param *p_state : Start of the state blob. 
+     * @param size : Bytes available at p_state - may be larger than the blob.
+     *
+     * @return ocsd_err_t  : OCSD_OK on success, OCSD_ERR_DCD_STATE_INVALID if the blob does not match the component.
+     */
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size) { return OCSD_ERR_DCD_INTERFACE_UNUSED; };
+
+    /*!
+     * Get the decode stage times accumulated by this component. 
+     * Times are only recorded if the library is built with OCSD_STAGE_TIMING defined.
+     *
+     * @return const ocsd_stage_times_t & : times indexed by stage.
+     */
+    const ocsd_stage_times_t &getStageTimes() const { return m_stage_times; };
+
+    /*!
+     * Clear the accumulated stage times.
+     */
+    void resetStageTimes();
+
+    /*!
+     * @return const bool : true if the library was built with stage timing.
+     */
+    static const bool stageTimingEnabled();
+
 protected:
     friend class errLogAttachMonitor;
 
     void LogError(const ocsdError &Error);
+    /* log error - error object only created if the severity is being logged. For use in per packet error paths. */
+    void LogError(const ocsd_err_severity_t sev, const ocsd_err_t code, const ocsd_trc_index_t idx, const uint8_t chan_id, const char *msg);
     void LogMessage(const ocsd_err_severity_t filter_level, const std::string &msg);
     const ocsd_err_severity_t getErrorLogLevel() const { return m_errVerbosity; };
     const bool isLoggingErrorLevel(const ocsd_err_severity_t level) const { return level <= m_errVerbosity; };
@@ -130,6 +175,9 @@ protected:
     void do_attach_notify(const int num_attached);
     void Init(const std::string &name);
 
+    /* stage time to update - used by OCSD_STAGE_TIMER() */
+    ocsd_stage_time_t &stageTime(const ocsd_timing_stage_t stage) { return m_stage_times.stage[stage]; };
+
     uint32_t m_op_flags;                //!< current component operational mode flags.
     uint32_t m_supported_op_flags;      //!< supported component operational mode flags - derived class to intialise.
 
@@ -142,6 +190,8 @@ private:
     std::string m_name; 
 
     TraceComponent *m_assocComp;    //!< associated component -> if this is a pkt decoder, associated pkt processor.
+
+    ocsd_stage_times_t m_stage_times;   //!< accumulated decode stage times.
 };
 /** @}*/
 #endif // ARM_TRC_COMPONENT_H_INCLUDED
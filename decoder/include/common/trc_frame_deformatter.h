@@ -63,6 +63,13 @@ public:
                                                 const uint8_t *pDataBlock, 
                                                 uint32_t *numBytesProcessed);
 
+    /* scatter-gather data input - gathers frames straddling segment boundaries */
+    virtual ocsd_datapath_resp_t TraceDataInSG(const ocsd_trc_index_t index,
+                                               const ocsd_trc_data_seg_t *segs,
+                                               const int num_segs,
+                                               const uint32_t seg_offset,
+                                               uint32_t *numBytesProcessed);
+
     /* attach a data processor to a stream ID output */
     componentAttachPt<ITrcDataIn> *getIDStreamAttachPt(uint8_t ID);
 
@@ -85,6 +92,14 @@ public:
     ocsd_datapath_resp_t Reset();    /* reset the decode to the start state, drop partial data - propogate to attached components */
     ocsd_datapath_resp_t Flush();    /* flush existing data if possible, retain state - propogate to attached components */
 
+    /* save and restore the dynamic deformatter state - partial frame and current ID */
+    ocsd_err_t saveState(std::vector<uint8_t> &state);
+    ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
+    /* decode stage times for the deformatter - 0 if not initialised */
+    const ocsd_stage_times_t *getStageTimes() const;
+    void resetStageTimes();
+
 private:
     TraceFmtDcdImpl *m_pDecoder;
     int m_instNum;
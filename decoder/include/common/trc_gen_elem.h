@@ -85,6 +85,7 @@ public:
 // stringize the element
 
     virtual void toString(std::string &str) const;
+    virtual int toStringBuf(char *buffer, const int buf_size) const;
 
 // get elements API
 
@@ -98,7 +99,7 @@ public:
     void copyPersistentData(const OcsdTraceElement &src);
 
 private:
-    void printSWInfoPkt(std::ostringstream &oss) const;
+    void printSWInfoPkt(trcPrintBuffer &buf) const;
     void clearPerPktData(); //!< clear flags that indicate validity / have values on a per packet basis
 
 };
@@ -0,0 +1,184 @@
+/*
+ * \file       trc_gen_elem_coverage.h
+ * \brief      OpenCSD : Code coverage bitmap generic element sink.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_TRC_GEN_ELEM_COVERAGE_H_INCLUDED
+#define ARM_TRC_GEN_ELEM_COVERAGE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "trc_gen_elem.h"
+#include "interfaces/trc_gen_elem_in_i.h"
+
+/** @addtogroup gen_trc_elem 
+@{*/
+
+/*
+ * Coverage file format (version 1).
+ *
+ * File header:
+ *  [8 bytes]  magic "OCSDCOVM"
+ *  [2 bytes]  format version (LE)
+ *  [2 bytes]  header size in bytes (LE)
+ *  [4 bytes]  number of regions (LE)
+ *
+ * Followed by a record for each region:
+ *  [varint ]  start address
+ *  [varint ]  end address (inclusive)
+ *  [1 byte ]  granule size in bytes
+ *  [runs   ]  bitmap words as runs of [varint] zero word count, [varint] literal word count,
+ *             [8 bytes LE] per literal word - until all the words in the region are covered.
+ *
+ * Varints are unsigned LEB128. Bit N of word W is set if the granule at 
+ * start address + ((W * 64) + N) * granule size has been executed.
+ */
+#define OCSD_COV_MAGIC          "OCSDCOVM"
+#define OCSD_COV_VERSION        1
+#define OCSD_COV_HDR_SIZE       16
+
+#define OCSD_COV_GRANULE_T32    2   /**< granule size for regions containing T32 code - default */
+#define OCSD_COV_GRANULE_A64    4   /**< granule size for regions containing only A32 / A64 code */
+
+/** largest region size for a bitmap - larger accessor ranges are rejected */
+#define OCSD_COV_MAX_REGION_SIZE ((ocsd_vaddr_t)1 << 32)
+
+/** function or symbol address range for coverage summaries */
+typedef struct _ocsd_cov_func {
+    std::string name;
+    ocsd_vaddr_t st_addr;   /**< start address */
+    ocsd_vaddr_t en_addr;   /**< end address - exclusive */
+    uint64_t num_granules;  /**< out: number of granules in the range that are within coverage regions */
+    uint64_t num_covered;   /**< out: number of those granules that have been executed */
+} ocsd_cov_func_t;
+
+/*!
+ * @class TrcGenElemCoverage
+ * @brief Generic element sink that records executed code in dense bitmaps.
+ * 
+ * Coverage is recorded for a set of address regions - typically the ranges mapped by 
+ * the memory accessors in a decode tree (DecodeTree::getMappedRanges()). Each region 
+ * holds a bit per granule - 2 bytes for regions containing T32 code, or 4 bytes for 
+ * A32 / A64 only regions - and executed instruction ranges set the bits a word at a time.
+ *
+ * Instruction range elements outside all the regions are counted but not recorded. 
+ * Ranges with no path information (OCSD_GEN_TRC_ELEM_I_RANGE_NOPATH) are not recorded.
+ *
+ * Maps built from multiple cores or decode trees can be combined with merge(), and saved 
+ * to and loaded from a compact binary file.
+ */
+class TrcGenElemCoverage : public ITrcGenElemIn
+{
+public:
+    TrcGenElemCoverage();
+    virtual ~TrcGenElemCoverage() {};
+
+    /*!
+     * Add a region to record coverage for. Regions may not overlap.
+     *
+     * @param st_addr : start address of the region.
+     * @param en_addr : end address of the region - inclusive.
+     * @param granule : granule size in bytes - OCSD_COV_GRANULE_T32 or OCSD_COV_GRANULE_A64.
+     *
+     * @return ocsd_err_t : OCSD_OK, OCSD_ERR_MEM_ACC_OVERLAP if overlaps an existing region, 
+     *                      OCSD_ERR_MEM_ACC_RANGE_INVALID if the range or granule is invalid.
+     */
+    ocsd_err_t addRegion(const ocsd_vaddr_t st_addr, const ocsd_vaddr_t en_addr, const int granule = OCSD_COV_GRANULE_T32);
+
+    /*!
+     * Add a set of regions - e.g. from DecodeTree::getMappedRanges(). Regions that cannot be added are 
+     * skipped, the first error is returned.
+     */
+    ocsd_err_t addRegions(const std::vector<std::pair<ocsd_vaddr_t, ocsd_vaddr_t> > &ranges, const int granule = OCSD_COV_GRANULE_T32);
+
+    void clear();           //!< remove all regions and coverage.
+    void clearCoverage();   //!< clear recorded coverage - keep the regions.
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                              const uint8_t trc_chan_id,
+                                              const OcsdTraceElement &elem);
+
+    /*!
+     * Mark an address range as executed.
+     *
+     * @param st_addr : start address.
+     * @param en_addr : end address - exclusive.
+     */
+    void markRange(const ocsd_vaddr_t st_addr, const ocsd_vaddr_t en_addr);
+
+    const bool isCovered(const ocsd_vaddr_t addr) const;    //!< true if the granule containing addr has been executed.
+
+    /*!
+     * Combine the coverage from another map into this one. Regions in the other map with a 
+     * matching address range and granule are combined word at a time, otherwise the executed
+     * ranges are marked into the regions of this map.
+     */
+    void merge(const TrcGenElemCoverage &other);
+
+    /*!
+     * Fill in the granule counts for a set of functions or symbol ranges.
+     *
+     * @param &funcs : function ranges - num_granules and num_covered set on return.
+     */
+    void getFuncCoverage(std::vector<ocsd_cov_func_t> &funcs) const;
+
+    ocsd_err_t save(const std::string &filename) const;  //!< write the regions and coverage to file.
+    ocsd_err_t load(const std::string &filename);        //!< replace the regions and coverage with those read from file.
+
+    const size_t getNumRegions() const { return m_regions.size(); };
+    const uint64_t getNumUnmapped() const { return m_num_unmapped; };  //!< instruction ranges outside all regions.
+
+private:
+    typedef struct _cov_region {
+        ocsd_vaddr_t st_addr;
+        ocsd_vaddr_t en_addr;       //!< inclusive
+        int granule_shift;          //!< log2 granule size.
+        std::vector<uint64_t> bits;
+    } cov_region_t;
+
+    size_t firstRegionFrom(const ocsd_vaddr_t addr) const;  //!< index of first region ending at or after addr.
+    int findRegion(const ocsd_vaddr_t addr) const;          //!< index of region containing addr, -1 if none.
+    void setBits(cov_region_t &region, const uint64_t first_bit, const uint64_t last_bit);
+    uint64_t countBits(const cov_region_t &region, const uint64_t first_bit, const uint64_t last_bit) const;
+
+    std::vector<cov_region_t> m_regions;    //!< regions sorted by start address.
+    mutable int m_last_region;              //!< most recently used region - tried first.
+    uint64_t m_num_unmapped;
+};
+
+/** @}*/
+
+#endif // ARM_TRC_GEN_ELEM_COVERAGE_H_INCLUDED
+
+/* End of File trc_gen_elem_coverage.h */
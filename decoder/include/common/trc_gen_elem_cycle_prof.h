@@ -0,0 +1,136 @@
+/*
+ * \file       trc_gen_elem_cycle_prof.h
+ * \brief      OpenCSD : Cycle count profiler generic element sink.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_TRC_GEN_ELEM_CYCLE_PROF_H_INCLUDED
+#define ARM_TRC_GEN_ELEM_CYCLE_PROF_H_INCLUDED
+
+#include <vector>
+
+#include "trc_gen_elem.h"
+#include "interfaces/trc_gen_elem_in_i.h"
+
+/** @addtogroup gen_trc_elem 
+@{*/
+
+#define OCSD_CYC_PROF_DEF_BUCKET_SHIFT  4       /**< default bucket size - 16 bytes */
+#define OCSD_CYC_PROF_MAX_PENDING       4096    /**< ranges held per trace ID waiting for a cycle count */
+
+/** profile data for an address bucket */
+typedef struct _ocsd_cyc_prof_bucket {
+    ocsd_vaddr_t addr;  /**< start address of the bucket */
+    uint64_t hits;      /**< number of instruction ranges executed in the bucket */
+    double instr;       /**< instructions executed in the bucket */
+    double cycles;      /**< cycles attributed to the instructions in the bucket */
+} ocsd_cyc_prof_bucket_t;
+
+/*!
+ * @class TrcGenElemCycleProfile
+ * @brief Generic element sink that attributes cycle counts to executed code.
+ * 
+ * Cycle counts in cycle accurate trace give the cycles since the previous count, either 
+ * as a cycle count element or on another element with has_cc set. Instruction ranges are 
+ * held per trace ID until the next count, which is then shared across them in proportion to 
+ * their instruction counts. An instruction range carrying a count is included in it. A count 
+ * with no ranges since the previous count is added to the last range given cycles.
+ *
+ * Cycles and instructions are accumulated into fixed size address buckets, held in an open 
+ * addressed hash table. A range spanning buckets is shared across them by size, so bucket 
+ * values may be fractional. Ranges that are not followed by a count before a trace discontinuity,
+ * or before OCSD_CYC_PROF_MAX_PENDING ranges are waiting, are recorded with no cycles.
+ */
+class TrcGenElemCycleProfile : public ITrcGenElemIn
+{
+public:
+    TrcGenElemCycleProfile();
+    virtual ~TrcGenElemCycleProfile() {};
+
+    /*! set the bucket size as a power of 2 - 1 to 16 (2 - 64k bytes). Clears the profile. */
+    ocsd_err_t setBucketShift(const int shift);
+    void clear();   //!< clear all profile data.
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                              const uint8_t trc_chan_id,
+                                              const OcsdTraceElement &elem);
+
+    /*! record any ranges still waiting for a cycle count - with no cycles. Call at the end of trace. */
+    void flush();
+
+    /*!
+     * Get the hotspot report - buckets sorted by attributed cycles, then by instructions.
+     *
+     * @param &hotspots : vector filled with the report.
+     * @param max_num : maximum number of buckets to return - 0 for all.
+     */
+    void getHotspots(std::vector<ocsd_cyc_prof_bucket_t> &hotspots, const size_t max_num = 0) const;
+
+    const size_t getNumBuckets() const { return m_num_used; };
+    const uint64_t getTotalCycles() const { return m_total_cycles; };           //!< cycles attributed to instructions.
+    const uint64_t getUnattribCycles() const { return m_unattrib_cycles; };     //!< cycle counts with no preceding ranges.
+    const uint64_t getTotalInstr() const { return m_total_instr; };
+    const uint64_t getUnattribInstr() const { return m_unattrib_instr; };       //!< instructions recorded with no cycles.
+
+private:
+    typedef struct _prof_range {
+        ocsd_vaddr_t st_addr;
+        ocsd_vaddr_t en_addr;
+        uint32_t num_instr;
+    } prof_range_t;
+
+    void attributeCycles(std::vector<prof_range_t> &pending, prof_range_t &last_range, const uint32_t cycles);
+    void flushPending(std::vector<prof_range_t> &pending);
+    void addRange(const prof_range_t &range, const double cycles);   //!< add executed range and its cycles.
+    void addCycles(const prof_range_t &range, const double cycles);  //!< add further cycles to a range already added.
+    void addToBuckets(const prof_range_t &range, const uint32_t num_instr, const double cycles, const uint32_t hits);
+    ocsd_cyc_prof_bucket_t &getBucket(const ocsd_vaddr_t addr);
+    void growTable();
+
+    std::vector<prof_range_t> m_pending[256];       //!< ranges waiting for a cycle count per trace ID.
+    prof_range_t m_last_range[256];                 //!< last range given cycles per trace ID - num_instr 0 if none.
+
+    std::vector<ocsd_cyc_prof_bucket_t> m_table;    //!< open addressed bucket table - power of 2 size.
+    size_t m_num_used;
+    int m_bucket_shift;
+
+    uint64_t m_total_cycles;
+    uint64_t m_unattrib_cycles;
+    uint64_t m_total_instr;
+    uint64_t m_unattrib_instr;
+};
+
+/** @}*/
+
+#endif // ARM_TRC_GEN_ELEM_CYCLE_PROF_H_INCLUDED
+
+/* End of File trc_gen_elem_cycle_prof.h */
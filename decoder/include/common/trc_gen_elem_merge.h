@@ -0,0 +1,193 @@
+/*
+ * \file       trc_gen_elem_merge.h
+ * \brief      OpenCSD : Timestamp ordered merge of generic trace element streams.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_TRC_GEN_ELEM_MERGE_H_INCLUDED
+#define ARM_TRC_GEN_ELEM_MERGE_H_INCLUDED
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <queue>
+
+#include "trc_gen_elem.h"
+#include "interfaces/trc_gen_elem_in_i.h"
+#include "interfaces/trc_merged_elem_in_i.h"
+
+/** @addtogroup gen_trc_elem 
+@{*/
+
+/*!
+ * @class TrcGenElemMerge
+ * @brief Merge generic element streams from multiple trace sources into a single time ordered stream.
+ * 
+ * Each decode tree to be merged is given an input interface, identified by a client source tag, 
+ * which is set as the generic element output of the tree. A merge source is a trace ID within 
+ * a tagged input, so multiple trace sources in a single tree are also merged.
+ *
+ * Elements are buffered per source in segments. A segment is closed by a timestamp element, 
+ * or an element with an associated timestamp - all the elements in the segment occurred before 
+ * the closing timestamp. Closed segments are merged from a min-heap in timestamp order, ties 
+ * ordered by source tag then trace ID, and are output once no other active source can still 
+ * produce an earlier segment. Elements within a source are never re-ordered.
+ *
+ * Buffered elements are bounded - if the limit is reached, the earliest available segment is 
+ * output regardless, and counted as a forced output. Sources without timestamps can only be 
+ * output in this way or at the end of the trace.
+ *
+ * A _WAIT response from the output is returned to the input that was in progress. The client 
+ * must call drain() until the response is not _WAIT before flushing the decode trees. At the end 
+ * of the trace call finish() to output all the remaining elements.
+ */
+class TrcGenElemMerge
+{
+public:
+    TrcGenElemMerge();
+    ~TrcGenElemMerge();
+
+    /*!
+     * Get the element input interface for a source tag - created on first call for a tag.
+     *
+     * @param source_tag : client tag for the decode tree. Passed to the output with each element.
+     *
+     * @return ITrcGenElemIn * : input to set as the generic element output of the decode tree.
+     */
+    ITrcGenElemIn *getInput(const int source_tag);
+
+    void setOutput(ITrcMergedElemIn *p_out) { m_p_out = p_out; };   //!< set the merged element output.
+    void setMaxBuffered(const size_t max_elem);                     //!< set buffered element limit - default OCSD_MERGE_DEF_MAX_BUFFERED.
+
+    /*!
+     * Output all the elements that are known to be in order. 
+     * Use to continue the output after a _WAIT response.
+     *
+     * @return ocsd_datapath_resp_t : last response from the output.
+     */
+    ocsd_datapath_resp_t drain();
+
+    /*!
+     * End of trace on all sources - output all buffered elements. 
+     * Elements after the last timestamp of a source are ordered at that timestamp.
+     * May be called again after a _WAIT response to continue.
+     *
+     * @return ocsd_datapath_resp_t : last response from the output.
+     */
+    ocsd_datapath_resp_t finish();
+
+    void reset();   //!< discard all buffered elements and sources. Inputs remain valid.
+
+    const size_t getNumBuffered() const { return m_num_buffered; };  //!< number of elements currently buffered.
+    const uint64_t getNumForced() const { return m_num_forced; };    //!< number of segments output early due to the buffer limit.
+
+private:
+    /* input adapter for a single tagged decode tree */
+    class MergeInput : public ITrcGenElemIn
+    {
+    public:
+        MergeInput(TrcGenElemMerge *p_merge, const int source_tag) : m_p_merge(p_merge), m_source_tag(source_tag) {};
+        virtual ~MergeInput() {};
+
+        virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                                  const uint8_t trc_chan_id,
+                                                  const OcsdTraceElement &elem)
+        {
+            return m_p_merge->elemIn(m_source_tag, index_sop, trc_chan_id, elem);
+        };
+
+    private:
+        TrcGenElemMerge *m_p_merge;
+        int m_source_tag;
+    };
+
+    /* buffered element - extended data copied for SW trace payloads */
+    typedef struct _merge_elem {
+        ocsd_trc_index_t index_sop;
+        ocsd_generic_trace_elem elem;
+        std::vector<uint8_t> ext_data;
+    } merge_elem_t;
+
+    /* single trace source - trace ID in a tagged input */
+    typedef struct _merge_source {
+        int source_tag;
+        uint8_t trc_chan_id;
+        std::deque<merge_elem_t> elems;     //!< buffered elements - closed segments followed by the open segment.
+        std::deque<size_t> seg_sizes;       //!< number of elements in each closed segment.
+        size_t num_open;                    //!< number of elements in the open segment.
+        uint64_t last_ts;                   //!< last timestamp seen - key of the last closed segment.
+        bool ts_seen;
+        bool done;                          //!< end of trace seen on this source.
+    } merge_source_t;
+
+    /* heap entry for a closed segment */
+    typedef struct _merge_seg_key {
+        uint64_t ts;
+        int source_tag;
+        uint8_t trc_chan_id;
+        uint64_t seq;                       //!< order segments were closed - keeps equal keys in source order.
+        size_t src_idx;
+        bool operator>(const struct _merge_seg_key &rhs) const;
+    } merge_seg_key_t;
+
+    ocsd_datapath_resp_t elemIn(const int source_tag, const ocsd_trc_index_t index_sop, const uint8_t trc_chan_id, const OcsdTraceElement &elem);
+    size_t getSource(const int source_tag, const uint8_t trc_chan_id);
+    void closeSegment(const size_t src_idx, const uint64_t ts);
+    bool segmentReady(const merge_seg_key_t &key) const;
+    ocsd_datapath_resp_t outputElems();
+    ocsd_datapath_resp_t emitCurrent();
+
+    ITrcMergedElemIn *m_p_out;
+    std::map<int, MergeInput *> m_inputs;
+    std::vector<merge_source_t> m_sources;
+    std::map<std::pair<int, uint8_t>, size_t> m_source_map;     //!< (tag, trace ID) to source index.
+    std::priority_queue<merge_seg_key_t, std::vector<merge_seg_key_t>, std::greater<merge_seg_key_t> > m_seg_heap;
+
+    size_t m_emit_src;          //!< source currently being output.
+    size_t m_emit_remaining;    //!< elements remaining to output from current source - 0 if none in progress.
+
+    size_t m_max_buffered;
+    size_t m_num_buffered;
+    uint64_t m_num_forced;
+    uint64_t m_seg_seq;
+    bool m_finishing;
+    OcsdTraceElement m_out_elem;    //!< element passed to the output.
+};
+
+/** default limit on the total number of buffered elements */
+#define OCSD_MERGE_DEF_MAX_BUFFERED (256 * 1024)
+
+/** @}*/
+
+#endif // ARM_TRC_GEN_ELEM_MERGE_H_INCLUDED
+
+/* End of File trc_gen_elem_merge.h */
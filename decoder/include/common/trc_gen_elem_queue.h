@@ -0,0 +1,142 @@
+/*
+ * \file       trc_gen_elem_queue.h
+ * \brief      OpenCSD : Queue generic trace elements to a sink on a consumer thread.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+
+#ifndef ARM_TRC_GEN_ELEM_QUEUE_H_INCLUDED
+#define ARM_TRC_GEN_ELEM_QUEUE_H_INCLUDED
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "trc_gen_elem.h"
+#include "interfaces/trc_gen_elem_in_i.h"
+
+/** @addtogroup gen_trc_elem 
+@{*/
+
+/** default number of elements in the queue */
+#define OCSD_ELEM_QUEUE_DEF_SIZE 4096
+
+/*!
+ * @class TrcGenElemQueue
+ * @brief Run a generic element sink on a dedicated consumer thread.
+ * 
+ * Set as the generic element output of a decode tree. Elements are copied into a bounded 
+ * lock-free single producer / single consumer ring, and passed to the output sink on the 
+ * consumer thread, so decode overlaps with expensive element analysis.
+ *
+ * When an element fills the ring, OCSD_RESP_WAIT is returned to the decoder - the client 
+ * may do other work before flushing the decode tree as usual. An element arriving while 
+ * the ring is still full blocks the decode thread until there is space - elements are 
+ * never dropped.
+ *
+ * _WAIT responses from the output sink are ignored - the queue provides the flow control. 
+ * A fatal response is returned to the decoder on the next element. Extended data is 
+ * copied for SW trace payloads only.
+ *
+ * Call flush() to wait until all queued elements have been output, e.g. after the end of 
+ * trace has been sent to the decode tree, before using the analysis results.
+ */
+class TrcGenElemQueue : public ITrcGenElemIn
+{
+public:
+    TrcGenElemQueue();
+    virtual ~TrcGenElemQueue();
+
+    /*!
+     * Start the consumer thread.
+     *
+     * @param *p_out : Output sink - called on the consumer thread.
+     * @param queue_size : Number of elements in the ring. Rounded up to a power of 2.
+     *
+     * @return ocsd_err_t : OCSD_OK if started.
+     */
+    ocsd_err_t start(ITrcGenElemIn *p_out, const uint32_t queue_size = OCSD_ELEM_QUEUE_DEF_SIZE);
+
+    void flush();   //!< wait until all queued elements have been output.
+    void stop();    //!< flush, and end the consumer thread.
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                              const uint8_t trc_chan_id,
+                                              const OcsdTraceElement &elem);
+
+    const uint64_t getNumWaits() const { return m_num_waits; };     //!< number of _WAIT responses returned.
+    const uint64_t getNumBlocked() const { return m_num_blocked; }; //!< number of elements that blocked on a full ring.
+
+private:
+    /* queued element - extended data copied for SW trace payloads */
+    typedef struct _queue_elem {
+        ocsd_trc_index_t index_sop;
+        uint8_t trc_chan_id;
+        ocsd_generic_trace_elem elem;
+        std::vector<uint8_t> ext_data;
+    } queue_elem_t;
+
+    void consumerThread();
+    void waitForElems(const uint32_t tail);
+    void wakeConsumer();
+
+    const bool ringFull(const uint32_t head) const { return (head - m_tail.load(std::memory_order_acquire)) == m_size; };
+
+    std::vector<queue_elem_t> m_ring;
+    uint32_t m_size;
+    uint32_t m_mask;
+    uint32_t m_wake_level;  //!< queued elements needed to wake an idle consumer.
+    ITrcGenElemIn *m_p_out;
+
+    std::atomic<uint32_t> m_head;   //!< next slot to write - written by the decode thread only.
+    uint8_t m_pad[64];              //!< keep head and tail on separate cache lines.
+    std::atomic<uint32_t> m_tail;   //!< next slot to read - written by the consumer thread only.
+
+    std::atomic<ocsd_datapath_resp_t> m_out_resp;   //!< fatal response from the output sink.
+    std::atomic<bool> m_stop;
+    std::atomic<bool> m_consumer_idle;
+
+    std::thread m_thread;
+    std::mutex m_idle_mutex;
+    std::condition_variable m_idle_cv;
+
+    uint64_t m_num_waits;
+    uint64_t m_num_blocked;
+};
+
+/** @}*/
+
+#endif // ARM_TRC_GEN_ELEM_QUEUE_H_INCLUDED
+
+/* End of File trc_gen_elem_queue.h */
@@ -0,0 +1,198 @@
+/*
+ * \file       trc_gen_elem_serial.h
+ * \brief      OpenCSD : Compact binary serialisation of generic trace elements.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+#ifndef ARM_TRC_GEN_ELEM_SERIAL_H_INCLUDED
+#define ARM_TRC_GEN_ELEM_SERIAL_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+
+#include "trc_gen_elem.h"
+#include "interfaces/trc_gen_elem_in_i.h"
+
+/** @addtogroup gen_trc_elem 
+@{*/
+
+/*
+ * Serialised element stream format (version 1).
+ *
+ * File header:
+ *  [8 bytes]  magic "OCSDGELM"
+ *  [2 bytes]  format version (LE)
+ *  [2 bytes]  header size in bytes (LE)
+ *  [4 bytes]  reserved - 0.
+ *
+ * Followed by a sequence of element records:
+ *  [1 byte ]  bits[4:0] element type, bit[5] same trace ID as previous record, 
+ *             bit[6] same trace index as previous record.
+ *  [1 byte ]  trace ID - only if bit[5] clear
+ *  [varint ]  zig-zag trace index delta from previous record - only if bit[6] clear
+ *  [varint ]  field mask - OCSD_SER_F_xxx bits for fields that differ from the previous 
+ *             element with the same trace ID.
+ *  [fields ]  the changed fields, in field mask bit order.
+ *
+ * Varints are unsigned LEB128. Addresses and timestamps are zig-zag encoded deltas. PE contexts are 
+ * written once into a dictionary and subsequently referenced by dictionary index.
+ */
+#define OCSD_SER_MAGIC          "OCSDGELM"
+#define OCSD_SER_VERSION        1
+#define OCSD_SER_HDR_SIZE       16
+
+#define OCSD_SER_REC_TYPE_MASK  0x1F    /**< element type bits in the record header */
+#define OCSD_SER_REC_SAME_ID    0x20    /**< trace ID omitted - same as previous record */
+#define OCSD_SER_REC_SAME_IDX   0x40    /**< trace index omitted - same as previous record */
+
+#define OCSD_SER_F_ISA          0x0001  /**< isa  : [1 byte] */
+#define OCSD_SER_F_ST_ADDR      0x0002  /**< st_addr : [varint] zig-zag delta from previous en_addr */
+#define OCSD_SER_F_EN_ADDR      0x0004  /**< en_addr : [varint] zig-zag delta from st_addr */
+#define OCSD_SER_F_CONTEXT      0x0008  /**< context : [varint] dictionary index. If index == dictionary size a new entry follows. */
+#define OCSD_SER_F_TS           0x0010  /**< timestamp : [varint] zig-zag delta from previous timestamp */
+#define OCSD_SER_F_CC           0x0020  /**< cycle_count : [varint] */
+#define OCSD_SER_F_LAST_I       0x0040  /**< last_i_type, last_i_subtype : [1 byte] each */
+#define OCSD_SER_F_FLAGS        0x0080  /**< flag_bits : [varint] */
+#define OCSD_SER_F_PAYLOAD      0x0100  /**< packet specific payload union : [varint] */
+#define OCSD_SER_F_EXT_DATA     0x0200  /**< extended data : [varint] size, [size bytes] data (SW trace payload only) */
+
+/*!
+ * @class TrcGenElemSerialWriter
+ * @brief Generic element sink that writes a compact binary element stream to file.
+ * 
+ * Attach as the generic element output of a decode tree, or pass elements in directly.
+ * Fields are only written when they change from the previous element with the same trace ID,
+ * giving output a fraction of the size of the printed element strings.
+ */
+class TrcGenElemSerialWriter : public ITrcGenElemIn
+{
+public:
+    TrcGenElemSerialWriter();
+    virtual ~TrcGenElemSerialWriter();
+
+    ocsd_err_t open(const std::string &filename);   //!< create the output file and write the header.
+    ocsd_err_t close();                             //!< flush remaining data and close the file.
+    const bool isOpen() const { return m_out_file.is_open(); };
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                              const uint8_t trc_chan_id,
+                                              const OcsdTraceElement &elem);
+
+    const uint64_t getNumElem() const { return m_num_elem; };   //!< number of elements written.
+
+private:
+    void writeElem(const ocsd_trc_index_t index_sop, const uint8_t trc_chan_id, const ocsd_generic_trace_elem &elem);
+    void writeContext(const ocsd_pe_context &context);
+    void putByte(const uint8_t val) { m_buffer.push_back(val); };
+    void putVarint(uint64_t val);
+    ocsd_err_t flushBuffer();
+    void resetState();
+
+    std::ofstream m_out_file;
+    std::vector<uint8_t> m_buffer;      //!< output staging buffer - flushed to file when full.
+
+    ocsd_generic_trace_elem m_prev_elem[256];   //!< previous element state per trace ID.
+    ocsd_trc_index_t m_prev_index;
+    uint8_t m_prev_chan_id;
+    uint64_t m_num_elem;
+
+    typedef std::map<std::pair<uint64_t, uint32_t>, uint32_t> ctxt_dict_t;
+    ctxt_dict_t m_ctxt_dict;            //!< PE contexts seen so far, mapped to dictionary index.
+};
+
+/*!
+ * @class TrcGenElemSerialReader
+ * @brief Iterate over the generic elements in a serialised element stream.
+ * 
+ * The stream is read from an in memory buffer - either loaded from file, or supplied by the client.
+ * Elements are returned in a single element owned by the reader, valid until the next call. 
+ * SW trace payload extended data pointers point directly into the stream buffer.
+ */
+class TrcGenElemSerialReader
+{
+public:
+    TrcGenElemSerialReader();
+    ~TrcGenElemSerialReader() {};
+
+    ocsd_err_t open(const std::string &filename);                   //!< load file and check header.
+    ocsd_err_t setBuffer(const uint8_t *p_buffer, const size_t size); //!< use client buffer - must persist while reading.
+    void close();
+
+    ocsd_err_t rewind();    //!< return to the first element in the stream.
+
+    /*!
+     * Get the next element in the stream.
+     *
+     * @param &index_sop : trace index of the element.
+     * @param &trc_chan_id : trace ID for the element.
+     * @param &p_elem : pointer to element, 0 if end of stream reached.
+     *
+     * @return ocsd_err_t : OCSD_OK, or OCSD_ERR_FILE_ERROR if the stream is corrupt or truncated.
+     */
+    ocsd_err_t nextElem(ocsd_trc_index_t &index_sop, uint8_t &trc_chan_id, const OcsdTraceElement *&p_elem);
+
+    /*!
+     * Send elements from the current position to the supplied sink, until end of stream or 
+     * the sink returns a response other than continue.
+     *
+     * @param *p_sink : generic element input interface.
+     *
+     * @return ocsd_datapath_resp_t : last response from the sink, OCSD_RESP_FATAL_SYS_ERR on stream error.
+     */
+    ocsd_datapath_resp_t replay(ITrcGenElemIn *p_sink);
+
+    const bool atEnd() const { return m_pos >= m_size; };
+
+private:
+    ocsd_err_t getVarint(uint64_t &val);
+    ocsd_err_t readContext(ocsd_pe_context &context);
+    void resetState();
+
+    std::vector<uint8_t> m_file_data;   //!< data loaded from file.
+    const uint8_t *m_p_data;            //!< stream data.
+    size_t m_size;
+    size_t m_pos;
+
+    OcsdTraceElement m_elem;                    //!< element returned to client.
+    ocsd_generic_trace_elem m_prev_elem[256];   //!< previous element state per trace ID.
+    ocsd_trc_index_t m_prev_index;
+    uint8_t m_prev_chan_id;
+
+    std::vector<ocsd_pe_context> m_ctxt_dict;
+};
+
+/** @}*/
+
+#endif // ARM_TRC_GEN_ELEM_SERIAL_H_INCLUDED
+
+/* End of File trc_gen_elem_serial.h */
@@ -42,6 +42,7 @@
 #include "interfaces/trc_gen_elem_in_i.h"
 #include "interfaces/trc_tgt_mem_access_i.h"
 #include "interfaces/trc_instr_decode_i.h"
+#include "common/ocsd_pe_filter.h"
 
 /** @defgroup ocsd_pkt_decode OpenCSD Library : Packet Decoders.
 
@@ -58,6 +59,9 @@
 @{*/
 
 
+/** Size of the opcode span read by PE decoders when scanning for the next waypoint. */
+#define OCSD_DCD_WP_SCAN_BYTES 64
+
 class TrcPktDecodeI : public TraceComponent
 {
 public:
@@ -75,6 +79,16 @@ public:
     void setUsesIDecode(bool bUsesIDecode) { m_uses_idecode = bUsesIDecode; };
     const bool getUsesIDecode() const { return m_uses_idecode; };
 
+    /*!
+     * Set the PE context and address filter. PE decoders that support filtering 
+     * skip instruction decode while outside the filter.
+     *
+     * @param &filter : filter to copy. Inactive filter disables filtering.
+     *
+     * @return ocsd_err_t : OCSD_OK, or OCSD_ERR_DCD_INTERFACE_UNUSED if filtering not supported.
+     */
+    virtual ocsd_err_t setPeFilter(const OcsdPeFilter &filter) { return OCSD_ERR_DCD_INTERFACE_UNUSED; };
+
 protected:
 
     /* implementation packet decoding interface */
@@ -99,6 +113,10 @@ protected:
 
     /* instruction decode */
     ocsd_err_t instrDecode(ocsd_instr_info *instr_info);
+    ocsd_err_t instrFindNextWaypoint(ocsd_instr_info *instr_info, const uint8_t *span, const uint32_t span_bytes, uint32_t *num_instr);
+
+    /* precomputed basic block - resolve range to next waypoint without memory reads */
+    bool instrFindBasicBlock(const ocsd_mem_space_acc_t mem_space, ocsd_instr_info *instr_info, uint32_t *num_instr);
 
     componentAttachPt<ITrcGenElemIn> m_trace_elem_out;
     componentAttachPt<ITargetMemAccess> m_mem_access;
@@ -158,25 +176,53 @@ inline const bool TrcPktDecodeI::checkInit()
 
 inline ocsd_datapath_resp_t TrcPktDecodeI::outputTraceElement(const OcsdTraceElement &elem)
 {
+    OCSD_STAGE_TIMER(OCSD_TSTAGE_ELEM_OUT);
     return m_trace_elem_out.first()->TraceElemIn(m_index_curr_pkt,getCoreSightTraceID(), elem);
 }
 
 inline ocsd_datapath_resp_t TrcPktDecodeI::outputTraceElementIdx(ocsd_trc_index_t idx, const OcsdTraceElement &elem)
 {
+    OCSD_STAGE_TIMER(OCSD_TSTAGE_ELEM_OUT);
     return m_trace_elem_out.first()->TraceElemIn(idx, getCoreSightTraceID(), elem);
 }
 
 inline ocsd_err_t TrcPktDecodeI::instrDecode(ocsd_instr_info *instr_info)
 {
     if(m_uses_idecode)
+    {
+        OCSD_STAGE_TIMER(OCSD_TSTAGE_INSTR_DECODE);
         return m_instr_decode.first()->DecodeInstruction(instr_info);
+    }
     return OCSD_ERR_DCD_INTERFACE_UNUSED;
 }
 
+inline ocsd_err_t TrcPktDecodeI::instrFindNextWaypoint(ocsd_instr_info *instr_info, const uint8_t *span, const uint32_t span_bytes, uint32_t *num_instr)
+{
+    if(m_uses_idecode)
+    {
+        OCSD_STAGE_TIMER(OCSD_TSTAGE_INSTR_DECODE);
+        return m_instr_decode.first()->FindNextWaypoint(instr_info, span, span_bytes, num_instr);
+    }
+    return OCSD_ERR_DCD_INTERFACE_UNUSED;
+}
+
+inline bool TrcPktDecodeI::instrFindBasicBlock(const ocsd_mem_space_acc_t mem_space, ocsd_instr_info *instr_info, uint32_t *num_instr)
+{
+    if(m_uses_memaccess)
+    {
+        OCSD_STAGE_TIMER(OCSD_TSTAGE_MEM_ACC);
+        return m_mem_access.first()->FindBasicBlock(getCoreSightTraceID(), mem_space, instr_info, num_instr);
+    }
+    return false;
+}
+
 inline ocsd_err_t TrcPktDecodeI::accessMemory(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space, uint32_t *num_bytes, uint8_t *p_buffer)
 {
     if(m_uses_memaccess)
+    {
+        OCSD_STAGE_TIMER(OCSD_TSTAGE_MEM_ACC);
         return m_mem_access.first()->ReadTargetMemory(address,getCoreSightTraceID(),mem_space, num_bytes,p_buffer);
+    }
     return OCSD_ERR_DCD_INTERFACE_UNUSED;
 }
 
@@ -231,12 +277,15 @@ template <class P, class Pc> ocsd_datapath_resp_t TrcPktDecodeBase<P, Pc>::Packe
                                                 const P *p_packet_in)
 {
     ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
-    if(!checkInit())
+
+    // reset only clears decode state - allowed before the output interfaces are attached.
+    if(!checkInit() && (op != OCSD_OP_RESET))
     {
         LogError(ocsdError(OCSD_ERR_SEV_ERROR,OCSD_ERR_NOT_INIT,init_err_msg));
         return OCSD_RESP_FATAL_NOT_INIT;
     }
 
+    OCSD_STAGE_TIMER(OCSD_TSTAGE_PKT_DECODE);
     switch(op)
     {
     case OCSD_OP_DATA:
@@ -262,6 +311,7 @@ template <class P, class Pc> ocsd_datapath_resp_t TrcPktDecodeBase<P, Pc>::Packe
         break;
 
     case OCSD_OP_RESET:
+        m_index_curr_pkt = index_sop;   // trace restarts - no current packet from before the reset.
         resp = onReset();
         break;
 
@@ -34,6 +34,8 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
  */ 
 
+#include <cstddef>
+
 class TrcPacketBase
 {
 public:
@@ -42,6 +44,9 @@ public:
 
     //! return the underlying C API packet structure
     virtual const void *c_pkt() const = 0;
+
+    //! return the size of the underlying C API packet structure - 0 if packets cannot be copied
+    virtual const size_t c_pkt_size() const { return 0; };
 };
 
 #endif // ARM_TRC_PKT_ELEM_BASE_H_INCLUDED
@@ -43,6 +43,10 @@
 
 #include "trc_component.h"
 #include "comp_attach_pt_t.h"
+#include "trc_pkt_elem_base.h"
+
+#include <vector>
+#include <cstring>
 
 /** @defgroup ocsd_pkt_proc  OpenCSD Library : Packet Processors.
     @brief Classes providing Protocol Packet Processing capability.
@@ -76,8 +80,36 @@ public:
                                                 const uint8_t *pDataBlock,
                                                 uint32_t *numBytesProcessed) = 0;
 
+    /*!
+     * Get the stream summary collected in skim mode (OCSD_OPFLG_PKTPROC_SKIM).
+     *
+     * @param *p_summary : summary structure to fill in.
+     *
+     * @return ocsd_err_t : OCSD_OK, or OCSD_ERR_DCD_INTERFACE_UNUSED if skim mode is not supported.
+     */
+    virtual ocsd_err_t getSkimSummary(ocsd_skim_summary_t *p_summary) const { return OCSD_ERR_DCD_INTERFACE_UNUSED; };
+
+    /*!
+     * Set the maximum number of packets collected into each batch on the batched 
+     * packet output. Set before decoding any trace - default is 64 packets.
+     *
+     * @param max_pkts : maximum packets per batch.
+     *
+     * @return ocsd_err_t : OCSD_OK, or OCSD_ERR_INVALID_PARAM_VAL if 0.
+     */
+    ocsd_err_t setPacketBatchSize(const uint32_t max_pkts);
+
+    //! Attachment point for the batched protocol packet output
+    componentAttachPt<IPktBatchIn> *getPacketBatchOutAttachPt() { return &m_pkt_batch_i; };
+
 protected:
 
+    /* batched packet output */
+    ocsd_datapath_resp_t batchPacket(const ocsd_trc_index_t index_sop, const TrcPacketBase *pkt);    //!< add packet to batch, send if full.
+    ocsd_datapath_resp_t sendPacketBatch(const ocsd_datapath_op_t op);  //!< send pending packets, then any non-data operation.
+    const bool usingPacketBatch() const { return m_pkt_batch_i.hasAttachedAndEnabled(); };
+    const bool hasPacketBatchOut() const { return m_pkt_batch_i.hasAttached(); };
+
     /* implementation packet processing interface */
 
     /*! @brief Implementation function for the OCSD_OP_DATA operation */
@@ -91,16 +123,93 @@ protected:
     virtual ocsd_datapath_resp_t onFlush() = 0;     //!< Implementation function for the OCSD_OP_FLUSH operation
     virtual ocsd_err_t onProtocolConfig() = 0;      //!< Called when the configuration object is passed to the decoder.
     virtual const bool isBadPacket() const = 0;     //!< check if the current packet is an error / bad packet
+
+private:
+    componentAttachPt<IPktBatchIn> m_pkt_batch_i;
+    std::vector<ocsd_trc_index_t> m_batch_idx;  //!< trace index per batched packet
+    std::vector<uint8_t> m_batch_pkts;          //!< C API packet structures
+    uint32_t m_batch_max;       //!< packets per batch
+    uint32_t m_batch_num;       //!< packets pending in batch
+    size_t m_batch_pkt_size;    //!< size of the C API packet structure
 };
 
 inline TrcPktProcI::TrcPktProcI(const char *component_name) :
-    TraceComponent(component_name)
+    TraceComponent(component_name),
+    m_batch_max(64),
+    m_batch_num(0),
+    m_batch_pkt_size(0)
 {
 }
 
 inline TrcPktProcI::TrcPktProcI(const char *component_name, int instIDNum) :
-    TraceComponent(component_name,instIDNum)
+    TraceComponent(component_name,instIDNum),
+    m_batch_max(64),
+    m_batch_num(0),
+    m_batch_pkt_size(0)
+{
+}
+
+inline ocsd_err_t TrcPktProcI::setPacketBatchSize(const uint32_t max_pkts)
+{
+    if (max_pkts == 0)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    m_batch_max = max_pkts;
+    m_batch_num = 0;
+    m_batch_pkt_size = 0;   // buffers sized on the next packet.
+    return OCSD_OK;
+}
+
+inline ocsd_datapath_resp_t TrcPktProcI::batchPacket(const ocsd_trc_index_t index_sop, const TrcPacketBase *pkt)
 {
+    const size_t pkt_size = pkt->c_pkt_size();
+
+    if (m_batch_pkt_size != pkt_size)
+    {
+        if (pkt_size == 0)
+        {
+            LogError(ocsdError(OCSD_ERR_SEV_ERROR, OCSD_ERR_DCD_INTERFACE_UNUSED, "Packet Processor: Packets cannot be batched for this protocol\n"));
+            return OCSD_RESP_FATAL_INVALID_OP;
+        }
+        m_batch_idx.resize(m_batch_max);
+        m_batch_pkts.resize(m_batch_max * pkt_size);
+        m_batch_pkt_size = pkt_size;
+    }
+
+    m_batch_idx[m_batch_num] = index_sop;
+    memcpy(&m_batch_pkts[m_batch_num * pkt_size], pkt->c_pkt(), pkt_size);
+    m_batch_num++;
+    if (m_batch_num == m_batch_max)
+        return sendPacketBatch(OCSD_OP_DATA);
+    return OCSD_RESP_CONT;
+}
+
+inline ocsd_datapath_resp_t TrcPktProcI::sendPacketBatch(const ocsd_datapath_op_t op)
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+
+    if (!m_pkt_batch_i.hasAttachedAndEnabled())
+    {
+        m_batch_num = 0;
+        return resp;
+    }
+
+    // reset drops any pending packets, other operations send them first.
+    if (op == OCSD_OP_RESET)
+        m_batch_num = 0;
+    else if (m_batch_num)
+    {
+        resp = m_pkt_batch_i.first()->PacketBatchIn(OCSD_OP_DATA, m_batch_num, &m_batch_idx[0], &m_batch_pkts[0]);
+        m_batch_num = 0;
+    }
+
+    // pass on the operation - a flush only once the pending packets are accepted.
+    if ((op == OCSD_OP_FLUSH) ? OCSD_DATA_RESP_IS_CONT(resp) : ((op != OCSD_OP_DATA) && !OCSD_DATA_RESP_IS_FATAL(resp)))
+    {
+        ocsd_datapath_resp_t resp_op = m_pkt_batch_i.first()->PacketBatchIn(op, 0, 0, 0);
+        if (resp_op > resp)
+            resp = resp_op;
+    }
+    return resp;
 }
 
 /*!
@@ -223,6 +332,7 @@ template<class P,class Pt, class Pc> ocsd_datapath_resp_t TrcPktProcBase<P, Pt,
                                                 uint32_t *numBytesProcessed)
 {
     ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+    OCSD_STAGE_TIMER(OCSD_TSTAGE_PKT_PROC);
     
     switch(op)
     {
@@ -267,6 +377,14 @@ template<class P,class Pt, class Pc> ocsd_datapath_resp_t TrcPktProcBase<P, Pt,
     if(m_pkt_out_i.hasAttachedAndEnabled())
         resp = m_pkt_out_i.first()->PacketDataIn(OCSD_OP_RESET,index,0);
 
+    // drop any batched packets and reset the batch output.
+    if(!OCSD_DATA_RESP_IS_FATAL(resp))
+    {
+        ocsd_datapath_resp_t batch_resp = sendPacketBatch(OCSD_OP_RESET);
+        if(batch_resp > resp)
+            resp = batch_resp;
+    }
+
     // reset the packet processor implmentation
     if(!OCSD_DATA_RESP_IS_FATAL(resp))
         resp = onReset();
@@ -291,6 +409,10 @@ template<class P,class Pt, class Pc> ocsd_datapath_resp_t TrcPktProcBase<P, Pt,
     if(OCSD_DATA_RESP_IS_CONT(resp))
         resplocal = onFlush();      // local flush
 
+    // send any batched packets, including those output by the local flush.
+    if(OCSD_DATA_RESP_IS_CONT(resp) && OCSD_DATA_RESP_IS_CONT(resplocal))
+        resplocal = sendPacketBatch(OCSD_OP_FLUSH);
+
     return (resplocal > resp) ?  resplocal : resp;
 }
 
@@ -302,6 +424,14 @@ template<class P,class Pt, class Pc> ocsd_datapath_resp_t TrcPktProcBase<P, Pt,
     if(m_pkt_out_i.hasAttachedAndEnabled() && !OCSD_DATA_RESP_IS_FATAL(resp))
         resp = m_pkt_out_i.first()->PacketDataIn(OCSD_OP_EOT,0,0);
 
+    // send any batched packets and the end of trace to the batch output
+    if(!OCSD_DATA_RESP_IS_FATAL(resp))
+    {
+        ocsd_datapath_resp_t batch_resp = sendPacketBatch(OCSD_OP_EOT);
+        if(batch_resp > resp)
+            resp = batch_resp;
+    }
+
     // packet monitor
     if(m_pkt_raw_mon_i.hasAttachedAndEnabled())
         m_pkt_raw_mon_i.first()->RawPacketDataMon(OCSD_OP_EOT,0,0,0,0);
@@ -320,6 +450,14 @@ template<class P,class Pt, class Pc> ocsd_datapath_resp_t TrcPktProcBase<P, Pt,
     // send a complete packet over the primary data path
     if(m_pkt_out_i.hasAttachedAndEnabled())
         resp = m_pkt_out_i.first()->PacketDataIn(OCSD_OP_DATA,index,pkt);
+
+    // add to the batch output - WAIT only returned when a batch is sent.
+    if(usingPacketBatch() && !OCSD_DATA_RESP_IS_FATAL(resp))
+    {
+        ocsd_datapath_resp_t batch_resp = batchPacket(index,pkt);
+        if(batch_resp > resp)
+            resp = batch_resp;
+    }
     return resp;
 }
 
@@ -398,7 +536,7 @@ template<class P,class Pt, class Pc> const bool TrcPktProcBase<P, Pt, Pc>::check
     if(!m_b_is_init)
     {
         if( (m_config != 0) &&
-            (m_pkt_out_i.hasAttached() || m_pkt_raw_mon_i.hasAttached())
+            (m_pkt_out_i.hasAttached() || m_pkt_raw_mon_i.hasAttached() || hasPacketBatchOut())
           )
             m_b_is_init = true;
     }
@@ -42,6 +42,79 @@
 /** @addtogroup ocsd_infrastructure
 @{*/
 
+/*!
+ * @class trcPrintBuffer
+ * @brief Fixed size string output buffer.
+ *
+ *  Allocation free formatting of strings and hex / decimal values into a caller supplied buffer.
+ *  Output is truncated at the buffer size, and the buffer is always zero terminated.
+ *  Holds no shared state, so may be used concurrently on different buffers.
+ */
+class trcPrintBuffer
+{
+public:
+    trcPrintBuffer(char *buffer, const int buf_size);
+    ~trcPrintBuffer() {};
+
+    void addStr(const char *str);
+    void addChar(const char c);
+    void addFill(const char c, int count);
+
+    /*! Hex value, no prefix, zero padded to min_digits, in upper or lower case. */
+    void addHex(const uint64_t value, const int min_digits = 1, const bool upper = false);
+    void addDec(const uint64_t value);
+    void addDecSigned(const int64_t value);
+
+    const int length() const { return m_len; };         //!< number of chars in buffer, excluding terminator
+    const bool truncated() const { return m_truncated; }; //!< true if output did not fit in buffer.
+    const char *c_str() const { return m_buffer; };
+
+private:
+    char *m_buffer;
+    int m_size;
+    int m_len;
+    bool m_truncated;
+};
+
+inline trcPrintBuffer::trcPrintBuffer(char *buffer, const int buf_size) :
+    m_buffer(buffer),
+    m_size(buf_size),
+    m_len(0),
+    m_truncated(false)
+{
+    if(m_buffer && (m_size > 0))
+        m_buffer[0] = 0;
+    else
+        m_size = 0;
+}
+
+inline void trcPrintBuffer::addChar(const char c)
+{
+    if(m_len < (m_size - 1))
+    {
+        m_buffer[m_len++] = c;
+        m_buffer[m_len] = 0;
+    }
+    else
+        m_truncated = true;
+}
+
+inline void trcPrintBuffer::addStr(const char *str)
+{
+    while(*str && (m_len < (m_size - 1)))
+        m_buffer[m_len++] = *str++;
+    if(m_size)
+        m_buffer[m_len] = 0;
+    if(*str)
+        m_truncated = true;
+}
+
+inline void trcPrintBuffer::addFill(const char c, int count)
+{
+    while(count-- > 0)
+        addChar(c);
+}
+
 /*!
  * @class trcPrintableElem
  * @brief Class to provide trace element strings for printing
@@ -60,8 +133,16 @@ public:
     virtual void toString(std::string &str) const;
     virtual void toStringFmt(const uint32_t fmtFlags, std::string &str) const;
 
+    /*! Print the element into a caller supplied buffer. 
+        Elements overriding this do not allocate memory, the default implementation uses toString().
+
+        @return int : number of chars written, excluding the zero terminator. 
+    */
+    virtual int toStringBuf(char *buffer, const int buf_size) const;
+
     // print formatting utilities
     static void getValStr(std::string &valStr, const int valTotalBitSize, const int valValidBits, const uint64_t value, const bool asHex = true, const int updateBits = 0);
+    static void getValStr(trcPrintBuffer &valBuf, const int valTotalBitSize, const int valValidBits, const uint64_t value, const bool asHex = true, const int updateBits = 0);
 
 };
 
@@ -75,6 +156,15 @@ inline void trcPrintableElem::toStringFmt(const uint32_t /*fmtFlags*/, std::stri
     toString(str);
 }
 
+inline int trcPrintableElem::toStringBuf(char *buffer, const int buf_size) const
+{
+    std::string str;
+    trcPrintBuffer buf(buffer, buf_size);
+    toString(str);
+    buf.addStr(str.c_str());
+    return buf.length();
+}
+
 /** static template string function - used in "C" API to provide generic printing */
 template<class Pc, class Pt>
 void trcPrintElemToString(const void *p_pkt, std::string &str)
@@ -84,6 +174,15 @@ void trcPrintElemToString(const void *p_pkt, std::string &str)
     pktClass.toString(str);
 }
 
+/** static template buffer print function - used in "C" API to provide generic printing */
+template<class Pc, class Pt>
+int trcPrintElemToBuffer(const void *p_pkt, char *buffer, const int buf_size)
+{
+    Pc pktClass;
+    pktClass = static_cast<const Pt *>(p_pkt);
+    return pktClass.toStringBuf(buffer, buf_size);
+}
+
 /** @}*/
 
 #endif // ARM_TRC_PRINTABLE_ELEM_H_INCLUDED
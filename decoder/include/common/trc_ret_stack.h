@@ -36,6 +36,7 @@
 #define ARM_TRC_RET_STACK_H_INCLUDED
 
 #include "opencsd/ocsd_if_types.h"
+#include "common/trc_state_blob.h"
 
 // uncomment below for return stack logging
 // #define TRC_RET_STACK_DEBUG
@@ -91,6 +92,10 @@ public:
         return m_pop_pending;
     }; 
 
+    // decoder state save and restore
+    void saveState(TrcStateWriter &wr) const;
+    void restoreState(TrcStateReader &rd);
+
 private:
     bool m_active;
     bool m_pop_pending; // flag for decoder to indicate a pop might be needed depending on the next packet (ETMv4)
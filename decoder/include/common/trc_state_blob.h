@@ -0,0 +1,224 @@
+/*
+ * \file       trc_state_blob.h
+ * \brief      OpenCSD : Component decode state save and restore
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_TRC_STATE_BLOB_H_INCLUDED
+#define ARM_TRC_STATE_BLOB_H_INCLUDED
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+#include "opencsd/ocsd_if_types.h"
+
+/** @addtogroup ocsd_infrastructure
+@{*/
+
+/*!
+ * Header at the start of every saved component state blob.
+ * 
+ * State blobs are host endian, host layout copies of the decode state. They are intended to 
+ * restore into the same library version on the same host, into a component created with the 
+ * same configuration - they are not an archive format.
+ */
+typedef struct _ocsd_state_blob_hdr {
+    uint32_t tag;       /**< component type tag - OCSD_STATE_TAG() */
+    uint16_t version;   /**< version of the state format for the component type */
+    uint16_t reserved;  /**< zero */
+    uint32_t size;      /**< total size of the blob, including this header */
+} ocsd_state_blob_hdr_t;
+
+/** Build a component tag value from 4 characters */
+#define OCSD_STATE_TAG(a, b, c, d) \
+    ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+/*!
+ * @class TrcStateWriter
+ * @brief Write component state into a blob.
+ *
+ * Appends the state header on construction, fields on each put() call, and sets 
+ * the final size on end().
+ */
+class TrcStateWriter
+{
+public:
+    TrcStateWriter(std::vector<uint8_t> &blob, const uint32_t tag, const uint16_t version) : 
+        m_blob(blob), m_start(blob.size())
+    {
+        ocsd_state_blob_hdr_t hdr;
+        hdr.tag = tag;
+        hdr.version = version;
+        hdr.reserved = 0;
+        hdr.size = 0;
+        put(hdr);
+    };
+
+    template <class T> void put(const T &val)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "state values must be trivially copyable");
+        putBytes(&val, sizeof(T));
+    };
+
+    void putBytes(const void *p_data, const size_t len)
+    {
+        const uint8_t *p_bytes = (const uint8_t *)p_data;
+        m_blob.insert(m_blob.end(), p_bytes, p_bytes + len);
+    };
+
+    /* length prefixed byte vector */
+    void putVec(const std::vector<uint8_t> &vec)
+    {
+        put((uint32_t)vec.size());
+        if (vec.size())
+            putBytes(&vec[0], vec.size());
+    };
+
+    /* set the final size into the header */
+    void end()
+    {
+        uint32_t size = (uint32_t)(m_blob.size() - m_start);
+        memcpy(&m_blob[m_start + offsetof(ocsd_state_blob_hdr_t, size)], &size, sizeof(uint32_t));
+    };
+
+private:
+    std::vector<uint8_t> &m_blob;
+    const size_t m_start;   //!< blob may be appended to an existing buffer.
+};
+
+/*!
+ * @class TrcStateReader
+ * @brief Read component state from a blob.
+ *
+ * Checks the header on construction. Reads past the end of the blob, or a header mismatch, 
+ * put the reader into an error state, where all get() calls fail. 
+ */
+class TrcStateReader
+{
+public:
+    TrcStateReader(const uint8_t *p_blob, const size_t size, const uint32_t tag, const uint16_t version) :
+        m_p_blob(p_blob), m_size(size), m_pos(0), m_ok(false)
+    {
+        ocsd_state_blob_hdr_t hdr;
+        if (p_blob && (size >= sizeof(hdr)))
+        {
+            memcpy(&hdr, p_blob, sizeof(hdr));
+            m_ok = (hdr.tag == tag) && (hdr.version == version) && (hdr.size <= size);
+            if (m_ok)
+            {
+                m_size = hdr.size;
+                m_pos = sizeof(hdr);
+            }
+        }
+    };
+
+    template <class T> bool get(T &val)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "state values must be trivially copyable");
+        return getBytes(&val, sizeof(T));
+    };
+
+    bool getBytes(void *p_data, const size_t len)
+    {
+        if (!m_ok || (len > (m_size - m_pos)))
+        {
+            m_ok = false;
+            return false;
+        }
+        memcpy(p_data, m_p_blob + m_pos, len);
+        m_pos += len;
+        return true;
+    };
+
+    bool getVec(std::vector<uint8_t> &vec)
+    {
+        uint32_t len = 0;
+        if (!get(len) || (len > (m_size - m_pos)))
+        {
+            m_ok = false;
+            return false;
+        }
+        vec.assign(m_p_blob + m_pos, m_p_blob + m_pos + len);
+        m_pos += len;
+        return true;
+    };
+
+    /* a complete state blob nested in this one - returns pointer and size, moves past it. */
+    bool getNested(const uint8_t *&p_nested, size_t &nested_size)
+    {
+        ocsd_state_blob_hdr_t hdr;
+        if (!m_ok || (sizeof(hdr) > (m_size - m_pos)))
+        {
+            m_ok = false;
+            return false;
+        }
+        memcpy(&hdr, m_p_blob + m_pos, sizeof(hdr));
+        if ((hdr.size < sizeof(hdr)) || (hdr.size > (m_size - m_pos)))
+        {
+            m_ok = false;
+            return false;
+        }
+        p_nested = m_p_blob + m_pos;
+        nested_size = hdr.size;
+        m_pos += hdr.size;
+        return true;
+    };
+
+    /* true if all data in the blob has been read, or reader in error state */
+    const bool atEnd() const { return !m_ok || (m_pos == m_size); };
+
+    /* flag an invalid value in the data */
+    void setInvalid() { m_ok = false; };
+
+    /* OCSD_OK if all reads were good and the whole blob was used */
+    const ocsd_err_t end() const 
+    { 
+        return (m_ok && (m_pos == m_size)) ? OCSD_OK : OCSD_ERR_DCD_STATE_INVALID; 
+    };
+
+    /* size of the blob as recorded in the header */
+    const size_t blobSize() const { return m_size; };
+
+private:
+    const uint8_t *m_p_blob;
+    size_t m_size;
+    size_t m_pos;
+    bool m_ok;
+};
+
+/** @}*/
+
+#endif // ARM_TRC_STATE_BLOB_H_INCLUDED
+
+/* End of File trc_state_blob.h */
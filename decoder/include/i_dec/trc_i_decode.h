@@ -44,6 +44,7 @@ public:
     virtual ~TrcIDecode() {};
 
     virtual ocsd_err_t DecodeInstruction(ocsd_instr_info *instr_info);
+    virtual ocsd_err_t FindNextWaypoint(ocsd_instr_info *instr_info, const uint8_t *span, const uint32_t span_bytes, uint32_t *num_instr);
 
 private:
     ocsd_err_t DecodeA32(ocsd_instr_info *instr_info);
@@ -129,6 +129,27 @@ int inst_Thumb_is_UDF(uint32_t inst);
 int inst_A64_is_UDF(uint32_t inst);
 
 
+/*
+Fast pre-classification using lookup tables on the major opcode bits.
+Returns 0 if the instruction is definitely not a branch, barrier or WFI/WFE - 
+i.e. all the branch, barrier, wfiwfe, conditional and IT queries above return 0.
+Non-zero means the full queries must be used to classify the instruction.
+*/
+int inst_ARM_maybe_waypoint(uint32_t inst);
+int inst_Thumb_maybe_waypoint(uint32_t inst);
+int inst_A64_maybe_waypoint(uint32_t inst);
+
+/*
+Scan a contiguous span of opcode memory for the first instruction that may be a waypoint.
+Opcode bytes are in target memory order, starting at span[0]. 
+Returns the number of leading instructions that are definitely not waypoints, with *last_offset 
+set to the byte offset of the last of these. Each counted instruction has 4 bytes available 
+in the span, as required by the full decode. Returns 0 if the first instruction must be decoded.
+
+A64 uses a SIMD scan where available (AVX2 / SSE2 / NEON), otherwise the lookup tables above.
+*/
+uint32_t inst_find_next_waypoint(const uint8_t *span, const uint32_t span_bytes, const ocsd_isa isa, uint32_t *last_offset);
+
 /* access sub-type information */
 ocsd_instr_subtype get_instr_subtype();
 void clear_instr_subtype();
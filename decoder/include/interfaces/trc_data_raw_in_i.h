@@ -76,8 +76,67 @@ public:
                                                   const uint8_t *pDataBlock,
                                                   uint32_t *numBytesProcessed) = 0;
 
+    /*!
+     * Scatter-gather data input. Trace data is supplied as a list of memory segments with 
+     * continuous trace indexes - e.g. the two parts of a wrapped ETR or perf AUX ring buffer - 
+     * so the client does not need to copy the data into a single buffer. Frames and packets may 
+     * straddle segment boundaries.
+     *
+     * If processing stops on a WAIT response, call again after flushing with seg_offset 
+     * advanced by the number of bytes processed.
+     *
+     * @param index : Byte index of the start of the first segment as offset from start of captured data.
+     * @param *segs : Array of data segments.
+     * @param num_segs : Number of segments in the array.
+     * @param seg_offset : Byte offset into the segment data to start processing from.
+     * @param *numBytesProcessed : Count of data used by processor in this call.
+     *
+     * @return ocsd_datapath_resp_t  : Standard data path response code.
+     */
+    virtual ocsd_datapath_resp_t TraceDataInSG(const ocsd_trc_index_t index,
+                                               const ocsd_trc_data_seg_t *segs,
+                                               const int num_segs,
+                                               const uint32_t seg_offset,
+                                               uint32_t *numBytesProcessed);
 };
 
+inline ocsd_datapath_resp_t ITrcDataIn::TraceDataInSG(const ocsd_trc_index_t index,
+                                                      const ocsd_trc_data_seg_t *segs,
+                                                      const int num_segs,
+                                                      const uint32_t seg_offset,
+                                                      uint32_t *numBytesProcessed)
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+    ocsd_trc_index_t seg_index = index;
+    uint32_t skip = seg_offset, seg_done, used;
+
+    *numBytesProcessed = 0;
+    for (int i = 0; (i < num_segs) && OCSD_DATA_RESP_IS_CONT(resp); i++)
+    {
+        // skip segments already processed.
+        if (skip >= segs[i].size)
+        {
+            skip -= segs[i].size;
+            seg_index += segs[i].size;
+            continue;
+        }
+
+        seg_done = skip;
+        skip = 0;
+        while ((seg_done < segs[i].size) && OCSD_DATA_RESP_IS_CONT(resp))
+        {
+            used = 0;
+            resp = TraceDataIn(OCSD_OP_DATA, seg_index + seg_done, segs[i].size - seg_done, segs[i].p_data + seg_done, &used);
+            if (!used && OCSD_DATA_RESP_IS_CONT(resp))
+                return resp;    // no progress possible.
+            seg_done += used;
+            *numBytesProcessed += used;
+        }
+        seg_index += segs[i].size;
+    }
+    return resp;
+}
+
 #endif // ARM_TRCDATA_RAW_IN_I_H_INCLUDED
 
 
@@ -0,0 +1,75 @@
+/*
+ * \file       trc_data_src_i.h
+ * \brief      OpenCSD : Trace data source interface for pull mode decode.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+
+#ifndef ARM_TRC_DATA_SRC_I_H_INCLUDED
+#define ARM_TRC_DATA_SRC_I_H_INCLUDED
+
+#include "opencsd/ocsd_if_types.h"
+
+/*!
+ * @class ITrcDataSrc
+ 
+ * @brief Interface to a source of raw trace data for the decode tree pull iterator.
+ *
+ * @ingroup ocsd_interfaces
+ *
+ * The decode tree reads blocks of trace data from the source as required when the client 
+ * requests the next batch of generic trace elements (DecodeTree::nextElements()).
+ * 
+ */
+class ITrcDataSrc
+{
+public:
+    ITrcDataSrc() {};  /**< Default constructor. */
+    virtual ~ITrcDataSrc() {}; /**< Default destructor. */
+
+    /*!
+     * Get the next block of trace data. Blocks are continuous in the trace index.
+     * 
+     * The block must remain valid until the next call to this function, as the decoders 
+     * may stop part way through a block when an element batch is full. 
+     *
+     * @param **pp_data : Returned pointer to the block of trace data.
+     * @param *p_size : Returned size of the block in bytes. Set to 0 at the end of the trace data.
+     *
+     * @return ocsd_err_t  : Library error code - or OCSD_OK if successful.
+     */
+    virtual ocsd_err_t ReadTraceData(const uint8_t **pp_data, uint32_t *p_size) = 0;
+};
+
+#endif // ARM_TRC_DATA_SRC_I_H_INCLUDED
+
+/* End of File trc_data_src_i.h */
@@ -59,6 +59,29 @@ public:
      * @return ocsd_err_t  : OCSD_OK if successful.
      */
     virtual ocsd_err_t DecodeInstruction(ocsd_instr_info *instr_info) = 0;
+
+    /*!
+     * Scan a contiguous span of opcode memory, skipping instructions that cannot be 
+     * waypoints without a full decode of each.
+     *
+     * On return *instr_info is as if DecodeInstruction() had been called for each skipped 
+     * instruction in turn, with the instruction address incremented past each one.
+     * The next instruction may be a waypoint and must be decoded with DecodeInstruction().
+     *
+     * Default implementation skips no instructions.
+     *
+     * @param *instr_info : Current decode information. instr_addr is the address of span[0].
+     * @param *span : Opcode bytes read from memory at instr_addr.
+     * @param span_bytes : Number of bytes in the span.
+     * @param *num_instr : Returns the number of instructions skipped.
+     *
+     * @return ocsd_err_t  : OCSD_OK if successful.
+     */
+    virtual ocsd_err_t FindNextWaypoint(ocsd_instr_info *instr_info, const uint8_t *span, const uint32_t span_bytes, uint32_t *num_instr)
+    {
+        *num_instr = 0;
+        return OCSD_OK;
+    };
 };
 
 #endif // ARM_TRC_INSTR_DECODE_I_H_INCLUDED
@@ -75,6 +75,41 @@ public:
 
 };
 
+/*!
+ * @class IPktBatchIn
+ * @ingroup ocsd_interfaces
+ * @brief Interface class providing an input for batches of discrete protocol packets.
+ *
+ * Implemented by packet consumers that do not need a call per packet. 
+ * The packet processor copies the C API packet structure of each packet into the 
+ * batch, and passes the batch on when full, or on a flush or end of trace.
+ */
+class IPktBatchIn : public ITrcTypedBase
+{
+public:
+    IPktBatchIn() {}; /**< Default constructor. */
+    virtual ~IPktBatchIn() {}; /**< Default destructor. */
+
+    /*!
+     * Interface function to process a batch of protocol packets.
+     * When the datapath operation is OCSD_OP_DATA, the batch contains one or more packets,
+     * as an array of the protocol C API packet structure (e.g. ocsd_etmv4_i_pkt), and 
+     * an array of the trace index for the start of each packet. 
+     * Arrays are only valid for the duration of the call.
+     *
+     * @param op : Datapath operation.
+     * @param num_pkts : Number of packets in the batch, 0 if not OCSD_OP_DATA.
+     * @param *p_indexes : Trace index for the start of each packet.
+     * @param *p_pkts : Array of C API packet structures.
+     *
+     * @return ocsd_datapath_resp_t  : Standard data path response - applies to the batch as a whole.
+     */
+    virtual ocsd_datapath_resp_t PacketBatchIn( const ocsd_datapath_op_t op,
+                                                const uint32_t num_pkts,
+                                                const ocsd_trc_index_t *p_indexes,
+                                                const void *p_pkts) = 0;
+};
+
 #endif // ARM_TRC_PKT_IN_I_H_INCLUDED
 
 /* End of File trc_proc_pkt_in_i.h */
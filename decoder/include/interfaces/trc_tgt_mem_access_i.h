@@ -83,6 +83,31 @@ public:
                                             const ocsd_mem_space_acc_t mem_space, 
                                             uint32_t *num_bytes, 
                                             uint8_t *p_buffer) = 0;
+
+    /*!
+     * Resolve the instruction range from instr_info->instr_addr to the next waypoint using 
+     * a precomputed basic block map of the target memory, if one is available.
+     *
+     * On success *instr_info is as if the decoder had read and decoded each instruction 
+     * in the range - instr_addr is the address after the waypoint, and the waypoint 
+     * instruction decode results are set.
+     *
+     * Default implementation has no maps.
+     *
+     * @param cs_trace_id : protocol source trace ID.
+     * @param mem_space : Memory space to access.
+     * @param *instr_info : Current decode information. instr_addr is the start of the range.
+     * @param *num_instr : Returns the number of instructions in the range, including the waypoint.
+     *
+     * @return bool : true if the range was resolved, false if the decoder must walk the range.
+     */
+    virtual bool FindBasicBlock(const uint8_t cs_trace_id, 
+                                const ocsd_mem_space_acc_t mem_space, 
+                                ocsd_instr_info *instr_info, 
+                                uint32_t *num_instr)
+    {
+        return false;
+    };
 };
 
 
@@ -40,6 +40,9 @@
 #include "trc_mem_acc_file.h"
 #include "trc_mem_acc_mapper.h"
 #include "trc_mem_acc_cb.h"
+#include "trc_mem_acc_image.h"
+#include "trc_mem_acc_elf.h"
+#include "trc_mem_acc_bbmap.h"
 
 
 #endif // ARM_TRC_MEM_ACC_H_INCLUDED
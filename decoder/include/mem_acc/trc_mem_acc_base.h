@@ -37,6 +37,12 @@
 
 #include "opencsd/ocsd_if_types.h"
 #include <string>
+#include <vector>
+#include <memory>
+
+#include "mem_acc/trc_mem_acc_bbmap.h"
+
+class TrcMemImage;
 
 /*!
  * @class TrcMemAccessorBase
@@ -59,6 +65,8 @@ public:
         MEMACC_FILE,        //<! Binary data file accessor
         MEMACC_BUFPTR,      //<! memory buffer accessor
         MEMACC_CB_IF,       //<! callback interface accessor - use for live memory access
+        MEMACC_IMAGE,       //<! shared memory image accessor
+        MEMACC_ELF,         //<! ELF file executable segments accessor
     };
 
     /** default constructor */
@@ -149,11 +157,40 @@ public:
     /* memory access info logging */
     virtual void getMemAccString(std::string &accStr) const;
 
+    typedef std::pair<ocsd_vaddr_t, ocsd_vaddr_t> addr_range_t;   //!< inclusive start and end address.
+
+    /*!
+     * Append the inclusive address ranges accessible through this accessor.
+     *
+     * @param &ranges : vector to add the ranges to.
+     */
+    virtual void getAddrRanges(std::vector<addr_range_t> &ranges) const;
+
+    /*!
+     * Attach a basic block map for a region of code in this accessor.
+     * Caller ensures the region is in range and matches the map.
+     *
+     * @param &map : Map to attach.
+     * @param address : Address of the start of the mapped region.
+     */
+    void addBBMap(const TrcBBMapPtr &map, const ocsd_vaddr_t address) { m_bb_maps.push_back(bb_map_t(address, map)); };
+
+    /*!
+     * Resolve the instruction range from instr_info->instr_addr to the next waypoint
+     * using the attached basic block maps. See TrcBBMap::lookup().
+     *
+     * @return bool : true if resolved by a map.
+     */
+    const bool findBasicBlock(ocsd_instr_info *instr_info, uint32_t *num_instr) const;
+
 protected:
     ocsd_vaddr_t m_startAddress;   /**< accessible range start address */
     ocsd_vaddr_t m_endAddress;     /**< accessible range end address */
     const MemAccTypes m_type;       /**< memory accessor type */
     ocsd_mem_space_acc_t m_mem_space;
+
+    typedef std::pair<ocsd_vaddr_t, TrcBBMapPtr> bb_map_t;     //!< map and address of the mapped region.
+    std::vector<bb_map_t> m_bb_maps;  /**< attached basic block maps */
 };
 
 inline TrcMemAccessorBase::TrcMemAccessorBase(MemAccTypes accType, ocsd_vaddr_t startAddr, ocsd_vaddr_t endAddr) :
@@ -211,6 +248,16 @@ inline const bool TrcMemAccessorBase::overLapRange(const TrcMemAccessorBase *p_t
     return false;
 }
 
+inline const bool TrcMemAccessorBase::findBasicBlock(ocsd_instr_info *instr_info, uint32_t *num_instr) const
+{
+    for(std::vector<bb_map_t>::const_iterator it = m_bb_maps.begin(); it != m_bb_maps.end(); it++)
+    {
+        if(it->second->lookup(it->first, instr_info, num_instr))
+            return true;
+    }
+    return false;
+}
+
 inline const bool TrcMemAccessorBase::validateRange()
 {
     if(m_startAddress & 0x1) // at least hword aligned for thumb
@@ -232,6 +279,8 @@ public:
     static ocsd_err_t CreateBufferAccessor(TrcMemAccessorBase **pAccessor, const ocsd_vaddr_t s_address, const uint8_t *p_buffer, const uint32_t size);
     static ocsd_err_t CreateFileAccessor(TrcMemAccessorBase **pAccessor, const std::string &pathToFile, ocsd_vaddr_t startAddr, size_t offset = 0, size_t size = 0);
     static ocsd_err_t CreateCBAccessor(TrcMemAccessorBase **pAccessor, const ocsd_vaddr_t s_address, const ocsd_vaddr_t e_address, const ocsd_mem_space_acc_t mem_space);
+    static ocsd_err_t CreateImageAccessor(TrcMemAccessorBase **pAccessor, const std::shared_ptr<const TrcMemImage> &image);
+    static ocsd_err_t CreateElfAccessor(TrcMemAccessorBase **pAccessor, const std::string &pathToFile, const ocsd_vaddr_t load_bias);
     
     /** Accessor Destruction */
     static void DestroyAccessor(TrcMemAccessorBase *pAccessor);
@@ -0,0 +1,175 @@
+/*
+ * \file       trc_mem_acc_bbmap.h
+ * \brief      OpenCSD : Precomputed basic block map for a memory image.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_TRC_MEM_ACC_BBMAP_H_INCLUDED
+#define ARM_TRC_MEM_ACC_BBMAP_H_INCLUDED
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "opencsd/ocsd_if_types.h"
+
+class TrcBBMap;
+typedef std::shared_ptr<const TrcBBMap> TrcBBMapPtr;     //!< shared basic block map reference.
+
+/*!
+ * @class TrcBBMap
+ * @brief Immutable basic block map for a region of code.
+ *
+ * Built once by disassembling a region of a memory image with the library instruction 
+ * decoder, and saved in a sidecar file for re-use. Each block runs from the instruction
+ * after the previous waypoint up to and including the next waypoint. Blocks are sorted
+ * by address so a PE decoder can resolve the instruction range to the next waypoint by
+ * binary search, with no memory reads or instruction decode.
+ *
+ * A map is valid for a single ISA and instruction decode configuration, and is keyed 
+ * by a hash of the region contents. The map records the link address of the region, 
+ * but may be attached to a memory accessor at any address.
+ *
+ * Maps are handled through TrcBBMapPtr reference counted pointers, so may be shared 
+ * between memory accessors in any number of decode trees.
+ */
+class TrcBBMap
+{
+public:
+    /*!
+     * Build a map for a region of code. 
+     *
+     * A64 and A32 regions are split between worker threads. T32 is variable length, 
+     * so instruction boundaries depend on the sweep from the start of the region, and 
+     * is built on a single thread.
+     *
+     * @param *p_buffer : Region contents.
+     * @param size : Size of the region in bytes.
+     * @param s_address : Link address of the start of the region.
+     * @param &cfg : Decode configuration - isa, pe_type.arch, dsb_dmb_waypoints and wfi_wfe_branch used.
+     * @param num_threads : Number of worker threads, 0 for one per hardware thread.
+     * @param &map : returned map.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    static ocsd_err_t build(const uint8_t *p_buffer, const uint32_t size, const ocsd_vaddr_t s_address, const ocsd_instr_info &cfg, const int num_threads, TrcBBMapPtr &map);
+
+    /*!
+     * Save maps to a sidecar file.
+     *
+     * @param &pathToFile : Path to the file to write.
+     * @param &maps : maps to save.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    static ocsd_err_t saveFile(const std::string &pathToFile, const std::vector<TrcBBMapPtr> &maps);
+
+    /*!
+     * Load maps from a sidecar file. Loaded maps are appended to the vector.
+     *
+     * @param &pathToFile : Path to the file to read.
+     * @param &maps : vector to add the maps to.
+     *
+     * @return ocsd_err_t  : OCSD_ERR_BB_MAP_INVALID if not a valid map file.
+     */
+    static ocsd_err_t loadFile(const std::string &pathToFile, std::vector<TrcBBMapPtr> &maps);
+
+    /** Map key for a region of memory - 64 bit FNV-1a hash of the contents. */
+    static uint64_t calcKey(const uint8_t *p_buffer, const uint32_t size);
+
+    /*!
+     * Resolve the instruction range from an address to the next waypoint.
+     *
+     * On success *instr_info is as if the PE decoder had walked the range - instr_addr 
+     * is the address after the waypoint instruction, and the waypoint decode results 
+     * are set. The address must be in the map region, and the map must match the ISA
+     * and decode configuration in *instr_info.
+     *
+     * A64 and A32 ranges may start at any instruction in a block, T32 ranges only at
+     * the start of a block. Returns false for any other address, or if there is no 
+     * waypoint in the region after the address. 
+     *
+     * @param base : Address the region is mapped at.
+     * @param *instr_info : Current decode information. instr_addr is the start of the range.
+     * @param *num_instr : Returns number of instructions in the range, including the waypoint.
+     *
+     * @return bool : true if the range was resolved.
+     */
+    const bool lookup(const ocsd_vaddr_t base, ocsd_instr_info *instr_info, uint32_t *num_instr) const;
+
+    const uint64_t getKey() const { return m_key; };
+    const ocsd_vaddr_t getStartAddress() const { return m_s_address; };
+    const uint32_t getSize() const { return m_size; };
+    const ocsd_isa getISA() const { return (ocsd_isa)m_isa; };
+    const size_t getNumBlocks() const { return m_blocks.size(); };
+
+    /** Map description for logging */
+    void getMapString(std::string &mapStr) const;
+
+    /** block entry - offsets relative to the start of the region. */
+    typedef struct _bb_entry {
+        uint32_t st_offset;     //!< first instruction in the block.
+        uint32_t wp_offset;     //!< waypoint instruction ending the block.
+        uint32_t num_instr;     //!< instructions in the block, including the waypoint.
+        uint32_t reserved;
+        int64_t  br_offset;     //!< direct branch target, relative to the waypoint address.
+        uint8_t  wp_type;       //!< ocsd_instr_type of the waypoint.
+        uint8_t  wp_sub_type;   //!< ocsd_instr_subtype of the waypoint.
+        uint8_t  wp_size;       //!< waypoint instruction size in bytes.
+        uint8_t  next_isa;      //!< ISA after the waypoint.
+        uint8_t  flags;         //!< BB_FLG_xxx values.
+        uint8_t  reserved1[3];
+    } bb_entry_t;
+
+    enum {
+        BB_FLG_LINK = 0x01,     //!< waypoint is a branch with link.
+        BB_FLG_COND = 0x02,     //!< waypoint is conditional.
+    };
+
+private:
+    TrcBBMap() : m_key(0), m_s_address(0), m_size(0), m_isa(0), m_arch(0), m_dsb_dmb_wp(0), m_wfi_wfe_br(0) {};
+
+    static void buildChunk(const uint8_t *p_buffer, const uint32_t size, const ocsd_vaddr_t s_address, const ocsd_instr_info &cfg, const uint32_t st_offset, const uint32_t en_offset, std::vector<bb_entry_t> &wps);
+
+    uint64_t m_key;             //!< hash of the region contents.
+    ocsd_vaddr_t m_s_address;   //!< link address of the region.
+    uint32_t m_size;            //!< region size.
+    uint8_t m_isa;              //!< decode configuration the map is valid for.
+    uint8_t m_arch;
+    uint8_t m_dsb_dmb_wp;
+    uint8_t m_wfi_wfe_br;
+    std::vector<bb_entry_t> m_blocks;   //!< blocks sorted by address.
+};
+
+#endif // ARM_TRC_MEM_ACC_BBMAP_H_INCLUDED
+
+/* End of File trc_mem_acc_bbmap.h */
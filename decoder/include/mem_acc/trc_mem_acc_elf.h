@@ -0,0 +1,147 @@
+/*
+ * \file       trc_mem_acc_elf.h
+ * \brief      OpenCSD : ELF file memory accessor - executable segments mapped on first access.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_TRC_MEM_ACC_ELF_H_INCLUDED
+#define ARM_TRC_MEM_ACC_ELF_H_INCLUDED
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "opencsd/ocsd_if_types.h"
+#include "mem_acc/trc_mem_acc_base.h"
+#include "mem_acc/trc_mem_acc_image.h"
+
+/*!
+ * @class TrcMemAccElf
+ * @brief Memory accessor for the executable segments of an ELF file.
+ *
+ * The ELF program headers are read when the accessor is created, and each executable 
+ * PT_LOAD segment is registered at its virtual address plus the load bias. Only the 
+ * headers are read at this point - segment data is loaded from the file on the first 
+ * access to that segment, and the file is not held open between loads.
+ *
+ * ELF32 and ELF64 files of either byte order are supported. Relocatable objects 
+ * (ET_REL, e.g. kernel modules before loading) have no program headers, so cannot be 
+ * mapped by this accessor.
+ *
+ * Loaded segments are immutable, so reads need no lock once a segment is loaded.
+ */
+class TrcMemAccElf : public TrcMemAccessorBase
+{
+public:
+    TrcMemAccElf();
+    virtual ~TrcMemAccElf() {};
+
+    /*!
+     * Read the ELF program headers and set up the executable segment ranges.
+     *
+     * @param &pathToFile : Path to the ELF file.
+     * @param load_bias : Value added to segment virtual addresses - e.g. the load address 
+     *                    of a shared object. 0 for executables and kernel images.
+     *
+     * @return ocsd_err_t  : OCSD_OK if successful. OCSD_ERR_MEM_ACC_ELF_INVALID if not an ELF 
+     *                       file or no executable segments.
+     */
+    ocsd_err_t initAccessor(const std::string &pathToFile, const ocsd_vaddr_t load_bias);
+
+    /** read bytes override - loads the segment on first access */
+    virtual const uint32_t readBytes(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t memSpace, const uint8_t trcID, const uint32_t reqBytes, uint8_t *byteBuffer);
+
+    /* range overrides for the individual segments */
+    virtual const bool addrInRange(const ocsd_vaddr_t s_address) const;
+    virtual const bool addrStartOfRange(const ocsd_vaddr_t s_address) const;
+    virtual const uint32_t bytesInRange(const ocsd_vaddr_t s_address, const uint32_t reqBytes) const;
+    virtual const bool overLapRange(const TrcMemAccessorBase *p_test_acc) const;
+    virtual const bool validateRange();
+
+    /** Add in the file name and segment ranges */
+    virtual void getMemAccString(std::string &accStr) const;
+
+    /** One range per executable segment */
+    virtual void getAddrRanges(std::vector<addr_range_t> &ranges) const;
+
+    const std::string &getFilePath() const { return m_file_path; };
+    const int getNumSegments() const { return (int)m_segs.size(); };
+    const int getNumSegmentsLoaded() const;     //!< segments loaded by accesses so far.
+
+    /*!
+     * Find the load bias for an ELF file from a mapping of part of the file - e.g. a 
+     * perf mmap record or a snapshot memory dump. 
+     *
+     * @param &pathToFile : Path to the ELF file.
+     * @param map_address : Address the file offset is mapped at.
+     * @param map_offset : File offset at map_address - must be in a PT_LOAD segment.
+     * @param &load_bias : Returned load bias for initAccessor().
+     *
+     * @return ocsd_err_t  : OCSD_OK if successful. OCSD_ERR_MEM_ACC_ELF_INVALID if not an ELF 
+     *                       file or offset not in a loadable segment.
+     */
+    static ocsd_err_t getLoadBias(const std::string &pathToFile, const ocsd_vaddr_t map_address, const uint64_t map_offset, ocsd_vaddr_t &load_bias);
+
+    /** true if the file starts with the ELF identification bytes */
+    static const bool isElfFile(const std::string &pathToFile);
+
+private:
+    /* loadable segment from the program headers */
+    typedef struct _elf_load_seg {
+        uint64_t vaddr;
+        uint64_t offset;
+        uint64_t filesz;
+        bool exec;
+    } elf_load_seg_t;
+
+    static ocsd_err_t readLoadSegments(const std::string &pathToFile, std::vector<elf_load_seg_t> &load_segs);
+
+    /* executable segment mapped by this accessor */
+    typedef struct _elf_seg {
+        ocsd_vaddr_t st_addr;   //!< inclusive range in memory.
+        ocsd_vaddr_t en_addr;
+        uint64_t offset;        //!< offset of segment data in the file.
+        TrcMemImagePtr image;   //!< segment data - read and written with std::atomic_load / std::atomic_store.
+    } elf_seg_t;
+
+    const elf_seg_t *getSegForAddress(const ocsd_vaddr_t address) const;
+    TrcMemImagePtr loadSegment(elf_seg_t &seg);
+
+    std::string m_file_path;
+    std::vector<elf_seg_t> m_segs;  //!< sorted by address, fixed after initAccessor().
+    std::mutex m_load_lock;         //!< serialises segment loads.
+};
+
+#endif // ARM_TRC_MEM_ACC_ELF_H_INCLUDED
+
+/* End of File trc_mem_acc_elf.h */
@@ -39,6 +39,7 @@
 #include <string>
 #include <fstream>
 #include <list>
+#include <mutex>
 
 #include "opencsd/ocsd_if_types.h"
 #include "mem_acc/trc_mem_acc_base.h"
@@ -72,6 +73,10 @@ private:
  * 
  * Static creation code to allow reference counted accessor usable for 
  * multiple access maps attached to multiple source trees for the same system.
+ *
+ * Creation, destruction and lookup of accessors are thread safe. Reads from a 
+ * shared accessor are serialised on the single file stream - use a TrcMemImage 
+ * for images read concurrently by decode trees on multiple threads.
  */
 class TrcMemAccessorFile : public TrcMemAccessorBase 
 {
@@ -167,6 +172,9 @@ public:
     /*! Override to handle ranges and offset accessors plus add in file name. */
     virtual void getMemAccString(std::string &accStr) const;
 
+    /*! Override to add the base range and all the offset ranges in the file. */
+    virtual void getAddrRanges(std::vector<addr_range_t> &ranges) const;
+
 
     /*!
      * Create a file accessor based on the supplied path and address.
@@ -218,9 +226,11 @@ public:
 
 private:
     static std::map<std::string, TrcMemAccessorFile *> s_FileAccessorMap;   /**< map of file accessors in use. */
+    static std::mutex s_FileAccessorMapLock;    /**< lock for the map and accessor reference counts. */
 
 private:
     std::ifstream m_mem_file;   /**< input binary file stream */
+    std::mutex m_mem_file_lock; /**< lock for file stream position when shared between trees */
     ocsd_vaddr_t m_file_size;  /**< size of the file */
     int m_ref_count;            /**< accessor reference count */
     std::string m_file_path;    /**< path to input file */
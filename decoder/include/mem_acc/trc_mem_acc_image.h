@@ -0,0 +1,186 @@
+/*
+ * \file       trc_mem_acc_image.h
+ * \brief      OpenCSD : Shared immutable memory images and image registry.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#ifndef ARM_TRC_MEM_ACC_IMAGE_H_INCLUDED
+#define ARM_TRC_MEM_ACC_IMAGE_H_INCLUDED
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mem_acc/trc_mem_acc_base.h"
+
+/*!
+ * @class TrcMemImage
+ * @brief Immutable memory image, shared between decode trees.
+ *
+ * Holds a copy of a block of target memory - loaded from a buffer or a region of a 
+ * binary file. The image cannot be changed once created, so may be read by memory 
+ * accessors in any number of decode trees, on any number of threads, without locking.
+ *
+ * Images are handled through TrcMemImagePtr reference counted pointers, and are 
+ * released when the last registry entry or memory accessor using them is destroyed.
+ */
+class TrcMemImage
+{
+public:
+    /*!
+     * Create an image from a copy of the supplied buffer.
+     *
+     * @param &name : Name of the image - key in an image registry.
+     * @param s_address : Start address of the image in the memory map.
+     * @param *p_buffer : Buffer containing the memory data.
+     * @param size : Size of the buffer.
+     * @param &image : returned image.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    static ocsd_err_t createFromBuffer(const std::string &name, const ocsd_vaddr_t s_address, const uint8_t *p_buffer, const uint32_t size, std::shared_ptr<const TrcMemImage> &image);
+
+    /*!
+     * Create an image from a region of a binary file. A size of 0 loads from the offset
+     * to the end of the file.
+     *
+     * @param &name : Name of the image - key in an image registry.
+     * @param &pathToFile : Path to the binary file.
+     * @param s_address : Start address of the image in the memory map.
+     * @param offset : Offset of the image data in the file.
+     * @param size : Size of the region, or 0 for the remainder of the file.
+     * @param &image : returned image.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    static ocsd_err_t createFromFile(const std::string &name, const std::string &pathToFile, const ocsd_vaddr_t s_address, const size_t offset, const size_t size, std::shared_ptr<const TrcMemImage> &image);
+
+    const std::string &getName() const { return m_name; };
+    const ocsd_vaddr_t getStartAddress() const { return m_s_address; };
+    const uint32_t getSize() const { return (uint32_t)m_data.size(); };
+    const uint8_t *getData() const { return m_data.data(); };
+
+private:
+    TrcMemImage(const std::string &name, const ocsd_vaddr_t s_address) : m_name(name), m_s_address(s_address) {};
+
+    const std::string m_name;
+    const ocsd_vaddr_t m_s_address;
+    std::vector<uint8_t> m_data;
+};
+
+typedef std::shared_ptr<const TrcMemImage> TrcMemImagePtr;                  //!< shared image reference.
+typedef std::map<std::string, TrcMemImagePtr> TrcMemImageMap;                //!< named images.
+typedef std::shared_ptr<const TrcMemImageMap> TrcMemImageSnapshot;           //!< published set of images.
+
+/*!
+ * @class TrcMemImageRegistry
+ * @brief Thread safe registry of named memory images.
+ *
+ * The published set of images is an immutable snapshot. Publishing or withdrawing an 
+ * image builds a new set and swaps it in - readers already holding a snapshot or an 
+ * image keep a consistent view and are never blocked by the update. Updates are 
+ * serialised with each other.
+ *
+ * A global registry is provided for images shared across all decode trees in the process.
+ */
+class TrcMemImageRegistry
+{
+public:
+    TrcMemImageRegistry();
+    ~TrcMemImageRegistry() {};
+
+    /** Process global registry */
+    static TrcMemImageRegistry &getGlobal();
+
+    /*!
+     * Publish an image. Replaces any existing image with the same name - 
+     * accessors using the old image continue to do so until destroyed.
+     *
+     * @param &image : Image to publish.
+     *
+     * @return ocsd_err_t  : Library error code or OCSD_OK if successful.
+     */
+    ocsd_err_t publishImage(const TrcMemImagePtr &image);
+
+    /*!
+     * Withdraw a named image from the registry. 
+     *
+     * @param &name : Name of the image.
+     *
+     * @return ocsd_err_t  : OCSD_ERR_INVALID_PARAM_VAL if no image by this name.
+     */
+    ocsd_err_t withdrawImage(const std::string &name);
+
+    /** Remove all images from the registry */
+    void clear();
+
+    /** Current published set of images */
+    TrcMemImageSnapshot getSnapshot() const;
+
+    /** Find a named image in the current set - empty pointer if not found */
+    TrcMemImagePtr findImage(const std::string &name) const;
+
+private:
+    TrcMemImageSnapshot m_snapshot;     //!< current set - read and written with std::atomic_load / std::atomic_store.
+    std::mutex m_update_lock;           //!< serialises updates.
+};
+
+/*!
+ * @class TrcMemAccImage
+ * @brief Memory accessor for a shared memory image.
+ *
+ * Holds a reference to the image, so the image remains valid for the 
+ * lifetime of the accessor regardless of changes to the registry.
+ */
+class TrcMemAccImage : public TrcMemAccessorBase
+{
+public:
+    TrcMemAccImage(const TrcMemImagePtr &image);
+    virtual ~TrcMemAccImage() {};
+
+    /** Memory access override - read bytes from the image. */
+    virtual const uint32_t readBytes(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t memSpace, const uint8_t trcID, const uint32_t reqBytes, uint8_t *byteBuffer);
+
+    /** Add in the image name */
+    virtual void getMemAccString(std::string &accStr) const;
+
+    const TrcMemImagePtr &getImage() const { return m_image; };
+
+private:
+    const TrcMemImagePtr m_image;
+};
+
+#endif // ARM_TRC_MEM_ACC_IMAGE_H_INCLUDED
+
+/* End of File trc_mem_acc_image.h */
@@ -61,6 +61,11 @@ public:
                                             uint32_t *num_bytes, 
                                             uint8_t *p_buffer);
 
+    virtual bool FindBasicBlock(const uint8_t cs_trace_id, 
+                                const ocsd_mem_space_acc_t mem_space, 
+                                ocsd_instr_info *instr_info, 
+                                uint32_t *num_instr);
+
 // mapper memory area configuration interface
 
     // add an accessor to this map
@@ -75,6 +80,9 @@ public:
 
     // remove a single accessor based on address.
     ocsd_err_t RemoveAccessorByAddress(const ocsd_vaddr_t st_address, const ocsd_mem_space_acc_t mem_space, const uint8_t cs_trace_id = 0);
+
+    // attach a basic block map to the accessor holding the mapped region - verifies the region contents match the map.
+    ocsd_err_t AttachBBMap(const TrcBBMapPtr &map, const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space, const uint8_t cs_trace_id = 0);
     
     // set the error log.
     void setErrorLog(ITraceErrorLog *err_log_i);
@@ -82,6 +90,9 @@ public:
     // print out the ranges in this mapper.
     virtual void logMappedRanges() = 0;
 
+    // get the address ranges of all the accessors in this mapper.
+    void getMappedRanges(std::vector<TrcMemAccessorBase::addr_range_t> &ranges);
+
 protected:
     virtual bool findAccessor(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space, const uint8_t cs_trace_id) = 0;     // set m_acc_curr if found valid range, leave unchanged if not.
     virtual bool readFromCurrent(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space, const uint8_t cs_trace_id) = 0;
@@ -90,7 +101,7 @@ protected:
     virtual void clearAccessorList() = 0;
 
     void LogMessage(const std::string &msg);
-    void LogWarn(const ocsd_err_t err, const std::string &msg);
+    void LogWarn(const ocsd_err_t err, const char *msg);
 
     TrcMemAccessorBase *m_acc_curr;     // most recently used - try this first.
     uint8_t m_trace_id_curr;            // trace ID for the current accessor
@@ -43,6 +43,7 @@
 /* C++ abstract interfaces */
 #include "interfaces/trc_data_raw_in_i.h"
 #include "interfaces/trc_data_rawframe_in_i.h"
+#include "interfaces/trc_data_src_i.h"
 #include "interfaces/trc_error_log_i.h"
 #include "interfaces/trc_gen_elem_in_i.h"
 #include "interfaces/trc_instr_decode_i.h"
@@ -67,6 +68,12 @@
 /** C++ library object types */
 #include "common/ocsd_error_logger.h"
 #include "common/ocsd_msg_logger.h"
+#include "common/ocsd_pe_filter.h"
+#include "common/trc_gen_elem_serial.h"
+#include "common/trc_gen_elem_merge.h"
+#include "common/trc_gen_elem_queue.h"
+#include "common/trc_gen_elem_coverage.h"
+#include "common/trc_gen_elem_cycle_prof.h"
 #include "i_dec/trc_i_decode.h"
 #include "mem_acc/trc_mem_acc.h"
 
@@ -77,6 +84,7 @@
 /** The decode tree and decoder register*/
 #include "common/ocsd_lib_dcd_register.h"
 #include "common/ocsd_dcd_tree.h"
+#include "common/ocsd_dcd_tree_pool.h"
 
 
 #endif // ARM_OPENCSD_H_INCLUDED
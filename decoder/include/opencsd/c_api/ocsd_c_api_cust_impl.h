@@ -105,6 +105,19 @@ static inline ocsd_err_t lib_cb_MemAccess(const ocsd_extern_dcd_cb_fns *callback
     return OCSD_ERR_NOT_INIT;
 }
 
+static inline ocsd_err_t lib_cb_TraceToWaypoint(const ocsd_extern_dcd_cb_fns *callbacks,
+    const uint8_t cs_trace_id,
+    const ocsd_mem_space_acc_t mem_space,
+    const ocsd_wp_walk_op_t walk_op,
+    const ocsd_vaddr_t addr_match,
+    ocsd_instr_info *instr_info,
+    ocsd_wp_walk_res_t *p_res)
+{
+    if (callbacks->fn_trace_to_waypoint)
+        return callbacks->fn_trace_to_waypoint(callbacks->lib_context, cs_trace_id, mem_space, walk_op, addr_match, instr_info, p_res);
+    return OCSD_ERR_NOT_INIT;
+}
+
 static inline void lib_cb_PktMon(const ocsd_extern_dcd_cb_fns *callbacks,
     const ocsd_datapath_op_t op,
     const ocsd_trc_index_t index_sop,
@@ -164,6 +164,48 @@ typedef ocsd_datapath_resp_t (* fnPktDataSinkCB)( const void *lib_context,
                                                   const ocsd_trc_index_t index_sop,
                                                   const void *pkt);
 
+/** Instruction walk operation for the fnTraceToWaypointCB callback */
+typedef enum _ocsd_wp_walk_op {
+    OCSD_WP_WALK_TO_WP,     /**< Walk instructions until a waypoint instruction (branch, ISB etc) is decoded. */
+    OCSD_WP_WALK_TO_ADDR    /**< Walk instructions until the next instruction address matches addr_match. */
+} ocsd_wp_walk_op_t;
+
+/** Result of an instruction walk by the fnTraceToWaypointCB callback */
+typedef struct _ocsd_wp_walk_res {
+    ocsd_vaddr_t st_addr;   /**< Address of the first instruction walked. */
+    ocsd_vaddr_t en_addr;   /**< Address following the last instruction walked (exclusive). */
+    uint32_t num_instr;     /**< Number of instructions walked. */
+    int wp_found;           /**< 1 if the waypoint / address was found, 0 if memory was not accessible before it was reached. */
+} ocsd_wp_walk_res_t;
+
+/** callback function to walk instructions to the next waypoint using the library memory access and instruction decode.
+
+    Performs the same instruction walk as the built-in decoders in a single call, using the memory 
+    accessor cache and span scanning of opcodes that cannot be waypoints.
+
+    On input instr_info must have the instr_addr, isa, pe_type and waypoint option fields set.
+    On return instr_info holds the decode of the last instruction walked - instruction type, branch address and
+    next ISA - with instr_addr advanced to the following instruction, as if fnDecodeArmInstCB had been called 
+    for each instruction in turn.
+
+    @param lib_context : library context pointer.
+    @param cs_trace_id : CoreSight trace ID - used for memory access.
+    @param mem_space : memory space for memory access.
+    @param walk_op : walk to a waypoint or to a matching address.
+    @param addr_match : next instruction address to stop at if walk_op is OCSD_WP_WALK_TO_ADDR.
+    @param *instr_info : instruction decode information - see above.
+    @param *p_res : returns the range and count of instructions walked.
+
+    @return ocsd_err_t  : Library error code -  OCSD_OK if successful. Inaccessible memory is not an error - see p_res->wp_found.
+*/
+typedef ocsd_err_t (* fnTraceToWaypointCB)(const void *lib_context,
+                                           const uint8_t cs_trace_id,
+                                           const ocsd_mem_space_acc_t mem_space,
+                                           const ocsd_wp_walk_op_t walk_op,
+                                           const ocsd_vaddr_t addr_match,
+                                           ocsd_instr_info *instr_info,
+                                           ocsd_wp_walk_res_t *p_res);
+
 /** an instance of this is owned by the decoder, filled in by the library - allows the CB fns in the library decode tree to be called. */
 typedef struct _ocsd_extern_dcd_cb_fns {
 /* Callback functions */
@@ -178,6 +220,8 @@ typedef struct _ocsd_extern_dcd_cb_fns {
     int packetCBFlags;  /**< Flags to indicate if the packet sink / packet monitor callbacks are in use. ( OCSD_CUST_DCD_PKT_CB_USE_MON / OCSD_CUST_DCD_PKT_CB_USE_SINK) */
 /* library context */
     const void *lib_context;  /**< library context pointer - use in callbacks to allow the library to load the correct context data. */
+/* Additional callback functions - after the context to keep the original structure layout. */
+    fnTraceToWaypointCB fn_trace_to_waypoint;       /**< Callback to walk instructions to a waypoint using library memory access and instruction decode. */
 } ocsd_extern_dcd_cb_fns;
 
 /** @}*/
@@ -76,6 +76,12 @@ typedef ocsd_datapath_resp_t (* FnTraceElemIn)( const void *p_context,
                                                 const uint8_t trc_chan_id, 
                                                 const ocsd_generic_trace_elem *elem); 
 
+/** function pointer type for pull mode trace data source. Return the next block of trace data - size 0 at end of data. 
+    Block must remain valid until the next call. */
+typedef ocsd_err_t (* FnTraceDataSrc)( const void *p_context,
+                                       const uint8_t **pp_data,
+                                       uint32_t *p_size);
+
 /** function pointer type for packet processor packet output sink, packet analyser/decoder input - generic declaration */
 typedef ocsd_datapath_resp_t (* FnDefPktDataIn)(const void *p_context, 
                                                 const ocsd_datapath_op_t op, 
@@ -90,6 +96,16 @@ typedef void (* FnDefPktDataMon)(const void *p_context,
                                                  const uint32_t size,
                                                  const uint8_t *p_data);
 
+/** function pointer type for batched packet processor packet output sink - all protocols. 
+    For OCSD_OP_DATA, p_packets is an array of num_pkts protocol packet structures (e.g. ocsd_etmv4_i_pkt), 
+    with the start trace index of each in p_indexes. num_pkts is 0 for other operations. 
+    Arrays are valid only during the call. */
+typedef ocsd_datapath_resp_t (* FnDefPktBatchIn)(const void *p_context,
+                                                 const ocsd_datapath_op_t op,
+                                                 const uint32_t num_pkts,
+                                                 const ocsd_trc_index_t *p_indexes,
+                                                 const void *p_packets);
+
 /** function pointer tyee for library default logger output to allow client to print zero terminated output string */
 typedef void (* FnDefLoggerPrintStrCB)(const void *p_context, const char *psz_msg_str, const int str_len);
 
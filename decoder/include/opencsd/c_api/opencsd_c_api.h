@@ -136,6 +136,28 @@ OCSD_C_API ocsd_datapath_resp_t ocsd_dt_process_data(const dcd_tree_handle_t han
                                             const uint8_t *pDataBlock,
                                             uint32_t *numBytesProcessed);
 
+/*!
+ * Input trace data into the decoder as a scatter-gather list of segments with continuous 
+ * trace indexes - e.g. the two parts of a wrapped ring buffer - without copying into a single buffer.
+ * 
+ * On a WAIT response, flush and call again with seg_offset advanced by the bytes processed.
+ *
+ * @param handle : Handle to decode tree.
+ * @param index : Trace buffer byte index for the start of the first segment.
+ * @param *segs : Array of data segments.
+ * @param num_segs : Number of segments.
+ * @param seg_offset : Byte offset into the segment data to start processing from.
+ * @param *numBytesProcessed : Number of bytes actually processed by the decoder in this call.
+ *
+ * @return ocsd_datapath_resp_t  : Datapath response code (CONT/WAIT/FATAL)
+ */
+OCSD_C_API ocsd_datapath_resp_t ocsd_dt_process_data_sg(const dcd_tree_handle_t handle,
+                                            const ocsd_trc_index_t index,
+                                            const ocsd_trc_data_seg_t *segs,
+                                            const int num_segs,
+                                            const uint32_t seg_offset,
+                                            uint32_t *numBytesProcessed);
+
 
 /*---------------------- Generic Trace Element Output  --------------------------------------------------------------*/
 
@@ -155,6 +177,35 @@ OCSD_C_API ocsd_datapath_resp_t ocsd_dt_process_data(const dcd_tree_handle_t han
  */
 OCSD_C_API ocsd_err_t ocsd_dt_set_gen_elem_outfn(const dcd_tree_handle_t handle, FnTraceElemIn pFn, const void *p_context);
 
+/*!
+ * Set a trace data source callback for pull mode decode - alternative to the element output callback.
+ *
+ * The decode tree calls the source for blocks of trace data as required by ocsd_dt_next_elems(). 
+ * Replaces any element output callback set on the tree.
+ *
+ * @param handle : Handle to decode tree.
+ * @param pFn : Pointer to the source callback function.
+ * @param p_context : opaque context pointer value used in callback function.
+ *
+ * @return  ocsd_err_t  : Library error code -  OCSD_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_dt_set_pull_source(const dcd_tree_handle_t handle, FnTraceDataSrc pFn, const void *p_context);
+
+/*!
+ * Get the next batch of decoded generic trace elements in pull mode.
+ *
+ * Trace data is read from the pull source and decoded until the batch is full or the trace data ends.
+ * Extended data pointers in the elements are valid until the next call.
+ *
+ * @param handle : Handle to decode tree.
+ * @param *p_elems : Array to fill with element records.
+ * @param max_elems : Size of the array.
+ * @param *num_elems : Returned number of elements. 0 at the end of the trace.
+ *
+ * @return  ocsd_err_t  : Library error code -  OCSD_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_dt_next_elems(const dcd_tree_handle_t handle, ocsd_gen_elem_rec_t *p_elems, const int max_elems, int *num_elems);
+
 /*---------------------- Trace Decoders ----------------------------------------------------------------------------------*/
 /*!
 * Creates a decoder that is registered with the library under the supplied name.
@@ -188,6 +239,30 @@ OCSD_C_API ocsd_err_t ocsd_dt_create_decoder(const dcd_tree_handle_t handle,
 OCSD_C_API ocsd_err_t ocsd_dt_remove_decoder(   const dcd_tree_handle_t handle, 
                                                 const unsigned char CSID);
 
+/*!
+* Apply a new configuration to an existing decoder in the tree, and reset the decoder.
+* The decoder is selected by the CoreSight trace ID in the configuration.
+*
+* @param handle : Handle to decode tree.
+* @param *decoder_name : Registered name of the decoder.
+* @param *decoder_cfg : Pointer to a valid configuration structure for the named decoder.
+*
+* @return ocsd_err_t  : Library error code -  OCSD_OK if successful.
+*/
+OCSD_C_API ocsd_err_t ocsd_dt_reconfig_decoder(const dcd_tree_handle_t handle,
+                                               const char *decoder_name,
+                                               const void *decoder_cfg);
+
+/*!
+* Reset the decode tree to the initial state for a new trace capture, retaining 
+* the decoders, callbacks and memory accessors.
+*
+* @param handle : Handle to decode tree.
+*
+* @return ocsd_err_t  : Library error code -  OCSD_OK if successful.
+*/
+OCSD_C_API ocsd_err_t ocsd_dt_reset(const dcd_tree_handle_t handle);
+
 
 /*!
 * Attach a callback function to the packet processor.
@@ -209,6 +284,73 @@ OCSD_C_API ocsd_err_t ocsd_dt_attach_packet_callback(  const dcd_tree_handle_t h
                                                 void *p_fn_callback_data,
                                                 const void *p_context);
 
+/*!
+* Attach a batched packet callback function to the packet processor.
+* 
+* Packets are copied into batches and the callback called once per batch, when the batch
+* is full, or on a flush or end of trace. This avoids a callback per packet for clients 
+* only interested in packets. A WAIT response applies to the batch - the packet processor 
+* stops when the batch callback returns WAIT, and continues on the next flush.
+* The batch callback is independent of the OCSD_C_API_CB_PKT_SINK output and may be used 
+* when a packet decoder is attached.
+* 
+* @param handle : Handle to decode tree.
+* @param CSID : Configured CoreSight trace ID for the decoder.
+* @param max_pkts : Maximum number of packets per batch.
+* @param p_fn_batch_in : Pointer to the callback function.
+* @param p_context : Opaque context pointer value used in callback function.
+*
+* @return ocsd_err_t  : Library error code -  OCSD_OK if successful.
+*/
+OCSD_C_API ocsd_err_t ocsd_dt_attach_packet_batch_callback( const dcd_tree_handle_t handle, 
+                                                const unsigned char CSID,
+                                                const uint32_t max_pkts,
+                                                FnDefPktBatchIn p_fn_batch_in,
+                                                const void *p_context);
+
+/*!
+* Get the stream summary from a packet processor created in skim mode - with 
+* OCSD_OPFLG_PKTPROC_SKIM in the create_flags. Skim mode counts packets from the 
+* packet headers, without outputting packets. ETMv4 instruction trace only.
+* 
+* @param handle : Handle to decode tree.
+* @param CSID : Configured CoreSight trace ID for the decoder.
+* @param *p_summary : Pointer to summary structure to fill in.
+*
+* @return ocsd_err_t  : Library error code -  OCSD_OK if successful, OCSD_ERR_DCD_INTERFACE_UNUSED if skim not supported by the protocol.
+*/
+OCSD_C_API ocsd_err_t ocsd_dt_get_skim_summary(const dcd_tree_handle_t handle, 
+                                               const unsigned char CSID,
+                                               ocsd_skim_summary_t *p_summary);
+
+/*!
+* Get the accumulated decode stage times. Times are only recorded if the library is 
+* built with OCSD_STAGE_TIMING defined, otherwise all values are 0.
+* 
+* @param handle : Handle to decode tree.
+* @param CSID : Configured CoreSight trace ID for the decoder, or OCSD_BAD_CS_SRC_ID for the whole tree.
+* @param *p_times : Pointer to stage times structure to fill in.
+*
+* @return ocsd_err_t  : Library error code -  OCSD_OK if successful.
+*/
+OCSD_C_API ocsd_err_t ocsd_dt_get_stage_times(const dcd_tree_handle_t handle, 
+                                              const unsigned char CSID,
+                                              ocsd_stage_times_t *p_times);
+
+/*!
+* Clear the decode stage times for all components in the decode tree.
+*
+* @param handle : Handle to decode tree.
+*/
+OCSD_C_API void ocsd_dt_reset_stage_times(const dcd_tree_handle_t handle);
+
+/*!
+* Log the decode stage times per component to the library message logger.
+*
+* @param handle : Handle to decode tree.
+*/
+OCSD_C_API void ocsd_dt_log_stage_times(const dcd_tree_handle_t handle);
+
 
 
 
@@ -314,6 +456,100 @@ OCSD_C_API ocsd_err_t ocsd_dt_add_callback_trcid_mem_acc(const dcd_tree_handle_t
  */
 OCSD_C_API ocsd_err_t ocsd_dt_remove_mem_acc(const dcd_tree_handle_t handle, const ocsd_vaddr_t st_address, const ocsd_mem_space_acc_t mem_space);
 
+/*!
+ * Publish a named memory image in the global image registry, from a copy of the supplied buffer.
+ * 
+ * Images are immutable once published, and may be added to any number of decode trees, 
+ * running on any threads. Publishing an image with an existing name replaces that image
+ * for subsequent users - decode trees already using the old image are unaffected.
+ * May be called concurrently from multiple threads.
+ *
+ * @param *name : Name of the image.
+ * @param address : Start address of memory area.
+ * @param *p_mem_buffer : pointer to memory buffer - copied into the image.
+ * @param mem_length : Size of memory buffer.
+ *
+ * @return ocsd_err_t  : Library error code -  RCDTL_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_publish_mem_image(const char *name, const ocsd_vaddr_t address, const uint8_t *p_mem_buffer, const uint32_t mem_length);
+
+/*!
+ * Publish a named memory image in the global image registry, loaded from a region of a binary file.
+ *
+ * @param *name : Name of the image.
+ * @param address : Start address of memory area.
+ * @param *filepath : Path to binary data file.
+ * @param file_offset : Offset of the memory data in the file.
+ * @param region_size : Size of the region, 0 for the remainder of the file.
+ *
+ * @return ocsd_err_t  : Library error code -  RCDTL_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_publish_mem_image_file(const char *name, const ocsd_vaddr_t address, const char *filepath, const size_t file_offset, const size_t region_size);
+
+/*!
+ * Withdraw a named memory image from the global image registry. Decode trees using the image 
+ * continue to do so until the memory accessor is removed or the tree destroyed.
+ *
+ * @param *name : Name of the image.
+ *
+ * @return ocsd_err_t  : Library error code -  RCDTL_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_withdraw_mem_image(const char *name);
+
+/*!
+ * Add a memory accessor for a named image in the global image registry to the decode tree.
+ *
+ * @param handle : Handle to decode tree.
+ * @param *name : Name of the published image.
+ * @param mem_space : Associated memory space.
+ *
+ * @return ocsd_err_t  : Library error code -  RCDTL_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_dt_add_mem_image_acc(const dcd_tree_handle_t handle, const char *name, const ocsd_mem_space_acc_t mem_space);
+
+/*!
+ * Add a memory accessor for the executable segments of an ELF file to the decode tree.
+ *
+ * The program headers are read, and each executable PT_LOAD segment mapped at its virtual
+ * address plus the load bias. Segment data is read from the file on first access.
+ *
+ * @param handle : Handle to decode tree.
+ * @param load_bias : Added to the segment addresses - e.g. load address of a shared object, 0 for executables.
+ * @param mem_space : Associated memory space.
+ * @param *filepath : Path to the ELF file.
+ *
+ * @return ocsd_err_t  : Library error code -  RCDTL_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_dt_add_elf_file_mem_acc(const dcd_tree_handle_t handle, const ocsd_vaddr_t load_bias, const ocsd_mem_space_acc_t mem_space, const char *filepath);
+
+/*!
+ * Get the load bias for an ELF file from the address a file offset is mapped at - e.g. from a 
+ * perf mmap record - for use with ocsd_dt_add_elf_file_mem_acc().
+ *
+ * @param *filepath : Path to the ELF file.
+ * @param map_address : Address the file offset is mapped at.
+ * @param map_offset : File offset mapped at map_address. Must be in a PT_LOAD segment.
+ * @param *load_bias : Returned load bias.
+ *
+ * @return ocsd_err_t  : Library error code -  RCDTL_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_get_elf_load_bias(const char *filepath, const ocsd_vaddr_t map_address, const uint64_t map_offset, ocsd_vaddr_t *load_bias);
+
+/*!
+ * Attach the precomputed basic block maps in a sidecar file to the memory accessors in the decode tree.
+ *
+ * Each map is attached at the link address of its region plus the load bias. The memory 
+ * accessor must be added first, and the region contents must match the map. 
+ *
+ * @param handle : Handle to decode tree.
+ * @param load_bias : Added to the map region addresses - as used for the memory accessor.
+ * @param mem_space : Associated memory space.
+ * @param *filepath : Path to the map file.
+ *
+ * @return ocsd_err_t  : Library error code -  RCDTL_OK if successful.
+ */
+OCSD_C_API ocsd_err_t ocsd_dt_attach_bb_map_file(const dcd_tree_handle_t handle, const ocsd_vaddr_t load_bias, const ocsd_mem_space_acc_t mem_space, const char *filepath);
+
 /*
  *  Print the mapped memory accessor ranges to the configured logger.
  *
@@ -384,6 +620,8 @@ OCSD_C_API void ocsd_def_errlog_msgout(const char *msg);
  * Take a packet structure and render a string representation of the packet data.
  * 
  * Returns a '0' terminated string of (buffer_size - 1) length or less.
+ * ETMv4 instruction trace packets are formatted directly into the buffer without memory allocation.
+ * May be called concurrently from multiple threads.
  *
  * @param pkt_protocol : Packet protocol type - used to interpret the packet pointer
  * @param *p_pkt : pointer to a valid packet structure of protocol type. cast to void *.
@@ -397,6 +635,9 @@ OCSD_C_API ocsd_err_t ocsd_pkt_str(const ocsd_trace_protocol_t pkt_protocol, con
 /*!
  * Get a string representation of the generic trace element.
  *
+ * Returns a '0' terminated string of (buffer_size - 1) length or less, formatted directly into 
+ * the buffer without memory allocation. May be called concurrently from multiple threads.
+ *
  * @param *p_pkt : pointer to valid generic element structure.
  * @param *buffer : character buffer for string.
  * @param buffer_size : size of character buffer.
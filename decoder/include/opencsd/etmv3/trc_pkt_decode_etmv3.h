@@ -211,6 +211,12 @@ public:
     TrcPktDecodeEtmV3(int instIDNum);
     virtual ~TrcPktDecodeEtmV3();
 
+    /* decode state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
+    virtual ocsd_err_t setPeFilter(const OcsdPeFilter &filter);
+
 protected:
     /* implementation packet decoding interface */
     virtual ocsd_datapath_resp_t processPacket();
@@ -251,6 +257,18 @@ private:
 
     OcsdGenElemList m_outputElemList;   //!< list of output elements
 
+//** PE filter
+    OcsdPeFilter m_pe_filter;   //!< filter set by client.
+    bool m_filter_active;       //!< filter has predicates set.
+    bool m_filter_ctxt_out;     //!< current context outside the filter.
+    bool m_filter_out_sent;     //!< filtered out marker output since the last traced range.
+
+    const bool isFilteredOut() const 
+    { 
+        return m_filter_active && (m_filter_ctxt_out || !m_pe_filter.matchAddr(m_IAddr)); 
+    };
+    void updateFilterCtxt();
+
 
 //** Other packet decoder state;
 
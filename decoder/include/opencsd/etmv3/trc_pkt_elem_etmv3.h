@@ -66,6 +66,7 @@ public:
 
     // override c_pkt to pass out the packet data struct.
     virtual const void *c_pkt() const { return &m_pkt_data; };
+    virtual const size_t c_pkt_size() const { return sizeof(ocsd_etmv3_pkt); };
 
 // update interface - set packet values
     void Clear();       //!< clear update data in packet ready for new one.
@@ -142,14 +143,15 @@ public:
 // printing
     virtual void toString(std::string &str) const;
     virtual void toStringFmt(const uint32_t fmtFlags, std::string &str) const;
+    virtual int toStringBuf(char *buffer, const int buf_size) const;
     
 private:
     const char *packetTypeName(const ocsd_etmv3_pkt_type type, const char **ppDesc) const;
-    void getBranchAddressStr(std::string &valStr) const;
-    void getAtomStr(std::string &valStr) const;
-    void getISyncStr(std::string &valStr) const;
-    void getISAStr(std::string &isaStr) const;
-    void getExcepStr(std::string &excepStr) const;
+    void getBranchAddressStr(trcPrintBuffer &buf) const;
+    void getAtomStr(trcPrintBuffer &buf) const;
+    void getISyncStr(trcPrintBuffer &buf) const;
+    void getISAStr(trcPrintBuffer &buf) const;
+    void getExcepStr(trcPrintBuffer &buf) const;
 
     ocsd_etmv3_pkt m_pkt_data; 
 };
@@ -54,6 +54,10 @@ public:
     TrcPktProcEtmV3(int instIDNum);
     virtual ~TrcPktProcEtmV3();
 
+    /* decode state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
 protected:
     /* implementation packet processing interface */
     virtual ocsd_datapath_resp_t processData(  const ocsd_trc_index_t index,
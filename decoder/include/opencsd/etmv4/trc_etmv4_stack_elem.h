@@ -35,6 +35,8 @@
 
 #include "opencsd/etmv4/trc_pkt_types_etmv4.h"
 
+#include "common/trc_state_blob.h"
+
 #include <deque>
 #include <vector>
 
@@ -82,6 +84,8 @@ private:
      p0_elem_t m_P0_type;
 
 protected:
+     void setRootIndex(const ocsd_trc_index_t root_index) { m_root_idx = root_index; };
+
      bool m_is_P0;  // true if genuine P0 - commit / cancellable, false otherwise
 
 };
@@ -227,6 +231,7 @@ protected:
 
 public:
     void setAtom(const ocsd_pkt_atom &atom) { m_atom = atom; };
+    void setHdrStarts(const uint32_t hdr_starts) { m_hdr_starts = hdr_starts; };
 
     const ocsd_atm_val commitOldest();
     int cancelNewest(const int nCancel);
@@ -235,20 +240,26 @@ public:
 
 private:
     ocsd_pkt_atom m_atom;
+    uint32_t m_hdr_starts;  // bulk atoms - bit set where an atom starts the next single byte header.
 };
 
 inline TrcStackElemAtom::TrcStackElemAtom(const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index) :
     TrcStackElem(P0_ATOM, true, root_pkt,root_index)
 {
     m_atom.num = 0;
+    m_hdr_starts = 0;
 }
 
 // commit oldest - get value and remove it from pattern
+// root index moves on to the header of the committed atom when it starts a new header in a bulk run.
 inline const ocsd_atm_val TrcStackElemAtom::commitOldest()
 {
     ocsd_atm_val val = (m_atom.En_bits & 0x1) ? ATOM_E : ATOM_N;
+    if (m_hdr_starts & 0x1)
+        setRootIndex(getRootIndex() + 1);
     m_atom.num--;
     m_atom.En_bits >>= 1;
+    m_hdr_starts >>= 1;
     return val;
 }
 
@@ -324,12 +335,19 @@ public:
     // creation functions - create and push if successful.
     TrcStackElemParam *createParamElem(const p0_elem_t p0_type, const bool isP0, const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const std::vector<uint32_t> &params);
     TrcStackElem *createParamElemNoParam(const p0_elem_t p0_type, const bool isP0, const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, bool back = false);
-    TrcStackElemAtom *createAtomElem (const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const ocsd_pkt_atom &atom);
+    TrcStackElemAtom *createAtomElem (const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const ocsd_pkt_atom &atom, const uint32_t hdr_starts = 0);
     TrcStackElemExcept *createExceptElem(const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const bool bSame, const uint16_t excepNum);
     TrcStackElemCtxt *createContextElem(const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const etmv4_context_t &context, const uint8_t IS, const bool back = false);
     TrcStackElemAddr *createAddrElem(const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const etmv4_addr_val_t &addr_val);
     TrcStackQElem *createQElem(const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const int count);
+
+    // decoder state save and restore - elements in stack order.
+    void saveState(TrcStateWriter &wr);
+    bool restoreState(TrcStateReader &rd);
+
 private:
+    TrcStackElem *restoreElem(TrcStateReader &rd);
+
     std::deque<TrcStackElem *> m_P0_stack;  //!< P0 decode element stack
     std::vector<TrcStackElem *> m_popped_elem;  //!< save list of popped but not deleted elements.
     std::deque<TrcStackElem *>::iterator m_iter;    //!< iterate across the list w/o removing stuff
@@ -54,6 +54,13 @@ public:
     TrcPktDecodeEtmV4I(int instIDNum);
     virtual ~TrcPktDecodeEtmV4I();
 
+    /* decode state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
+    /* PE filter */
+    virtual ocsd_err_t setPeFilter(const OcsdPeFilter &filter);
+
 protected:
     /* implementation packet decoding interface */
     virtual ocsd_datapath_resp_t processPacket();
@@ -97,6 +104,10 @@ protected:
     ocsd_err_t addElemCC(TrcStackElemParam *pParamElem);
     ocsd_err_t addElemTS(TrcStackElemParam *pParamElem, bool withCC);
     ocsd_err_t addElemEvent(TrcStackElemParam *pParamElem);
+
+    // PE filter handling - true if the filtered out marker needs to be output.
+    const bool enterFilteredOut();
+    void setElemFilteredOut(OcsdTraceElement &elem);
      
 private:
     void SetInstrInfoInAddrISA(const ocsd_vaddr_t addr_val, const uint8_t isa); 
@@ -127,6 +138,8 @@ private:
     ocsd_err_t returnStackPop();  // pop return stack and update instruction address.
 
     void setElemTraceRange(OcsdTraceElement &elemIn, const instr_range_t &addr_range, const bool executed, ocsd_trc_index_t index);
+    void mergeElemTraceRange(OcsdTraceElement &elemIn, const instr_range_t &addr_range, const bool executed, ocsd_trc_index_t index);
+    bool canMergeRange();
 
     ocsd_mem_space_acc_t getCurrMemSpace();
 
@@ -165,6 +178,9 @@ private:
     uint8_t m_CSID; //!< Coresight trace ID for this decoder.
 
     bool m_IASize64;    //!< True if 64 bit instruction addresses supported.
+    bool m_v7M_profile; //!< True if v7M profile core - exception returns are P0 elements.
+    bool m_v8M_profile; //!< True if v8M profile core - function returns are P0 elements.
+    bool m_ts_with_cc;  //!< True if cycle counting enabled - timestamps carry a cycle count.
 
 //** Other processor state;
 
@@ -218,6 +234,19 @@ private:
 
     TrcAddrReturnStack m_return_stack;  //!< the address return stack.
 
+//** PE filter
+    OcsdPeFilter m_pe_filter;   //!< filter set by client.
+    bool m_filter_active;       //!< filter has predicates set.
+    bool m_filter_ctxt_out;     //!< current context outside the filter.
+    bool m_filter_out_sent;     //!< filtered out marker output since the last traced range.
+    ocsd_ex_level m_curr_el;    //!< current exception level, from last context.
+
+    const bool isFilteredOut() const 
+    { 
+        return m_filter_active && (m_filter_ctxt_out || !m_pe_filter.matchAddr(m_instr_info.instr_addr)); 
+    };
+    void updateFilterCtxt();
+
 //** output element handling
     OcsdGenElemStack m_out_elem;  //!< output element stack.
     OcsdTraceElement &outElem() { return m_out_elem.getCurrElem(); };   //!< current  out element
@@ -116,6 +116,7 @@ public:
     EtmV4ITrcPacket &operator =(const ocsd_etmv4_i_pkt* p_pkt);
 
     virtual const void *c_pkt() const { return (const ocsd_etmv4_i_pkt *)this; };
+    virtual const size_t c_pkt_size() const { return sizeof(ocsd_etmv4_i_pkt); };
 
     // update interface - set packet values
     void initStartState();   //!< Set to initial state - no intra packet state valid. Use on start of trace / discontinuities.
@@ -135,6 +136,7 @@ public:
     void setCommitElements(const uint32_t commit_elem);
     void setCancelElements(const uint32_t cancel_elem);
     void setAtomPacket(const ocsd_pkt_atm_type type, const uint32_t En_bits, const uint8_t num);
+    void setAtomHdrStarts(const uint32_t hdr_starts);
 
     void setCondIF1(uint32_t const cond_key);
     void setCondIF2(uint8_t const c_elem_idx);
@@ -180,6 +182,7 @@ public:
     // atom
     const ocsd_pkt_atom &getAtom() const { return atom; };
     const int getNumAtoms() const { return atom.num; };
+    const uint32_t getAtomHdrStarts() const { return atom_hdr_starts; };
 
     // context
     const etmv4_context_t &getContext() const { return context; };
@@ -203,16 +206,22 @@ public:
     // packet type
     const bool isBadPacket() const;
 
+    // address stack is part of the packet processor state
+    const Etmv4PktAddrStack &getAddrStack() const { return m_addr_stack; };
+    void setAddrStack(const Etmv4PktAddrStack &addr_stack) { m_addr_stack = addr_stack; };
+
     // printing
     virtual void toString(std::string &str) const;
     virtual void toStringFmt(const uint32_t fmtFlags, std::string &str) const;
+    virtual int toStringBuf(char *buffer, const int buf_size) const;
 
 private:
     const char *packetTypeName(const ocsd_etmv4_i_pkt_type type, const char **pDesc) const;
-    void contextStr(std::string &ctxtStr) const;
-    void atomSeq(std::string &valStr) const;
-    void addrMatchIdx(std::string &valStr) const;
-    void exceptionInfo(std::string &valStr) const;
+    void contextStr(trcPrintBuffer &buf) const;
+    void atomSeq(trcPrintBuffer &buf) const;
+    void addrMatchIdx(trcPrintBuffer &buf) const;
+    void exceptionInfo(trcPrintBuffer &buf) const;
+    void addrStr(trcPrintBuffer &buf, const int updateBits) const;
 
     void push_vaddr();
     void pop_vaddr_idx(const uint8_t idx);
@@ -331,6 +340,12 @@ inline void EtmV4ITrcPacket::setAtomPacket(const ocsd_pkt_atm_type type, const u
     else
         atom.En_bits = En_bits;
     atom.num = num;    
+    atom_hdr_starts = 0;
+}
+
+inline void EtmV4ITrcPacket::setAtomHdrStarts(const uint32_t hdr_starts)
+{
+    atom_hdr_starts = hdr_starts;
 }
 
 inline void EtmV4ITrcPacket::setCondIF1(const uint32_t cond_key)
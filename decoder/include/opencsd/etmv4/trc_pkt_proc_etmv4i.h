@@ -55,6 +55,13 @@ public:
     TrcPktProcEtmV4I(int instIDNum);
     virtual ~TrcPktProcEtmV4I();
 
+    /* decode state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
+    /* skim mode summary */
+    virtual ocsd_err_t getSkimSummary(ocsd_skim_summary_t *p_summary) const;
+
 protected:
     /* implementation packet processing interface */
     virtual ocsd_datapath_resp_t processData(  const ocsd_trc_index_t index,
@@ -177,6 +184,7 @@ private:
     void iPktLongAddr(const uint8_t lastByte);
     void iPktQ(const uint8_t lastByte);
     void iAtom(const uint8_t lastByte);
+    void iAtomBulk(const uint8_t lastByte);     // atom run - bulk atom mode
     void iPktInvalidCfg(const uint8_t lastByte);  // packet invalid in current config.
 
     unsigned extractContField(const std::vector<uint8_t> &buffer, const unsigned st_idx, uint32_t &value, const unsigned byte_limit = 5);
@@ -197,8 +205,30 @@ private:
     } m_i_table[256];
 
     void BuildIPacketTable();
+    void SetConfigConsts();
+
+    // session constants - derived from the config once, rather than per packet.
+    uint32_t m_cc_mask;         //!< mask for the cycle count size.
+    bool m_commit_opt1;         //!< TRCIDR0.COMMOPT == 1 - no commit field in cycle count packets.
+    int m_ccf2_commit_offset;   //!< commit offset for cycle count F2 packets with the A bit set.
+    int m_cfg_vmid_bytes;       //!< bytes of VMID in context packets, if present.
+    int m_cfg_cid_bytes;        //!< bytes of context ID in context packets, if present.
+    uint8_t m_excep_m_type;     //!< exception type is M profile.
 
     void throwBadSequenceError(const char *pszExtMsg);
+
+    bool atomHdrPattern(const ocsd_etmv4_i_pkt_type type, const uint8_t hdr, uint32_t &En_bits, uint8_t &num) const;
+
+    // skim mode - packet lengths from the header table, no packet objects built or output.
+    ocsd_datapath_resp_t skimData(const uint32_t dataBlockSize, const uint8_t *pDataBlock, uint32_t *numBytesProcessed);
+    uint32_t skimPktLen(const uint8_t *pData, const uint32_t avail, bool &bBad) const;
+    void skimPkt(const uint8_t *pData, const uint32_t len, const bool bBad);
+    void skimTimestamp(const uint8_t *pData, const uint32_t len);
+    void skimResetState();
+
+    ocsd_skim_summary_t m_skim;             //!< summary of the stream in skim mode.
+    std::vector<uint8_t> m_skim_partial;    //!< packet split across data blocks.
+    int m_skim_zeros;                       //!< consecutive 0x00 bytes seen while searching for sync.
 };
 
 
@@ -207,6 +237,9 @@ inline const bool TrcPktProcEtmV4I::isBadPacket() const
     return m_curr_packet.isBadPacket();
 }
 
+
+#define ETMV4_OPFLG_PKTPROC_BULK_ATOMS  0x00010000 /**< Combine runs of consecutive atom packets into a single ETM4_PKT_I_ATOM_BULK packet */
+
 /** @}*/
 
 #endif // ARM_TRC_PKT_PROC_ETMV4I_IMPL_H_INCLUDED
@@ -147,6 +147,9 @@ typedef enum _ocsd_etmv4_i_pkt_type
         ETM4_PKT_I_DISCARD = 0x103,            //!< b00000011
         ETM4_PKT_I_OVERFLOW = 0x105,           //!< b00000101
 
+    // combined packets - output by the packet processor in bulk atom mode
+        ETM4_PKT_I_ATOM_BULK = 0x400,          //!< run of consecutive atom packets (F1 - F6) output as a single packet.
+
 } ocsd_etmv4_i_pkt_type;
 
 typedef union _etmv4_trace_info_t {
@@ -198,6 +201,7 @@ typedef struct _ocsd_etmv4_i_pkt
 
     // single packet data - only valid for specific packet types on packet instance.
     ocsd_pkt_atom  atom;       //!< atom elements - number of atoms indicates validity of packet
+    uint32_t atom_hdr_starts;   //!< bulk atom packets - bit n set if atom n is the first atom of a following header in the run.
     uint32_t cycle_count;       //!< cycle count
 
     uint32_t curr_spec_depth;   //!< current speculation depth
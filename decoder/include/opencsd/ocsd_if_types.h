@@ -140,6 +140,13 @@ typedef enum _ocsd_err_t {
     OCSD_ERR_DCDREG_TOOMANY,            /**< attempted to register too many custom decoders */
     /* decoder config */
     OCSD_ERR_DCD_INTERFACE_UNUSED,      /**< Attempt to connect or use and interface not supported by this decoder. */
+    /* decoder state save / restore */
+    OCSD_ERR_DCD_STATE_INVALID,         /**< Saved decoder state data invalid - wrong component, version or size. */
+    OCSD_ERR_DCD_STATE_BUSY,            /**< Decoder state cannot be saved - decoder has output pending. */
+    /* ELF memory accessor */
+    OCSD_ERR_MEM_ACC_ELF_INVALID,       /**< File is not a valid ELF file, or has no executable loadable segments. */
+    /* basic block maps */
+    OCSD_ERR_BB_MAP_INVALID,            /**< Basic block map file invalid, or map does not match the memory image. */
     /* end marker*/
     OCSD_ERR_LAST
 } ocsd_err_t;
@@ -184,6 +191,13 @@ typedef enum _ocsd_datapath_op_t {
     OCSD_OP_RESET, /**< Reset decode state - drop any existing partial data. No data packet. */
 } ocsd_datapath_op_t;
 
+/** Trace data segment - one part of a scatter-gather list of trace data.
+  */
+typedef struct _ocsd_trc_data_seg {
+    const uint8_t *p_data;  /**< Pointer to segment data. */
+    uint32_t size;          /**< Size of segment in bytes. */
+} ocsd_trc_data_seg_t;
+
 /**
   * Trace Datapath responses
   */
@@ -503,18 +517,67 @@ typedef struct _ocsd_file_mem_region {
 #define OCSD_OPFLG_PKTPROC_NOMON_BAD_PKTS  0x00000020  /**< don't forward bad packets to monitor interface */
 #define OCSD_OPFLG_PKTPROC_ERR_BAD_PKTS    0x00000040  /**< throw error for bad packets - halt decoding. */
 #define OCSD_OPFLG_PKTPROC_UNSYNC_ON_BAD_PKTS 0x00000080  /**< switch to unsynced state on bad packets - wait for next sync point */
+#define OCSD_OPFLG_PKTPROC_SKIM            0x00000400  /**< skim mode - scan packet headers into a stream summary, no packets output. ETMv4 only - not in the common set. */
 
 /** mask to combine all common packet processor operational control flags */
 #define OCSD_OPFLG_PKTPROC_COMMON (OCSD_OPFLG_PKTPROC_NOFWD_BAD_PKTS | \
                                     OCSD_OPFLG_PKTPROC_NOMON_BAD_PKTS | \
                                     OCSD_OPFLG_PKTPROC_ERR_BAD_PKTS | \
-                                    OCSD_OPFLG_PKTPROC_UNSYNC_ON_BAD_PKTS  )
+                                    OCSD_OPFLG_PKTPROC_UNSYNC_ON_BAD_PKTS )
 
 /** mask for the component spcific flags */
 #define OCSD_OPFLG_COMP_MODE_MASK 0xFFFF0000
 
 /** @}*/
 
+/** @name Packet Processor Skim Summary
+@{*/
+
+/** Summary of a single trace stream, collected by a packet processor in skim mode (OCSD_OPFLG_PKTPROC_SKIM).
+    Accumulated until the processor is reset. */
+typedef struct _ocsd_skim_summary {
+    uint64_t num_bytes;         /**< trace bytes seen on the stream */
+    uint64_t unsync_bytes;      /**< bytes seen while searching for a sync point */
+    uint64_t num_packets;       /**< number of complete packets */
+    uint32_t num_sync;          /**< number of sync packets (ETMv4 A-Sync) */
+    uint32_t num_overflow;      /**< number of overflow packets */
+    uint32_t num_bad;           /**< number of reserved header or bad sequence packets */
+    uint32_t ts_valid;          /**< 1 if ts_first and ts_last are valid */
+    uint64_t ts_first;          /**< first timestamp value on the stream */
+    uint64_t ts_last;           /**< last timestamp value on the stream */
+    uint64_t hdr_counts[256];   /**< packet counts by first header byte - protocol packet type histogram */
+} ocsd_skim_summary_t;
+
+/** @}*/
+
+/** @name Decode Stage Timing
+@{*/
+
+/** Decode stages timed per component when the library is built with OCSD_STAGE_TIMING defined. */
+typedef enum _ocsd_timing_stage_t {
+    OCSD_TSTAGE_DEFORMAT,       /**< Frame deformatter - trace data in. */
+    OCSD_TSTAGE_PKT_PROC,       /**< Packet processor - trace data in to packets. */
+    OCSD_TSTAGE_PKT_DECODE,     /**< Packet decoder - packets in to generic elements. */
+    OCSD_TSTAGE_MEM_ACC,        /**< Packet decoder memory access. */
+    OCSD_TSTAGE_INSTR_DECODE,   /**< Packet decoder instruction decode. */
+    OCSD_TSTAGE_ELEM_OUT,       /**< Packet decoder generic element output - the client sink. */
+    OCSD_TSTAGE_NUM             /**< Number of timed stages. */
+} ocsd_timing_stage_t;
+
+/** Accumulated time for a single decode stage. */
+typedef struct _ocsd_stage_time {
+    uint64_t calls;             /**< number of timed calls into the stage */
+    uint64_t total_ns;          /**< total time in the stage, including other timed stages called from it */
+    uint64_t self_ns;           /**< time in the stage, excluding other timed stages called from it */
+} ocsd_stage_time_t;
+
+/** Accumulated times for all decode stages. Accumulated until reset. */
+typedef struct _ocsd_stage_times {
+    ocsd_stage_time_t stage[OCSD_TSTAGE_NUM];   /**< times indexed by ocsd_timing_stage_t */
+} ocsd_stage_times_t;
+
+/** @}*/
+
 /** @name Packet Decoder Operation Control Flags
     common operational flags - bottom 16 bits,
     protcol component specific - top 16 bits.
@@ -522,9 +585,11 @@ typedef struct _ocsd_file_mem_region {
     @{*/
 
 #define OCSD_OPFLG_PKTDEC_ERROR_BAD_PKTS  0x00000100  /**< throw error on bad packets input (default is to unsync and wait) */
+#define OCSD_OPFLG_PKTDEC_MERGE_RANGES    0x00000200  /**< PE decoders merge address contiguous instruction ranges (not taken branch followed by fall through range) into a single range element, num_instr_range is the total for the merged range */
 
 /** mask to combine all common packet processor operational control flags */
-#define OCSD_OPFLG_PKTDEC_COMMON (OCSD_OPFLG_PKTDEC_ERROR_BAD_PKTS)
+#define OCSD_OPFLG_PKTDEC_COMMON (OCSD_OPFLG_PKTDEC_ERROR_BAD_PKTS | \
+                                  OCSD_OPFLG_PKTDEC_MERGE_RANGES)
 
 /** @}*/
 
@@ -105,6 +105,12 @@ public:
     TrcPktDecodePtm(int instIDNum);
     virtual ~TrcPktDecodePtm();
 
+    /* decode state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
+    virtual ocsd_err_t setPeFilter(const OcsdPeFilter &filter);
+
 protected:
     /* implementation packet decoding interface */
     virtual ocsd_datapath_resp_t processPacket();
@@ -136,6 +142,7 @@ private:
     ocsd_err_t traceInstrToWP(bool &bWPFound, const waypoint_trace_t traceWPOp = TRACE_WAYPOINT, const ocsd_vaddr_t nextAddrMatch = 0);      //!< follow instructions from the current address to a WP. true if good, false if memory cannot be accessed.
     ocsd_datapath_resp_t processAtomRange(const ocsd_atm_val A, const char *pkt_msg, const waypoint_trace_t traceWPOp = TRACE_WAYPOINT, const ocsd_vaddr_t nextAddrMatch = 0);
     void checkPendingNacc(ocsd_datapath_resp_t &resp);
+    bool canHoldRange(const ocsd_atm_val A);
 
     uint8_t m_CSID; //!< Coresight trace ID for this decoder.
 
@@ -181,8 +188,21 @@ private:
     bool m_i_sync_pe_ctxt;  //!< isync has pe context.
 
     PtmAtoms m_atoms;           //!< atoms to process in an atom packet
+    bool m_range_held;          //!< output range not sent - to be merged with the range for the next atom in the packet.
 
     TrcAddrReturnStack m_return_stack;  //!< trace return stack.
+
+//** PE filter
+    OcsdPeFilter m_pe_filter;   //!< filter set by client.
+    bool m_filter_active;       //!< filter has predicates set.
+    bool m_filter_ctxt_out;     //!< current context outside the filter.
+    bool m_filter_out_sent;     //!< filtered out marker output since the last traced range.
+
+    const bool isFilteredOut() const 
+    { 
+        return m_filter_active && (m_filter_ctxt_out || !m_pe_filter.matchAddr(m_curr_pe_state.instr_addr)); 
+    };
+    void updateFilterCtxt();
     
 //** output element
     OcsdTraceElement m_output_elem;
@@ -45,7 +45,7 @@
 @{*/
 
 
-class PtmTrcPacket :  public TrcPacketBase, public ocsd_ptm_pkt, trcPrintableElem
+class PtmTrcPacket :  public TrcPacketBase, public ocsd_ptm_pkt, public trcPrintableElem
 {
 public:
     PtmTrcPacket();
@@ -54,6 +54,7 @@ public:
     PtmTrcPacket &operator =(const ocsd_ptm_pkt* p_pkt);
 
     virtual const void *c_pkt() const { return (const ocsd_ptm_pkt *)this; };
+    virtual const size_t c_pkt_size() const { return sizeof(ocsd_ptm_pkt); };
 
     // update interface - set packet values
 
@@ -120,16 +121,17 @@ public:
     // printing
     virtual void toString(std::string &str) const;
     virtual void toStringFmt(const  uint32_t fmtFlags, std::string &str) const;
+    virtual int toStringBuf(char *buffer, const int buf_size) const;
 
 private:
-    void packetTypeName(const ocsd_ptm_pkt_type pkt_type, std::string &name, std::string &desc) const;
-    void getAtomStr(std::string &valStr) const;
-    void getBranchAddressStr(std::string &valStr) const;
-    void getExcepStr(std::string &excepStr) const;
-    void getISAStr(std::string &isaStr) const;
-    void getCycleCountStr(std::string &subStr) const;
-    void getISyncStr(std::string &valStr) const;
-    void getTSStr(std::string &valStr) const;
+    const char *packetTypeName(const ocsd_ptm_pkt_type pkt_type, const char **ppDesc) const;
+    void getAtomStr(trcPrintBuffer &buf) const;
+    void getBranchAddressStr(trcPrintBuffer &buf) const;
+    void getExcepStr(trcPrintBuffer &buf) const;
+    void getISAStr(trcPrintBuffer &buf) const;
+    void getCycleCountStr(trcPrintBuffer &buf) const;
+    void getISyncStr(trcPrintBuffer &buf) const;
+    void getTSStr(trcPrintBuffer &buf) const;
 };
 
 
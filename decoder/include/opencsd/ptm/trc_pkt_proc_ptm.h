@@ -56,6 +56,10 @@ public:
     TrcPktProcPtm(int instIDNum);
     virtual ~TrcPktProcPtm();
 
+    /* decode state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
 protected:
     /* implementation packet processing interface */
     virtual ocsd_datapath_resp_t processData(  const ocsd_trc_index_t index,
@@ -51,7 +51,14 @@ public:
     TrcPktDecodeStm();
     TrcPktDecodeStm(int instIDNum);
     virtual ~TrcPktDecodeStm();
-    
+
+    /* decode state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
+    /* no PE instruction trace in STM - PE filter does not apply */
+    virtual ocsd_err_t setPeFilter(const OcsdPeFilter &filter) { return OCSD_OK; };
+
 protected:
     /* implementation packet decoding interface */
     virtual ocsd_datapath_resp_t processPacket();
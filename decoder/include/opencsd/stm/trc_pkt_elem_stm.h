@@ -59,6 +59,7 @@ public:
     StmTrcPacket &operator =(const ocsd_stm_pkt *p_pkt);
 
     virtual const void *c_pkt() const { return (const ocsd_stm_pkt *)this; };
+    virtual const size_t c_pkt_size() const { return sizeof(ocsd_stm_pkt); };
 
     void initStartState();  //!< Initialise packet state at start of decoder. 
     void initNextPacket();  //!< Initialise state for next packet.
@@ -97,10 +98,11 @@ public:
     // printing
     virtual void toString(std::string &str) const;
     virtual void toStringFmt(const uint32_t fmtFlags, std::string &str) const;
+    virtual int toStringBuf(char *buffer, const int buf_size) const;
 
 
 private:
-    void pktTypeName(const ocsd_stm_pkt_type pkt_type, std::string &name, std::string &desc) const;
+    void pktTypeName(trcPrintBuffer &buf, const ocsd_stm_pkt_type pkt_type, const bool incDesc) const;
 };
 
 inline void StmTrcPacket::setPacketType(const ocsd_stm_pkt_type type, const bool bMarker)
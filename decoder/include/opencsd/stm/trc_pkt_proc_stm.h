@@ -52,6 +52,10 @@ public:
     TrcPktProcStm(int instIDNum);
     virtual ~TrcPktProcStm();
 
+    /* decode state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
 protected:
     /* implementation packet processing interface */
     virtual ocsd_datapath_resp_t processData(  const ocsd_trc_index_t index,
@@ -153,6 +157,8 @@ private:
     PPKTFN m_2N_ops[0x10];
     PPKTFN m_3N_ops[0x10];
 
+    void getStateFnList(std::vector<PPKTFN> &fn_list); //!< functions m_pCurrPktFn may hold - state saved as index into list
+
     // read a nibble from the input data - may read a byte and set spare or return spare.
     // handles setting up packet data block and end of input 
     bool readNibble();
@@ -62,6 +62,7 @@ typedef enum _ocsd_gen_trc_elem_t
     OCSD_GEN_TRC_ELEM_EVENT,           /*!< Event - trigger or numbered event  */   
     OCSD_GEN_TRC_ELEM_SWTRACE,         /*!< Software trace packet - may contain data payload. */
     OCSD_GEN_TRC_ELEM_CUSTOM,          /*!< Fully custom packet type - used by none-ARM architecture decoders */
+    OCSD_GEN_TRC_ELEM_FILTERED_OUT,    /*!< PE executing outside the decode PE filter - instructions not decoded until back inside filter. */
 } ocsd_gen_trc_elem_t;
 
 
@@ -128,6 +129,13 @@ typedef struct _ocsd_generic_trace_elem {
 
 } ocsd_generic_trace_elem;
 
+/** Generic trace element record - returned in batches by the decode tree pull iterator. */
+typedef struct _ocsd_gen_elem_rec {
+    ocsd_trc_index_t index_sop;         /**< Trace index for start of packet generating this element. */
+    uint8_t trc_chan_id;                /**< CoreSight Trace ID for the source of this element. */
+    ocsd_generic_trace_elem elem;       /**< The generic trace element. */
+} ocsd_gen_elem_rec_t;
+
 
 typedef enum _event_t {
     EVENT_UNKNOWN = 0,
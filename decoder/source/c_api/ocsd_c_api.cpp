@@ -65,6 +65,7 @@ static ocsd_err_t ocsd_check_and_add_mem_acc_mapper(const dcd_tree_handle_t hand
 typedef struct _lib_dt_data_list {
     std::vector<ITrcTypedBase *> cb_objs;
     DefLogStrCBObj s_def_log_str_cb;
+    TraceDataSrcCBObj pull_src_cb;
 } lib_dt_data_list;
 
 /* map lists to handles */
@@ -113,8 +114,9 @@ OCSD_C_API void ocsd_destroy_dcd_tree(const dcd_tree_handle_t handle)
 {
     if(handle != C_API_INVALID_TREE_HANDLE)
     {
+        // element output is the library pull sink in pull mode.
         GenTraceElemCBObj * pIf = (GenTraceElemCBObj *)(((DecodeTree *)handle)->getGenTraceElemOutI());
-        if(pIf != 0)
+        if((pIf != 0) && !((DecodeTree *)handle)->getPullSource())
             delete pIf;
 
         /* need to clear any associated callback data. */
@@ -152,6 +154,19 @@ OCSD_C_API ocsd_datapath_resp_t ocsd_dt_process_data(const dcd_tree_handle_t han
     return resp;
 }
 
+OCSD_C_API ocsd_datapath_resp_t ocsd_dt_process_data_sg(const dcd_tree_handle_t handle,
+                                            const ocsd_trc_index_t index,
+                                            const ocsd_trc_data_seg_t *segs,
+                                            const int num_segs,
+                                            const uint32_t seg_offset,
+                                            uint32_t *numBytesProcessed)
+{
+    ocsd_datapath_resp_t resp =  OCSD_RESP_FATAL_NOT_INIT;
+    if(handle != C_API_INVALID_TREE_HANDLE)
+        resp = ((DecodeTree *)handle)->TraceDataInSG(index,segs,num_segs,seg_offset,numBytesProcessed);
+    return resp;
+}
+
 /*** Decode tree - decoder management */
 
 OCSD_C_API ocsd_err_t ocsd_dt_create_decoder(const dcd_tree_handle_t handle,
@@ -187,6 +202,33 @@ OCSD_C_API ocsd_err_t ocsd_dt_remove_decoder(   const dcd_tree_handle_t handle,
     return ((DecodeTree *)handle)->removeDecoder(CSID);
 }
 
+OCSD_C_API ocsd_err_t ocsd_dt_reconfig_decoder(const dcd_tree_handle_t handle,
+                                               const char *decoder_name,
+                                               const void *decoder_cfg)
+{
+    ocsd_err_t err = OCSD_OK;
+    DecodeTree *dt = (DecodeTree *)handle;
+    std::string dName = decoder_name;
+    IDecoderMngr *pDcdMngr;
+    err = OcsdLibDcdRegister::getDecoderRegister()->getDecoderMngrByName(dName,&pDcdMngr);
+    if(err != OCSD_OK)
+        return err;
+
+    CSConfig *pConfig = 0;
+    err = pDcdMngr->createConfigFromDataStruct(&pConfig,decoder_cfg);
+    if(err != OCSD_OK)
+        return err;
+
+    err = dt->reconfigureDecoder(pConfig);
+    delete pConfig;
+    return err;
+}
+
+OCSD_C_API ocsd_err_t ocsd_dt_reset(const dcd_tree_handle_t handle)
+{
+    return ((DecodeTree *)handle)->resetDecodeTree();
+}
+
 OCSD_C_API ocsd_err_t ocsd_dt_attach_packet_callback(  const dcd_tree_handle_t handle, 
                                                 const unsigned char CSID,
                                                 const ocsd_c_api_cb_types callback_type, 
@@ -234,6 +276,66 @@ OCSD_C_API ocsd_err_t ocsd_dt_attach_packet_callback(  const dcd_tree_handle_t h
     return err;
 }
 
+OCSD_C_API ocsd_err_t ocsd_dt_attach_packet_batch_callback( const dcd_tree_handle_t handle, 
+                                                const unsigned char CSID,
+                                                const uint32_t max_pkts,
+                                                FnDefPktBatchIn p_fn_batch_in,
+                                                const void *p_context)
+{
+    ocsd_err_t err = OCSD_OK;
+    DecodeTree *pDT = static_cast<DecodeTree *>(handle);
+
+    if (!p_fn_batch_in || !max_pkts)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    PktBatchCBObj *pBatchSink = new (std::nothrow) PktBatchCBObj(p_fn_batch_in, p_context);
+    if (!pBatchSink)
+        return OCSD_ERR_MEM;
+
+    err = pDT->attachPktBatchSink(CSID, pBatchSink, max_pkts);
+    if (err == OCSD_OK)
+    {
+        // save object pointer for destruction later.
+        std::map<dcd_tree_handle_t, lib_dt_data_list *>::iterator it;
+        it = s_data_map.find(handle);
+        if (it != s_data_map.end())
+            it->second->cb_objs.push_back(pBatchSink);
+    }
+    else
+        delete pBatchSink;
+    return err;
+}
+
+OCSD_C_API ocsd_err_t ocsd_dt_get_skim_summary(const dcd_tree_handle_t handle, 
+                                               const unsigned char CSID,
+                                               ocsd_skim_summary_t *p_summary)
+{
+    if (!p_summary)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    return ((DecodeTree *)handle)->getSkimSummary(CSID, p_summary);
+}
+
+OCSD_C_API ocsd_err_t ocsd_dt_get_stage_times(const dcd_tree_handle_t handle, 
+                                              const unsigned char CSID,
+                                              ocsd_stage_times_t *p_times)
+{
+    if (!p_times)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    return ((DecodeTree *)handle)->getStageTimes(CSID, p_times);
+}
+
+OCSD_C_API void ocsd_dt_reset_stage_times(const dcd_tree_handle_t handle)
+{
+    if (handle != C_API_INVALID_TREE_HANDLE)
+        ((DecodeTree *)handle)->resetStageTimes();
+}
+
+OCSD_C_API void ocsd_dt_log_stage_times(const dcd_tree_handle_t handle)
+{
+    if (handle != C_API_INVALID_TREE_HANDLE)
+        ((DecodeTree *)handle)->logStageTimes();
+}
+
 /*** Decode tree set element output */
 
 OCSD_C_API ocsd_err_t ocsd_dt_set_gen_elem_outfn(const dcd_tree_handle_t handle, FnTraceElemIn pFn, const void *p_context)
@@ -248,6 +350,30 @@ OCSD_C_API ocsd_err_t ocsd_dt_set_gen_elem_outfn(const dcd_tree_handle_t handle,
     return OCSD_ERR_MEM;
 }
 
+OCSD_C_API ocsd_err_t ocsd_dt_set_pull_source(const dcd_tree_handle_t handle, FnTraceDataSrc pFn, const void *p_context)
+{
+    std::map<dcd_tree_handle_t, lib_dt_data_list *>::iterator it;
+    it = s_data_map.find(handle);
+    if (it == s_data_map.end())
+        return OCSD_ERR_NOT_INIT;
+
+    DecodeTree *pTree = (DecodeTree *)handle;
+    GenTraceElemCBObj *pCBObj = pTree->getPullSource() ? 0 : (GenTraceElemCBObj *)(pTree->getGenTraceElemOutI());
+    it->second->pull_src_cb.setCBFn(p_context, pFn);
+    ocsd_err_t err = pTree->setPullSource(pFn ? &(it->second->pull_src_cb) : 0);
+
+    // any element output callback is replaced by the pull iterator.
+    if ((err == OCSD_OK) && pCBObj)
+        delete pCBObj;
+    return err;
+}
+
+OCSD_C_API ocsd_err_t ocsd_dt_next_elems(const dcd_tree_handle_t handle, ocsd_gen_elem_rec_t *p_elems, const int max_elems, int *num_elems)
+{
+    if (handle == C_API_INVALID_TREE_HANDLE)
+        return OCSD_ERR_NOT_INIT;
+    return ((DecodeTree *)handle)->nextElements(p_elems, max_elems, num_elems);
+}
 
 /*** Default error logging */
 
@@ -310,25 +436,24 @@ OCSD_C_API ocsd_err_t ocsd_pkt_str(const ocsd_trace_protocol_t pkt_protocol, con
     if((buffer == NULL) || (buffer_size < 2))
         return OCSD_ERR_INVALID_PARAM_VAL;
 
-    std::string pktStr = "";
     buffer[0] = 0;
 
     switch(pkt_protocol)
     {
     case OCSD_PROTOCOL_ETMV4I:
-        trcPrintElemToString<EtmV4ITrcPacket,ocsd_etmv4_i_pkt>(p_pkt, pktStr);
+        trcPrintElemToBuffer<EtmV4ITrcPacket,ocsd_etmv4_i_pkt>(p_pkt, buffer, buffer_size);
         break;
 
     case OCSD_PROTOCOL_ETMV3:
-        trcPrintElemToString<EtmV3TrcPacket,ocsd_etmv3_pkt>(p_pkt, pktStr);
+        trcPrintElemToBuffer<EtmV3TrcPacket,ocsd_etmv3_pkt>(p_pkt, buffer, buffer_size);
         break;
 
     case OCSD_PROTOCOL_STM:
-        trcPrintElemToString<StmTrcPacket,ocsd_stm_pkt>(p_pkt, pktStr);
+        trcPrintElemToBuffer<StmTrcPacket,ocsd_stm_pkt>(p_pkt, buffer, buffer_size);
         break;
 
     case OCSD_PROTOCOL_PTM:
-        trcPrintElemToString<PtmTrcPacket,ocsd_ptm_pkt>(p_pkt, pktStr);
+        trcPrintElemToBuffer<PtmTrcPacket,ocsd_ptm_pkt>(p_pkt, buffer, buffer_size);
         break;
 
     default:
@@ -338,28 +463,15 @@ OCSD_C_API ocsd_err_t ocsd_pkt_str(const ocsd_trace_protocol_t pkt_protocol, con
             err = OCSD_ERR_NO_PROTOCOL;
         break;
     }
-
-    if(pktStr.size() > 0)
-    {
-        strncpy(buffer,pktStr.c_str(),buffer_size-1);
-        buffer[buffer_size-1] = 0;
-    }
     return err;
 }
 
 OCSD_C_API ocsd_err_t ocsd_gen_elem_str(const ocsd_generic_trace_elem *p_pkt, char *buffer, const int buffer_size)
 {
-    ocsd_err_t err = OCSD_OK;
     if((buffer == NULL) || (buffer_size < 2))
         return OCSD_ERR_INVALID_PARAM_VAL;
-    std::string str;
-    trcPrintElemToString<OcsdTraceElement,ocsd_generic_trace_elem>(p_pkt,str);
-    if(str.size() > 0)
-    {
-        strncpy(buffer,str.c_str(),buffer_size -1);
-        buffer[buffer_size-1] = 0;
-    }
-    return err;
+    trcPrintElemToBuffer<OcsdTraceElement,ocsd_generic_trace_elem>(p_pkt, buffer, buffer_size);
+    return OCSD_OK;
 }
 
 /*** Decode tree -- memory accessor control */
@@ -429,6 +541,74 @@ OCSD_C_API ocsd_err_t ocsd_dt_remove_mem_acc(const dcd_tree_handle_t handle, con
     return err;
 }
 
+OCSD_C_API ocsd_err_t ocsd_publish_mem_image(const char *name, const ocsd_vaddr_t address, const uint8_t *p_mem_buffer, const uint32_t mem_length)
+{
+    TrcMemImagePtr image;
+    if(name == 0)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    ocsd_err_t err = TrcMemImage::createFromBuffer(name, address, p_mem_buffer, mem_length, image);
+    if(err == OCSD_OK)
+        err = TrcMemImageRegistry::getGlobal().publishImage(image);
+    return err;
+}
+
+OCSD_C_API ocsd_err_t ocsd_publish_mem_image_file(const char *name, const ocsd_vaddr_t address, const char *filepath, const size_t file_offset, const size_t region_size)
+{
+    TrcMemImagePtr image;
+    if((name == 0) || (filepath == 0))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    ocsd_err_t err = TrcMemImage::createFromFile(name, filepath, address, file_offset, region_size, image);
+    if(err == OCSD_OK)
+        err = TrcMemImageRegistry::getGlobal().publishImage(image);
+    return err;
+}
+
+OCSD_C_API ocsd_err_t ocsd_withdraw_mem_image(const char *name)
+{
+    if(name == 0)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    return TrcMemImageRegistry::getGlobal().withdrawImage(name);
+}
+
+OCSD_C_API ocsd_err_t ocsd_dt_add_mem_image_acc(const dcd_tree_handle_t handle, const char *name, const ocsd_mem_space_acc_t mem_space)
+{
+    ocsd_err_t err = OCSD_OK;
+    DecodeTree *pDT;
+    if(name == 0)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    err = ocsd_check_and_add_mem_acc_mapper(handle,&pDT);
+    if(err == OCSD_OK)
+        err = pDT->addImageMemAcc(std::string(name), mem_space);
+    return err;
+}
+
+OCSD_C_API ocsd_err_t ocsd_dt_add_elf_file_mem_acc(const dcd_tree_handle_t handle, const ocsd_vaddr_t load_bias, const ocsd_mem_space_acc_t mem_space, const char *filepath)
+{
+    ocsd_err_t err = OCSD_OK;
+    DecodeTree *pDT;
+    if(filepath == 0)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    err = ocsd_check_and_add_mem_acc_mapper(handle,&pDT);
+    if(err == OCSD_OK)
+        err = pDT->addElfFileMemAcc(filepath, load_bias, mem_space);
+    return err;
+}
+
+OCSD_C_API ocsd_err_t ocsd_get_elf_load_bias(const char *filepath, const ocsd_vaddr_t map_address, const uint64_t map_offset, ocsd_vaddr_t *load_bias)
+{
+    if((filepath == 0) || (load_bias == 0))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    return TrcMemAccElf::getLoadBias(filepath, map_address, map_offset, *load_bias);
+}
+
+OCSD_C_API ocsd_err_t ocsd_dt_attach_bb_map_file(const dcd_tree_handle_t handle, const ocsd_vaddr_t load_bias, const ocsd_mem_space_acc_t mem_space, const char *filepath)
+{
+    if((handle == C_API_INVALID_TREE_HANDLE) || (filepath == 0))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    DecodeTree *pDT = static_cast<DecodeTree *>(handle);
+    return pDT->attachBBMapFile(filepath, load_bias, mem_space);
+}
+
 OCSD_C_API void ocsd_tl_log_mapped_mem_ranges(const dcd_tree_handle_t handle)
 {
     if(handle != C_API_INVALID_TREE_HANDLE)
@@ -361,7 +361,18 @@ ocsd_datapath_resp_t PktDataSinkCB(const void *lib_context,
     return resp;
 }
 
-
+ocsd_err_t TraceToWaypointCB(const void *lib_context,
+    const uint8_t cs_trace_id,
+    const ocsd_mem_space_acc_t mem_space,
+    const ocsd_wp_walk_op_t walk_op,
+    const ocsd_vaddr_t addr_match,
+    ocsd_instr_info *instr_info,
+    ocsd_wp_walk_res_t *p_res)
+{
+    if (lib_context && instr_info && p_res)
+        return ((CustomDecoderWrapper *)lib_context)->traceToWaypoint(cs_trace_id, mem_space, walk_op, addr_match, instr_info, p_res);
+    return OCSD_ERR_INVALID_PARAM_VAL;
+}
 
 /** decoder instance object */
 CustomDecoderWrapper::CustomDecoderWrapper() : TraceComponent("extern_wrapper"),                                            
@@ -426,6 +437,75 @@ void CustomDecoderWrapper::SetCallbacks(ocsd_extern_dcd_cb_fns & callbacks)
     callbacks.fn_memory_access = MemAccessCB;
     callbacks.fn_packet_data_sink = PktDataSinkCB;
     callbacks.fn_packet_mon = PktMonCB;
+    callbacks.fn_trace_to_waypoint = TraceToWaypointCB;
+}
+
+// same walk as the built-in decoder traceInstrToWP() - span reads when looking for a waypoint.
+ocsd_err_t CustomDecoderWrapper::traceToWaypoint(const uint8_t cs_trace_id, const ocsd_mem_space_acc_t mem_space,
+                                                 const ocsd_wp_walk_op_t walk_op, const ocsd_vaddr_t addr_match,
+                                                 ocsd_instr_info *instr_info, ocsd_wp_walk_res_t *p_res)
+{
+    uint8_t span[OCSD_DCD_WP_SCAN_BYTES];
+    uint32_t bytesReq, span_offset, num_skipped;
+    ocsd_vaddr_t span_addr;
+    ocsd_err_t err = OCSD_OK;
+    const bool toAddr = (walk_op == OCSD_WP_WALK_TO_ADDR);
+    const uint32_t readSize = toAddr ? 4 : OCSD_DCD_WP_SCAN_BYTES;
+    bool done = false;
+
+    if (!m_pMemAccessor || !m_pIInstrDec)
+        return OCSD_ERR_DCD_INTERFACE_UNUSED;
+
+    p_res->st_addr = p_res->en_addr = instr_info->instr_addr;
+    p_res->num_instr = 0;
+    p_res->wp_found = 0;
+
+    while (!done)
+    {
+        bytesReq = readSize;
+        err = m_pMemAccessor->ReadTargetMemory(instr_info->instr_addr, cs_trace_id, mem_space, &bytesReq, span);
+        if (err != OCSD_OK) break;
+
+        // full span may not be accessible - fall back to a single opcode read.
+        if ((bytesReq < 4) && (readSize > 4))
+        {
+            bytesReq = 4;
+            err = m_pMemAccessor->ReadTargetMemory(instr_info->instr_addr, cs_trace_id, mem_space, &bytesReq, span);
+            if (err != OCSD_OK) break;
+        }
+
+        if (bytesReq < 4)
+            break;  // memory not accessible - wp_found remains 0
+
+        span_offset = 0;
+        if (!toAddr)
+        {
+            span_addr = instr_info->instr_addr;
+            err = m_pIInstrDec->FindNextWaypoint(instr_info, span, bytesReq, &num_skipped);
+            if (err != OCSD_OK) break;
+            p_res->num_instr += num_skipped;
+
+            // next opcode not in the span - read again from the current address
+            span_offset = (uint32_t)(instr_info->instr_addr - span_addr);
+            if (span_offset + 4 > bytesReq)
+                continue;
+        }
+
+        memcpy(&instr_info->opcode, span + span_offset, sizeof(uint32_t));
+        err = m_pIInstrDec->DecodeInstruction(instr_info);
+        if (err != OCSD_OK) break;
+
+        instr_info->instr_addr += instr_info->instr_size;
+        p_res->num_instr++;
+
+        if (toAddr)
+            done = (instr_info->instr_addr == addr_match);
+        else
+            done = (instr_info->type != OCSD_INSTR_OTHER);
+    }
+    p_res->wp_found = done ? 1 : 0;
+    p_res->en_addr = instr_info->instr_addr;
+    return err;
 }
 
 /* End of File ocsd_c_api_custom_obj.cpp */
@@ -121,6 +121,11 @@ public:
 
     static void SetCallbacks(ocsd_extern_dcd_cb_fns &callbacks);
 
+    // walk instructions to a waypoint on behalf of the external decoder.
+    ocsd_err_t traceToWaypoint(const uint8_t cs_trace_id, const ocsd_mem_space_acc_t mem_space,
+                               const ocsd_wp_walk_op_t walk_op, const ocsd_vaddr_t addr_match,
+                               ocsd_instr_info *instr_info, ocsd_wp_walk_res_t *p_res);
+
 private:
     // declare the callback functions as friend functions.
     friend ocsd_datapath_resp_t GenElemOpCB( const void *lib_context,
@@ -160,6 +165,14 @@ private:
         const ocsd_trc_index_t index_sop,
         const void *pkt);
 
+    friend ocsd_err_t TraceToWaypointCB(const void *lib_context,
+        const uint8_t cs_trace_id,
+        const ocsd_mem_space_acc_t mem_space,
+        const ocsd_wp_walk_op_t walk_op,
+        const ocsd_vaddr_t addr_match,
+        ocsd_instr_info *instr_info,
+        ocsd_wp_walk_res_t *p_res);
+
 private:
     ITrcGenElemIn *m_pGenElemIn;        //!< generic element sink interface - output from decoder fed to common sink.
     IInstrDecode *m_pIInstrDec;         //!< arm instruction decode interface - decoder may want to use this.
@@ -144,6 +144,31 @@ private:
     const void *m_p_context;
 };
 
+/* batched packet sink CB object - all protocols, packets passed as C API structures */
+class PktBatchCBObj : public IPktBatchIn
+{
+public:
+    PktBatchCBObj(FnDefPktBatchIn pCBFunc, const void *p_context)
+    {
+        m_c_api_cb_fn = pCBFunc;
+        m_p_context = p_context;
+    };
+
+    virtual ~PktBatchCBObj() {};
+
+    virtual ocsd_datapath_resp_t PacketBatchIn(const ocsd_datapath_op_t op,
+        const uint32_t num_pkts,
+        const ocsd_trc_index_t *p_indexes,
+        const void *p_pkts)
+    {
+        return m_c_api_cb_fn(m_p_context, op, num_pkts, p_indexes, p_pkts);
+    };
+
+private:
+    FnDefPktBatchIn m_c_api_cb_fn;
+    const void *m_p_context;
+};
+
 /* handler for default string print CB object */
 class DefLogStrCBObj : public ocsdMsgLogStrOutI
 {
@@ -177,6 +202,35 @@ private:
     const void *m_p_context;
 };
 
+class TraceDataSrcCBObj : public ITrcDataSrc
+{
+public:
+    TraceDataSrcCBObj()
+    {
+        m_c_api_cb_fn = 0;
+        m_p_context = 0;
+    };
+
+    virtual ~TraceDataSrcCBObj() {};
+
+    void setCBFn(const void *p_context, FnTraceDataSrc pCBFn)
+    {
+        m_c_api_cb_fn = pCBFn;
+        m_p_context = p_context;
+    };
+
+    virtual ocsd_err_t ReadTraceData(const uint8_t **pp_data, uint32_t *p_size)
+    {
+        if(!m_c_api_cb_fn)
+            return OCSD_ERR_NOT_INIT;
+        return m_c_api_cb_fn(m_p_context, pp_data, p_size);
+    };
+
+private:
+    FnTraceDataSrc m_c_api_cb_fn;
+    const void *m_p_context;
+};
+
 #endif // ARM_OCSD_C_API_OBJ_H_INCLUDED
 
 /* End of File ocsd_c_api_obj.h */
@@ -33,9 +33,12 @@
  */ 
 
 #include "opencsd/etmv3/trc_pkt_decode_etmv3.h"
+#include "common/trc_state_blob.h"
 
 #define DCD_NAME "DCD_ETMV3"
 
+static const uint32_t ETMV3_SUPPORTED_DECODE_OP_FLAGS = OCSD_OPFLG_PKTDEC_MERGE_RANGES;
+
 TrcPktDecodeEtmV3::TrcPktDecodeEtmV3() : 
     TrcPktDecodeBase(DCD_NAME)
 {
@@ -172,6 +175,7 @@ ocsd_err_t TrcPktDecodeEtmV3::onProtocolConfig()
     {
         // set some static config elements
         m_CSID = m_config->getTraceID();
+        m_unsync_info = UNSYNC_INIT_DECODER;  // new config - unsynced as on creation.
 
         // check config compatible with current decoder support level.
         // at present no data trace;
@@ -199,11 +203,101 @@ ocsd_err_t TrcPktDecodeEtmV3::onProtocolConfig()
 // initialise on creation
 void TrcPktDecodeEtmV3::initDecoder()
 {
+    // set the operational modes supported.
+    m_supported_op_flags = ETMV3_SUPPORTED_DECODE_OP_FLAGS;
+
     m_CSID = 0;
+    m_filter_active = false;
     resetDecoder();
     m_unsync_info = UNSYNC_INIT_DECODER;
     m_code_follower.initInterfaces(getMemoryAccessAttachPt(),getInstrDecodeAttachPt());
     m_outputElemList.initSendIf(getTraceElemOutAttachPt());
+    m_outputElemList.initStageTime(&stageTime(OCSD_TSTAGE_ELEM_OUT));
+}
+
+ocsd_err_t TrcPktDecodeEtmV3::setPeFilter(const OcsdPeFilter &filter)
+{
+    m_pe_filter = filter;
+    m_filter_active = m_pe_filter.isActive();
+    m_filter_out_sent = false;
+    updateFilterCtxt();
+    return OCSD_OK;
+}
+
+void TrcPktDecodeEtmV3::updateFilterCtxt()
+{
+    // ETMv3 only traces Hyp mode as an exception level - other EL predicates do not match.
+    m_filter_ctxt_out = m_filter_active && 
+        !m_pe_filter.matchContext(m_PeContext.getCtxtID(), m_PeContext.getVMID(), 
+                                  m_PeContext.getEL(), m_PeContext.getSecLevel());
+}
+
+/* state save and restore */
+#define ETMV3_DCD_STATE_TAG OCSD_STATE_TAG('E','3','D','C')
+#define ETMV3_DCD_STATE_VER 3
+
+ocsd_err_t TrcPktDecodeEtmV3::saveState(std::vector<uint8_t> &state)
+{
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    // output list must be empty - sent or pending elements belong to packets already seen.
+    if ((m_curr_state == SEND_PKTS) || (m_outputElemList.getNumElem() > 0))
+        return OCSD_ERR_DCD_STATE_BUSY;
+
+    const ocsd_pe_context &pe_ctxt = m_PeContext;
+
+    TrcStateWriter wr(state, ETMV3_DCD_STATE_TAG, ETMV3_DCD_STATE_VER);
+    wr.put(m_curr_state);
+    wr.put(m_unsync_info);
+    wr.put(m_index_curr_pkt);
+    wr.put(m_IAddr);
+    wr.put(m_bNeedAddr);
+    wr.put(m_bSentUnknown);
+    wr.put(m_bWaitISync);
+    wr.put(pe_ctxt);
+    wr.put(m_filter_ctxt_out);
+    wr.put(m_filter_out_sent);
+    m_code_follower.saveState(wr);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcPktDecodeEtmV3::restoreState(const uint8_t *p_state, const size_t size)
+{
+    ocsd_err_t err;
+    ocsd_pe_context pe_ctxt;
+
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    const unsync_info_t unsync_info = m_unsync_info;   // current reason kept if restore fails.
+    TrcStateReader rd(p_state, size, ETMV3_DCD_STATE_TAG, ETMV3_DCD_STATE_VER);
+    rd.get(m_curr_state);
+    rd.get(m_unsync_info);
+    rd.get(m_index_curr_pkt);
+    rd.get(m_IAddr);
+    rd.get(m_bNeedAddr);
+    rd.get(m_bSentUnknown);
+    rd.get(m_bWaitISync);
+    rd.get(pe_ctxt);
+    rd.get(m_filter_ctxt_out);
+    rd.get(m_filter_out_sent);
+    m_code_follower.restoreState(rd);
+    m_PeContext = &pe_ctxt;
+    m_outputElemList.reset();
+
+    if (m_curr_state == SEND_PKTS)
+        rd.setInvalid();
+
+    err = rd.end();
+    if (err != OCSD_OK)
+    {
+        // bad state data - back to unsynced start state.
+        resetDecoder();
+        m_unsync_info = unsync_info;
+    }
+    return err;
 }
 
 // reset for first use / re-use.
@@ -214,6 +308,8 @@ void TrcPktDecodeEtmV3::resetDecoder()
     m_bSentUnknown = false;
     m_bWaitISync = false;
     m_outputElemList.reset();
+    m_filter_out_sent = false;
+    updateFilterCtxt();
 }
 
 OcsdTraceElement *TrcPktDecodeEtmV3::GetNextOpElem(ocsd_datapath_resp_t &resp)
@@ -301,6 +397,7 @@ ocsd_datapath_resp_t TrcPktDecodeEtmV3::decodePacket(bool &pktDone)
             pElem->setType(OCSD_GEN_TRC_ELEM_PE_CONTEXT);
             m_PeContext.setCtxtID(m_curr_packet_in->getCtxtID());
             pElem->setContext(m_PeContext);
+            updateFilterCtxt();
             break;
 
         case ETM3_PKT_VMID:
@@ -308,6 +405,7 @@ ocsd_datapath_resp_t TrcPktDecodeEtmV3::decodePacket(bool &pktDone)
             pElem->setType(OCSD_GEN_TRC_ELEM_PE_CONTEXT);
             m_PeContext.setVMID(m_curr_packet_in->getVMID());
             pElem->setContext(m_PeContext);
+            updateFilterCtxt();
             break;
 
         case ETM3_PKT_EXCEPTION_ENTRY:
@@ -437,6 +535,8 @@ ocsd_datapath_resp_t TrcPktDecodeEtmV3::processISync(const bool withCC, const bo
                 m_PeContext.setSecLevel(m_curr_packet_in->isNS() ? ocsd_sec_nonsecure : ocsd_sec_secure);
             }
 
+            updateFilterCtxt();
+
             // prepare the context packet
             pElem->setType(OCSD_GEN_TRC_ELEM_PE_CONTEXT);
             pElem->setContext(m_PeContext);
@@ -520,6 +620,7 @@ ocsd_datapath_resp_t TrcPktDecodeEtmV3::processBranchAddr()
 
             if(bUpdatePEContext)
             {
+                updateFilterCtxt();
                 pElem = GetNextOpElem(resp);
                 pElem->setType(OCSD_GEN_TRC_ELEM_PE_CONTEXT);
                 pElem->setContext(m_PeContext);
@@ -551,8 +652,11 @@ ocsd_datapath_resp_t TrcPktDecodeEtmV3::processPHdr()
 {
     ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
     OcsdTraceElement *pElem = 0;
+    OcsdTraceElement *pMergeRange = 0;  // N atom range in this packet that the next range may extend.
     ocsd_isa isa;
     Etmv3Atoms atoms(m_config->isCycleAcc());
+    const bool bMergeRanges = (getComponentOpMode() & OCSD_OPFLG_PKTDEC_MERGE_RANGES) && !m_config->isCycleAcc();
+    bool bMerge;
 
     atoms.initAtomPkt(m_curr_packet_in,m_index_curr_pkt);
     isa = m_curr_packet_in->ISA();
@@ -580,10 +684,40 @@ ocsd_datapath_resp_t TrcPktDecodeEtmV3::processPHdr()
                 }
                 atoms.clearAll();   // skip remaining atoms
             }
+            else if(isFilteredOut())
+            {
+                // outside the PE filter - no instruction walk, one marker until back inside.
+                if(!m_filter_out_sent)
+                {
+                    pElem = GetNextOpElem(resp);
+                    pElem->setType(OCSD_GEN_TRC_ELEM_FILTERED_OUT);
+                    pElem->setAddrStart(m_IAddr);
+                    if(m_config->isCycleAcc())
+                        pElem->setCycleCount(atoms.getRemainCC());
+                    m_filter_out_sent = true;
+                }
+                // resync on the next address packet - no unknown address marker while filtered.
+                m_bNeedAddr = true;
+                m_bSentUnknown = true;
+                pMergeRange = 0;
+                atoms.clearAll();
+            }
             else    // have an address, can process atoms
             {
-                pElem = GetNextOpElem(resp);
-                pElem->setType(OCSD_GEN_TRC_ELEM_INSTR_RANGE);
+                m_filter_out_sent = false;
+
+                // extend the previous range if contiguous. The last atom in the packet
+                // always has its own element as an exception may cancel it.
+                bMerge = pMergeRange && (atoms.numAtoms() > 1) &&
+                         (pMergeRange->en_addr == m_IAddr) && (pMergeRange->isa == isa);
+                if(bMerge)
+                    pElem = pMergeRange;
+                else
+                {
+                    pElem = GetNextOpElem(resp);
+                    pElem->setType(OCSD_GEN_TRC_ELEM_INSTR_RANGE);
+                }
+                pMergeRange = 0;
     
                 // cycle accurate may have a cycle count to use
                 if(m_config->isCycleAcc())
@@ -604,14 +738,22 @@ ocsd_datapath_resp_t TrcPktDecodeEtmV3::processPHdr()
                     // valid code range
                     if(m_code_follower.hasRange())
                     {
-                        pElem->setAddrRange(m_IAddr,m_code_follower.getRangeEn());
+                        if(bMerge)
+                            pElem->setAddrRange(pElem->st_addr,m_code_follower.getRangeEn(),
+                                                pElem->num_instr_range + m_code_follower.getNumInstr());
+                        else
+                            pElem->setAddrRange(m_IAddr,m_code_follower.getRangeEn(),m_code_follower.getNumInstr());
                         pElem->setLastInstrInfo(atoms.getCurrAtomVal() == ATOM_E, 
                                     m_code_follower.getInstrType(),
                                     m_code_follower.getInstrSubType(),m_code_follower.getInstrSize());
                         pElem->setLastInstrCond(m_code_follower.isCondInstr());
                         pElem->setISA(isa);
                         if(m_code_follower.hasNextAddr())
+                        {
                             m_IAddr = m_code_follower.getNextAddr();
+                            if(bMergeRanges && (atoms.getCurrAtomVal() == ATOM_N) && !m_code_follower.isNacc())
+                                pMergeRange = pElem;
+                        }
                         else
                             setNeedAddr(true);
                     }
@@ -623,7 +765,7 @@ ocsd_datapath_resp_t TrcPktDecodeEtmV3::processPHdr()
                     // there is a nacc
                     if(m_code_follower.isNacc())
                     {
-                        if(m_code_follower.hasRange())
+                        if(m_code_follower.hasRange() || bMerge)
                         {
                             pElem = GetNextOpElem(resp);
                             pElem->setType(OCSD_GEN_TRC_ELEM_ADDR_NACC);
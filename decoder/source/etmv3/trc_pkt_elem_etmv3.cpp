@@ -33,8 +33,6 @@
  */ 
 
 #include <cstring>
-#include <sstream>
-#include <iomanip>
 
 #include "opencsd/etmv3/trc_pkt_elem_etmv3.h"
 
@@ -220,12 +218,21 @@ EtmV3TrcPacket &EtmV3TrcPacket::operator =(const ocsd_etmv3_pkt* p_pkt)
     // printing
 void EtmV3TrcPacket::toString(std::string &str) const
 {
+    char szBuffer[512];
+    toStringBuf(szBuffer, sizeof(szBuffer));
+    str = szBuffer;
+}
+
+int EtmV3TrcPacket::toStringBuf(char *buffer, const int buf_size) const
+{
+    trcPrintBuffer buf(buffer, buf_size);
     const char *name;
     const char *desc;
-    std::string valStr, ctxtStr = "";
 
     name = packetTypeName(m_pkt_data.type, &desc);
-    str = name + (std::string)" : " + desc;
+    buf.addStr(name);
+    buf.addStr(" : ");
+    buf.addStr(desc);
     
     switch(m_pkt_data.type)
     {
@@ -233,104 +240,92 @@ void EtmV3TrcPacket::toString(std::string &str) const
     case ETM3_PKT_BAD_SEQUENCE: 
     case ETM3_PKT_BAD_TRACEMODE:
         name = packetTypeName(m_pkt_data.err_type,0);
-        str += "[" + (std::string)name + "]";
+        buf.addChar('[');
+        buf.addStr(name);
+        buf.addChar(']');
         break;
 
     case ETM3_PKT_BRANCH_ADDRESS:
-        getBranchAddressStr(valStr);
-        str += "; " + valStr;
+        buf.addStr("; ");
+        getBranchAddressStr(buf);
         break;
 
     case ETM3_PKT_I_SYNC_CYCLE:
     case ETM3_PKT_I_SYNC:
-        getISyncStr(valStr);
-        str += "; " + valStr;
+        buf.addStr("; ");
+        getISyncStr(buf);
         break;
 
     case ETM3_PKT_P_HDR:
-        getAtomStr(valStr);
-        str += "; " + valStr;
+        buf.addStr("; ");
+        getAtomStr(buf);
         break;
 
     case ETM3_PKT_CYCLE_COUNT:
-        {
-            std::ostringstream oss;
-            oss << "; Cycles=" << m_pkt_data.cycle_count;
-            str += oss.str();
-        }
+        buf.addStr("; Cycles=");
+        buf.addDec(m_pkt_data.cycle_count);
         break;
 
     case ETM3_PKT_CONTEXT_ID:
-        {
-            std::ostringstream oss;
-            oss << "; CtxtID=" << std::hex << "0x" << m_pkt_data.context.ctxtID;
-            str += oss.str();
-        }
+        buf.addStr("; CtxtID=0x");
+        buf.addHex(m_pkt_data.context.ctxtID);
         break;
 
     case ETM3_PKT_VMID:
-        {
-            std::ostringstream oss;
-            oss << "; VMID=" << std::hex << "0x" << m_pkt_data.context.VMID;
-            str += oss.str();
-        }
+        buf.addStr("; VMID=0x");
+        buf.addHex(m_pkt_data.context.VMID);
         break;
 
     case ETM3_PKT_TIMESTAMP:
-        {
-            std::ostringstream oss;
-            oss << "; TS=" << std::hex << "0x" << m_pkt_data.timestamp << " (" << std::dec << m_pkt_data.timestamp << ") ";
-            str += oss.str();
-        }
+        buf.addStr("; TS=0x");
+        buf.addHex(m_pkt_data.timestamp);
+        buf.addStr(" (");
+        buf.addDec(m_pkt_data.timestamp);
+        buf.addStr(") ");
         break;
 
     case ETM3_PKT_OOO_DATA:
-        {
-            std::ostringstream oss;
-            oss << "; Val=" << std::hex << "0x" << m_pkt_data.data.value;
-            oss << "; OO_Tag=" << std::hex << "0x" << m_pkt_data.data.ooo_tag;
-            str += oss.str();
-        }
+        buf.addStr("; Val=0x");
+        buf.addHex(m_pkt_data.data.value);
+        buf.addStr("; OO_Tag=0x");
+        buf.addHex(m_pkt_data.data.ooo_tag);
         break;
 
     case ETM3_PKT_VAL_NOT_TRACED:
         if(m_pkt_data.data.update_addr)
         {
-            trcPrintableElem::getValStr(valStr,32, m_pkt_data.data.addr.valid_bits, 
+            buf.addStr("; Addr=");
+            trcPrintableElem::getValStr(buf,32, m_pkt_data.data.addr.valid_bits, 
                 m_pkt_data.data.addr.val,true,m_pkt_data.data.addr.pkt_bits);
-            str += "; Addr=" + valStr;
         }
         break;
 
     case ETM3_PKT_OOO_ADDR_PLC:
         if(m_pkt_data.data.update_addr)
         {
-            trcPrintableElem::getValStr(valStr,32, m_pkt_data.data.addr.valid_bits, 
+            buf.addStr("; Addr=");
+            trcPrintableElem::getValStr(buf,32, m_pkt_data.data.addr.valid_bits, 
                 m_pkt_data.data.addr.val,true,m_pkt_data.data.addr.pkt_bits);
-            str += "; Addr=" + valStr;
-        }
-        {
-            std::ostringstream oss;
-            oss << "; OO_Tag=" << std::hex << "0x" << m_pkt_data.data.ooo_tag;
-            str += oss.str();
         }
+        buf.addStr("; OO_Tag=0x");
+        buf.addHex(m_pkt_data.data.ooo_tag);
         break;
 
     case ETM3_PKT_NORM_DATA:
         if(m_pkt_data.data.update_addr)
         {
-            trcPrintableElem::getValStr(valStr,32, m_pkt_data.data.addr.valid_bits, 
+            buf.addStr("; Addr=");
+            trcPrintableElem::getValStr(buf,32, m_pkt_data.data.addr.valid_bits, 
                 m_pkt_data.data.addr.val,true,m_pkt_data.data.addr.pkt_bits);
-            str += "; Addr=" + valStr;
         }
         if(m_pkt_data.data.update_dval)
         {
-            std::ostringstream oss;
-            oss << "; Val=" << std::hex << "0x" << m_pkt_data.data.value;
-            str += oss.str();
+            buf.addStr("; Val=0x");
+            buf.addHex(m_pkt_data.data.value);
         }
         break;
     }
+    return buf.length();
 }
 
 void EtmV3TrcPacket::toStringFmt(const uint32_t fmtFlags, std::string &str) const
@@ -479,49 +474,39 @@ const char *EtmV3TrcPacket::packetTypeName(const ocsd_etmv3_pkt_type type, const
     return pName;
 }
 
-void EtmV3TrcPacket::getBranchAddressStr(std::string &valStr) const
+void EtmV3TrcPacket::getBranchAddressStr(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
-    std::string subStr;
-
     // print address.
-    trcPrintableElem::getValStr(subStr,32,m_pkt_data.addr.valid_bits,
+    buf.addStr("Addr=");
+    trcPrintableElem::getValStr(buf,32,m_pkt_data.addr.valid_bits,
         m_pkt_data.addr.val,true,m_pkt_data.addr.pkt_bits);
-    oss << "Addr=" << subStr << "; ";
+    buf.addStr("; ");
 
     // current ISA if changed.
     if(m_pkt_data.curr_isa != m_pkt_data.prev_isa)
-    {
-        getISAStr(subStr);
-        oss << subStr;
-    }
+        getISAStr(buf);
 
     // S / NS etc if changed.
     if(m_pkt_data.context.updated)
     {
-        oss << (m_pkt_data.context.curr_NS ? "NS; " : "S; ");
-        oss << (m_pkt_data.context.curr_Hyp ? "Hyp; " : "");
+        buf.addStr(m_pkt_data.context.curr_NS ? "NS; " : "S; ");
+        buf.addStr(m_pkt_data.context.curr_Hyp ? "Hyp; " : "");
     }
     
     // exception? 
     if(m_pkt_data.exception.bits.present)
-    {
-        getExcepStr(subStr);
-        oss << subStr;
-    }
-    valStr = oss.str();
+        getExcepStr(buf);
 }
 
-void EtmV3TrcPacket::getAtomStr(std::string &valStr) const
+void EtmV3TrcPacket::getAtomStr(trcPrintBuffer &buf) const
 {   
-    std::ostringstream oss;
     uint32_t bitpattern = m_pkt_data.atom.En_bits; // arranged LSBit oldest, MSbit newest
 
     if(!m_pkt_data.cycle_count)
     {
         for(int i = 0; i < m_pkt_data.atom.num; i++)
         {
-            oss << ((bitpattern & 0x1) ? "E" : "N"); // in spec read L->R, oldest->newest
+            buf.addChar((bitpattern & 0x1) ? 'E' : 'N'); // in spec read L->R, oldest->newest
             bitpattern >>= 1;
         }        
     }
@@ -532,120 +517,116 @@ void EtmV3TrcPacket::getAtomStr(std::string &valStr) const
         case 1:
             for(int i = 0; i < m_pkt_data.atom.num; i++)
             {
-                oss << ((bitpattern & 0x1) ? "WE" : "WN"); // in spec read L->R, oldest->newest
+                buf.addStr((bitpattern & 0x1) ? "WE" : "WN"); // in spec read L->R, oldest->newest
                 bitpattern >>= 1;
             }        
             break;
 
         case 2:
-            oss << "W";
+            buf.addChar('W');
             for(int i = 0; i < m_pkt_data.atom.num; i++)
             {
-                oss << ((bitpattern & 0x1) ? "E" : "N"); // in spec read L->R, oldest->newest
+                buf.addChar((bitpattern & 0x1) ? 'E' : 'N'); // in spec read L->R, oldest->newest
                 bitpattern >>= 1;
             }        
             break;
 
         case 3:
-            for(uint32_t i = 0; i < m_pkt_data.cycle_count; i++)
-                oss << "W";
+            buf.addFill('W', (int)m_pkt_data.cycle_count);
             if(m_pkt_data.atom.num)
-                oss << ((bitpattern & 0x1) ? "E" : "N"); // in spec read L->R, oldest->newest
+                buf.addChar((bitpattern & 0x1) ? 'E' : 'N'); // in spec read L->R, oldest->newest
             break;
         }
-        oss << "; Cycles=" << m_pkt_data.cycle_count;
+        buf.addStr("; Cycles=");
+        buf.addDec(m_pkt_data.cycle_count);
     }
-    valStr = oss.str();
 }
 
-void EtmV3TrcPacket::getISyncStr(std::string &valStr) const
+void EtmV3TrcPacket::getISyncStr(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
     static const char *reason[] = { "Periodic", "Trace Enable", "Restart Overflow", "Debug Exit" };
 
     // reason.
-    oss << "(" << reason[(int)m_pkt_data.isync_info.reason] << "); ";
+    buf.addChar('(');
+    buf.addStr(reason[(int)m_pkt_data.isync_info.reason]);
+    buf.addStr("); ");
 
     // full address.
     if(!m_pkt_data.isync_info.no_address)
     {
         if(m_pkt_data.isync_info.has_LSipAddress)
-            oss << "Data Instr Addr=0x";
+            buf.addStr("Data Instr Addr=0x");
         else
-            oss << "Addr=0x";
-        oss << std::hex << std::setfill('0') << std::setw(8) << m_pkt_data.addr.val << "; ";
+            buf.addStr("Addr=0x");
+        buf.addHex(m_pkt_data.addr.val, 8);
+        buf.addStr("; ");
     }
     
-    oss << (m_pkt_data.context.curr_NS ? "NS; " : "S; ");
-    oss << (m_pkt_data.context.curr_Hyp ? "Hyp; " : " ");
+    buf.addStr(m_pkt_data.context.curr_NS ? "NS; " : "S; ");
+    buf.addStr(m_pkt_data.context.curr_Hyp ? "Hyp; " : " ");
     
     if(m_pkt_data.context.updated_c)
     {
-        oss << "CtxtID=" << std::hex << m_pkt_data.context.ctxtID << "; ";
+        buf.addStr("CtxtID=");
+        buf.addHex(m_pkt_data.context.ctxtID);
+        buf.addStr("; ");
     }
 
     if(m_pkt_data.isync_info.no_address)
-    {
-        valStr = oss.str();
         return;     // bail out at this point if a data only ISYNC
-    }
 
-    std::string isaStr;
-    getISAStr(isaStr);
-    oss << isaStr;
+    getISAStr(buf);
 
     if(m_pkt_data.isync_info.has_cycle_count)
     {
-        oss << "Cycles=" << std::dec << m_pkt_data.cycle_count << "; ";
+        buf.addStr("Cycles=");
+        buf.addDec(m_pkt_data.cycle_count);
+        buf.addStr("; ");
     }
 
     if(m_pkt_data.isync_info.has_LSipAddress)
     {
-        std::string addrStr;
-
         // extract address updata.
-        trcPrintableElem::getValStr(addrStr,32,m_pkt_data.data.addr.valid_bits,
+        buf.addStr("Curr Instr Addr=");
+        trcPrintableElem::getValStr(buf,32,m_pkt_data.data.addr.valid_bits,
             m_pkt_data.data.addr.val,true,m_pkt_data.data.addr.pkt_bits);
-        oss << "Curr Instr Addr=" << addrStr << ";";        
+        buf.addChar(';');
     }    
-    valStr = oss.str();
 }
 
-void EtmV3TrcPacket::getISAStr(std::string &isaStr) const
+void EtmV3TrcPacket::getISAStr(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
-    oss << "ISA=";
+    buf.addStr("ISA=");
     switch(m_pkt_data.curr_isa)
     {
     case ocsd_isa_arm: 
-        oss << "ARM(32); ";
+        buf.addStr("ARM(32); ");
         break;
 
     case ocsd_isa_thumb2:
-        oss << "Thumb2; ";
+        buf.addStr("Thumb2; ");
         break;
 
     case ocsd_isa_aarch64:
-        oss << "AArch64; ";
+        buf.addStr("AArch64; ");
         break;
 
     case ocsd_isa_tee:
-        oss << "ThumbEE; ";
+        buf.addStr("ThumbEE; ");
         break;
 
     case ocsd_isa_jazelle:
-        oss << "Jazelle; ";
+        buf.addStr("Jazelle; ");
         break;
 
     default:
     case ocsd_isa_unknown:
-        oss << "Unknown; ";
+        buf.addStr("Unknown; ");
         break;
     }
-    isaStr = oss.str();
 }
 
-void EtmV3TrcPacket::getExcepStr(std::string &excepStr) const
+void EtmV3TrcPacket::getExcepStr(trcPrintBuffer &buf) const
 {
     static const char *ARv7Excep[] = {
         "No Exception", "Debug Halt", "SMC", "Hyp", 
@@ -663,26 +644,31 @@ void EtmV3TrcPacket::getExcepStr(std::string &excepStr) const
         "Reserved","BusFault","Reserved","Reserved"
     };
 
-    std::ostringstream oss;
-    oss << "Exception=";
+    buf.addStr("Exception=");
 
     if(m_pkt_data.exception.bits.cm_type)
     {
         if(m_pkt_data.exception.number < 0x18)
-            oss << MExcep[m_pkt_data.exception.number];
+            buf.addStr(MExcep[m_pkt_data.exception.number]);
         else
-            oss << "IRQ" << std::dec << (m_pkt_data.exception.number - 0x10);
+        {
+            buf.addStr("IRQ");
+            buf.addDec(m_pkt_data.exception.number - 0x10);
+        }
         if(m_pkt_data.exception.bits.cm_resume)
-            oss << "; Resume=" << m_pkt_data.exception.bits.cm_resume;
+        {
+            buf.addStr("; Resume=");
+            buf.addDec(m_pkt_data.exception.bits.cm_resume);
+        }
         if(m_pkt_data.exception.bits.cancel)
-            oss << "; Cancel prev instr";
+            buf.addStr("; Cancel prev instr");
     }
     else
     {
-        oss << ARv7Excep[m_pkt_data.exception.number] << "; ";
+        buf.addStr(ARv7Excep[m_pkt_data.exception.number]);
+        buf.addStr("; ");
         if(m_pkt_data.exception.bits.cancel)
-            oss << "; Cancel prev instr";
+            buf.addStr("; Cancel prev instr");
     }
-    excepStr = oss.str();
 }
 /* End of File trc_pkt_elem_etmv3.cpp */
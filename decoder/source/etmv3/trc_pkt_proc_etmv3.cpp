@@ -81,6 +81,20 @@ ocsd_err_t TrcPktProcEtmV3::onProtocolConfig()
     return m_pProcessor->Configure(m_config);
 }
 
+ocsd_err_t TrcPktProcEtmV3::saveState(std::vector<uint8_t> &state)
+{
+    if(m_pProcessor)
+        return m_pProcessor->saveState(state);
+    return OCSD_ERR_NOT_INIT;
+}
+
+ocsd_err_t TrcPktProcEtmV3::restoreState(const uint8_t *p_state, const size_t size)
+{
+    if(m_pProcessor)
+        return m_pProcessor->restoreState(p_state, size);
+    return OCSD_ERR_NOT_INIT;
+}
+
 ocsd_datapath_resp_t TrcPktProcEtmV3::processData(  const ocsd_trc_index_t index,
                                                 const uint32_t dataBlockSize,
                                                 const uint8_t *pDataBlock,
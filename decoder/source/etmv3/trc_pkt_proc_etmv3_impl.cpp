@@ -33,6 +33,7 @@
  */ 
 
 #include "trc_pkt_proc_etmv3_impl.h"
+#include "common/trc_state_blob.h"
 
 EtmV3PktProcImpl::EtmV3PktProcImpl() :
     m_isInit(false),
@@ -152,6 +153,81 @@ ocsd_datapath_resp_t EtmV3PktProcImpl::onFlush()
     return OCSD_RESP_CONT;
 }
 
+#define ETMV3_PROC_STATE_TAG OCSD_STATE_TAG('E','3','P','P')
+#define ETMV3_PROC_STATE_VER 1
+
+ocsd_err_t EtmV3PktProcImpl::saveState(std::vector<uint8_t> &state)
+{
+    if(!m_isInit)
+        return OCSD_ERR_NOT_INIT;
+
+    TrcStateWriter wr(state, ETMV3_PROC_STATE_TAG, ETMV3_PROC_STATE_VER);
+
+    // processor state
+    wr.put(m_process_state);
+    wr.putVec(m_currPacketData);
+    wr.put(m_currPktIdx);
+    wr.put(*(const ocsd_etmv3_pkt *)m_curr_packet.c_pkt());
+    wr.putVec(m_partPktData);
+    wr.put(m_bSendPartPkt);
+    wr.put(m_post_part_pkt_state);
+    wr.put(m_post_part_pkt_type);
+    wr.put(m_bStreamSync);
+    wr.put(m_bStartOfSync);
+
+    // current packet progress
+    wr.put(m_bytesExpectedThisPkt);
+    wr.put(m_BranchPktNeedsException);
+    wr.put(m_bIsync_got_cycle_cnt);
+    wr.put(m_bIsync_get_LSiP_addr);
+    wr.put(m_IsyncInfoIdx);
+    wr.put(m_bExpectingDataAddress);
+    wr.put(m_bFoundDataAddress);
+    wr.put(m_packet_index);
+    wr.put(m_packet_curr_byte_index);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t EtmV3PktProcImpl::restoreState(const uint8_t *p_state, const size_t size)
+{
+    ocsd_etmv3_pkt pkt;
+    ocsd_err_t err;
+
+    if(!m_isInit)
+        return OCSD_ERR_NOT_INIT;
+
+    TrcStateReader rd(p_state, size, ETMV3_PROC_STATE_TAG, ETMV3_PROC_STATE_VER);
+
+    rd.get(m_process_state);
+    rd.getVec(m_currPacketData);
+    rd.get(m_currPktIdx);
+    rd.get(pkt);
+    rd.getVec(m_partPktData);
+    rd.get(m_bSendPartPkt);
+    rd.get(m_post_part_pkt_state);
+    rd.get(m_post_part_pkt_type);
+    rd.get(m_bStreamSync);
+    rd.get(m_bStartOfSync);
+
+    rd.get(m_bytesExpectedThisPkt);
+    rd.get(m_BranchPktNeedsException);
+    rd.get(m_bIsync_got_cycle_cnt);
+    rd.get(m_bIsync_get_LSiP_addr);
+    rd.get(m_IsyncInfoIdx);
+    rd.get(m_bExpectingDataAddress);
+    rd.get(m_bFoundDataAddress);
+    rd.get(m_packet_index);
+    rd.get(m_packet_curr_byte_index);
+
+    err = rd.end();
+    if(err == OCSD_OK)
+        m_curr_packet = &pkt;
+    else
+        InitProcessorState();   // bad state data - back to unsynced start state.
+    return err;
+}
+
 void EtmV3PktProcImpl::Initialise(TrcPktProcEtmV3 *p_interface)
 {
     if(p_interface)
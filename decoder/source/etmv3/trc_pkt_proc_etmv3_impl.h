@@ -63,6 +63,9 @@ public:
     ocsd_datapath_resp_t onFlush();
     const bool isBadPacket() const;
 
+    ocsd_err_t saveState(std::vector<uint8_t> &state);
+    ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
 protected:
     typedef enum _process_state {
         WAIT_SYNC,
@@ -67,12 +67,13 @@ TrcStackElemParam *EtmV4P0Stack::createParamElem(const p0_elem_t p0_type, const
     return pElem;
 }
 
-TrcStackElemAtom *EtmV4P0Stack::createAtomElem(const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const ocsd_pkt_atom &atom)
+TrcStackElemAtom *EtmV4P0Stack::createAtomElem(const ocsd_etmv4_i_pkt_type root_pkt, const ocsd_trc_index_t root_index, const ocsd_pkt_atom &atom, const uint32_t hdr_starts /*= 0*/)
 {
     TrcStackElemAtom *pElem = new (std::nothrow) TrcStackElemAtom(root_pkt, root_index);
     if (pElem)
     {
         pElem->setAtom(atom);
+        pElem->setHdrStarts(hdr_starts);
         push_front(pElem);
     }
     return pElem;
@@ -152,5 +153,174 @@ void EtmV4P0Stack::erase_curr_from_front()
     m_P0_stack.erase(erase_iter);
 }
 
+// state save and restore
+void EtmV4P0Stack::saveState(TrcStateWriter &wr)
+{
+    std::deque<TrcStackElem *>::iterator iter;
+
+    wr.put((uint32_t)m_P0_stack.size());
+    for (iter = m_P0_stack.begin(); iter != m_P0_stack.end(); iter++)
+    {
+        TrcStackElem *pElem = *iter;
+        wr.put(pElem->getP0Type());
+        wr.put(pElem->isP0());
+        wr.put(pElem->getRootPkt());
+        wr.put(pElem->getRootIndex());
+
+        switch (pElem->getP0Type())
+        {
+        case P0_ATOM:
+            wr.put(((TrcStackElemAtom *)pElem)->m_atom);
+            wr.put(((TrcStackElemAtom *)pElem)->m_hdr_starts);
+            break;
+
+        case P0_ADDR:
+            wr.put(((TrcStackElemAddr *)pElem)->m_addr_val);
+            break;
+
+        case P0_CTXT:
+            wr.put(((TrcStackElemCtxt *)pElem)->m_context);
+            wr.put(((TrcStackElemCtxt *)pElem)->m_IS);
+            break;
+
+        case P0_EXCEP:
+            wr.put(((TrcStackElemExcept *)pElem)->m_prev_addr_same);
+            wr.put(((TrcStackElemExcept *)pElem)->m_excep_num);
+            break;
+
+        case P0_Q:
+            wr.put(((TrcStackQElem *)pElem)->m_has_addr);
+            wr.put(((TrcStackQElem *)pElem)->m_addr_val);
+            wr.put(((TrcStackQElem *)pElem)->m_instr_count);
+            break;
+
+        case P0_EVENT:
+        case P0_CC:
+        case P0_TS:
+        case P0_TS_CC:
+            wr.put(((TrcStackElemParam *)pElem)->m_param);
+            break;
+
+        default:
+            // no parameter elements
+            break;
+        }
+    }
+}
+
+TrcStackElem *EtmV4P0Stack::restoreElem(TrcStateReader &rd)
+{
+    p0_elem_t p0_type = P0_UNKNOWN;
+    bool isP0 = false;
+    ocsd_etmv4_i_pkt_type root_pkt = ETM4_PKT_I_NOTSYNC;
+    ocsd_trc_index_t root_index = 0;
+    TrcStackElem *pElem = 0;
+
+    rd.get(p0_type);
+    rd.get(isP0);
+    rd.get(root_pkt);
+    if (!rd.get(root_index))
+        return 0;
+
+    switch (p0_type)
+    {
+    case P0_ATOM:
+        {
+            TrcStackElemAtom *pAtom = new (std::nothrow) TrcStackElemAtom(root_pkt, root_index);
+            if (pAtom)
+            {
+                rd.get(pAtom->m_atom);
+                rd.get(pAtom->m_hdr_starts);
+            }
+            pElem = pAtom;
+        }
+        break;
+
+    case P0_ADDR:
+        {
+            TrcStackElemAddr *pAddr = new (std::nothrow) TrcStackElemAddr(root_pkt, root_index);
+            if (pAddr)
+                rd.get(pAddr->m_addr_val);
+            pElem = pAddr;
+        }
+        break;
+
+    case P0_CTXT:
+        {
+            TrcStackElemCtxt *pCtxt = new (std::nothrow) TrcStackElemCtxt(root_pkt, root_index);
+            if (pCtxt)
+            {
+                rd.get(pCtxt->m_context);
+                rd.get(pCtxt->m_IS);
+            }
+            pElem = pCtxt;
+        }
+        break;
+
+    case P0_EXCEP:
+        {
+            TrcStackElemExcept *pExcep = new (std::nothrow) TrcStackElemExcept(root_pkt, root_index);
+            if (pExcep)
+            {
+                rd.get(pExcep->m_prev_addr_same);
+                rd.get(pExcep->m_excep_num);
+            }
+            pElem = pExcep;
+        }
+        break;
+
+    case P0_Q:
+        {
+            TrcStackQElem *pQ = new (std::nothrow) TrcStackQElem(root_pkt, root_index);
+            if (pQ)
+            {
+                rd.get(pQ->m_has_addr);
+                rd.get(pQ->m_addr_val);
+                rd.get(pQ->m_instr_count);
+            }
+            pElem = pQ;
+        }
+        break;
+
+    case P0_EVENT:
+    case P0_CC:
+    case P0_TS:
+    case P0_TS_CC:
+        {
+            TrcStackElemParam *pParam = new (std::nothrow) TrcStackElemParam(p0_type, isP0, root_pkt, root_index);
+            if (pParam)
+                rd.get(pParam->m_param);
+            pElem = pParam;
+        }
+        break;
+
+    default:
+        pElem = new (std::nothrow) TrcStackElem(p0_type, isP0, root_pkt, root_index);
+        break;
+    }
+    return pElem;
+}
+
+bool EtmV4P0Stack::restoreState(TrcStateReader &rd)
+{
+    uint32_t num_elem = 0;
+    TrcStackElem *pElem;
+
+    delete_all();
+    if (!rd.get(num_elem))
+        return false;
+
+    for (uint32_t i = 0; i < num_elem; i++)
+    {
+        pElem = restoreElem(rd);
+        if (!pElem)
+        {
+            rd.setInvalid();
+            return false;
+        }
+        push_back(pElem);
+    }
+    return true;
+}
 
 /* End of file trc_etmv4_stack_elem.cpp */
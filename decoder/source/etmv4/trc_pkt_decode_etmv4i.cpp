@@ -35,6 +35,9 @@
 #include "opencsd/etmv4/trc_pkt_decode_etmv4i.h"
 
 #include "common/trc_gen_elem.h"
+#include "common/trc_state_blob.h"
+
+#include <cstring>
 
 
 #define DCD_NAME "DCD_ETMV4"
@@ -174,6 +177,7 @@ ocsd_err_t TrcPktDecodeEtmV4I::onProtocolConfig()
 
     // set some static config elements
     m_CSID = m_config->getTraceID();
+    m_unsync_eot_info = UNSYNC_INIT_DECODER;  // new config - unsynced as on creation.
     m_max_spec_depth = m_config->MaxSpecDepth();
 
     // elements associated with data trace
@@ -191,14 +195,15 @@ ocsd_err_t TrcPktDecodeEtmV4I::onProtocolConfig()
     m_instr_info.pe_type.profile = m_config->coreProfile();
 
     m_IASize64 = (m_config->iaSizeMax() == 64);
+    m_v7M_profile = (m_config->archVersion() == ARCH_V7) && (m_config->coreProfile() == profile_CortexM);
+    m_v8M_profile = OCSD_IS_V8_ARCH(m_config->archVersion()) && (m_config->coreProfile() == profile_CortexM);
+    m_ts_with_cc = m_config->enabledCCI();
 
-    if (m_config->enabledRetStack())
-    {
-        m_return_stack.set_active(true);
+    // set both ways - a reconfigured decoder may have had the return stack enabled.
+    m_return_stack.set_active(m_config->enabledRetStack());
 #ifdef TRC_RET_STACK_DEBUG
-        m_return_stack.set_dbg_logger(this);
+    m_return_stack.set_dbg_logger(this);
 #endif
-    }
 
     // check config compatible with current decoder support level.
     // at present no data trace, no spec depth, no return stack, no QE
@@ -231,6 +236,10 @@ void TrcPktDecodeEtmV4I::initDecoder()
     m_max_spec_depth = 0;
     m_CSID = 0;
     m_IASize64 = false;
+    m_v7M_profile = false;
+    m_v8M_profile = false;
+    m_ts_with_cc = false;
+    m_filter_active = false;
 
     // elements associated with data trace
 #ifdef DATA_TRACE_SUPPORTED
@@ -260,6 +269,9 @@ void TrcPktDecodeEtmV4I::resetDecoder()
     m_P0_stack.delete_all();
     m_out_elem.resetElemStack();
     m_last_IS = 0;
+    m_filter_ctxt_out = false;
+    m_filter_out_sent = false;
+    m_curr_el = ocsd_EL_unknown;
     clearElemRes();
 
     // elements associated with data trace
@@ -270,10 +282,117 @@ void TrcPktDecodeEtmV4I::resetDecoder()
 #endif
 }
 
+/* state save and restore */
+#define ETMV4_DCD_STATE_TAG OCSD_STATE_TAG('E','4','D','C')
+#define ETMV4_DCD_STATE_VER 4
+
+ocsd_err_t TrcPktDecodeEtmV4I::saveState(std::vector<uint8_t> &state)
+{
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    // cannot save part way through output of resolved elements.
+    if ((m_curr_state == RESOLVE_ELEM) || m_out_elem.numElemToSend())
+        return OCSD_ERR_DCD_STATE_BUSY;
+    m_out_elem.resetElemStack();    // ensure the persistent output element exists.
+
+    TrcStateWriter wr(state, ETMV4_DCD_STATE_TAG, ETMV4_DCD_STATE_VER);
+    wr.put(m_timestamp);
+    wr.put(m_context_id);
+    wr.put(m_vmid_id);
+    wr.put(m_is_secure);
+    wr.put(m_is_64bit);
+    wr.put(m_last_IS);
+    wr.put(m_cc_threshold);
+    wr.put(m_curr_spec_depth);
+    wr.put(m_unseen_spec_elem);
+    wr.put(m_curr_state);
+    wr.put(m_unsync_eot_info);
+    wr.put(m_index_curr_pkt);
+    wr.put(m_elem_res);
+    wr.put(m_need_ctxt);
+    wr.put(m_need_addr);
+    wr.put(m_elem_pending_addr);
+    wr.put(m_instr_info);
+    wr.put(m_pe_context);
+    wr.put(m_trace_info);
+    wr.put(m_prev_overflow);
+    wr.put(m_filter_ctxt_out);
+    wr.put(m_filter_out_sent);
+    wr.put(m_curr_el);
+    m_return_stack.saveState(wr);
+    m_P0_stack.saveState(wr);
+
+    // data persistent between output elements
+    wr.put(outElem().isa);
+    wr.put(outElem().context);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcPktDecodeEtmV4I::restoreState(const uint8_t *p_state, const size_t size)
+{
+    ocsd_err_t err;
+
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    m_out_elem.resetElemStack();
+    const unsync_info_t unsync_info = m_unsync_eot_info;   // current reason kept if restore fails.
+    TrcStateReader rd(p_state, size, ETMV4_DCD_STATE_TAG, ETMV4_DCD_STATE_VER);
+    rd.get(m_timestamp);
+    rd.get(m_context_id);
+    rd.get(m_vmid_id);
+    rd.get(m_is_secure);
+    rd.get(m_is_64bit);
+    rd.get(m_last_IS);
+    rd.get(m_cc_threshold);
+    rd.get(m_curr_spec_depth);
+    rd.get(m_unseen_spec_elem);
+    rd.get(m_curr_state);
+    rd.get(m_unsync_eot_info);
+    rd.get(m_index_curr_pkt);
+    rd.get(m_elem_res);
+    rd.get(m_need_ctxt);
+    rd.get(m_need_addr);
+    rd.get(m_elem_pending_addr);
+    rd.get(m_instr_info);
+    rd.get(m_pe_context);
+    rd.get(m_trace_info);
+    rd.get(m_prev_overflow);
+    rd.get(m_filter_ctxt_out);
+    rd.get(m_filter_out_sent);
+    rd.get(m_curr_el);
+    m_return_stack.restoreState(rd);
+    m_P0_stack.restoreState(rd);
+    rd.get(outElem().isa);
+    rd.get(outElem().context);
+
+    err = rd.end();
+    if (err != OCSD_OK)
+    {
+        // bad state data - back to unsynced start state.
+        m_unsync_eot_info = unsync_info;
+        resetDecoder();
+        m_return_stack.flush();
+    }
+    return err;
+}
+
+ocsd_err_t TrcPktDecodeEtmV4I::setPeFilter(const OcsdPeFilter &filter)
+{
+    m_pe_filter = filter;
+    m_filter_active = m_pe_filter.isActive();
+    m_filter_out_sent = false;
+    updateFilterCtxt();
+    return OCSD_OK;
+}
+
 void TrcPktDecodeEtmV4I::onFirstInitOK()
 {
     // once init, set the output element interface to the out elem list.
     m_out_elem.initSendIf(this->getTraceElemOutAttachPt());
+    m_out_elem.initStageTime(&stageTime(OCSD_TSTAGE_ELEM_OUT));
 }
 
 // Changes a packet into stack of trace elements - these will be resolved and output later
@@ -315,6 +434,25 @@ ocsd_err_t TrcPktDecodeEtmV4I::decodePacket()
         }
         break;
 
+    case ETM4_PKT_I_ATOM_BULK:
+        {
+            // run of single byte atom headers - element indices follow the header of each atom, 
+            // and the current packet index becomes that of the last header, as if the run had been decoded singly.
+            uint32_t hdr_starts = m_curr_packet_in->getAtomHdrStarts();
+            if (m_P0_stack.createAtomElem(m_curr_packet_in->getType(), m_index_curr_pkt, m_curr_packet_in->getAtom(), hdr_starts) == 0)
+                bAllocErr = true;
+            else
+            {
+                m_curr_spec_depth += m_curr_packet_in->getAtom().num;
+                while (hdr_starts)
+                {
+                    m_index_curr_pkt++;
+                    hdr_starts &= hdr_starts - 1;
+                }
+            }
+        }
+        break;
+
     case ETM4_PKT_I_CTXT:
         {
             if (m_P0_stack.createContextElem(m_curr_packet_in->getType(), m_index_curr_pkt, m_curr_packet_in->getContext(), m_last_IS) == 0)
@@ -377,10 +515,9 @@ ocsd_err_t TrcPktDecodeEtmV4I::decodePacket()
     case ETM4_PKT_I_EXCEPT_RTN:
         {
             // P0 element if V7M profile.
-            bool bV7MProfile = (m_config->archVersion() == ARCH_V7) && (m_config->coreProfile() == profile_CortexM);
-            if (m_P0_stack.createParamElemNoParam(P0_EXCEP_RET, bV7MProfile, m_curr_packet_in->getType(), m_index_curr_pkt) == 0)
+            if (m_P0_stack.createParamElemNoParam(P0_EXCEP_RET, m_v7M_profile, m_curr_packet_in->getType(), m_index_curr_pkt) == 0)
                 bAllocErr = true;
-            else if (bV7MProfile)
+            else if (m_v7M_profile)
                 m_curr_spec_depth++;
         }
         break;
@@ -388,7 +525,7 @@ ocsd_err_t TrcPktDecodeEtmV4I::decodePacket()
     case ETM4_PKT_I_FUNC_RET:
         {
             // P0 element iff V8M profile, otherwise ignore
-            if (OCSD_IS_V8_ARCH(m_config->archVersion()) && (m_config->coreProfile() == profile_CortexM))
+            if (m_v8M_profile)
             {
                 if (m_P0_stack.createParamElemNoParam(P0_FUNC_RET, true, m_curr_packet_in->getType(), m_index_curr_pkt) == 0)
                     bAllocErr = true;
@@ -425,14 +562,13 @@ ocsd_err_t TrcPktDecodeEtmV4I::decodePacket()
     // timestamp
     case ETM4_PKT_I_TIMESTAMP:
         {
-            bool bTSwithCC = m_config->enabledCCI();
             uint64_t ts = m_curr_packet_in->getTS();
             std::vector<uint32_t> params = { 0, 0, 0 };
             params[0] = (uint32_t)(ts & 0xFFFFFFFF);
             params[1] = (uint32_t)((ts >> 32) & 0xFFFFFFFF);
-            if (bTSwithCC)
+            if (m_ts_with_cc)
                 params[2] = m_curr_packet_in->getCC();
-            if (m_P0_stack.createParamElem(bTSwithCC ? P0_TS_CC : P0_TS, false, m_curr_packet_in->getType(), m_index_curr_pkt, params) == 0)
+            if (m_P0_stack.createParamElem(m_ts_with_cc ? P0_TS_CC : P0_TS, false, m_curr_packet_in->getType(), m_index_curr_pkt, params) == 0)
                 bAllocErr = true;
 
         }
@@ -525,14 +661,14 @@ ocsd_err_t TrcPktDecodeEtmV4I::decodePacket()
         //resp = OCSD_RESP_FATAL_INVALID_DATA;
 #endif
         err = OCSD_ERR_UNSUPP_DECODE_PKT;
-        LogError(ocsdError(sev, err, "Data trace releated, unsupported packet type."));
+        LogError(sev, err, OCSD_BAD_TRC_INDEX, OCSD_BAD_CS_SRC_ID, "Data trace releated, unsupported packet type.");
         }
         break;
 
     default:
         // any other packet - bad packet error
         err = OCSD_ERR_BAD_DECODE_PKT;
-        LogError(ocsdError(OCSD_ERR_SEV_ERROR,err,"Unknown packet type."));
+        LogError(OCSD_ERR_SEV_ERROR, err, OCSD_BAD_TRC_INDEX, OCSD_BAD_CS_SRC_ID, "Unknown packet type.");
         break;
     }
 
@@ -759,7 +895,7 @@ ocsd_err_t TrcPktDecodeEtmV4I::commitElements()
         {
             // too few elements for commit operation - decode error.
             err = OCSD_ERR_COMMIT_PKT_OVERRUN;
-            LogError(ocsdError(OCSD_ERR_SEV_ERROR,OCSD_ERR_COMMIT_PKT_OVERRUN,err_idx,m_CSID,"Not enough elements to commit"));
+            LogError(OCSD_ERR_SEV_ERROR, OCSD_ERR_COMMIT_PKT_OVERRUN, err_idx, m_CSID, "Not enough elements to commit");
         }
     }
 
@@ -908,7 +1044,7 @@ ocsd_err_t TrcPktDecodeEtmV4I::cancelElements()
         {
             // too few elements for commit operation - decode error.
             err = OCSD_ERR_COMMIT_PKT_OVERRUN;
-            LogError(ocsdError(OCSD_ERR_SEV_ERROR, err, m_index_curr_pkt, m_CSID, "Not enough elements to cancel"));
+            LogError(OCSD_ERR_SEV_ERROR, err, m_index_curr_pkt, m_CSID, "Not enough elements to cancel");
             m_elem_res.P0_cancel = 0;
             break;
         }
@@ -964,7 +1100,7 @@ ocsd_err_t TrcPktDecodeEtmV4I::mispredictAtom()
     if (!bFoundAtom && !m_unseen_spec_elem)
     {
         err = OCSD_ERR_COMMIT_PKT_OVERRUN;
-        LogError(ocsdError(OCSD_ERR_SEV_ERROR, err, m_index_curr_pkt, m_CSID, "Not found mispredict atom"));
+        LogError(OCSD_ERR_SEV_ERROR, err, m_index_curr_pkt, m_CSID, "Not found mispredict atom");
     }
     m_elem_res.mispredict = false;
     return err;
@@ -1090,15 +1226,55 @@ void TrcPktDecodeEtmV4I::setElemTraceRange(OcsdTraceElement &elemIn, const instr
         m_instr_info.isa = m_instr_info.next_isa;
 }
 
+// extend the current range element with a range that follows on from it.
+void TrcPktDecodeEtmV4I::mergeElemTraceRange(OcsdTraceElement &elemIn, const instr_range_t &addr_range,
+                                             const bool executed, ocsd_trc_index_t index)
+{
+    const ocsd_vaddr_t st_addr = elemIn.st_addr;
+    const uint32_t num_instr = elemIn.num_instr_range + addr_range.num_instr;
+
+    setElemTraceRange(elemIn, addr_range, executed, index);
+    elemIn.setAddrRange(st_addr, addr_range.en_addr, num_instr);
+}
+
+// merge if enabled and the current element is a range ending in a not taken branch, 
+// falling through to the current address, with no other elements since.
+bool TrcPktDecodeEtmV4I::canMergeRange()
+{
+    if (!(getComponentOpMode() & OCSD_OPFLG_PKTDEC_MERGE_RANGES) || !m_out_elem.numElemToSend())
+        return false;
+
+    const OcsdTraceElement &elem = outElem();
+    return (elem.getType() == OCSD_GEN_TRC_ELEM_INSTR_RANGE) &&
+           !elem.last_instr_exec &&
+           (elem.en_addr == m_instr_info.instr_addr) &&
+           (elem.isa == m_instr_info.isa);
+}
+
 ocsd_err_t TrcPktDecodeEtmV4I::processAtom(const ocsd_atm_val atom)
 {
     ocsd_err_t err;
     TrcStackElem *pElem = m_P0_stack.back();  // get the atom element
     WP_res_t WPRes;
     instr_range_t addr_range;
+    bool bMerge;
 
-    // new element for this processed atom
-    if ((err = m_out_elem.addElem(pElem->getRootIndex())) != OCSD_OK)
+    // outside the PE filter - no instruction walk, one marker until back inside.
+    if (isFilteredOut())
+    {
+        if (enterFilteredOut())
+        {
+            if ((err = m_out_elem.addElem(pElem->getRootIndex())) != OCSD_OK)
+                return err;
+            setElemFilteredOut(outElem());
+        }
+        return OCSD_OK;
+    }
+    m_filter_out_sent = false;
+
+    // new element for this processed atom - unless extending the current range.
+    bMerge = canMergeRange();
+    if (!bMerge && ((err = m_out_elem.addElem(pElem->getRootIndex())) != OCSD_OK))
         return err;
 
     err = traceInstrToWP(addr_range, WPRes);
@@ -1108,13 +1284,13 @@ ocsd_err_t TrcPktDecodeEtmV4I::processAtom(const ocsd_atm_val atom)
         {
              m_need_addr = true;
              m_need_ctxt = true;
-             LogError(ocsdError(OCSD_ERR_SEV_WARN,err,pElem->getRootIndex(),m_CSID,"Warning: unsupported instruction set processing atom packet."));  
+             LogError(OCSD_ERR_SEV_WARN, err, pElem->getRootIndex(), m_CSID, "Warning: unsupported instruction set processing atom packet.");  
              // wait for next context
              return OCSD_OK;
         }
         else
         {
-            LogError(ocsdError(OCSD_ERR_SEV_ERROR,err,pElem->getRootIndex(),m_CSID,"Error processing atom packet."));  
+            LogError(OCSD_ERR_SEV_ERROR, err, pElem->getRootIndex(), m_CSID, "Error processing atom packet.");  
             return err;
         }
     }
@@ -1147,7 +1323,10 @@ ocsd_err_t TrcPktDecodeEtmV4I::processAtom(const ocsd_atm_val atom)
             }
             break;
         }
-        setElemTraceRange(outElem(), addr_range, (atom == ATOM_E), pElem->getRootIndex());
+        if (bMerge)
+            mergeElemTraceRange(outElem(), addr_range, (atom == ATOM_E), pElem->getRootIndex());
+        else
+            setElemTraceRange(outElem(), addr_range, (atom == ATOM_E), pElem->getRootIndex());
     }
     else
     {
@@ -1157,12 +1336,17 @@ ocsd_err_t TrcPktDecodeEtmV4I::processAtom(const ocsd_atm_val atom)
         if(addr_range.st_addr != addr_range.en_addr)
         {
             // some trace before we were out of memory access range
-            setElemTraceRange(outElem(), addr_range, true, pElem->getRootIndex());
+            if (bMerge)
+                mergeElemTraceRange(outElem(), addr_range, true, pElem->getRootIndex());
+            else
+                setElemTraceRange(outElem(), addr_range, true, pElem->getRootIndex());
 
             // another element for the nacc...
             if (WPNacc(WPRes))
                 err = m_out_elem.addElem(pElem->getRootIndex());
         }
+        else if (bMerge && WPNacc(WPRes))
+            err = m_out_elem.addElem(pElem->getRootIndex()); // current element is the previous range - nacc needs a new one.
 
         if(WPNacc(WPRes) && !err)
         {
@@ -1203,7 +1387,7 @@ ocsd_err_t TrcPktDecodeEtmV4I::processException()
    if(pElem->getP0Type() != P0_ADDR)
    {
        // no following address element - indicate processing error.      
-       LogError(ocsdError(OCSD_ERR_SEV_ERROR,OCSD_ERR_BAD_PACKET_SEQ, excep_pkt_index,m_CSID,"Address missing in exception packet."));
+       LogError(OCSD_ERR_SEV_ERROR, OCSD_ERR_BAD_PACKET_SEQ, excep_pkt_index, m_CSID, "Address missing in exception packet.");
        return OCSD_ERR_BAD_PACKET_SEQ;
    }
    else
@@ -1247,9 +1431,21 @@ ocsd_err_t TrcPktDecodeEtmV4I::processException()
     }
 
     // if the preferred return address is not the end of the last output range...
-    if (m_instr_info.instr_addr != excep_ret_addr)
+    if ((m_instr_info.instr_addr != excep_ret_addr) && isFilteredOut())
+    {
+        // outside the PE filter - no walk to the return address.
+        if (enterFilteredOut())
+        {
+            setElemFilteredOut(outElem());
+            if ((err = m_out_elem.addElem(excep_pkt_index)))
+                return err;
+        }
+    }
+    else if (m_instr_info.instr_addr != excep_ret_addr)
     {        
         bool range_out = false;
+
+        m_filter_out_sent = false;
         instr_range_t addr_range;
 
         // look for match to return address.
@@ -1261,11 +1457,11 @@ ocsd_err_t TrcPktDecodeEtmV4I::processException()
             {
                 m_need_addr = true;
                 m_need_ctxt = true;
-                LogError(ocsdError(OCSD_ERR_SEV_WARN,err, excep_pkt_index,m_CSID,"Warning: unsupported instruction set processing exception packet."));
+                LogError(OCSD_ERR_SEV_WARN, err, excep_pkt_index, m_CSID, "Warning: unsupported instruction set processing exception packet.");
             }
             else
             {
-                LogError(ocsdError(OCSD_ERR_SEV_ERROR,err, excep_pkt_index,m_CSID,"Error processing exception packet."));
+                LogError(OCSD_ERR_SEV_ERROR, err, excep_pkt_index, m_CSID, "Error processing exception packet.");
             }
             return err;
         }
@@ -1350,7 +1546,7 @@ ocsd_err_t TrcPktDecodeEtmV4I::processQElement()
         {
             // no following address element - indicate processing error.
             err = OCSD_ERR_BAD_PACKET_SEQ;
-            LogError(ocsdError(OCSD_ERR_SEV_ERROR, err, pQElem->getRootIndex(), m_CSID, "Address missing in Q packet."));
+            LogError(OCSD_ERR_SEV_ERROR, err, pQElem->getRootIndex(), m_CSID, "Address missing in Q packet.");
             m_P0_stack.delete_popped();
             return err;
         }
@@ -1369,6 +1565,21 @@ ocsd_err_t TrcPktDecodeEtmV4I::processQElement()
     else
         QAddr = pQElem->getAddr();
 
+    // outside the PE filter - skip the instruction walk, trace resumes at the Q address.
+    if (isFilteredOut())
+    {
+        if (enterFilteredOut())
+        {
+            if ((err = m_out_elem.addElem(pQElem->getRootIndex())) == OCSD_OK)
+                setElemFilteredOut(outElem());
+        }
+        SetInstrInfoInAddrISA(QAddr.val, QAddr.isa);
+        m_need_addr = false;
+        m_P0_stack.delete_popped();
+        return err;
+    }
+    m_filter_out_sent = false;
+
     // process the Q element with address. 
     iCount = pQElem->getInstrCount();
 
@@ -1447,7 +1658,7 @@ ocsd_err_t TrcPktDecodeEtmV4I::processQElement()
     else
     {
         // output error and halt decode.
-        LogError(ocsdError(OCSD_ERR_SEV_ERROR, err, pQElem->getRootIndex(), m_CSID, "Error processing Q packet"));
+        LogError(OCSD_ERR_SEV_ERROR, err, pQElem->getRootIndex(), m_CSID, "Error processing Q packet");
     }
     m_P0_stack.delete_popped();
     return err;
@@ -1462,25 +1673,60 @@ void TrcPktDecodeEtmV4I::SetInstrInfoInAddrISA(const ocsd_vaddr_t addr_val, cons
 // trace an instruction range to a waypoint - and set next address to restart from.
 ocsd_err_t TrcPktDecodeEtmV4I::traceInstrToWP(instr_range_t &range, WP_res_t &WPRes, const bool traceToAddrNext /*= false*/, const ocsd_vaddr_t nextAddrMatch /*= 0*/)
 {
-    uint32_t opcode;
+    uint8_t span[OCSD_DCD_WP_SCAN_BYTES];
     uint32_t bytesReq;
+    uint32_t span_offset, num_skipped;
+    ocsd_vaddr_t span_addr;
     ocsd_err_t err = OCSD_OK;
 
+    // when looking for a waypoint, read a span of memory and skip instructions that cannot be waypoints.
+    const uint32_t readSize = traceToAddrNext ? 4 : OCSD_DCD_WP_SCAN_BYTES;
+
     range.st_addr = range.en_addr = m_instr_info.instr_addr;
     range.num_instr = 0;
 
+    // range may be resolved from a precomputed basic block map.
+    if(!traceToAddrNext && instrFindBasicBlock(getCurrMemSpace(), &m_instr_info, &range.num_instr))
+    {
+        WPRes = WP_FOUND;
+        range.en_addr = m_instr_info.instr_addr;
+        return OCSD_OK;
+    }
+
     WPRes = WP_NOT_FOUND;
 
     while(WPRes == WP_NOT_FOUND)
     {
-        // start off by reading next opcode;
-        bytesReq = 4;
-        err = accessMemory(m_instr_info.instr_addr, getCurrMemSpace(),&bytesReq,(uint8_t *)&opcode);
+        // start off by reading next opcode(s);
+        bytesReq = readSize;
+        err = accessMemory(m_instr_info.instr_addr, getCurrMemSpace(), &bytesReq, span);
         if(err != OCSD_OK) break;
 
-        if(bytesReq == 4) // got data back
+        // full span may not be accessible - fall back to a single opcode read.
+        if((bytesReq < 4) && (readSize > 4))
         {
-            m_instr_info.opcode = opcode;
+            bytesReq = 4;
+            err = accessMemory(m_instr_info.instr_addr, getCurrMemSpace(), &bytesReq, span);
+            if(err != OCSD_OK) break;
+        }
+
+        if(bytesReq >= 4) // got data back
+        {
+            span_offset = 0;
+            if(!traceToAddrNext)
+            {
+                span_addr = m_instr_info.instr_addr;
+                err = instrFindNextWaypoint(&m_instr_info, span, bytesReq, &num_skipped);
+                if(err != OCSD_OK) break;
+                range.num_instr += num_skipped;
+
+                // next opcode not in the span - read again from the current address
+                span_offset = (uint32_t)(m_instr_info.instr_addr - span_addr);
+                if(span_offset + 4 > bytesReq)
+                    continue;
+            }
+
+            memcpy(&m_instr_info.opcode, span + span_offset, sizeof(uint32_t));
             err = instrDecode(&m_instr_info);
             if(err != OCSD_OK) break;
 
@@ -1519,7 +1765,7 @@ void TrcPktDecodeEtmV4I::updateContext(TrcStackElemCtxt *pCtxtElem, OcsdTraceEle
     elem.context.bits64 = ctxt.SF;
     m_is_secure = (ctxt.NS == 0);
     elem.context.security_level = ctxt.NS ? ocsd_sec_nonsecure : ocsd_sec_secure;
-    elem.context.exception_level = (ocsd_ex_level)ctxt.EL;
+    m_curr_el = elem.context.exception_level = (ocsd_ex_level)ctxt.EL;
     elem.context.el_valid = 1;
     if(ctxt.updated_c)
     {
@@ -1535,6 +1781,30 @@ void TrcPktDecodeEtmV4I::updateContext(TrcStackElemCtxt *pCtxtElem, OcsdTraceEle
     // need to update ISA in case context follows address.
     elem.isa = m_instr_info.isa = calcISA(m_is_64bit, pCtxtElem->getIS());
     m_need_ctxt = false;
+    updateFilterCtxt();
+}
+
+void TrcPktDecodeEtmV4I::updateFilterCtxt()
+{
+    m_filter_ctxt_out = m_filter_active && 
+        !m_pe_filter.matchContext(m_context_id, m_vmid_id, m_curr_el, m_is_secure ? ocsd_sec_secure : ocsd_sec_nonsecure);
+}
+
+const bool TrcPktDecodeEtmV4I::enterFilteredOut()
+{
+    // return stack will not be valid without the instruction walk - resync on next address packet.
+    m_need_addr = true;
+    m_return_stack.flush();
+    if (m_filter_out_sent)
+        return false;
+    m_filter_out_sent = true;
+    return true;
+}
+
+void TrcPktDecodeEtmV4I::setElemFilteredOut(OcsdTraceElement &elem)
+{
+    elem.setType(OCSD_GEN_TRC_ELEM_FILTERED_OUT);
+    elem.st_addr = m_instr_info.instr_addr;
 }
 
 ocsd_err_t TrcPktDecodeEtmV4I::handleBadPacket(const char *reason)
@@ -1545,11 +1815,11 @@ ocsd_err_t TrcPktDecodeEtmV4I::handleBadPacket(const char *reason)
     {
         // error out - stop decoding
         err = OCSD_ERR_BAD_DECODE_PKT;
-        LogError(ocsdError(OCSD_ERR_SEV_ERROR,err,reason));
+        LogError(OCSD_ERR_SEV_ERROR, err, OCSD_BAD_TRC_INDEX, OCSD_BAD_CS_SRC_ID, reason);
     }
     else
     {
-        LogError(ocsdError(OCSD_ERR_SEV_WARN, OCSD_ERR_BAD_DECODE_PKT, reason));
+        LogError(OCSD_ERR_SEV_WARN, OCSD_ERR_BAD_DECODE_PKT, OCSD_BAD_TRC_INDEX, OCSD_BAD_CS_SRC_ID, reason);
         // switch to unsync - clear decode state
         resetDecoder();
         m_curr_state = NO_SYNC;
@@ -31,8 +31,6 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
  */ 
-#include <sstream>
-#include <iomanip>
 
 #include "opencsd/etmv4/trc_pkt_elem_etmv4i.h"
 
@@ -70,6 +68,7 @@ void EtmV4ITrcPacket::initNextPacket()
     pkt_valid.bits.cc_valid = 0;
     pkt_valid.bits.commit_elem_valid = 0;
     atom.num = 0;
+    atom_hdr_starts = 0;
     context.updated = 0;
     context.updated_v = 0;
     context.updated_c = 0;
@@ -79,12 +78,21 @@ void EtmV4ITrcPacket::initNextPacket()
 // printing
 void EtmV4ITrcPacket::toString(std::string &str) const
 {
+    char szBuffer[512];
+    toStringBuf(szBuffer, sizeof(szBuffer));
+    str = szBuffer;
+}
+
+int EtmV4ITrcPacket::toStringBuf(char *buffer, const int buf_size) const
+{
+    trcPrintBuffer buf(buffer, buf_size);
     const char *name;
     const char *desc;
-    std::string valStr, ctxtStr = "";
 
     name = packetTypeName(type, &desc);
-    str = name + (std::string)" : " + desc;
+    buf.addStr(name);
+    buf.addStr(" : ");
+    buf.addStr(desc);
 
     // extended descriptions
     switch (type)
@@ -93,43 +101,50 @@ void EtmV4ITrcPacket::toString(std::string &str) const
     case ETM4_PKT_I_INCOMPLETE_EOT:
     case ETM4_PKT_I_RESERVED_CFG:
         name = packetTypeName(err_type, 0);
-        str += "[" + (std::string)name + "]";
+        buf.addChar('[');
+        buf.addStr(name);
+        buf.addChar(']');
         break;
 
     case ETM4_PKT_I_ADDR_CTXT_L_32IS0:
     case ETM4_PKT_I_ADDR_CTXT_L_32IS1:
-        contextStr(ctxtStr);
     case ETM4_PKT_I_ADDR_L_32IS0:
     case ETM4_PKT_I_ADDR_L_32IS1:
-        trcPrintableElem::getValStr(valStr, (v_addr.size == VA_64BIT) ? 64 : 32, v_addr.valid_bits, v_addr.val, true, (v_addr.pkt_bits < 32) ? v_addr.pkt_bits : 0);
-        str += "; Addr=" + valStr + "; " + ctxtStr;
+        buf.addStr("; Addr=");
+        addrStr(buf, (v_addr.pkt_bits < 32) ? v_addr.pkt_bits : 0);
+        buf.addStr("; ");
+        if ((type == ETM4_PKT_I_ADDR_CTXT_L_32IS0) || (type == ETM4_PKT_I_ADDR_CTXT_L_32IS1))
+            contextStr(buf);
         break;
 
     case ETM4_PKT_I_ADDR_CTXT_L_64IS0:
     case ETM4_PKT_I_ADDR_CTXT_L_64IS1:
-        contextStr(ctxtStr);
     case ETM4_PKT_I_ADDR_L_64IS0:
     case ETM4_PKT_I_ADDR_L_64IS1:
-        trcPrintableElem::getValStr(valStr, (v_addr.size == VA_64BIT) ? 64 : 32, v_addr.valid_bits, v_addr.val, true, (v_addr.pkt_bits < 64) ? v_addr.pkt_bits : 0);
-        str += "; Addr=" + valStr + "; " + ctxtStr;
+        buf.addStr("; Addr=");
+        addrStr(buf, (v_addr.pkt_bits < 64) ? v_addr.pkt_bits : 0);
+        buf.addStr("; ");
+        if ((type == ETM4_PKT_I_ADDR_CTXT_L_64IS0) || (type == ETM4_PKT_I_ADDR_CTXT_L_64IS1))
+            contextStr(buf);
         break;
 
     case ETM4_PKT_I_CTXT:
-        contextStr(ctxtStr);
-        str += "; " + ctxtStr;
+        buf.addStr("; ");
+        contextStr(buf);
         break;
 
     case ETM4_PKT_I_ADDR_S_IS0:
     case ETM4_PKT_I_ADDR_S_IS1:
-        trcPrintableElem::getValStr(valStr, (v_addr.size == VA_64BIT) ? 64 : 32, v_addr.valid_bits, v_addr.val, true, v_addr.pkt_bits);
-        str += "; Addr=" + valStr;
+        buf.addStr("; Addr=");
+        addrStr(buf, v_addr.pkt_bits);
         break;
 
     case ETM4_PKT_I_ADDR_MATCH:
-        addrMatchIdx(valStr);
-        str += ", " + valStr;
-        trcPrintableElem::getValStr(valStr, (v_addr.size == VA_64BIT) ? 64 : 32, v_addr.valid_bits, v_addr.val, true);
-        str += "; Addr=" + valStr + "; " + ctxtStr;
+        buf.addStr(", ");
+        addrMatchIdx(buf);
+        buf.addStr("; Addr=");
+        addrStr(buf, 0);
+        buf.addStr("; ");
         break;
 
     case ETM4_PKT_I_ATOM_F1:
@@ -138,136 +153,125 @@ void EtmV4ITrcPacket::toString(std::string &str) const
     case ETM4_PKT_I_ATOM_F4:
     case ETM4_PKT_I_ATOM_F5:
     case ETM4_PKT_I_ATOM_F6:
-        atomSeq(valStr);
-        str += "; " + valStr;
+    case ETM4_PKT_I_ATOM_BULK:
+        buf.addStr("; ");
+        atomSeq(buf);
         break;
 
     case ETM4_PKT_I_EXCEPT:
-        exceptionInfo(valStr);
-        str += "; " + valStr;
+        buf.addStr("; ");
+        exceptionInfo(buf);
         break;
 
     case ETM4_PKT_I_TIMESTAMP:
+        buf.addStr("; Updated val = 0x");
+        buf.addHex(ts.timestamp);
+        if (pkt_valid.bits.cc_valid)
         {
-            std::ostringstream oss;
-            oss << "; Updated val = " << std::hex << "0x" << ts.timestamp;
-            if (pkt_valid.bits.cc_valid)
-                oss << "; CC=" << std::hex << "0x" << cycle_count;
-            str += oss.str();
+            buf.addStr("; CC=0x");
+            buf.addHex(cycle_count);
         }
         break;
 
     case ETM4_PKT_I_TRACE_INFO:
+        buf.addStr("; INFO=0x");
+        buf.addHex(trace_info.val);
+        buf.addStr(" { CC.");
+        buf.addDec(trace_info.bits.cc_enabled);
+        buf.addStr(" }");
+        if (trace_info.bits.cc_enabled)
         {
-            std::ostringstream oss;
-            oss << "; INFO=" << std::hex << "0x" << trace_info.val;
-            oss << " { CC." << std::dec << trace_info.bits.cc_enabled << " }";
-            if (trace_info.bits.cc_enabled)
-                oss << "; CC_THRESHOLD=" << std::hex << "0x" << cc_threshold;
-            str += oss.str();
+            buf.addStr("; CC_THRESHOLD=0x");
+            buf.addHex(cc_threshold);
         }
         break;
 
     case ETM4_PKT_I_CCNT_F1:
     case ETM4_PKT_I_CCNT_F2:
     case ETM4_PKT_I_CCNT_F3:
-        {
-            std::ostringstream oss;
-            oss << "; Count=" << std::hex << "0x" << cycle_count;
-            str += oss.str();
-        }
+        buf.addStr("; Count=0x");
+        buf.addHex(cycle_count);
         break;
 
     case ETM4_PKT_I_CANCEL_F1:
-        {
-            std::ostringstream oss;
-            oss << "; Cancel(" << std::dec << cancel_elements << ")";
-            str += oss.str();
-        }
+        buf.addStr("; Cancel(");
+        buf.addDec(cancel_elements);
+        buf.addChar(')');
         break;
 
     case ETM4_PKT_I_CANCEL_F1_MISPRED:
-        {
-            std::ostringstream oss;
-            oss << "; Cancel(" << std::dec << cancel_elements << "), Mispredict";
-            str += oss.str();
-        }
+        buf.addStr("; Cancel(");
+        buf.addDec(cancel_elements);
+        buf.addStr("), Mispredict");
         break;
 
     case ETM4_PKT_I_MISPREDICT:
-        {
-            std::ostringstream oss;
-            oss << "; ";
-            if (atom.num) {
-                atomSeq(valStr);
-                oss << "Atom: " << valStr << ", ";
-            }
-            oss << "Mispredict";
-            str += oss.str();
+        buf.addStr("; ");
+        if (atom.num) {
+            buf.addStr("Atom: ");
+            atomSeq(buf);
+            buf.addStr(", ");
         }
+        buf.addStr("Mispredict");
         break;
 
     case ETM4_PKT_I_CANCEL_F2:
-        {
-            std::ostringstream oss;
-            oss << "; ";
-            if (atom.num) {
-                atomSeq(valStr);
-                oss << "Atom: " << valStr << ", ";
-            }
-            oss << "Cancel(1), Mispredict";
-            str += oss.str();
+        buf.addStr("; ");
+        if (atom.num) {
+            buf.addStr("Atom: ");
+            atomSeq(buf);
+            buf.addStr(", ");
         }
+        buf.addStr("Cancel(1), Mispredict");
         break;
 
     case ETM4_PKT_I_CANCEL_F3:
-        {
-            std::ostringstream oss;
-            oss << "; ";
-            if (atom.num) {
-                oss << "Atom: E, ";
-            }
-            oss << "Cancel(" << std::dec << cancel_elements << "), Mispredict";
-            str += oss.str();
+        buf.addStr("; ");
+        if (atom.num) {
+            buf.addStr("Atom: E, ");
         }
+        buf.addStr("Cancel(");
+        buf.addDec(cancel_elements);
+        buf.addStr("), Mispredict");
         break;
 
     case ETM4_PKT_I_COMMIT:
-        {
-            std::ostringstream oss;
-            oss << "; Commit(" << std::dec << commit_elements << ")";
-            str += oss.str();
-        }
+        buf.addStr("; Commit(");
+        buf.addDec(commit_elements);
+        buf.addChar(')');
         break;
 
     case ETM4_PKT_I_Q:
+        if (Q_pkt.count_present)
         {
-            std::ostringstream oss;
-            if (Q_pkt.count_present)
-            {
-                oss << "; Count(" << std::dec << Q_pkt.q_count << ")";
-                str += oss.str();
-            }
-            else
-                str += "; Count(Unknown)";
+            buf.addStr("; Count(");
+            buf.addDec(Q_pkt.q_count);
+            buf.addChar(')');
+        }
+        else
+            buf.addStr("; Count(Unknown)");
 
-            if (Q_pkt.addr_match) 
-            {
-                addrMatchIdx(valStr);
-                str += "; " + valStr;
-            }
+        if (Q_pkt.addr_match) 
+        {
+            buf.addStr("; ");
+            addrMatchIdx(buf);
+        }
 
-            if (Q_pkt.addr_present || Q_pkt.addr_match)
-            {
-                trcPrintableElem::getValStr(valStr, (v_addr.size == VA_64BIT) ? 64 : 32, v_addr.valid_bits, v_addr.val, true, (v_addr.pkt_bits < 64) ? v_addr.pkt_bits : 0);
-                str += "; Addr=" + valStr;
-            }
+        if (Q_pkt.addr_present || Q_pkt.addr_match)
+        {
+            buf.addStr("; Addr=");
+            addrStr(buf, (v_addr.pkt_bits < 64) ? v_addr.pkt_bits : 0);
         }
         break;
     }
-
+    return buf.length();
 }   
 
+void EtmV4ITrcPacket::addrStr(trcPrintBuffer &buf, const int updateBits) const
+{
+    trcPrintableElem::getValStr(buf, (v_addr.size == VA_64BIT) ? 64 : 32, v_addr.valid_bits, v_addr.val, true, updateBits);
+}
+
 void EtmV4ITrcPacket::toStringFmt(const uint32_t fmtFlags, std::string &str) const
 {
     toString(str);  // TBD add in formatted response.
@@ -551,6 +555,11 @@ const char *EtmV4ITrcPacket::packetTypeName(const ocsd_etmv4_i_pkt_type type, co
         pDesc = "Atom format 3.";
         break;
 
+    case ETM4_PKT_I_ATOM_BULK:
+        pName = "I_ATOM_BULK";
+        pDesc = "Atom run - combined atom packets.";
+        break;
+
     case ETM4_PKT_I_ASYNC:
         pName = "I_ASYNC";
         pDesc = "Alignment Synchronisation.";
@@ -574,55 +583,56 @@ const char *EtmV4ITrcPacket::packetTypeName(const ocsd_etmv4_i_pkt_type type, co
     return pName;
 }
 
-void EtmV4ITrcPacket::contextStr(std::string &ctxtStr) const
+void EtmV4ITrcPacket::contextStr(trcPrintBuffer &buf) const
 {
-    ctxtStr = "";
     if(pkt_valid.bits.context_valid)
     {
-        std::ostringstream oss;
         if(context.updated)
         {           
-            oss << "Ctxt: " << (context.SF ? "AArch64," : "AArch32, ") << "EL" << context.EL << ", " << (context.NS ? "NS; " : "S; ");
+            buf.addStr("Ctxt: ");
+            buf.addStr(context.SF ? "AArch64," : "AArch32, ");
+            buf.addStr("EL");
+            buf.addDec(context.EL);
+            buf.addStr(context.NS ? ", NS; " : ", S; ");
             if(context.updated_c)
             {
-                oss << "CID=0x" << std::hex << std::setfill('0') << std::setw(8) << context.ctxtID << "; ";
+                buf.addStr("CID=0x");
+                buf.addHex(context.ctxtID, 8);
+                buf.addStr("; ");
             }
             if(context.updated_v)
             {
-                oss << "VMID=0x" << std::hex << std::setfill('0') << std::setw(4) << context.VMID << "; ";
+                buf.addStr("VMID=0x");
+                buf.addHex(context.VMID, 4);
+                buf.addStr("; ");
             }
         }
         else
         {
-            oss << "Ctxt: Same";
+            buf.addStr("Ctxt: Same");
         }
-        ctxtStr = oss.str();
     }
 }
 
-void EtmV4ITrcPacket::atomSeq(std::string &valStr) const
+void EtmV4ITrcPacket::atomSeq(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
     uint32_t bitpattern = atom.En_bits;
     for(int i = 0; i < atom.num; i++)
     {
-        oss << ((bitpattern & 0x1) ? "E" : "N");
+        buf.addChar((bitpattern & 0x1) ? 'E' : 'N');
         bitpattern >>= 1;
     }
-    valStr = oss.str();
 }
 
-void EtmV4ITrcPacket::addrMatchIdx(std::string &valStr) const
+void EtmV4ITrcPacket::addrMatchIdx(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
-    oss << "[" << (uint16_t)addr_exact_match_idx << "]";
-    valStr = oss.str();
+    buf.addChar('[');
+    buf.addDec(addr_exact_match_idx);
+    buf.addChar(']');
 }
 
-void EtmV4ITrcPacket::exceptionInfo(std::string &valStr) const
+void EtmV4ITrcPacket::exceptionInfo(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
-
     static const char *ARv8Excep[] = {
         "PE Reset", "Debug Halt", "Call", "Trap", 
         "System Error", "Reserved", "Inst Debug", "Data Debug",
@@ -644,29 +654,39 @@ void EtmV4ITrcPacket::exceptionInfo(std::string &valStr) const
     if(exception_info.m_type == 0)
     {
         if(exception_info.exceptionType < 0x10)
-            oss << " " << ARv8Excep[exception_info.exceptionType] << ";";
+        {
+            buf.addChar(' ');
+            buf.addStr(ARv8Excep[exception_info.exceptionType]);
+            buf.addChar(';');
+        }
         else
-            oss << " Reserved;";
+            buf.addStr(" Reserved;");
 
     }
     else
     {
         if(exception_info.exceptionType < 0x20)
-            oss << " " << MExcep[exception_info.exceptionType] << ";";
+        {
+            buf.addChar(' ');
+            buf.addStr(MExcep[exception_info.exceptionType]);
+            buf.addChar(';');
+        }
         else if((exception_info.exceptionType >= 0x208) && (exception_info.exceptionType <= 0x3EF))
-            oss << " IRQ" << (int)(exception_info.exceptionType - 0x200) << ";";
+        {
+            buf.addStr(" IRQ");
+            buf.addDec(exception_info.exceptionType - 0x200);
+            buf.addChar(';');
+        }
         else
-            oss << " Reserved;";
+            buf.addStr(" Reserved;");
         if(exception_info.m_fault_pending)
-            oss << " Fault Pending;";
+            buf.addStr(" Fault Pending;");
     }
 
     if(exception_info.addr_interp == 0x1)
-        oss << " Ret Addr Follows;";
+        buf.addStr(" Ret Addr Follows;");
     else if(exception_info.addr_interp == 0x2)
-        oss << " Ret Addr Follows, Match Prev;";            
-    
-    valStr = oss.str();
+        buf.addStr(" Ret Addr Follows, Match Prev;");            
 }
 
 EtmV4ITrcPacket &EtmV4ITrcPacket::operator =(const ocsd_etmv4_i_pkt* p_pkt)
@@ -32,8 +32,11 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
  */ 
 
+#include <cstring>
+
 #include "opencsd/etmv4/trc_pkt_proc_etmv4.h"
 #include "common/ocsd_error.h"
+#include "common/trc_state_blob.h"
 
 #ifdef __GNUC__
  // G++ doesn't like the ## pasting
@@ -43,7 +46,9 @@
 #define ETMV4I_PKTS_NAME OCSD_CMPNAME_PREFIX_PKTPROC##"_ETMV4I"
 #endif
 
-static const uint32_t ETMV4_SUPPORTED_OP_FLAGS = OCSD_OPFLG_PKTPROC_COMMON;
+static const uint32_t ETMV4_SUPPORTED_OP_FLAGS = OCSD_OPFLG_PKTPROC_COMMON |
+    OCSD_OPFLG_PKTPROC_SKIM |
+    ETMV4_OPFLG_PKTPROC_BULK_ATOMS;
 
 /* trace etmv4 packet processing class */
 TrcPktProcEtmV4I::TrcPktProcEtmV4I() : TrcPktProcBase(ETMV4I_PKTS_NAME),
@@ -70,6 +75,7 @@ ocsd_err_t TrcPktProcEtmV4I::onProtocolConfig()
     InitProcessorState();
     m_config = *TrcPktProcBase::getProtocolConfig();
     BuildIPacketTable();    // packet table based on config
+    SetConfigConsts();
     m_isInit = true;
     return OCSD_OK;
 }
@@ -84,10 +90,14 @@ ocsd_datapath_resp_t TrcPktProcEtmV4I::processData(  const ocsd_trc_index_t inde
     if (!m_isInit)
         return OCSD_RESP_FATAL_NOT_INIT;
 
+    if (getComponentOpMode() & OCSD_OPFLG_PKTPROC_SKIM)
+        return skimData(dataBlockSize, pDataBlock, numBytesProcessed);
+
     m_trcIn.init(dataBlockSize, pDataBlock, &m_currPacketData);
     m_blockIndex = index;
     bool done = false;
     uint8_t nextByte;
+    const bool bulkAtoms = (getComponentOpMode() & ETMV4_OPFLG_PKTPROC_BULK_ATOMS) != 0;
 
     do
     {
@@ -106,6 +116,8 @@ ocsd_datapath_resp_t TrcPktProcEtmV4I::processData(  const ocsd_trc_index_t inde
                         nextByte = m_trcIn.peekNextByte();
                         m_pIPktFn = m_i_table[nextByte].pptkFn;
                         m_curr_packet.type = m_i_table[nextByte].pkt_type;
+                        if (bulkAtoms && (m_pIPktFn == &TrcPktProcEtmV4I::iAtom))
+                            m_pIPktFn = &TrcPktProcEtmV4I::iAtomBulk;
                     }
                     else
                     {
@@ -211,6 +223,172 @@ ocsd_datapath_resp_t TrcPktProcEtmV4I::onFlush()
     return OCSD_RESP_CONT;
 }
 
+/* state save and restore */
+#define ETMV4_PROC_STATE_TAG OCSD_STATE_TAG('E','4','P','P')
+#define ETMV4_PROC_STATE_VER 2
+
+// packet function pointer is saved as an index into the header table, or one of these values.
+#define PKTFN_IDX_NOTSYNC  0x100
+#define PKTFN_IDX_ASYNC    0x101
+#define PKTFN_IDX_UNKNOWN  0x1FF
+
+ocsd_err_t TrcPktProcEtmV4I::saveState(std::vector<uint8_t> &state)
+{
+    // skim summaries are not part of the decode state.
+    if (getComponentOpMode() & OCSD_OPFLG_PKTPROC_SKIM)
+        return OCSD_ERR_DCD_INTERFACE_UNUSED;
+
+    uint16_t fn_idx = PKTFN_IDX_UNKNOWN;
+    Etmv4PktAddrStack addr_stack = m_curr_packet.getAddrStack();
+    ocsd_pkt_vaddr vaddr;
+    uint8_t isa;
+
+    if (!m_isInit)
+        return OCSD_ERR_NOT_INIT;
+
+    if (m_pIPktFn == &TrcPktProcEtmV4I::iNotSync)
+        fn_idx = PKTFN_IDX_NOTSYNC;
+    else if (m_pIPktFn == &TrcPktProcEtmV4I::iPktASync)
+        fn_idx = PKTFN_IDX_ASYNC;
+    else
+    {
+        for (uint16_t i = 0; i < 256; i++)
+        {
+            if (m_i_table[i].pptkFn == m_pIPktFn)
+            {
+                fn_idx = i;
+                break;
+            }
+        }
+    }
+    if (fn_idx == PKTFN_IDX_UNKNOWN)
+        return OCSD_ERR_FAIL;
+
+    TrcStateWriter wr(state, ETMV4_PROC_STATE_TAG, ETMV4_PROC_STATE_VER);
+
+    // processor state
+    wr.put(m_process_state);
+    wr.putVec(m_currPacketData);
+    wr.put(m_currPktIdx);
+    wr.put((const ocsd_etmv4_i_pkt &)m_curr_packet);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        addr_stack.get_idx(i, vaddr, isa);
+        wr.put(vaddr);
+        wr.put(isa);
+    }
+    wr.put(m_packet_index);
+    wr.put(m_is_sync);
+    wr.put(m_first_trace_info);
+    wr.put(m_sent_notsync_packet);
+    wr.put(m_dump_unsynced_bytes);
+    wr.put(m_update_on_unsync_packet_index);
+    wr.put(fn_idx);
+
+    // current packet progress
+    wr.put(m_tinfo_sections);
+    wr.put(m_addrBytes);
+    wr.put(m_addrIS);
+    wr.put(m_bAddr64bit);
+    wr.put(m_vmidBytes);
+    wr.put(m_ctxtidBytes);
+    wr.put(m_bCtxtInfoDone);
+    wr.put(m_addr_done);
+    wr.put(m_ccount_done);
+    wr.put(m_ts_done);
+    wr.put(m_ts_bytes);
+    wr.put(m_excep_size);
+    wr.put(m_has_count);
+    wr.put(m_count_done);
+    wr.put(m_commit_done);
+    wr.put(m_F1P1_done);
+    wr.put(m_F1P2_done);
+    wr.put(m_F1has_P2);
+    wr.put(m_has_addr);
+    wr.put(m_addr_short);
+    wr.put(m_addr_match);
+    wr.put(m_Q_type);
+    wr.put(m_QE);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcPktProcEtmV4I::restoreState(const uint8_t *p_state, const size_t size)
+{
+    uint16_t fn_idx = PKTFN_IDX_UNKNOWN;
+    Etmv4PktAddrStack addr_stack;
+    ocsd_pkt_vaddr vaddr[3];
+    uint8_t isa[3];
+    ocsd_err_t err;
+
+    if (!m_isInit)
+        return OCSD_ERR_NOT_INIT;
+
+    TrcStateReader rd(p_state, size, ETMV4_PROC_STATE_TAG, ETMV4_PROC_STATE_VER);
+
+    rd.get(m_process_state);
+    rd.getVec(m_currPacketData);
+    rd.get(m_currPktIdx);
+    rd.get((ocsd_etmv4_i_pkt &)m_curr_packet);
+    for (int i = 0; i < 3; i++)
+    {
+        rd.get(vaddr[i]);
+        rd.get(isa[i]);
+    }
+    rd.get(m_packet_index);
+    rd.get(m_is_sync);
+    rd.get(m_first_trace_info);
+    rd.get(m_sent_notsync_packet);
+    rd.get(m_dump_unsynced_bytes);
+    rd.get(m_update_on_unsync_packet_index);
+    rd.get(fn_idx);
+
+    rd.get(m_tinfo_sections);
+    rd.get(m_addrBytes);
+    rd.get(m_addrIS);
+    rd.get(m_bAddr64bit);
+    rd.get(m_vmidBytes);
+    rd.get(m_ctxtidBytes);
+    rd.get(m_bCtxtInfoDone);
+    rd.get(m_addr_done);
+    rd.get(m_ccount_done);
+    rd.get(m_ts_done);
+    rd.get(m_ts_bytes);
+    rd.get(m_excep_size);
+    rd.get(m_has_count);
+    rd.get(m_count_done);
+    rd.get(m_commit_done);
+    rd.get(m_F1P1_done);
+    rd.get(m_F1P2_done);
+    rd.get(m_F1has_P2);
+    rd.get(m_has_addr);
+    rd.get(m_addr_short);
+    rd.get(m_addr_match);
+    rd.get(m_Q_type);
+    rd.get(m_QE);
+
+    if (fn_idx == PKTFN_IDX_NOTSYNC)
+        m_pIPktFn = &TrcPktProcEtmV4I::iNotSync;
+    else if (fn_idx == PKTFN_IDX_ASYNC)
+        m_pIPktFn = &TrcPktProcEtmV4I::iPktASync;
+    else if (fn_idx < 256)
+        m_pIPktFn = m_i_table[fn_idx].pptkFn;
+    else
+        rd.setInvalid();
+
+    err = rd.end();
+    if (err == OCSD_OK)
+    {
+        // push oldest first to rebuild the address stack
+        for (int i = 2; i >= 0; i--)
+            addr_stack.push(vaddr[i], isa[i]);
+        m_curr_packet.setAddrStack(addr_stack);
+    }
+    else
+        InitProcessorState();   // bad state data - back to unsynced start state.
+    return err;
+}
+
 void TrcPktProcEtmV4I::InitPacketState()
 {
     m_currPacketData.clear();
@@ -228,6 +406,7 @@ void TrcPktProcEtmV4I::InitProcessorState()
     m_sent_notsync_packet = false;
     m_process_state = PROC_HDR;
     m_curr_packet.initStartState();
+    skimResetState();
 }
 
 ocsd_datapath_resp_t TrcPktProcEtmV4I::outputPacket()
@@ -512,12 +691,11 @@ void TrcPktProcEtmV4I::iPktTimestamp(const uint8_t lastByte)
 
         if((m_currPacketData[0] & 0x1) == 0x1)
         {
-            uint32_t countVal, countMask;
+            uint32_t countVal;
             
             idx += ts_bytes;           
             extractContField(m_currPacketData, idx, countVal, 3);    // only 3 possible count bytes.
-            countMask = (((uint32_t)1UL << m_config.ccSize()) - 1); // mask of the CC size
-            countVal &= countMask;
+            countVal &= m_cc_mask;
             m_curr_packet.setCycleCount(countVal);
         }
 
@@ -542,7 +720,7 @@ void TrcPktProcEtmV4I::iPktException(const uint8_t lastByte)
         excep_type =  (m_currPacketData[1] >> 1) & 0x1F;
         uint8_t addr_interp = (m_currPacketData[1] & 0x40) >> 5 | (m_currPacketData[1] & 0x1);
         uint8_t m_fault_pending = 0;        
-        uint8_t m_type = (m_config.coreProfile() == profile_CortexM) ? 1 : 0;
+        uint8_t m_type = m_excep_m_type;
 
         // extended exception packet (probably M class);
         if(m_currPacketData[1] & 0x80)
@@ -569,7 +747,7 @@ void TrcPktProcEtmV4I::iPktCycleCntF123(const uint8_t lastByte)
         if(format == ETM4_PKT_I_CCNT_F3)
         {
             // no commit section for TRCIDR0.COMMOPT == 1
-            if(!m_config.commitOpt1())
+            if(!m_commit_opt1)
             {
                 m_curr_packet.setCommitElements(((lastByte >> 2) & 0x3) + 1);
             }
@@ -586,13 +764,13 @@ void TrcPktProcEtmV4I::iPktCycleCntF123(const uint8_t lastByte)
             }
 
             // no commit section for TRCIDR0.COMMOPT == 1
-            if(m_config.commitOpt1())
+            if(m_commit_opt1)
                 m_commit_done = true;
         }
     }
     else if((format == ETM4_PKT_I_CCNT_F2) && ( m_currPacketData.size() == 2))
     {
-        int commit_offset = ((lastByte & 0x1) == 0x1) ? ((int)m_config.MaxSpecDepth() - 15) : 1;
+        int commit_offset = ((lastByte & 0x1) == 0x1) ? m_ccf2_commit_offset : 1;
         int commit_elements = ((lastByte >> 4) & 0xF);
         commit_elements += commit_offset;
 
@@ -616,7 +794,7 @@ void TrcPktProcEtmV4I::iPktCycleCntF123(const uint8_t lastByte)
         int idx = 1; // index into buffer for payload data.
         uint32_t field_value = 0;
         // no commit section for TRCIDR0.COMMOPT == 1
-        if(!m_config.commitOpt1())
+        if(!m_commit_opt1)
         {
             idx += extractContField(m_currPacketData,idx,field_value);
             m_curr_packet.setCommitElements(field_value);
@@ -806,8 +984,8 @@ void TrcPktProcEtmV4I::iPktContext(const uint8_t lastByte)
         }
         else
         {
-            m_vmidBytes = ((lastByte & 0x40) == 0x40) ? (m_config.vmidSize()/8) : 0;
-            m_ctxtidBytes = ((lastByte & 0x80) == 0x80) ? (m_config.cidSize()/8) : 0;
+            m_vmidBytes = ((lastByte & 0x40) == 0x40) ? m_cfg_vmid_bytes : 0;
+            m_ctxtidBytes = ((lastByte & 0x80) == 0x80) ? m_cfg_cid_bytes : 0;
         }
     }
     else    // 3rd byte onwards
@@ -836,8 +1014,8 @@ void TrcPktProcEtmV4I::extractAndSetContextInfo(const std::vector<uint8_t> &buff
     m_curr_packet.setContextInfo(true, (infoByte & 0x3), (infoByte >> 5) & 0x1, (infoByte >> 4) & 0x1);    
 
     // see if there are VMID and CID bytes, and how many.
-    int nVMID_bytes = ((infoByte & 0x40) == 0x40) ? (m_config.vmidSize()/8) : 0;
-    int nCtxtID_bytes = ((infoByte & 0x80) == 0x80) ? (m_config.cidSize()/8) : 0;
+    int nVMID_bytes = ((infoByte & 0x40) == 0x40) ? m_cfg_vmid_bytes : 0;
+    int nCtxtID_bytes = ((infoByte & 0x80) == 0x80) ? m_cfg_cid_bytes : 0;
 
     // extract any VMID and CID
     int payload_idx = st_idx+1;
@@ -896,8 +1074,8 @@ void TrcPktProcEtmV4I::iPktAddrCtxt(const uint8_t lastByte)
             if(m_bCtxtInfoDone == false)
             {
                 m_bCtxtInfoDone = true;
-                m_vmidBytes = ((lastByte & 0x40) == 0x40) ? (m_config.vmidSize()/8) : 0;
-                m_ctxtidBytes = ((lastByte & 0x80) == 0x80) ? (m_config.cidSize()/8) : 0;
+                m_vmidBytes = ((lastByte & 0x40) == 0x40) ? m_cfg_vmid_bytes : 0;
+                m_ctxtidBytes = ((lastByte & 0x80) == 0x80) ? m_cfg_cid_bytes : 0;
             }
             else
             {
@@ -1133,6 +1311,53 @@ void TrcPktProcEtmV4I::iPktQ(const uint8_t lastByte)
 }
 
 void TrcPktProcEtmV4I::iAtom(const uint8_t lastByte)
+{
+    uint32_t En_bits;
+    uint8_t num;
+
+    // atom packets are single byte, no payload.
+    if (atomHdrPattern(m_curr_packet.type, lastByte, En_bits, num))
+        m_curr_packet.setAtomPacket(ATOM_PATTERN, En_bits, num);
+    m_process_state = SEND_PKT;
+}
+
+void TrcPktProcEtmV4I::iAtomBulk(const uint8_t lastByte)
+{
+    uint32_t En_bits, bulk_bits, hdr_starts = 0;
+    uint8_t num, bulk_num;
+    uint8_t nextByte;
+    int nPkts = 1;
+
+    iAtom(lastByte);
+    if (!atomHdrPattern(m_curr_packet.type, lastByte, bulk_bits, bulk_num))
+        return;
+
+    // append following atom headers in this block while the combined pattern fits in 32 bits.
+    // any other header ends the run, so the atom order relative to other packets is unchanged.
+    while (!m_trcIn.empty())
+    {
+        nextByte = m_trcIn.peekNextByte();
+        if ((m_i_table[nextByte].pptkFn != &TrcPktProcEtmV4I::iAtom) ||
+            !atomHdrPattern(m_i_table[nextByte].pkt_type, nextByte, En_bits, num) ||
+            ((bulk_num + num) > 32))
+            break;
+        bulk_bits |= En_bits << bulk_num;
+        hdr_starts |= ((uint32_t)0x1) << bulk_num;
+        bulk_num += num;
+        m_trcIn.copyByteToPkt();
+        nPkts++;
+    }
+
+    if (nPkts > 1)
+    {
+        m_curr_packet.type = ETM4_PKT_I_ATOM_BULK;
+        m_curr_packet.setAtomPacket(ATOM_PATTERN, bulk_bits, bulk_num);
+        m_curr_packet.setAtomHdrStarts(hdr_starts);
+    }
+}
+
+// E/N pattern and count for an atom header - false for invalid F5 patterns.
+bool TrcPktProcEtmV4I::atomHdrPattern(const ocsd_etmv4_i_pkt_type type, const uint8_t hdr, uint32_t &En_bits, uint8_t &num) const
 {
     // patterns lsbit = oldest atom, ms bit = newest.
     static const uint32_t f4_patterns[] = {
@@ -1145,62 +1370,64 @@ void TrcPktProcEtmV4I::iAtom(const uint8_t lastByte)
     uint8_t pattIdx = 0, pattCount = 0;
     uint32_t pattern;
 
-    // atom packets are single byte, no payload.
-    switch(m_curr_packet.type)
+    switch(type)
     {
     case ETM4_PKT_I_ATOM_F1:
-        m_curr_packet.setAtomPacket(ATOM_PATTERN,(lastByte & 0x1), 1); // 1xE or N
+        En_bits = (hdr & 0x1); num = 1; // 1xE or N
         break;
 
     case ETM4_PKT_I_ATOM_F2:
-        m_curr_packet.setAtomPacket(ATOM_PATTERN,(lastByte & 0x3), 2); // 2x (E or N)
+        En_bits = (hdr & 0x3); num = 2; // 2x (E or N)
         break;
 
     case ETM4_PKT_I_ATOM_F3:
-        m_curr_packet.setAtomPacket(ATOM_PATTERN,(lastByte & 0x7), 3); // 3x (E or N)
+        En_bits = (hdr & 0x7); num = 3; // 3x (E or N)
         break;
 
     case ETM4_PKT_I_ATOM_F4:
-        m_curr_packet.setAtomPacket(ATOM_PATTERN,f4_patterns[(lastByte & 0x3)], 4); // 4 atom pattern
+        En_bits = f4_patterns[(hdr & 0x3)]; num = 4; // 4 atom pattern
         break; 
 
     case ETM4_PKT_I_ATOM_F5:
-        pattIdx = ((lastByte & 0x20) >> 3) | (lastByte & 0x3);
+        pattIdx = ((hdr & 0x20) >> 3) | (hdr & 0x3);
+        num = 5;
         switch(pattIdx)
         {
         case 5: // 0b101
-            m_curr_packet.setAtomPacket(ATOM_PATTERN,0x1E, 5); // 5 atom pattern EEEEN
+            En_bits = 0x1E; // 5 atom pattern EEEEN
             break;
 
         case 1: // 0b001
-            m_curr_packet.setAtomPacket(ATOM_PATTERN,0x00, 5); // 5 atom pattern NNNNN
+            En_bits = 0x00; // 5 atom pattern NNNNN
             break;
 
         case 2: //0b010
-            m_curr_packet.setAtomPacket(ATOM_PATTERN,0x0A, 5); // 5 atom pattern NENEN
+            En_bits = 0x0A; // 5 atom pattern NENEN
             break;
 
         case 3: //0b011
-            m_curr_packet.setAtomPacket(ATOM_PATTERN,0x15, 5); // 5 atom pattern ENENE
+            En_bits = 0x15; // 5 atom pattern ENENE
             break;
 
         default:
             // TBD: warn about invalid pattern in here.
-            break;
+            return false;
         }
         break;
 
     case ETM4_PKT_I_ATOM_F6:
-        pattCount = (lastByte & 0x1F) + 3;  // count of E's
+        pattCount = (hdr & 0x1F) + 3;  // count of E's
         // TBD: check 23 or less at this point? 
         pattern = ((uint32_t)0x1 << pattCount) - 1; // set pattern to string of E's
-        if((lastByte & 0x20) == 0x00)   // last atom is E?
+        if((hdr & 0x20) == 0x00)   // last atom is E?
             pattern |= ((uint32_t)0x1 << pattCount); 
-        m_curr_packet.setAtomPacket(ATOM_PATTERN,pattern, pattCount+1);
+        En_bits = pattern; num = pattCount + 1;
         break;
-    }
 
-    m_process_state = SEND_PKT;
+    default:
+        return false;
+    }
+    return true;
 }
 
 // header byte processing is table driven.
@@ -1569,10 +1796,10 @@ unsigned TrcPktProcEtmV4I::extractContField64(const std::vector<uint8_t> &buffer
     {
         if(buffer.size() > (st_idx + idx))
         {
-            // each byte has seven bits + cont bit
+            // each byte has seven bits + cont bit - 9th byte has all 8 bits for [63:56]
             byteVal = buffer[(st_idx + idx)];
             lastByte = (byteVal & 0x80) != 0x80;
-            value |= ((uint64_t)(byteVal & 0x7F)) << (idx * 7);
+            value |= ((uint64_t)((idx == 8) ? byteVal : (byteVal & 0x7F))) << (idx * 7);
             idx++;
         }
         else
@@ -1657,11 +1884,317 @@ int TrcPktProcEtmV4I::extract32BitLongAddr(const std::vector<uint8_t> &buffer, c
     return 4;
 }
 
+// values fixed by the config for the trace session - the header table handles the packet types valid 
+// for the config, these handle config dependent fields within the packets.
+void TrcPktProcEtmV4I::SetConfigConsts()
+{
+    m_cc_mask = (((uint32_t)1UL << m_config.ccSize()) - 1);
+    m_commit_opt1 = m_config.commitOpt1();
+    m_ccf2_commit_offset = (int)m_config.MaxSpecDepth() - 15;
+    m_cfg_vmid_bytes = m_config.vmidSize() / 8;
+    m_cfg_cid_bytes = m_config.cidSize() / 8;
+    m_excep_m_type = (m_config.coreProfile() == profile_CortexM) ? 1 : 0;
+}
+
 void TrcPktProcEtmV4I::throwBadSequenceError(const char *pszExtMsg)
 {
     m_curr_packet.updateErrType(ETM4_PKT_I_BAD_SEQUENCE);   // swap type for err type
     throw ocsdError(OCSD_ERR_SEV_ERROR, OCSD_ERR_BAD_PACKET_SEQ,m_packet_index,m_config.getTraceID(),pszExtMsg);
 }
 
+/*** skim mode ***/
+
+// add a continuation field at len to the packet length - false if incomplete in available data.
+static inline bool skimContField(const uint8_t *pData, const uint32_t avail, uint32_t &len, const uint32_t max_bytes = 0)
+{
+    uint32_t n = 0;
+    while ((len + n) < avail)
+    {
+        n++;
+        if (((pData[len + n - 1] & 0x80) == 0) || (n == max_bytes))
+        {
+            len += n;
+            return true;
+        }
+    }
+    return false;
+}
+
+ocsd_err_t TrcPktProcEtmV4I::getSkimSummary(ocsd_skim_summary_t *p_summary) const
+{
+    if (!p_summary)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    *p_summary = m_skim;
+    return OCSD_OK;
+}
+
+void TrcPktProcEtmV4I::skimResetState()
+{
+    memset(&m_skim, 0, sizeof(m_skim));
+    m_skim_partial.clear();
+    m_skim_zeros = 0;
+}
+
+ocsd_datapath_resp_t TrcPktProcEtmV4I::skimData(const uint32_t dataBlockSize, const uint8_t *pDataBlock, uint32_t *numBytesProcessed)
+{
+    uint32_t idx = 0, len;
+    bool bBad;
+
+    m_skim.num_bytes += dataBlockSize;
+    while (idx < dataBlockSize)
+    {
+        if (!m_is_sync)
+        {
+            // search for A-Sync - at least 11 x 0x00 followed by 0x80
+            const uint8_t byte = pDataBlock[idx++];
+            m_skim.unsync_bytes++;
+            if ((byte == 0x80) && (m_skim_zeros >= 11))
+            {
+                m_is_sync = true;
+                m_skim.unsync_bytes -= 12;
+                m_skim.num_sync++;
+                m_skim.num_packets++;
+                m_skim.hdr_counts[0x00]++;
+            }
+            m_skim_zeros = (byte == 0x00) ? m_skim_zeros + 1 : 0;
+        }
+        else if (m_skim_partial.size())
+        {
+            // packet split across blocks - add bytes until complete.
+            m_skim_partial.push_back(pDataBlock[idx++]);
+            if ((len = skimPktLen(&m_skim_partial[0], (uint32_t)m_skim_partial.size(), bBad)) != 0)
+            {
+                skimPkt(&m_skim_partial[0], len, bBad);
+                m_skim_partial.clear();
+            }
+        }
+        else if ((len = skimPktLen(pDataBlock + idx, dataBlockSize - idx, bBad)) != 0)
+        {
+            skimPkt(pDataBlock + idx, len, bBad);
+            idx += len;
+        }
+        else
+        {
+            m_skim_partial.assign(pDataBlock + idx, pDataBlock + dataBlockSize);
+            idx = dataBlockSize;
+        }
+    }
+    *numBytesProcessed = dataBlockSize;
+    return OCSD_RESP_CONT;
+}
+
+// length of packet at pData - 0 if more data needed. bBad set for reserved headers or bad sequences.
+uint32_t TrcPktProcEtmV4I::skimPktLen(const uint8_t *pData, const uint32_t avail, bool &bBad) const
+{
+    const uint8_t hdr = pData[0];
+    uint32_t len = 1;
+    uint32_t i;
+
+    bBad = false;
+    if ((m_i_table[hdr].pptkFn == &TrcPktProcEtmV4I::iPktReserved) ||
+        (m_i_table[hdr].pptkFn == &TrcPktProcEtmV4I::iPktInvalidCfg))
+    {
+        bBad = true;
+        return 1;
+    }
+
+    switch (m_i_table[hdr].pkt_type)
+    {
+    case ETM4_PKT_I_EXTENSION:
+        if (avail < 2)
+            return 0;
+        if ((pData[1] == 0x03) || (pData[1] == 0x05))
+            return 2;   // discard, overflow
+        if (pData[1] != 0x00)
+        {
+            bBad = true;
+            return 2;
+        }
+        // A-Sync - bad sequence ends at first non-zero byte.
+        for (i = 2; i < 12; i++)
+        {
+            if (i >= avail)
+                return 0;
+            if (pData[i] != 0x00)
+            {
+                bBad = (i != 11) || (pData[i] != 0x80);
+                return i + 1;
+            }
+        }
+        bBad = true;
+        return 12;
+
+    case ETM4_PKT_I_TRACE_INFO:
+        if (!skimContField(pData, avail, len))  // control bytes
+            return 0;
+        for (i = 0; i < 4; i++)                 // info, key, spec, cyct sections
+        {
+            if ((pData[1] & (0x1 << i)) && !skimContField(pData, avail, len))
+                return 0;
+        }
+        break;
+
+    case ETM4_PKT_I_TIMESTAMP:
+        if (!skimContField(pData, avail, len, 9))
+            return 0;
+        if ((hdr & 0x1) && !skimContField(pData, avail, len))
+            return 0;
+        break;
+
+    case ETM4_PKT_I_EXCEPT:
+        if (avail < 2)
+            return 0;
+        len = (pData[1] & 0x80) ? 3 : 2;
+        break;
+
+    case ETM4_PKT_I_CCNT_F1:
+        if (!m_commit_opt1 && !skimContField(pData, avail, len))
+            return 0;
+        if (!(hdr & 0x1) && !skimContField(pData, avail, len))
+            return 0;
+        break;
+
+    case ETM4_PKT_I_CCNT_F2:
+    case ETM4_PKT_I_COND_I_F3:
+    case ETM4_PKT_I_COND_RES_F3:
+        len = 2;
+        break;
+
+    case ETM4_PKT_I_COMMIT:
+    case ETM4_PKT_I_CANCEL_F1:
+    case ETM4_PKT_I_CANCEL_F1_MISPRED:
+    case ETM4_PKT_I_COND_I_F1:
+        if (!skimContField(pData, avail, len))
+            return 0;
+        break;
+
+    case ETM4_PKT_I_COND_RES_F1:
+        if (!skimContField(pData, avail, len))
+            return 0;
+        if (((hdr & 0xFC) != 0x6C) && !skimContField(pData, avail, len))
+            return 0;
+        break;
+
+    case ETM4_PKT_I_CTXT:
+        if (hdr & 0x1)
+        {
+            if (avail < 2)
+                return 0;
+            len = 2 + ((pData[1] & 0x40) ? m_cfg_vmid_bytes : 0) + ((pData[1] & 0x80) ? m_cfg_cid_bytes : 0);
+        }
+        break;
+
+    case ETM4_PKT_I_ADDR_CTXT_L_32IS0:
+    case ETM4_PKT_I_ADDR_CTXT_L_32IS1:
+    case ETM4_PKT_I_ADDR_CTXT_L_64IS0:
+    case ETM4_PKT_I_ADDR_CTXT_L_64IS1:
+        i = (hdr >= ETM4_PKT_I_ADDR_CTXT_L_64IS0) ? 9 : 5;  // index of context info byte
+        if (avail <= i)
+            return 0;
+        len = i + 1 + ((pData[i] & 0x40) ? m_cfg_vmid_bytes : 0) + ((pData[i] & 0x80) ? m_cfg_cid_bytes : 0);
+        break;
+
+    case ETM4_PKT_I_ADDR_S_IS0:
+    case ETM4_PKT_I_ADDR_S_IS1:
+        if (!skimContField(pData, avail, len, 2))
+            return 0;
+        break;
+
+    case ETM4_PKT_I_ADDR_L_32IS0:
+    case ETM4_PKT_I_ADDR_L_32IS1:
+        len = 5;
+        break;
+
+    case ETM4_PKT_I_ADDR_L_64IS0:
+    case ETM4_PKT_I_ADDR_L_64IS1:
+        len = 9;
+        break;
+
+    case ETM4_PKT_I_Q:
+        switch (hdr & 0xF)
+        {
+        case 0x5: case 0x6:     // short address + count
+            if (!skimContField(pData, avail, len, 2))
+                return 0;
+            // fall through
+        case 0x0: case 0x1: case 0x2: case 0xC: // count only
+            if (!skimContField(pData, avail, len))
+                return 0;
+            break;
+
+        case 0xA: case 0xB:     // long address + count
+            len = 5;
+            if (!skimContField(pData, avail, len))
+                return 0;
+            break;
+
+        case 0xF:
+            break;
+
+        default:
+            bBad = true;
+            break;
+        }
+        break;
+
+    default:
+        // single byte packets - atoms, events, markers etc.
+        break;
+    }
+    return (len <= avail) ? len : 0;
+}
+
+void TrcPktProcEtmV4I::skimPkt(const uint8_t *pData, const uint32_t len, const bool bBad)
+{
+    if (bBad)
+    {
+        m_skim.num_bad++;
+        return;
+    }
+
+    m_skim.num_packets++;
+    m_skim.hdr_counts[pData[0]]++;
+    switch (m_i_table[pData[0]].pkt_type)
+    {
+    case ETM4_PKT_I_EXTENSION:
+        if (pData[1] == 0x05)
+            m_skim.num_overflow++;
+        else if (pData[1] == 0x00)
+            m_skim.num_sync++;
+        break;
+
+    case ETM4_PKT_I_TIMESTAMP:
+        skimTimestamp(pData, len);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void TrcPktProcEtmV4I::skimTimestamp(const uint8_t *pData, const uint32_t len)
+{
+    uint64_t value = 0, mask = (uint64_t)-1LL;
+    uint32_t idx = 0;
+    bool lastByte = false;
+
+    // same field extraction as the full packet - partial updates of the low order bits.
+    // 9th byte has all 8 bits for [63:56].
+    while (!lastByte && (idx < 9) && ((idx + 1) < len))
+    {
+        lastByte = (pData[idx + 1] & 0x80) == 0;
+        value |= ((uint64_t)((idx == 8) ? pData[idx + 1] : (pData[idx + 1] & 0x7F))) << (idx * 7);
+        idx++;
+    }
+    if ((idx < 7) && m_skim.ts_valid)
+        mask = (1ULL << (idx * 7)) - 1;
+
+    m_skim.ts_last = (m_skim.ts_last & ~mask) | (value & mask);
+    if (!m_skim.ts_valid)
+    {
+        m_skim.ts_first = m_skim.ts_last;
+        m_skim.ts_valid = 1;
+    }
+}
 
 /* End of File trc_pkt_proc_etmv4i.cpp */
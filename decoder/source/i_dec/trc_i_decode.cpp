@@ -36,6 +36,8 @@
 #include "i_dec/trc_i_decode.h"
 #include "i_dec/trc_idec_arminst.h"
 
+#include <cstring>
+
 ocsd_err_t TrcIDecode::DecodeInstruction(ocsd_instr_info *instr_info)
 {
     ocsd_err_t err = OCSD_OK;
@@ -67,6 +69,24 @@ ocsd_err_t TrcIDecode::DecodeInstruction(ocsd_instr_info *instr_info)
     return err;
 }
 
+ocsd_err_t TrcIDecode::FindNextWaypoint(ocsd_instr_info *instr_info, const uint8_t *span, const uint32_t span_bytes, uint32_t *num_instr)
+{
+    ocsd_err_t err = OCSD_OK;
+    uint32_t last_offset = 0;
+
+    *num_instr = inst_find_next_waypoint(span, span_bytes, instr_info->isa, &last_offset);
+    if (*num_instr)
+    {
+        // full decode of the last skipped instruction leaves instr_info as the single instruction walk would.
+        instr_info->instr_addr += last_offset;
+        memcpy(&instr_info->opcode, span + last_offset, sizeof(uint32_t));
+        err = DecodeInstruction(instr_info);
+        if (err == OCSD_OK)
+            instr_info->instr_addr += instr_info->instr_size;
+    }
+    return err;
+}
+
 void TrcIDecode::SetArchVersion(ocsd_instr_info *instr_info)
 {
     uint16_t arch = 0x0700;
@@ -93,6 +113,13 @@ ocsd_err_t TrcIDecode::DecodeA32(ocsd_instr_info *instr_info)
     instr_info->next_isa = instr_info->isa; // assume same ISA 
     instr_info->is_link = 0;
 
+    // most instructions are not waypoints - reject these without running the full decode.
+    if(!inst_ARM_maybe_waypoint(instr_info->opcode))
+    {
+        instr_info->is_conditional = inst_ARM_is_conditional(instr_info->opcode);
+        return OCSD_OK;
+    }
+
     if(inst_ARM_is_indirect_branch(instr_info->opcode))
     {
         instr_info->type = OCSD_INSTR_BR_INDIRECT;
@@ -146,6 +173,13 @@ ocsd_err_t TrcIDecode::DecodeA64(ocsd_instr_info *instr_info)
     instr_info->type =  OCSD_INSTR_OTHER;  // default type
     instr_info->next_isa = instr_info->isa; // assume same ISA 
     instr_info->is_link = 0;
+
+    // most instructions are not waypoints - reject these without running the full decode.
+    if(!inst_A64_maybe_waypoint(instr_info->opcode))
+    {
+        instr_info->is_conditional = 0;
+        return OCSD_OK;
+    }
     
     if(inst_A64_is_indirect_branch_link(instr_info->opcode, &instr_info->is_link))
     {
@@ -205,6 +239,12 @@ ocsd_err_t TrcIDecode::DecodeT32(ocsd_instr_info *instr_info)
     instr_info->is_link = 0;
     instr_info->is_conditional = 0;
 
+    // most instructions are not waypoints - reject these without running the full decode.
+    if(!inst_Thumb_maybe_waypoint(instr_info->opcode))
+    {
+        instr_info->thumb_it_conditions = 0;
+        return OCSD_OK;
+    }
 
     if(inst_Thumb_is_direct_branch_link(instr_info->opcode,&instr_info->is_link, &instr_info->is_conditional))
     {
@@ -41,12 +41,22 @@ block identification and trace decode.
 
 #include <stddef.h>  /* for NULL */
 #include <assert.h>
+#include <string.h>  /* for memcpy */
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
-static ocsd_instr_subtype instr_sub_type = OCSD_S_INSTR_NONE;
+
+/* per thread decode state - instruction decoders may run on several threads at once */
+static thread_local ocsd_instr_subtype instr_sub_type = OCSD_S_INSTR_NONE;
 
 /* need to spot the architecture version for certain instructions */
-static uint16_t arch_version = 0x70;
+static thread_local uint16_t arch_version = 0x70;
 
 ocsd_instr_subtype get_instr_subtype()
 {
@@ -659,6 +669,275 @@ arm_barrier_t inst_A64_barrier(uint32_t inst)
     }
 }
 
+/*
+Lookup tables for fast rejection of instructions that cannot be waypoints.
+Tables are generated at compile time from the opcode bits tested by the 
+queries above - any encoding accepted by those queries must map to a 
+none LUT_NONE entry.
+*/
+typedef enum {
+    LUT_NONE,           /* cannot be a waypoint */
+    LUT_CHECK,          /* may be a waypoint - run full queries */
+    LUT_CHECK_RD_PC,    /* may be a waypoint if bits[15:12] == 0xF (Rd / Rt == PC) */
+    LUT_CHECK_PC_BIT    /* may be a waypoint if bit[15] set (PC in register list) */
+} lut_entry_t;
+
+#define LUT_ROW4(f, n)  f(n), f((n) + 1), f((n) + 2), f((n) + 3)
+#define LUT_ROW16(f, n) LUT_ROW4(f, n), LUT_ROW4(f, (n) + 4), LUT_ROW4(f, (n) + 8), LUT_ROW4(f, (n) + 12)
+#define LUT_ROW64(f, n) LUT_ROW16(f, n), LUT_ROW16(f, (n) + 16), LUT_ROW16(f, (n) + 32), LUT_ROW16(f, (n) + 48)
+#define LUT_256(f, n)   LUT_ROW64(f, n), LUT_ROW64(f, (n) + 64), LUT_ROW64(f, (n) + 128), LUT_ROW64(f, (n) + 192)
+
+/* A32 - index [8] = NV space, [7:0] = inst[27:20] */
+static constexpr uint8_t arm_lut_entry(const uint32_t idx)
+{
+    return (idx & 0x100) ?
+        /* NV space */
+        ((((idx & 0xE0) == 0xA0) ||         /* BLX (imm) */
+          ((idx & 0xE5) == 0x81) ||         /* RFE */
+          ((idx & 0xFF) == 0x57) ||         /* DSB, DMB, ISB */
+          ((idx & 0xFF) == 0xE0)) ?         /* CP15 barriers */
+          LUT_CHECK : LUT_NONE) :
+        /* conditional space */
+        ((((idx & 0xE0) == 0xA0) ||         /* B, BL */
+          (idx == 0x12) ||                  /* BX, BLX (reg), BXJ */
+          (idx == 0xE0)) ?                  /* CP15 barriers */
+          LUT_CHECK :
+         ((idx & 0xE1) == 0x81) ?           /* LDM {..,pc} */
+          LUT_CHECK_PC_BIT :
+         (((idx & 0xE0) == 0x00) ||         /* DP PC,reg, MOV PC */
+          ((idx & 0xE0) == 0x20) ||         /* DP PC,imm, WFI, WFE */
+          ((idx & 0xE5) == 0x41) ||         /* LDR PC,imm */
+          ((idx & 0xE5) == 0x61)) ?         /* LDR PC,reg */
+          LUT_CHECK_RD_PC : LUT_NONE);
+}
+
+/* T32 - index inst[31:24] (first halfword in top 16 bits) */
+static constexpr uint8_t thumb_lut_entry(const uint32_t idx)
+{
+    return (((idx & 0xF0) == 0xD0) ||   /* B<c> (T1) */
+            ((idx & 0xF8) == 0xE0) ||   /* B (T2) */
+            ((idx & 0xF8) == 0xF0) ||   /* B (T3, T4), BL, BLX, BXJ, SUBS PC,LR, barriers, WFI, WFE (T2) */
+            ((idx & 0xF5) == 0xB1) ||   /* CB(N)Z */
+            (idx == 0xBF) ||            /* IT, WFI, WFE (T1) */
+            (idx == 0x47) ||            /* BX, BLX (reg) */
+            (idx == 0xBD) ||            /* POP {pc} */
+            ((idx & 0xFD) == 0x44) ||   /* MOV PC, ADD PC */
+            ((idx & 0xFE) == 0xE8) ||   /* TBB, TBH, RFE, LDM PC */
+            (idx == 0xEE) ||            /* CP15 barriers */
+            (idx == 0xF8)) ?            /* LDR PC */
+            LUT_CHECK : LUT_NONE;
+}
+
+/* A64 - index inst[31:24] */
+static constexpr uint8_t a64_lut_entry(const uint32_t idx)
+{
+    return (((idx & 0x7C) == 0x34) ||   /* CB, TB */
+            (idx == 0x54) ||            /* B<cond> */
+            ((idx & 0x7C) == 0x14) ||   /* B, BL */
+            (idx == 0xD5) ||            /* barriers, WFI, WFE */
+            ((idx & 0xFE) == 0xD6)) ?   /* BR, BLR, RET, ERET, v8.3 pointer auth branches */
+            LUT_CHECK : LUT_NONE;
+}
+
+static constexpr uint8_t s_arm_lut[512] = { LUT_256(arm_lut_entry, 0), LUT_256(arm_lut_entry, 0x100) };
+static constexpr uint8_t s_thumb_lut[256] = { LUT_256(thumb_lut_entry, 0) };
+static constexpr uint8_t s_a64_lut[256] = { LUT_256(a64_lut_entry, 0) };
+
+int inst_ARM_maybe_waypoint(uint32_t inst)
+{
+    uint32_t idx = ((inst >> 20) & 0xFF) | (((inst & 0xf0000000) == 0xf0000000) ? 0x100 : 0);
+
+    switch (s_arm_lut[idx])
+    {
+    case LUT_CHECK:
+        return 1;
+    case LUT_CHECK_RD_PC:
+        return (inst & 0x0000f000) == 0x0000f000;
+    case LUT_CHECK_PC_BIT:
+        return (inst & 0x00008000) != 0;
+    }
+    return 0;
+}
+
+int inst_Thumb_maybe_waypoint(uint32_t inst)
+{
+    return s_thumb_lut[inst >> 24] != LUT_NONE;
+}
+
+int inst_A64_maybe_waypoint(uint32_t inst)
+{
+    return s_a64_lut[inst >> 24] != LUT_NONE;
+}
+
+static inline uint32_t span_opcode(const uint8_t *span, const uint32_t offset)
+{
+    uint32_t inst;
+    memcpy(&inst, span + offset, sizeof(uint32_t));
+    return inst;
+}
+
+/* scan fixed size A64 opcodes - return index of first possible waypoint, or num_instr if none. */
+static uint32_t a64_scan_scalar(const uint8_t *span, const uint32_t start, const uint32_t num_instr)
+{
+    uint32_t idx = start;
+    while ((idx < num_instr) && !inst_A64_maybe_waypoint(span_opcode(span, idx * 4)))
+        idx++;
+    return idx;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(__ARM_NEON) && defined(__aarch64__))
+/* 
+SIMD versions of the A64 lookup table - compares on the major opcode bits, 
+must match the encodings in a64_lut_entry().
+*/
+#define A64_SCAN_MASK_A     0x7C000000  /* CB, TB / B, BL */
+#define A64_SCAN_CB_TB      0x34000000
+#define A64_SCAN_B_BL       0x14000000
+#define A64_SCAN_MASK_B     0xFF000000  /* B<cond> / system */
+#define A64_SCAN_B_COND     0x54000000
+#define A64_SCAN_SYS        0xD5000000
+#define A64_SCAN_MASK_C     0xFE000000  /* branch register */
+#define A64_SCAN_BR_REG     0xD6000000
+
+/* index of the first lane set in a compare result mask */
+static inline uint32_t first_lane(const int lanes)
+{
+    uint32_t lane = 0;
+    while (!(lanes & (1 << lane)))
+        lane++;
+    return lane;
+}
+#endif
+
+#if defined(__AVX2__)
+#define A64_SCAN_LANES 8
+static uint32_t a64_scan_simd(const uint8_t *span, const uint32_t num_instr)
+{
+    const __m256i mask_a = _mm256_set1_epi32((int)A64_SCAN_MASK_A);
+    const __m256i mask_b = _mm256_set1_epi32((int)A64_SCAN_MASK_B);
+    const __m256i mask_c = _mm256_set1_epi32((int)A64_SCAN_MASK_C);
+    const __m256i cb_tb = _mm256_set1_epi32((int)A64_SCAN_CB_TB);
+    const __m256i b_bl = _mm256_set1_epi32((int)A64_SCAN_B_BL);
+    const __m256i b_cond = _mm256_set1_epi32((int)A64_SCAN_B_COND);
+    const __m256i sys = _mm256_set1_epi32((int)A64_SCAN_SYS);
+    const __m256i br_reg = _mm256_set1_epi32((int)A64_SCAN_BR_REG);
+    uint32_t idx = 0;
+
+    while (idx + A64_SCAN_LANES <= num_instr)
+    {
+        __m256i ops = _mm256_loadu_si256((const __m256i *)(span + idx * 4));
+        __m256i op_a = _mm256_and_si256(ops, mask_a);
+        __m256i op_b = _mm256_and_si256(ops, mask_b);
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi32(op_a, cb_tb), _mm256_cmpeq_epi32(op_a, b_bl));
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(op_b, b_cond));
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(op_b, sys));
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(_mm256_and_si256(ops, mask_c), br_reg));
+        int lanes = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+        if (lanes)
+            return idx + first_lane(lanes);
+        idx += A64_SCAN_LANES;
+    }
+    return a64_scan_scalar(span, idx, num_instr);
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+#define A64_SCAN_LANES 4
+static uint32_t a64_scan_simd(const uint8_t *span, const uint32_t num_instr)
+{
+    const __m128i mask_a = _mm_set1_epi32((int)A64_SCAN_MASK_A);
+    const __m128i mask_b = _mm_set1_epi32((int)A64_SCAN_MASK_B);
+    const __m128i mask_c = _mm_set1_epi32((int)A64_SCAN_MASK_C);
+    const __m128i cb_tb = _mm_set1_epi32((int)A64_SCAN_CB_TB);
+    const __m128i b_bl = _mm_set1_epi32((int)A64_SCAN_B_BL);
+    const __m128i b_cond = _mm_set1_epi32((int)A64_SCAN_B_COND);
+    const __m128i sys = _mm_set1_epi32((int)A64_SCAN_SYS);
+    const __m128i br_reg = _mm_set1_epi32((int)A64_SCAN_BR_REG);
+    uint32_t idx = 0;
+
+    while (idx + A64_SCAN_LANES <= num_instr)
+    {
+        __m128i ops = _mm_loadu_si128((const __m128i *)(span + idx * 4));
+        __m128i op_a = _mm_and_si128(ops, mask_a);
+        __m128i op_b = _mm_and_si128(ops, mask_b);
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi32(op_a, cb_tb), _mm_cmpeq_epi32(op_a, b_bl));
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi32(op_b, b_cond));
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi32(op_b, sys));
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi32(_mm_and_si128(ops, mask_c), br_reg));
+        int lanes = _mm_movemask_ps(_mm_castsi128_ps(hit));
+        if (lanes)
+            return idx + first_lane(lanes);
+        idx += A64_SCAN_LANES;
+    }
+    return a64_scan_scalar(span, idx, num_instr);
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define A64_SCAN_LANES 4
+static uint32_t a64_scan_simd(const uint8_t *span, const uint32_t num_instr)
+{
+    const uint32x4_t mask_a = vdupq_n_u32(A64_SCAN_MASK_A);
+    const uint32x4_t mask_b = vdupq_n_u32(A64_SCAN_MASK_B);
+    const uint32x4_t mask_c = vdupq_n_u32(A64_SCAN_MASK_C);
+    uint32_t idx = 0;
+
+    while (idx + A64_SCAN_LANES <= num_instr)
+    {
+        uint32x4_t ops = vreinterpretq_u32_u8(vld1q_u8(span + idx * 4));
+        uint32x4_t op_a = vandq_u32(ops, mask_a);
+        uint32x4_t op_b = vandq_u32(ops, mask_b);
+        uint32x4_t hit = vorrq_u32(vceqq_u32(op_a, vdupq_n_u32(A64_SCAN_CB_TB)), vceqq_u32(op_a, vdupq_n_u32(A64_SCAN_B_BL)));
+        hit = vorrq_u32(hit, vceqq_u32(op_b, vdupq_n_u32(A64_SCAN_B_COND)));
+        hit = vorrq_u32(hit, vceqq_u32(op_b, vdupq_n_u32(A64_SCAN_SYS)));
+        hit = vorrq_u32(hit, vceqq_u32(vandq_u32(ops, mask_c), vdupq_n_u32(A64_SCAN_BR_REG)));
+        if (vmaxvq_u32(hit))
+            return a64_scan_scalar(span, idx, idx + A64_SCAN_LANES);
+        idx += A64_SCAN_LANES;
+    }
+    return a64_scan_scalar(span, idx, num_instr);
+}
+#else
+static uint32_t a64_scan_simd(const uint8_t *span, const uint32_t num_instr)
+{
+    return a64_scan_scalar(span, 0, num_instr);
+}
+#endif
+
+uint32_t inst_find_next_waypoint(const uint8_t *span, const uint32_t span_bytes, const ocsd_isa isa, uint32_t *last_offset)
+{
+    uint32_t num_instr = 0, offset = 0;
+
+    switch (isa)
+    {
+    case ocsd_isa_aarch64:
+        num_instr = a64_scan_simd(span, span_bytes / 4);
+        offset = num_instr * 4;
+        break;
+
+    case ocsd_isa_arm:
+        while ((offset + 4 <= span_bytes) && !inst_ARM_maybe_waypoint(span_opcode(span, offset)))
+        {
+            offset += 4;
+            num_instr++;
+        }
+        break;
+
+    case ocsd_isa_thumb2:
+        /* first halfword of the instruction is in span[offset+1:offset] - test the top byte */
+        while ((offset + 4 <= span_bytes) && !inst_Thumb_maybe_waypoint((uint32_t)span[offset + 1] << 24))
+        {
+            *last_offset = offset;
+            offset += is_wide_thumb((uint16_t)(span[offset] | (span[offset + 1] << 8))) ? 4 : 2;
+            num_instr++;
+        }
+        return num_instr;
+
+    default:
+        break;
+    }
+
+    if (num_instr)
+        *last_offset = offset - 4;
+    return num_instr;
+}
+
 int inst_ARM_is_UDF(uint32_t inst)
 {
     return (inst & 0xfff000f0) == 0xe7f000f0;
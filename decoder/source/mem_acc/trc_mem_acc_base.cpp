@@ -37,6 +37,8 @@
 #include "mem_acc/trc_mem_acc_file.h"
 #include "mem_acc/trc_mem_acc_cb.h"
 #include "mem_acc/trc_mem_acc_bufptr.h"
+#include "mem_acc/trc_mem_acc_image.h"
+#include "mem_acc/trc_mem_acc_elf.h"
 
 #include <sstream>
 #include <iomanip>
@@ -73,6 +75,35 @@ ocsd_err_t TrcMemAccFactory::CreateCBAccessor(TrcMemAccessorBase **pAccessor, co
     return err;
 }
 
+ocsd_err_t TrcMemAccFactory::CreateImageAccessor(TrcMemAccessorBase **pAccessor, const std::shared_ptr<const TrcMemImage> &image)
+{
+    ocsd_err_t err = OCSD_OK;
+    TrcMemAccessorBase *pAcc = 0;
+    if(!image)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    pAcc = new (std::nothrow) TrcMemAccImage(image);
+    if(pAcc == 0)
+        err = OCSD_ERR_MEM;
+    *pAccessor = pAcc;
+    return err;
+}
+
+ocsd_err_t TrcMemAccFactory::CreateElfAccessor(TrcMemAccessorBase **pAccessor, const std::string &pathToFile, const ocsd_vaddr_t load_bias)
+{
+    ocsd_err_t err = OCSD_OK;
+    TrcMemAccElf *pAcc = 0;
+    pAcc = new (std::nothrow) TrcMemAccElf();
+    if(pAcc == 0)
+        err = OCSD_ERR_MEM;
+    else if((err = pAcc->initAccessor(pathToFile, load_bias)) != OCSD_OK)
+    {
+        delete pAcc;
+        pAcc = 0;
+    }
+    *pAccessor = pAcc;
+    return err;
+}
+
 /** Accessor Destruction */
 void TrcMemAccFactory::DestroyAccessor(TrcMemAccessorBase *pAccessor)
 {
@@ -84,6 +115,8 @@ void TrcMemAccFactory::DestroyAccessor(TrcMemAccessorBase *pAccessor)
 
     case TrcMemAccessorBase::MEMACC_CB_IF:
     case TrcMemAccessorBase::MEMACC_BUFPTR:
+    case TrcMemAccessorBase::MEMACC_IMAGE:
+    case TrcMemAccessorBase::MEMACC_ELF:
     delete pAccessor;
         break;
 
@@ -93,6 +126,11 @@ void TrcMemAccFactory::DestroyAccessor(TrcMemAccessorBase *pAccessor)
 }
 
 
+void TrcMemAccessorBase::getAddrRanges(std::vector<addr_range_t> &ranges) const
+{
+    ranges.push_back(addr_range_t(m_startAddress, m_endAddress));
+}
+
 /* memory access info logging */
 void TrcMemAccessorBase::getMemAccString(std::string &accStr) const
 {
@@ -112,6 +150,14 @@ void TrcMemAccessorBase::getMemAccString(std::string &accStr) const
         oss << "CB  Acc; Range::0x";
         break;
 
+    case MEMACC_IMAGE:
+        oss << "Img Acc; Range::0x";
+        break;
+
+    case MEMACC_ELF:
+        oss << "ElfAcc; Range::0x";
+        break;
+
     default: 
         oss << "UnknAcc; Range::0x";
         break;
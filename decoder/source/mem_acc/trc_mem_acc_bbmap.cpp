@@ -0,0 +1,365 @@
+/*
+ * \file       trc_mem_acc_bbmap.cpp
+ * \brief      OpenCSD : Precomputed basic block map for a memory image.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <thread>
+
+#include "mem_acc/trc_mem_acc_bbmap.h"
+#include "i_dec/trc_i_decode.h"
+
+/* sidecar file layout - host byte order */
+static const char bb_map_magic[8] = { 'O', 'C', 'S', 'D', 'B', 'B', 'M', 'P' };
+static const uint32_t bb_map_version = 1;
+
+typedef struct _bb_file_hdr {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_maps;
+} bb_file_hdr_t;
+
+typedef struct _bb_map_hdr {
+    uint64_t key;
+    uint64_t s_address;
+    uint32_t size;
+    uint32_t num_blocks;
+    uint8_t isa;
+    uint8_t arch;
+    uint8_t dsb_dmb_wp;
+    uint8_t wfi_wfe_br;
+    uint8_t reserved[4];
+} bb_map_hdr_t;
+
+/* do not split small regions between threads */
+#define BB_MAP_MIN_CHUNK 0x10000
+
+ocsd_err_t TrcBBMap::build(const uint8_t *p_buffer, const uint32_t size, const ocsd_vaddr_t s_address, const ocsd_instr_info &cfg, const int num_threads, TrcBBMapPtr &map)
+{
+    if((p_buffer == 0) || (size == 0))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    if((cfg.isa != ocsd_isa_aarch64) && (cfg.isa != ocsd_isa_arm) && (cfg.isa != ocsd_isa_thumb2))
+        return OCSD_ERR_UNSUPPORTED_ISA;
+
+    TrcBBMap *p_map = new (std::nothrow) TrcBBMap();
+    if(!p_map)
+        return OCSD_ERR_MEM;
+
+    p_map->m_key = calcKey(p_buffer, size);
+    p_map->m_s_address = s_address;
+    p_map->m_size = size;
+    p_map->m_isa = (uint8_t)cfg.isa;
+    p_map->m_arch = (uint8_t)cfg.pe_type.arch;
+    p_map->m_dsb_dmb_wp = cfg.dsb_dmb_waypoints ? 1 : 0;
+    p_map->m_wfi_wfe_br = cfg.wfi_wfe_branch ? 1 : 0;
+
+    // fixed width instructions can be decoded from any aligned offset, so split the region.
+    int num_chunks = 1;
+    if(cfg.isa != ocsd_isa_thumb2)
+    {
+        num_chunks = num_threads;
+        if(num_chunks <= 0)
+            num_chunks = (int)std::thread::hardware_concurrency();
+        if((uint32_t)num_chunks > (size / BB_MAP_MIN_CHUNK))
+            num_chunks = (int)(size / BB_MAP_MIN_CHUNK);
+        if(num_chunks < 1)
+            num_chunks = 1;
+    }
+    uint32_t chunk_size = ((size / num_chunks) + 3) & ~0x3;
+
+    try
+    {
+        std::vector<std::vector<bb_entry_t> > chunk_wps(num_chunks);
+        std::vector<std::thread> workers;
+        for(int i = 1; i < num_chunks; i++)
+        {
+            uint32_t st = chunk_size * i;
+            uint32_t en = (i == num_chunks - 1) ? size : st + chunk_size;
+            workers.push_back(std::thread(buildChunk, p_buffer, size, s_address, std::cref(cfg), st, en, std::ref(chunk_wps[i])));
+        }
+        buildChunk(p_buffer, size, s_address, cfg, 0, (num_chunks == 1) ? size : chunk_size, chunk_wps[0]);
+        for(std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); it++)
+            it->join();
+
+        // join the chunks - each block starts after the previous waypoint.
+        size_t num_blocks = 0;
+        for(int i = 0; i < num_chunks; i++)
+            num_blocks += chunk_wps[i].size();
+        p_map->m_blocks.reserve(num_blocks);
+
+        uint32_t blk_st = 0;
+        for(int i = 0; i < num_chunks; i++)
+        {
+            for(std::vector<bb_entry_t>::iterator it = chunk_wps[i].begin(); it != chunk_wps[i].end(); it++)
+            {
+                it->st_offset = blk_st;
+                if(cfg.isa != ocsd_isa_thumb2)
+                    it->num_instr = ((it->wp_offset - blk_st) >> 2) + 1;
+                p_map->m_blocks.push_back(*it);
+                blk_st = it->wp_offset + it->wp_size;
+            }
+        }
+    }
+    catch(...)
+    {
+        delete p_map;
+        return OCSD_ERR_MEM;
+    }
+    map.reset(p_map);
+    return OCSD_OK;
+}
+
+// sweep the instructions starting in [st_offset, en_offset), recording waypoints.
+void TrcBBMap::buildChunk(const uint8_t *p_buffer, const uint32_t size, const ocsd_vaddr_t s_address, const ocsd_instr_info &cfg, const uint32_t st_offset, const uint32_t en_offset, std::vector<bb_entry_t> &wps)
+{
+    TrcIDecode idecode;
+    ocsd_instr_info instr_info = cfg;
+    bb_entry_t entry;
+    uint32_t offset = st_offset;
+    uint32_t blk_st = st_offset;
+    uint32_t num_instr = 0;
+
+    memset(&entry, 0, sizeof(bb_entry_t));
+
+    // decode needs a full opcode word - as the PE decoders memory read.
+    while((offset < en_offset) && (size - offset >= 4))
+    {
+        instr_info.instr_addr = s_address + offset;
+        memcpy(&instr_info.opcode, p_buffer + offset, sizeof(uint32_t));
+        if(idecode.DecodeInstruction(&instr_info) != OCSD_OK)
+            break;
+        num_instr++;
+
+        if(instr_info.type != OCSD_INSTR_OTHER)
+        {
+            entry.st_offset = blk_st;
+            entry.wp_offset = offset;
+            entry.num_instr = num_instr;
+            entry.br_offset = (instr_info.type == OCSD_INSTR_BR) ? (int64_t)(instr_info.branch_addr - instr_info.instr_addr) : 0;
+            entry.wp_type = (uint8_t)instr_info.type;
+            entry.wp_sub_type = (uint8_t)instr_info.sub_type;
+            entry.wp_size = instr_info.instr_size;
+            entry.next_isa = (uint8_t)instr_info.next_isa;
+            entry.flags = (instr_info.is_link ? BB_FLG_LINK : 0) | (instr_info.is_conditional ? BB_FLG_COND : 0);
+            wps.push_back(entry);
+            blk_st = offset + instr_info.instr_size;
+            num_instr = 0;
+        }
+        offset += instr_info.instr_size;
+    }
+}
+
+uint64_t TrcBBMap::calcKey(const uint8_t *p_buffer, const uint32_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(uint32_t i = 0; i < size; i++)
+    {
+        hash ^= p_buffer[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+const bool TrcBBMap::lookup(const ocsd_vaddr_t base, ocsd_instr_info *instr_info, uint32_t *num_instr) const
+{
+    if((instr_info->isa != (ocsd_isa)m_isa) || 
+       (instr_info->pe_type.arch != (ocsd_arch_version_t)m_arch) ||
+       ((instr_info->dsb_dmb_waypoints ? 1 : 0) != m_dsb_dmb_wp) || 
+       ((instr_info->wfi_wfe_branch ? 1 : 0) != m_wfi_wfe_br))
+        return false;
+
+    if((instr_info->instr_addr < base) || ((instr_info->instr_addr - base) >= m_size))
+        return false;
+    const uint32_t offset = (uint32_t)(instr_info->instr_addr - base);
+
+    // first block with the waypoint at or after the offset.
+    std::vector<bb_entry_t>::const_iterator it = m_blocks.begin();
+    size_t count = m_blocks.size();
+    while(count > 0)
+    {
+        size_t step = count / 2;
+        if(it[step].wp_offset < offset)
+        {
+            it += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+    if((it == m_blocks.end()) || (it->st_offset > offset))
+        return false;
+
+    if(m_isa == ocsd_isa_thumb2)
+    {
+        // instruction boundaries within a T32 block are not recorded.
+        if(offset != it->st_offset)
+            return false;
+        *num_instr = it->num_instr;
+    }
+    else
+    {
+        if((offset - it->st_offset) & 0x3)
+            return false;
+        *num_instr = ((it->wp_offset - offset) >> 2) + 1;
+    }
+
+    const ocsd_vaddr_t wp_addr = base + it->wp_offset;
+    instr_info->type = (ocsd_instr_type)it->wp_type;
+    instr_info->sub_type = (ocsd_instr_subtype)it->wp_sub_type;
+    instr_info->instr_size = it->wp_size;
+    instr_info->next_isa = (ocsd_isa)it->next_isa;
+    instr_info->is_link = (it->flags & BB_FLG_LINK) ? 1 : 0;
+    instr_info->is_conditional = (it->flags & BB_FLG_COND) ? 1 : 0;
+    if(instr_info->type == OCSD_INSTR_BR)
+    {
+        instr_info->branch_addr = wp_addr + it->br_offset;
+        // A32 and T32 branch destinations are calculated in 32 bits.
+        if(m_isa != ocsd_isa_aarch64)
+            instr_info->branch_addr &= 0xFFFFFFFF;
+    }
+    instr_info->instr_addr = wp_addr + it->wp_size;
+    return true;
+}
+
+void TrcBBMap::getMapString(std::string &mapStr) const
+{
+    static const char *isa_names[] = { "A32", "T32", "A64", "TEE", "Jazelle", "custom", "unknown" };
+    char buffer[128];
+
+    sprintf(buffer, "BBMap %s: 0x%010llX:0x%010llX; %u blocks; key 0x%016llX", 
+        isa_names[(m_isa > ocsd_isa_unknown) ? ocsd_isa_unknown : m_isa],
+        (unsigned long long)m_s_address, (unsigned long long)(m_s_address + m_size - 1),
+        (unsigned)m_blocks.size(), (unsigned long long)m_key);
+    mapStr = buffer;
+}
+
+ocsd_err_t TrcBBMap::saveFile(const std::string &pathToFile, const std::vector<TrcBBMapPtr> &maps)
+{
+    std::ofstream map_file(pathToFile.c_str(), std::ofstream::binary | std::ofstream::trunc);
+    if(!map_file.is_open())
+        return OCSD_ERR_FILE_ERROR;
+
+    bb_file_hdr_t file_hdr;
+    memcpy(file_hdr.magic, bb_map_magic, sizeof(bb_map_magic));
+    file_hdr.version = bb_map_version;
+    file_hdr.num_maps = (uint32_t)maps.size();
+    map_file.write((const char *)&file_hdr, sizeof(bb_file_hdr_t));
+
+    for(std::vector<TrcBBMapPtr>::const_iterator it = maps.begin(); it != maps.end(); it++)
+    {
+        const TrcBBMap *p_map = it->get();
+        bb_map_hdr_t map_hdr;
+        memset(&map_hdr, 0, sizeof(bb_map_hdr_t));
+        map_hdr.key = p_map->m_key;
+        map_hdr.s_address = p_map->m_s_address;
+        map_hdr.size = p_map->m_size;
+        map_hdr.num_blocks = (uint32_t)p_map->m_blocks.size();
+        map_hdr.isa = p_map->m_isa;
+        map_hdr.arch = p_map->m_arch;
+        map_hdr.dsb_dmb_wp = p_map->m_dsb_dmb_wp;
+        map_hdr.wfi_wfe_br = p_map->m_wfi_wfe_br;
+        map_file.write((const char *)&map_hdr, sizeof(bb_map_hdr_t));
+        if(map_hdr.num_blocks)
+            map_file.write((const char *)p_map->m_blocks.data(), map_hdr.num_blocks * sizeof(bb_entry_t));
+    }
+    map_file.close();
+    return map_file ? OCSD_OK : OCSD_ERR_FILE_ERROR;
+}
+
+ocsd_err_t TrcBBMap::loadFile(const std::string &pathToFile, std::vector<TrcBBMapPtr> &maps)
+{
+    std::ifstream map_file(pathToFile.c_str(), std::ifstream::binary);
+    if(!map_file.is_open())
+        return OCSD_ERR_FILE_ERROR;
+
+    bb_file_hdr_t file_hdr;
+    map_file.read((char *)&file_hdr, sizeof(bb_file_hdr_t));
+    if(!map_file || memcmp(file_hdr.magic, bb_map_magic, sizeof(bb_map_magic)) || (file_hdr.version != bb_map_version))
+        return OCSD_ERR_BB_MAP_INVALID;
+
+    std::vector<TrcBBMapPtr> loaded;
+    try
+    {
+        for(uint32_t i = 0; i < file_hdr.num_maps; i++)
+        {
+            bb_map_hdr_t map_hdr;
+            map_file.read((char *)&map_hdr, sizeof(bb_map_hdr_t));
+            if(!map_file || (map_hdr.size == 0) ||
+               ((map_hdr.isa != ocsd_isa_aarch64) && (map_hdr.isa != ocsd_isa_arm) && (map_hdr.isa != ocsd_isa_thumb2)))
+                return OCSD_ERR_BB_MAP_INVALID;
+
+            std::shared_ptr<TrcBBMap> map(new TrcBBMap());
+            map->m_key = map_hdr.key;
+            map->m_s_address = (ocsd_vaddr_t)map_hdr.s_address;
+            map->m_size = map_hdr.size;
+            map->m_isa = map_hdr.isa;
+            map->m_arch = map_hdr.arch;
+            map->m_dsb_dmb_wp = map_hdr.dsb_dmb_wp;
+            map->m_wfi_wfe_br = map_hdr.wfi_wfe_br;
+
+            // a block cannot be smaller than a T32 instruction.
+            if(map_hdr.num_blocks > (map_hdr.size / 2))
+                return OCSD_ERR_BB_MAP_INVALID;
+            map->m_blocks.resize(map_hdr.num_blocks);
+            if(map_hdr.num_blocks)
+                map_file.read((char *)map->m_blocks.data(), map_hdr.num_blocks * sizeof(bb_entry_t));
+            if(!map_file)
+                return OCSD_ERR_BB_MAP_INVALID;
+
+            // blocks must be ordered, contiguous and within the region, lookups rely on this.
+            uint32_t blk_st = 0;
+            for(std::vector<bb_entry_t>::const_iterator it = map->m_blocks.begin(); it != map->m_blocks.end(); it++)
+            {
+                if((it->st_offset != blk_st) || (it->wp_offset < it->st_offset) || (it->num_instr == 0) ||
+                   ((it->wp_size != 2) && (it->wp_size != 4)) ||
+                   ((uint64_t)it->wp_offset + it->wp_size > map_hdr.size))
+                    return OCSD_ERR_BB_MAP_INVALID;
+                blk_st = it->wp_offset + it->wp_size;
+            }
+            loaded.push_back(map);
+        }
+        maps.insert(maps.end(), loaded.begin(), loaded.end());
+    }
+    catch(...)
+    {
+        return OCSD_ERR_MEM;
+    }
+    return OCSD_OK;
+}
+
+/* End of File trc_mem_acc_bbmap.cpp */
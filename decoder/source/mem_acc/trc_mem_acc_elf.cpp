@@ -0,0 +1,351 @@
+/*
+ * \file       trc_mem_acc_elf.cpp
+ * \brief      OpenCSD : ELF file memory accessor - executable segments mapped on first access.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "mem_acc/trc_mem_acc_elf.h"
+
+/* ELF format values used - defined here as elf.h is not available on all hosts */
+#define ELF_IDENT_SIZE  16
+#define ELF_CLASS_32    1
+#define ELF_CLASS_64    2
+#define ELF_DATA_LSB    1
+#define ELF_DATA_MSB    2
+#define ELF_PT_LOAD     1
+#define ELF_PF_X        0x1
+#define ELF_PN_XNUM     0xFFFF
+
+#define ELF32_EHDR_SIZE 52
+#define ELF64_EHDR_SIZE 64
+#define ELF32_PHDR_SIZE 32
+#define ELF64_PHDR_SIZE 56
+
+/* read a value of the file byte order from a header buffer */
+static uint64_t elf_read_val(const uint8_t *p_buf, const int bytes, const bool big_endian)
+{
+    uint64_t val = 0;
+    for (int i = 0; i < bytes; i++)
+    {
+        if (big_endian)
+            val = (val << 8) | p_buf[i];
+        else
+            val |= ((uint64_t)p_buf[i]) << (8 * i);
+    }
+    return val;
+}
+
+/***************************************************/
+/* ELF header parsing                              */
+/***************************************************/
+
+const bool TrcMemAccElf::isElfFile(const std::string &pathToFile)
+{
+    uint8_t ident[4] = { 0 };
+    std::ifstream elf_file(pathToFile.c_str(), std::ifstream::binary);
+    if (!elf_file.is_open())
+        return false;
+    elf_file.read((char *)ident, sizeof(ident));
+    return (elf_file.gcount() == sizeof(ident)) && (ident[0] == 0x7F) && (ident[1] == 'E') && (ident[2] == 'L') && (ident[3] == 'F');
+}
+
+ocsd_err_t TrcMemAccElf::readLoadSegments(const std::string &pathToFile, std::vector<elf_load_seg_t> &load_segs)
+{
+    uint8_t ehdr[ELF64_EHDR_SIZE];
+
+    std::ifstream elf_file(pathToFile.c_str(), std::ifstream::binary | std::ifstream::ate);
+    if (!elf_file.is_open())
+        return OCSD_ERR_MEM_ACC_FILE_NOT_FOUND;
+    uint64_t file_size = (uint64_t)elf_file.tellg();
+    elf_file.seekg(0, elf_file.beg);
+
+    // identification and file header
+    elf_file.read((char *)ehdr, ELF32_EHDR_SIZE);
+    if (elf_file.gcount() != ELF32_EHDR_SIZE)
+        return OCSD_ERR_MEM_ACC_ELF_INVALID;
+    if ((ehdr[0] != 0x7F) || (ehdr[1] != 'E') || (ehdr[2] != 'L') || (ehdr[3] != 'F'))
+        return OCSD_ERR_MEM_ACC_ELF_INVALID;
+
+    const bool is_64 = (ehdr[4] == ELF_CLASS_64);
+    const bool big_endian = (ehdr[5] == ELF_DATA_MSB);
+    if (((ehdr[4] != ELF_CLASS_32) && !is_64) || ((ehdr[5] != ELF_DATA_LSB) && !big_endian))
+        return OCSD_ERR_MEM_ACC_ELF_INVALID;
+
+    uint64_t phoff;
+    uint32_t phentsize, phnum, phdr_size;
+    if (is_64)
+    {
+        elf_file.read((char *)ehdr + ELF32_EHDR_SIZE, ELF64_EHDR_SIZE - ELF32_EHDR_SIZE);
+        if (elf_file.gcount() != (ELF64_EHDR_SIZE - ELF32_EHDR_SIZE))
+            return OCSD_ERR_MEM_ACC_ELF_INVALID;
+        phoff = elf_read_val(ehdr + 32, 8, big_endian);
+        phentsize = (uint32_t)elf_read_val(ehdr + 54, 2, big_endian);
+        phnum = (uint32_t)elf_read_val(ehdr + 56, 2, big_endian);
+        phdr_size = ELF64_PHDR_SIZE;
+    }
+    else
+    {
+        phoff = elf_read_val(ehdr + 28, 4, big_endian);
+        phentsize = (uint32_t)elf_read_val(ehdr + 42, 2, big_endian);
+        phnum = (uint32_t)elf_read_val(ehdr + 44, 2, big_endian);
+        phdr_size = ELF32_PHDR_SIZE;
+    }
+
+    // no program headers (relocatable object), or extended numbering not supported.
+    if ((phoff == 0) || (phnum == 0) || (phnum == ELF_PN_XNUM) || (phentsize < phdr_size))
+        return OCSD_ERR_MEM_ACC_ELF_INVALID;
+    if ((phoff + ((uint64_t)phnum * phentsize)) > file_size)
+        return OCSD_ERR_MEM_ACC_ELF_INVALID;
+
+    // program header table
+    std::vector<uint8_t> phdrs((size_t)phnum * phentsize);
+    elf_file.seekg((std::streamoff)phoff, elf_file.beg);
+    elf_file.read((char *)phdrs.data(), phdrs.size());
+    if (elf_file.gcount() != (std::streamsize)phdrs.size())
+        return OCSD_ERR_MEM_ACC_ELF_INVALID;
+
+    load_segs.clear();
+    for (uint32_t i = 0; i < phnum; i++)
+    {
+        const uint8_t *p_phdr = &phdrs[(size_t)i * phentsize];
+        elf_load_seg_t seg;
+        uint32_t p_type = (uint32_t)elf_read_val(p_phdr, 4, big_endian);
+        uint32_t p_flags;
+
+        if (p_type != ELF_PT_LOAD)
+            continue;
+
+        if (is_64)
+        {
+            p_flags = (uint32_t)elf_read_val(p_phdr + 4, 4, big_endian);
+            seg.offset = elf_read_val(p_phdr + 8, 8, big_endian);
+            seg.vaddr = elf_read_val(p_phdr + 16, 8, big_endian);
+            seg.filesz = elf_read_val(p_phdr + 32, 8, big_endian);
+        }
+        else
+        {
+            seg.offset = elf_read_val(p_phdr + 4, 4, big_endian);
+            seg.vaddr = elf_read_val(p_phdr + 8, 4, big_endian);
+            seg.filesz = elf_read_val(p_phdr + 16, 4, big_endian);
+            p_flags = (uint32_t)elf_read_val(p_phdr + 24, 4, big_endian);
+        }
+        seg.exec = (p_flags & ELF_PF_X) != 0;
+
+        // segment data must be in the file.
+        if ((seg.offset > file_size) || (seg.filesz > (file_size - seg.offset)))
+            return OCSD_ERR_MEM_ACC_ELF_INVALID;
+        load_segs.push_back(seg);
+    }
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcMemAccElf::getLoadBias(const std::string &pathToFile, const ocsd_vaddr_t map_address, const uint64_t map_offset, ocsd_vaddr_t &load_bias)
+{
+    std::vector<elf_load_seg_t> load_segs;
+    ocsd_err_t err = readLoadSegments(pathToFile, load_segs);
+    if (err != OCSD_OK)
+        return err;
+
+    for (size_t i = 0; i < load_segs.size(); i++)
+    {
+        if ((map_offset >= load_segs[i].offset) && (map_offset < (load_segs[i].offset + load_segs[i].filesz)))
+        {
+            load_bias = map_address - (load_segs[i].vaddr + (map_offset - load_segs[i].offset));
+            return OCSD_OK;
+        }
+    }
+    return OCSD_ERR_MEM_ACC_ELF_INVALID;
+}
+
+/***************************************************/
+/* accessor instance functions                     */
+/***************************************************/
+
+TrcMemAccElf::TrcMemAccElf() : TrcMemAccessorBase(MEMACC_ELF)
+{
+}
+
+ocsd_err_t TrcMemAccElf::initAccessor(const std::string &pathToFile, const ocsd_vaddr_t load_bias)
+{
+    std::vector<elf_load_seg_t> load_segs;
+    ocsd_err_t err = readLoadSegments(pathToFile, load_segs);
+    if (err != OCSD_OK)
+        return err;
+
+    m_segs.clear();
+    for (size_t i = 0; i < load_segs.size(); i++)
+    {
+        // round size down to keep ranges a whole number of half words, as the file accessor.
+        uint64_t size = load_segs[i].filesz & ~((uint64_t)0x1);
+        if (!load_segs[i].exec || (size == 0) || (size > 0xFFFFFFFF))
+            continue;
+
+        elf_seg_t seg;
+        seg.st_addr = load_segs[i].vaddr + load_bias;
+        seg.en_addr = seg.st_addr + size - 1;
+        seg.offset = load_segs[i].offset;
+        m_segs.push_back(seg);
+    }
+    if (m_segs.size() == 0)
+        return OCSD_ERR_MEM_ACC_ELF_INVALID;
+
+    std::sort(m_segs.begin(), m_segs.end(), [](const elf_seg_t &a, const elf_seg_t &b) { return a.st_addr < b.st_addr; });
+
+    // base range covers all the segments - used by other accessors to test overlap.
+    setRange(m_segs.front().st_addr, m_segs.back().en_addr);
+    m_file_path = pathToFile;
+    return OCSD_OK;
+}
+
+const TrcMemAccElf::elf_seg_t *TrcMemAccElf::getSegForAddress(const ocsd_vaddr_t address) const
+{
+    for (size_t i = 0; i < m_segs.size(); i++)
+    {
+        if ((address >= m_segs[i].st_addr) && (address <= m_segs[i].en_addr))
+            return &m_segs[i];
+    }
+    return 0;
+}
+
+TrcMemImagePtr TrcMemAccElf::loadSegment(elf_seg_t &seg)
+{
+    std::lock_guard<std::mutex> lock(m_load_lock);
+
+    // may have been loaded by another thread while waiting for the lock.
+    TrcMemImagePtr image = std::atomic_load(&seg.image);
+    if (!image)
+    {
+        if (TrcMemImage::createFromFile(m_file_path, m_file_path, seg.st_addr, (size_t)seg.offset, (size_t)(seg.en_addr - seg.st_addr + 1), image) == OCSD_OK)
+            std::atomic_store(&seg.image, image);
+    }
+    return image;
+}
+
+const int TrcMemAccElf::getNumSegmentsLoaded() const
+{
+    int num_loaded = 0;
+    for (size_t i = 0; i < m_segs.size(); i++)
+    {
+        if (std::atomic_load(&m_segs[i].image))
+            num_loaded++;
+    }
+    return num_loaded;
+}
+
+const uint32_t TrcMemAccElf::readBytes(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space, const uint8_t trcID, const uint32_t reqBytes, uint8_t *byteBuffer)
+{
+    elf_seg_t *p_seg = const_cast<elf_seg_t *>(getSegForAddress(address));
+    if (!p_seg)
+        return 0;
+
+    TrcMemImagePtr image = std::atomic_load(&p_seg->image);
+    if (!image)
+        image = loadSegment(*p_seg);
+    if (!image)
+        return 0;   // file no longer readable
+
+    uint32_t bytesRead = reqBytes;
+    if ((p_seg->en_addr - address + 1) < bytesRead)
+        bytesRead = (uint32_t)(p_seg->en_addr - address + 1);
+    memcpy(byteBuffer, image->getData() + (address - p_seg->st_addr), bytesRead);
+    return bytesRead;
+}
+
+const bool TrcMemAccElf::addrInRange(const ocsd_vaddr_t s_address) const
+{
+    return getSegForAddress(s_address) != 0;
+}
+
+const bool TrcMemAccElf::addrStartOfRange(const ocsd_vaddr_t s_address) const
+{
+    return (m_segs.size() > 0) && (s_address == m_segs.front().st_addr);
+}
+
+const uint32_t TrcMemAccElf::bytesInRange(const ocsd_vaddr_t s_address, const uint32_t reqBytes) const
+{
+    const elf_seg_t *p_seg = getSegForAddress(s_address);
+    if (!p_seg)
+        return 0;
+    if ((p_seg->en_addr - s_address + 1) < reqBytes)
+        return (uint32_t)(p_seg->en_addr - s_address + 1);
+    return reqBytes;
+}
+
+const bool TrcMemAccElf::overLapRange(const TrcMemAccessorBase *p_test_acc) const
+{
+    std::vector<addr_range_t> test_ranges;
+
+    p_test_acc->getAddrRanges(test_ranges);
+    for (size_t i = 0; i < m_segs.size(); i++)
+    {
+        for (size_t j = 0; j < test_ranges.size(); j++)
+        {
+            if ((test_ranges[j].first <= m_segs[i].en_addr) && (test_ranges[j].second >= m_segs[i].st_addr))
+                return true;
+        }
+    }
+    return false;
+}
+
+const bool TrcMemAccElf::validateRange()
+{
+    for (size_t i = 0; i < m_segs.size(); i++)
+    {
+        if ((m_segs[i].st_addr & 0x1) || (m_segs[i].st_addr > m_segs[i].en_addr))
+            return false;
+    }
+    return m_segs.size() > 0;
+}
+
+void TrcMemAccElf::getMemAccString(std::string &accStr) const
+{
+    std::ostringstream oss;
+    TrcMemAccessorBase::getMemAccString(accStr);
+    for (size_t i = 0; (m_segs.size() > 1) && (i < m_segs.size()); i++)
+        oss << "\nSegment 0x" << std::hex << m_segs[i].st_addr << ":" << m_segs[i].en_addr << "; offset 0x" << m_segs[i].offset;
+    oss << "\nFilename=" << m_file_path;
+    accStr += oss.str();
+}
+
+void TrcMemAccElf::getAddrRanges(std::vector<addr_range_t> &ranges) const
+{
+    for (size_t i = 0; i < m_segs.size(); i++)
+        ranges.push_back(addr_range_t(m_segs[i].st_addr, m_segs[i].en_addr));
+}
+
+/* End of File trc_mem_acc_elf.cpp */
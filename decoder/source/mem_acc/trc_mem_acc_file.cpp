@@ -118,12 +118,14 @@ FileRegionMemAccessor *TrcMemAccessorFile::getRegionForAddress(const ocsd_vaddr_
 /***************************************************/
 
 std::map<std::string, TrcMemAccessorFile *> TrcMemAccessorFile::s_FileAccessorMap;
+std::mutex TrcMemAccessorFile::s_FileAccessorMapLock;
 
 // return existing or create new accessor
 ocsd_err_t TrcMemAccessorFile::createFileAccessor(TrcMemAccessorFile **p_acc, const std::string &pathToFile, ocsd_vaddr_t startAddr, size_t offset /*= 0*/, size_t size /*= 0*/)
 {
     ocsd_err_t err = OCSD_OK;
     TrcMemAccessorFile * acc = 0;
+    std::lock_guard<std::mutex> lock(s_FileAccessorMapLock);
     std::map<std::string, TrcMemAccessorFile *>::iterator it = s_FileAccessorMap.find(pathToFile);
     if(it != s_FileAccessorMap.end())
     {
@@ -163,6 +165,7 @@ void TrcMemAccessorFile::destroyFileAccessor(TrcMemAccessorFile *p_accessor)
 {
     if(p_accessor != 0)
     {
+        std::lock_guard<std::mutex> lock(s_FileAccessorMapLock);
         p_accessor->DecRefCount();
         if(p_accessor->getRefCount() == 0)
         {
@@ -179,6 +182,7 @@ void TrcMemAccessorFile::destroyFileAccessor(TrcMemAccessorFile *p_accessor)
 const bool TrcMemAccessorFile::isExistingFileAccessor(const std::string &pathToFile)
 {
     bool bExists = false;
+    std::lock_guard<std::mutex> lock(s_FileAccessorMapLock);
     std::map<std::string, TrcMemAccessorFile *>::const_iterator it = s_FileAccessorMap.find(pathToFile);
     if(it != s_FileAccessorMap.end())
         bExists = true;
@@ -188,6 +192,7 @@ const bool TrcMemAccessorFile::isExistingFileAccessor(const std::string &pathToF
 TrcMemAccessorFile * TrcMemAccessorFile::getExistingFileAccessor(const std::string &pathToFile)
 {
     TrcMemAccessorFile * p_acc = 0;
+    std::lock_guard<std::mutex> lock(s_FileAccessorMapLock);
     std::map<std::string, TrcMemAccessorFile *>::iterator it = s_FileAccessorMap.find(pathToFile);
     if(it != s_FileAccessorMap.end())
         p_acc = it->second;
@@ -204,6 +209,7 @@ const uint32_t TrcMemAccessorFile::readBytes(const ocsd_vaddr_t address, const o
     if(!m_mem_file.is_open())
         return 0;
     uint32_t bytesRead = 0;
+    std::lock_guard<std::mutex> lock(m_mem_file_lock);
 
     if(m_base_range_set)
     {
@@ -388,4 +394,17 @@ void TrcMemAccessorFile::getMemAccString(std::string &accStr) const
     accStr += (std::string)"\nFilename=" + m_file_path;
 }
 
+void TrcMemAccessorFile::getAddrRanges(std::vector<addr_range_t> &ranges) const
+{
+    if(m_base_range_set)
+        TrcMemAccessorBase::getAddrRanges(ranges);
+
+    if(m_has_access_regions)
+    {
+        std::list<FileRegionMemAccessor *>::const_iterator it;
+        for(it = m_access_regions.begin(); it != m_access_regions.end(); it++)
+            (*it)->getAddrRanges(ranges);
+    }
+}
+
 /* End of File trc_mem_acc_file.cpp */
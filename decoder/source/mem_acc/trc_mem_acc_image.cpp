@@ -0,0 +1,208 @@
+/*
+ * \file       trc_mem_acc_image.cpp
+ * \brief      OpenCSD : Shared immutable memory images and image registry.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#include "mem_acc/trc_mem_acc_image.h"
+
+/***************************************************/
+/* immutable memory image                          */
+/***************************************************/
+
+ocsd_err_t TrcMemImage::createFromBuffer(const std::string &name, const ocsd_vaddr_t s_address, const uint8_t *p_buffer, const uint32_t size, TrcMemImagePtr &image)
+{
+    if((p_buffer == 0) || (size == 0))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    TrcMemImage *p_image = new (std::nothrow) TrcMemImage(name, s_address);
+    if(!p_image)
+        return OCSD_ERR_MEM;
+
+    try
+    {
+        p_image->m_data.assign(p_buffer, p_buffer + size);
+    }
+    catch(...)
+    {
+        delete p_image;
+        return OCSD_ERR_MEM;
+    }
+    image.reset(p_image);
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcMemImage::createFromFile(const std::string &name, const std::string &pathToFile, const ocsd_vaddr_t s_address, const size_t offset, const size_t size, TrcMemImagePtr &image)
+{
+    std::ifstream mem_file(pathToFile.c_str(), std::ifstream::binary | std::ifstream::ate);
+    if(!mem_file.is_open())
+        return OCSD_ERR_MEM_ACC_FILE_NOT_FOUND;
+
+    size_t file_size = (size_t)mem_file.tellg();
+    size_t load_size = size;
+    if(offset >= file_size)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    if(load_size == 0)
+        load_size = file_size - offset;
+    if(((offset + load_size) > file_size) || (load_size > 0xFFFFFFFF))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    TrcMemImage *p_image = new (std::nothrow) TrcMemImage(name, s_address);
+    if(!p_image)
+        return OCSD_ERR_MEM;
+
+    try
+    {
+        p_image->m_data.resize(load_size);
+    }
+    catch(...)
+    {
+        delete p_image;
+        return OCSD_ERR_MEM;
+    }
+
+    mem_file.seekg(offset, mem_file.beg);
+    mem_file.read((char *)p_image->m_data.data(), load_size);
+    if(!mem_file)
+    {
+        delete p_image;
+        return OCSD_ERR_FILE_ERROR;
+    }
+    image.reset(p_image);
+    return OCSD_OK;
+}
+
+/***************************************************/
+/* image registry                                  */
+/***************************************************/
+
+TrcMemImageRegistry::TrcMemImageRegistry() : 
+    m_snapshot(std::make_shared<const TrcMemImageMap>())
+{
+}
+
+TrcMemImageRegistry &TrcMemImageRegistry::getGlobal()
+{
+    static TrcMemImageRegistry s_global_registry;
+    return s_global_registry;
+}
+
+ocsd_err_t TrcMemImageRegistry::publishImage(const TrcMemImagePtr &image)
+{
+    if(!image)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    std::lock_guard<std::mutex> lock(m_update_lock);
+    try
+    {
+        // copy the current set, update and swap in - readers keep the set they hold.
+        std::shared_ptr<TrcMemImageMap> new_set = std::make_shared<TrcMemImageMap>(*std::atomic_load(&m_snapshot));
+        (*new_set)[image->getName()] = image;
+        std::atomic_store(&m_snapshot, TrcMemImageSnapshot(new_set));
+    }
+    catch(...)
+    {
+        return OCSD_ERR_MEM;
+    }
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcMemImageRegistry::withdrawImage(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(m_update_lock);
+    TrcMemImageSnapshot curr_set = std::atomic_load(&m_snapshot);
+    if(curr_set->find(name) == curr_set->end())
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    try
+    {
+        std::shared_ptr<TrcMemImageMap> new_set = std::make_shared<TrcMemImageMap>(*curr_set);
+        new_set->erase(name);
+        std::atomic_store(&m_snapshot, TrcMemImageSnapshot(new_set));
+    }
+    catch(...)
+    {
+        return OCSD_ERR_MEM;
+    }
+    return OCSD_OK;
+}
+
+void TrcMemImageRegistry::clear()
+{
+    std::lock_guard<std::mutex> lock(m_update_lock);
+    std::atomic_store(&m_snapshot, TrcMemImageSnapshot(std::make_shared<const TrcMemImageMap>()));
+}
+
+TrcMemImageSnapshot TrcMemImageRegistry::getSnapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+TrcMemImagePtr TrcMemImageRegistry::findImage(const std::string &name) const
+{
+    TrcMemImageSnapshot curr_set = std::atomic_load(&m_snapshot);
+    TrcMemImageMap::const_iterator it = curr_set->find(name);
+    if(it != curr_set->end())
+        return it->second;
+    return TrcMemImagePtr();
+}
+
+/***************************************************/
+/* image memory accessor                           */
+/***************************************************/
+
+TrcMemAccImage::TrcMemAccImage(const TrcMemImagePtr &image) :
+    TrcMemAccessorBase(MEMACC_IMAGE, image->getStartAddress(), image->getStartAddress() + image->getSize() - 1),
+    m_image(image)
+{
+}
+
+const uint32_t TrcMemAccImage::readBytes(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space, const uint8_t trcID, const uint32_t reqBytes, uint8_t *byteBuffer)
+{
+    // image is immutable - no locking required.
+    uint32_t bytesRead = bytesInRange(address,reqBytes);
+    if(bytesRead)
+        memcpy(byteBuffer, m_image->getData() + address - m_startAddress, bytesRead);
+    return bytesRead;
+}
+
+void TrcMemAccImage::getMemAccString(std::string &accStr) const
+{
+    TrcMemAccessorBase::getMemAccString(accStr);
+    accStr += (std::string)"\nImage=" + m_image->getName();
+}
+
+/* End of File trc_mem_acc_image.cpp */
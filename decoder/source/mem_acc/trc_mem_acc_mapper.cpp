@@ -119,6 +119,22 @@ ocsd_err_t TrcMemAccMapper::ReadTargetMemory(const ocsd_vaddr_t address, const u
     return err;
 }
 
+bool TrcMemAccMapper::FindBasicBlock(const uint8_t cs_trace_id, const ocsd_mem_space_acc_t mem_space, ocsd_instr_info *instr_info, uint32_t *num_instr)
+{
+    const ocsd_vaddr_t address = instr_info->instr_addr;
+
+    if (!readFromCurrent(address, mem_space, cs_trace_id))
+    {
+        if (!findAccessor(address, mem_space, cs_trace_id))
+            return false;
+
+        // found a new accessor - invalidate any cache entries used by the previous one.
+        if (m_cache.enabled())
+            m_cache.invalidateAll();
+    }
+    return m_acc_curr->findBasicBlock(instr_info, num_instr);
+}
+
 void TrcMemAccMapper::RemoveAllAccessors()
 {
     TrcMemAccessorBase *pAcc = 0;
@@ -152,15 +168,64 @@ ocsd_err_t TrcMemAccMapper::RemoveAccessorByAddress(const ocsd_vaddr_t st_addres
     return err;
 }
 
+ocsd_err_t TrcMemAccMapper::AttachBBMap(const TrcBBMapPtr &map, const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space, const uint8_t cs_trace_id /* = 0 */)
+{
+    if (!map)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    // T32 branch destinations depend on word alignment - the map cannot be moved by a partial word.
+    if ((address - map->getStartAddress()) & 0x3)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    if (!findAccessor(address, mem_space, cs_trace_id))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    if (m_cache.enabled())
+        m_cache.invalidateAll();
+
+    // whole region must be in the accessor, and match the map.
+    const uint32_t size = map->getSize();
+    if (m_acc_curr->bytesInRange(address, size) != size)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    try
+    {
+        std::vector<uint8_t> region(size);
+        if ((m_acc_curr->readBytes(address, mem_space, cs_trace_id, size, region.data()) != size) ||
+            (TrcBBMap::calcKey(region.data(), size) != map->getKey()))
+            return OCSD_ERR_BB_MAP_INVALID;
+        m_acc_curr->addBBMap(map, address);
+    }
+    catch (...)
+    {
+        return OCSD_ERR_MEM;
+    }
+
+    std::string mapStr;
+    map->getMapString(mapStr);
+    LogMessage("Mem Acc: attached " + mapStr + "\n");
+    return OCSD_OK;
+}
+
+void TrcMemAccMapper::getMappedRanges(std::vector<TrcMemAccessorBase::addr_range_t> &ranges)
+{
+    TrcMemAccessorBase *pAcc = getFirstAccessor();
+    while(pAcc != 0)
+    {
+        pAcc->getAddrRanges(ranges);
+        pAcc = getNextAccessor();
+    }
+}
+
 void  TrcMemAccMapper::LogMessage(const std::string &msg)
 {
     if(m_err_log)
         m_err_log->LogMessage(ITraceErrorLog::HANDLE_GEN_INFO,OCSD_ERR_SEV_INFO,msg);
 }
 
-void TrcMemAccMapper::LogWarn(const ocsd_err_t err, const std::string &msg)
+void TrcMemAccMapper::LogWarn(const ocsd_err_t err, const char *msg)
 {
-    if (m_err_log)
+    // check verbosity before creating the error - called per memory read.
+    if (m_err_log && (m_err_log->GetErrorLogVerbosity() >= OCSD_ERR_SEV_WARN))
     {
         ocsdError err_ocsd(OCSD_ERR_SEV_WARN,err,msg);
         m_err_log->LogError(ITraceErrorLog::HANDLE_GEN_INFO, &err_ocsd);
@@ -48,6 +48,7 @@ OcsdCodeFollower::OcsdCodeFollower()
     m_pIDecode = 0;
     m_mem_space_csid = 0;
     m_st_range_addr =  m_en_range_addr = m_next_addr = 0;
+    m_num_instr = 0;
     m_b_next_valid = false;
     m_b_nacc_err = false;
 }
@@ -72,6 +73,7 @@ bool OcsdCodeFollower::initFollowerState()
 
     // set range addresses
     m_en_range_addr = m_next_addr = m_st_range_addr;
+    m_num_instr = 0;
 
 // check initialisation is valid.
 
@@ -110,6 +112,7 @@ ocsd_err_t OcsdCodeFollower::followSingleAtom(const ocsd_vaddr_t addrStart, cons
 
     // set end range - always after the instruction executed.
     m_en_range_addr = m_instr_info.instr_addr + m_instr_info.instr_size;
+    m_num_instr = 1;
                     
     // assume next addr is the instruction after
     m_next_addr = m_en_range_addr;
@@ -159,4 +162,30 @@ ocsd_err_t OcsdCodeFollower::decodeSingleOpCode()
     return err;
 }
 
+void OcsdCodeFollower::saveState(TrcStateWriter &wr) const
+{
+    wr.put(m_instr_info);
+    wr.put(m_st_range_addr);
+    wr.put(m_en_range_addr);
+    wr.put(m_next_addr);
+    wr.put(m_b_next_valid);
+    wr.put(m_mem_acc_rule);
+    wr.put(m_mem_space_csid);
+    wr.put(m_nacc_address);
+    wr.put(m_b_nacc_err);
+}
+
+void OcsdCodeFollower::restoreState(TrcStateReader &rd)
+{
+    rd.get(m_instr_info);
+    rd.get(m_st_range_addr);
+    rd.get(m_en_range_addr);
+    rd.get(m_next_addr);
+    rd.get(m_b_next_valid);
+    rd.get(m_mem_acc_rule);
+    rd.get(m_mem_space_csid);
+    rd.get(m_nacc_address);
+    rd.get(m_b_nacc_err);
+}
+
 /* End of File ocsd_code_follower.cpp */
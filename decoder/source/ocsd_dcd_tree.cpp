@@ -36,6 +36,109 @@
 #include "common/ocsd_dcd_tree.h"
 #include "common/ocsd_lib_dcd_register.h"
 #include "mem_acc/trc_mem_acc_mapper.h"
+#include "common/trc_state_blob.h"
+
+#include <deque>
+#include <sstream>
+#include <cstring>
+
+/***************************************************************/
+/* element sink for the pull iterator - copies elements into the client batch.
+   Elements arriving once the batch is full are held for the next batch - the 
+   deformatter passes EOT to all IDs regardless of a _WAIT response. */
+class PullElemSink : public ITrcGenElemIn
+{
+public:
+    PullElemSink() : m_p_elems(0), m_max_elems(0), m_num_elems(0) {};
+    virtual ~PullElemSink() {};
+
+    void setBatch(ocsd_gen_elem_rec_t *p_elems, const int max_elems);
+    void clear() { m_overflow.clear(); };
+
+    const int numElems() const { return m_num_elems; };
+    const bool batchFull() const { return m_num_elems >= m_max_elems; };
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                              const uint8_t trc_chan_id,
+                                              const OcsdTraceElement &elem);
+
+private:
+    /* held element - extended data copied for SW trace payloads */
+    typedef struct _pull_elem {
+        ocsd_gen_elem_rec_t rec;
+        std::vector<uint8_t> ext_data;
+    } pull_elem_t;
+
+    void setRec(ocsd_gen_elem_rec_t &rec, std::vector<uint8_t> &ext_data, const ocsd_trc_index_t index_sop,
+                const uint8_t trc_chan_id, const OcsdTraceElement &elem);
+    void nextBatchEntry();
+
+    ocsd_gen_elem_rec_t *m_p_elems;
+    int m_max_elems;
+    int m_num_elems;
+    std::vector<std::vector<uint8_t> > m_batch_ext_data;  //!< extended data for each batch entry.
+    std::deque<pull_elem_t> m_overflow;
+};
+
+void PullElemSink::setBatch(ocsd_gen_elem_rec_t *p_elems, const int max_elems)
+{
+    m_p_elems = p_elems;
+    m_max_elems = max_elems;
+    m_num_elems = 0;
+    if ((int)m_batch_ext_data.size() < max_elems)
+        m_batch_ext_data.resize(max_elems);
+
+    // held elements first
+    while (!m_overflow.empty() && !batchFull())
+    {
+        m_p_elems[m_num_elems] = m_overflow.front().rec;
+        m_batch_ext_data[m_num_elems].swap(m_overflow.front().ext_data);
+        m_overflow.pop_front();
+        nextBatchEntry();
+    }
+}
+
+void PullElemSink::setRec(ocsd_gen_elem_rec_t &rec, std::vector<uint8_t> &ext_data, const ocsd_trc_index_t index_sop,
+                          const uint8_t trc_chan_id, const OcsdTraceElement &elem)
+{
+    rec.index_sop = index_sop;
+    rec.trc_chan_id = trc_chan_id;
+    rec.elem = elem;
+
+    // only SW trace payloads have a known size.
+    ext_data.clear();
+    if ((elem.elem_type == OCSD_GEN_TRC_ELEM_SWTRACE) && elem.extended_data && elem.ptr_extended_data)
+    {
+        size_t size = ((elem.sw_trace_info.swt_payload_pkt_bitsize * elem.sw_trace_info.swt_payload_num_packets) + 7) / 8;
+        const uint8_t *p_data = (const uint8_t *)elem.ptr_extended_data;
+        ext_data.assign(p_data, p_data + size);
+    }
+}
+
+void PullElemSink::nextBatchEntry()
+{
+    // point the batch entry at the copied extended data.
+    if (!m_batch_ext_data[m_num_elems].empty())
+        m_p_elems[m_num_elems].elem.ptr_extended_data = &m_batch_ext_data[m_num_elems][0];
+    m_num_elems++;
+}
+
+ocsd_datapath_resp_t PullElemSink::TraceElemIn(const ocsd_trc_index_t index_sop,
+                                               const uint8_t trc_chan_id,
+                                               const OcsdTraceElement &elem)
+{
+    if (!batchFull())
+    {
+        setRec(m_p_elems[m_num_elems], m_batch_ext_data[m_num_elems], index_sop, trc_chan_id, elem);
+        nextBatchEntry();
+    }
+    else
+    {
+        m_overflow.push_back(pull_elem_t());
+        setRec(m_overflow.back().rec, m_overflow.back().ext_data, index_sop, trc_chan_id, elem);
+    }
+    return batchFull() ? OCSD_RESP_WAIT : OCSD_RESP_CONT;
+}
 
 /***************************************************************/
 ITraceErrorLog *DecodeTree::s_i_error_logger = &DecodeTree::s_error_logger; 
@@ -97,10 +200,13 @@ DecodeTree::DecodeTree() :
     m_frame_deformatter_root(0),
     m_decode_elem_iter(0),
     m_default_mapper(0),
-    m_created_mapper(false)
+    m_created_mapper(false),
+    m_i_pull_src(0),
+    m_pull_sink(0)
 {
     for(int i = 0; i < 0x80; i++)
         m_decode_elements[i] = 0;
+    resetPullState();
 }
 
 DecodeTree::~DecodeTree()
@@ -112,6 +218,7 @@ DecodeTree::~DecodeTree()
     }
     PktPrinterFact::destroyAllPrinters(m_printer_list);
     delete m_frame_deformatter_root;
+    delete m_pull_sink;
 }
 
 
@@ -128,6 +235,18 @@ ocsd_datapath_resp_t DecodeTree::TraceDataIn( const ocsd_datapath_op_t op,
     return OCSD_RESP_FATAL_NOT_INIT;
 }
 
+ocsd_datapath_resp_t DecodeTree::TraceDataInSG(const ocsd_trc_index_t index,
+                                               const ocsd_trc_data_seg_t *segs,
+                                               const int num_segs,
+                                               const uint32_t seg_offset,
+                                               uint32_t *numBytesProcessed)
+{
+    if(m_i_decoder_root)
+        return m_i_decoder_root->TraceDataInSG(index,segs,num_segs,seg_offset,numBytesProcessed);
+    *numBytesProcessed = 0;
+    return OCSD_RESP_FATAL_NOT_INIT;
+}
+
 /* set key interfaces - attach / replace on any existing tree components */
 void DecodeTree::setInstrDecoder(IInstrDecode *i_instr_decode)
 {
@@ -167,6 +286,7 @@ void DecodeTree::setGenTraceElemOutI(ITrcGenElemIn *i_gen_trace_elem)
         pElem->getDecoderMngr()->attachOutputSink(pElem->getDecoderHandle(),i_gen_trace_elem);
         pElem = getNextElement(elemID);
     }
+    m_i_gen_elem_out = i_gen_trace_elem;
 }
 
 ocsd_err_t DecodeTree::createMemAccMapper(memacc_mapper_t type /* = MEMACC_MAP_GLOBAL*/ )
@@ -217,6 +337,12 @@ void DecodeTree::logMappedRanges()
         m_default_mapper->logMappedRanges();
 }
 
+void DecodeTree::getMappedRanges(std::vector<TrcMemAccessorBase::addr_range_t> &ranges)
+{
+    if(m_default_mapper)
+        m_default_mapper->getMappedRanges(ranges);
+}
+
 /* Memory accessor creation - all on default mem accessor using the 0 CSID for global core space. */
 ocsd_err_t DecodeTree::addBufferMemAcc(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space, const uint8_t *p_mem_buffer, const uint32_t mem_length)
 {
@@ -386,6 +512,70 @@ ocsd_err_t DecodeTree::addCallbackIDMemAcc(const ocsd_vaddr_t st_address, const
     return initCallbackMemAcc(st_address, en_address, mem_space, (void *)p_cb_func, true, p_context);
 }
 
+ocsd_err_t DecodeTree::addImageMemAcc(const TrcMemImagePtr &image, const ocsd_mem_space_acc_t mem_space)
+{
+    if(!hasMemAccMapper())
+        return OCSD_ERR_NOT_INIT;
+
+    TrcMemAccessorBase *p_accessor;
+    ocsd_err_t err = TrcMemAccFactory::CreateImageAccessor(&p_accessor, image);
+    if(err == OCSD_OK)
+    {
+        p_accessor->setMemSpace(mem_space);
+        err = m_default_mapper->AddAccessor(p_accessor,0);
+        if(err != OCSD_OK)
+            TrcMemAccFactory::DestroyAccessor(p_accessor);
+    }
+    return err;
+}
+
+ocsd_err_t DecodeTree::addImageMemAcc(const std::string &name, const ocsd_mem_space_acc_t mem_space)
+{
+    TrcMemImagePtr image = TrcMemImageRegistry::getGlobal().findImage(name);
+    if(!image)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    return addImageMemAcc(image, mem_space);
+}
+
+ocsd_err_t DecodeTree::addElfFileMemAcc(const std::string &filepath, const ocsd_vaddr_t load_bias, const ocsd_mem_space_acc_t mem_space)
+{
+    if(!hasMemAccMapper())
+        return OCSD_ERR_NOT_INIT;
+
+    if(filepath.length() == 0)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    TrcMemAccessorBase *p_accessor;
+    ocsd_err_t err = TrcMemAccFactory::CreateElfAccessor(&p_accessor, filepath, load_bias);
+    if(err == OCSD_OK)
+    {
+        p_accessor->setMemSpace(mem_space);
+        err = m_default_mapper->AddAccessor(p_accessor,0);
+        if(err != OCSD_OK)
+            TrcMemAccFactory::DestroyAccessor(p_accessor);
+    }
+    return err;
+}
+
+ocsd_err_t DecodeTree::attachBBMap(const TrcBBMapPtr &map, const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space)
+{
+    if(!hasMemAccMapper())
+        return OCSD_ERR_NOT_INIT;
+    return m_default_mapper->AttachBBMap(map, address, mem_space, 0);
+}
+
+ocsd_err_t DecodeTree::attachBBMapFile(const std::string &filepath, const ocsd_vaddr_t load_bias, const ocsd_mem_space_acc_t mem_space)
+{
+    if(!hasMemAccMapper())
+        return OCSD_ERR_NOT_INIT;
+
+    std::vector<TrcBBMapPtr> maps;
+    ocsd_err_t err = TrcBBMap::loadFile(filepath, maps);
+    for(std::vector<TrcBBMapPtr>::iterator it = maps.begin(); (it != maps.end()) && (err == OCSD_OK); it++)
+        err = m_default_mapper->AttachBBMap(*it, (*it)->getStartAddress() + load_bias, mem_space, 0);
+    return err;
+}
+
 ocsd_err_t DecodeTree::removeMemAccByAddress(const ocsd_vaddr_t address, const ocsd_mem_space_acc_t mem_space)
 {
     if(!hasMemAccMapper())
@@ -447,6 +637,9 @@ ocsd_err_t DecodeTree::createDecoder(const std::string &decoderName, const int c
 
         if( m_i_gen_elem_out && (err == OCSD_OK))
             err = pDecoderMngr->attachOutputSink(pTraceComp,m_i_gen_elem_out);
+
+        if (m_pe_filter.isActive() && (err == OCSD_OK))
+            err = applyPeFilter(pTraceComp);
     }
 
     // finally attach the packet processor input to the demux output channel
@@ -486,6 +679,125 @@ ocsd_err_t DecodeTree::removeDecoder(const uint8_t CSID)
     return err;
 }
 
+ocsd_err_t DecodeTree::reconfigureDecoder(const CSConfig *pConfig)
+{
+    ocsd_err_t err = OCSD_OK;
+    ITrcDataIn *pDataIn = 0;
+
+    if(!pConfig)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    uint8_t CSID = 0;   // single stream decoder uses element 0
+    if(usingFormatter())
+        CSID = pConfig->getTraceID();
+
+    if((CSID >= 0x80) || (m_decode_elements[CSID] == 0))
+        return OCSD_ERR_INVALID_ID;
+
+    DecodeTreeElement *pElem = m_decode_elements[CSID];
+
+    // clear the current decode, then apply the new config - decoder restarts from the initial state.
+    err = pElem->getDecoderMngr()->getDataInputI(pElem->getDecoderHandle(), &pDataIn);
+    if(err == OCSD_OK)
+    {
+        pDataIn->TraceDataIn(OCSD_OP_RESET, 0, 0, 0, 0);
+        err = pElem->getDecoderMngr()->setDecoderConfig(pElem->getDecoderHandle(), pConfig);
+    }
+    return err;
+}
+
+ocsd_err_t DecodeTree::resetDecodeTree()
+{
+    if(!m_i_decoder_root)
+        return OCSD_ERR_NOT_INIT;
+
+    // deformatter passes the reset on to all the ID streams.
+    ocsd_datapath_resp_t resp = m_i_decoder_root->TraceDataIn(OCSD_OP_RESET, 0, 0, 0, 0);
+    resetPullState();
+    return OCSD_DATA_RESP_IS_FATAL(resp) ? OCSD_ERR_DATA_DECODE_FATAL : OCSD_OK;
+}
+
+ocsd_err_t DecodeTree::setPullSource(ITrcDataSrc *p_src)
+{
+    if(p_src && !m_pull_sink)
+    {
+        m_pull_sink = new (std::nothrow) PullElemSink();
+        if(!m_pull_sink)
+            return OCSD_ERR_MEM;
+    }
+    m_i_pull_src = p_src;
+    setGenTraceElemOutI(p_src ? m_pull_sink : 0);
+    resetPullState();
+    return OCSD_OK;
+}
+
+void DecodeTree::resetPullState()
+{
+    m_pull_block = 0;
+    m_pull_block_size = 0;
+    m_pull_block_used = 0;
+    m_pull_index = 0;
+    m_pull_resp = OCSD_RESP_CONT;
+    m_pull_eot = false;
+    if(m_pull_sink)
+        m_pull_sink->clear();
+}
+
+ocsd_err_t DecodeTree::nextElements(ocsd_gen_elem_rec_t *p_elems, const int max_elems, int *num_elems)
+{
+    ocsd_err_t err = OCSD_OK;
+    uint32_t used;
+
+    if(!num_elems || !p_elems || (max_elems <= 0))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    *num_elems = 0;
+    if(!m_i_pull_src || !m_i_decoder_root)
+        return OCSD_ERR_NOT_INIT;
+
+    // elements held from earlier calls are returned even after a fatal error.
+    m_pull_sink->setBatch(p_elems, max_elems);
+    if(OCSD_DATA_RESP_IS_FATAL(m_pull_resp))
+        err = OCSD_ERR_DATA_DECODE_FATAL;
+
+    while(!m_pull_sink->batchFull() && (err == OCSD_OK))
+    {
+        if(OCSD_DATA_RESP_IS_WAIT(m_pull_resp))
+        {
+            // previous batch filled - continue the decode.
+            m_pull_resp = m_i_decoder_root->TraceDataIn(OCSD_OP_FLUSH, 0, 0, 0, 0);
+        }
+        else if(m_pull_block_used < m_pull_block_size)
+        {
+            used = 0;
+            m_pull_resp = m_i_decoder_root->TraceDataIn(OCSD_OP_DATA, m_pull_index,
+                                                        m_pull_block_size - m_pull_block_used,
+                                                        m_pull_block + m_pull_block_used, &used);
+            m_pull_block_used += used;
+            m_pull_index += used;
+        }
+        else if(!m_pull_eot)
+        {
+            // current block done - read the next, or end of trace at the end of the source data.
+            m_pull_block_used = 0;
+            err = m_i_pull_src->ReadTraceData(&m_pull_block, &m_pull_block_size);
+            if(err != OCSD_OK)
+                m_pull_block_size = 0;
+            else if(m_pull_block_size == 0)
+            {
+                m_pull_eot = true;
+                m_pull_resp = m_i_decoder_root->TraceDataIn(OCSD_OP_EOT, 0, 0, 0, 0);
+            }
+        }
+        else
+            break;  // all elements returned.
+
+        if(OCSD_DATA_RESP_IS_FATAL(m_pull_resp))
+            err = OCSD_ERR_DATA_DECODE_FATAL;
+    }
+    *num_elems = m_pull_sink->numElems();
+    return err;
+}
+
 DecodeTreeElement * DecodeTree::getDecoderElement(const uint8_t CSID) const
 {
     DecodeTreeElement *ret_elem = 0;
@@ -525,6 +837,116 @@ DecodeTreeElement *DecodeTree::getNextElement(uint8_t &elemID)
     return ret_elem;
 }
 
+/* checkpoint records - component type and CSID followed by the component state blob */
+#define DCD_TREE_CKPT_TAG OCSD_STATE_TAG('D','T','C','K')
+#define DCD_TREE_CKPT_VER 1
+
+typedef enum {
+    CKPT_DEFORMATTER,
+    CKPT_PKT_PROC,
+    CKPT_PKT_DECODER
+} ckpt_comp_t;
+
+ocsd_err_t DecodeTree::saveCheckpoint(std::vector<uint8_t> &checkpoint)
+{
+    ocsd_err_t err = OCSD_OK;
+    const size_t start_size = checkpoint.size();
+    DecodeTreeElement *pElem = 0;
+    TraceComponent *pDecoder, *pPktProc;
+    uint8_t elemID;
+
+    TrcStateWriter wr(checkpoint, DCD_TREE_CKPT_TAG, DCD_TREE_CKPT_VER);
+    wr.put((uint8_t)m_dcd_tree_type);
+
+    if (usingFormatter())
+    {
+        wr.put((uint8_t)CKPT_DEFORMATTER);
+        wr.put((uint8_t)0);
+        err = m_frame_deformatter_root->saveState(checkpoint);
+    }
+
+    pElem = getFirstElement(elemID);
+    while (pElem && (err == OCSD_OK))
+    {
+        // handle is the packet decoder, with the packet processor associated, or packet processor only.
+        pDecoder = pElem->getDecoderHandle();
+        pPktProc = pDecoder->getAssocComponent();
+        if (pPktProc == 0)
+        {
+            pPktProc = pDecoder;
+            pDecoder = 0;
+        }
+
+        wr.put((uint8_t)CKPT_PKT_PROC);
+        wr.put(elemID);
+        err = pPktProc->saveState(checkpoint);
+        if ((err == OCSD_OK) && pDecoder)
+        {
+            wr.put((uint8_t)CKPT_PKT_DECODER);
+            wr.put(elemID);
+            err = pDecoder->saveState(checkpoint);
+        }
+        pElem = getNextElement(elemID);
+    }
+
+    if (err == OCSD_OK)
+        wr.end();
+    else
+        checkpoint.resize(start_size);
+    return err;
+}
+
+ocsd_err_t DecodeTree::restoreCheckpoint(const uint8_t *p_checkpoint, const size_t size)
+{
+    ocsd_err_t err = OCSD_OK;
+    TrcStateReader rd(p_checkpoint, size, DCD_TREE_CKPT_TAG, DCD_TREE_CKPT_VER);
+    DecodeTreeElement *pElem = 0;
+    TraceComponent *pComp;
+    const uint8_t *p_state = 0;
+    size_t state_size = 0;
+    uint8_t tree_type = 0, comp_type = 0, elemID = 0;
+
+    rd.get(tree_type);
+    if (tree_type != (uint8_t)m_dcd_tree_type)
+        rd.setInvalid();
+
+    while (!rd.atEnd() && (err == OCSD_OK))
+    {
+        rd.get(comp_type);
+        rd.get(elemID);
+        if (!rd.getNested(p_state, state_size))
+            break;
+
+        if (comp_type == CKPT_DEFORMATTER)
+        {
+            err = usingFormatter() ? m_frame_deformatter_root->restoreState(p_state, state_size) : OCSD_ERR_DCD_STATE_INVALID;
+            continue;
+        }
+
+        pComp = 0;
+        if ((elemID < 0x80) && ((pElem = m_decode_elements[elemID]) != 0))
+        {
+            pComp = pElem->getDecoderHandle();
+            if (comp_type == CKPT_PKT_PROC)
+            {
+                if (pComp->getAssocComponent() != 0)
+                    pComp = pComp->getAssocComponent();
+            }
+            else if ((comp_type != CKPT_PKT_DECODER) || (pComp->getAssocComponent() == 0))
+                pComp = 0;
+        }
+        err = pComp ? pComp->restoreState(p_state, state_size) : OCSD_ERR_DCD_STATE_INVALID;
+    }
+
+    if (err == OCSD_OK)
+        err = rd.end();
+
+    // partial restore leaves the tree inconsistent - back to start state.
+    if ((err != OCSD_OK) && m_i_decoder_root)
+        m_i_decoder_root->TraceDataIn(OCSD_OP_RESET, 0, 0, 0, 0);
+    return err;
+}
+
 bool DecodeTree::initialise(const ocsd_dcd_tree_src_t type, uint32_t formatterCfgFlags)
 {
     bool initOK = true;
@@ -604,6 +1026,221 @@ ocsd_err_t DecodeTree::clearIDFilter()
     return err;
 }
 
+ocsd_err_t DecodeTree::setPeFilter(const OcsdPeFilter &filter)
+{
+    ocsd_err_t err = OCSD_OK;
+    DecodeTreeElement *pElem = 0;
+    uint8_t elemID;
+
+    m_pe_filter = filter;
+    pElem = getFirstElement(elemID);
+    while (pElem && (err == OCSD_OK))
+    {
+        err = applyPeFilter(pElem->getDecoderHandle());
+        pElem = getNextElement(elemID);
+    }
+    return err;
+}
+
+ocsd_err_t DecodeTree::clearPeFilter()
+{
+    OcsdPeFilter no_filter;
+    return setPeFilter(no_filter);
+}
+
+ocsd_err_t DecodeTree::applyPeFilter(TraceComponent *pDecoder)
+{
+    ocsd_err_t err = OCSD_OK;
+    TrcPktDecodeI *pPktDecoder = dynamic_cast<TrcPktDecodeI *>(pDecoder);
+    
+    // packet processor only decodes everything.
+    if (pPktDecoder)
+    {
+        // decoder without filter support decodes everything - warn if a filter was requested.
+        err = pPktDecoder->setPeFilter(m_pe_filter);
+        if (err == OCSD_ERR_DCD_INTERFACE_UNUSED)
+        {
+            if (m_pe_filter.isActive())
+            {
+                std::ostringstream oss;
+                oss << "DecodeTree : PE filter not supported by " << pDecoder->getComponentName() << " - all trace decoded.\n";
+                s_i_error_logger->LogMessage(ITraceErrorLog::HANDLE_GEN_INFO, OCSD_ERR_SEV_WARN, oss.str());
+            }
+            err = OCSD_OK;
+        }
+    }
+    return err;
+}
+
+TrcPktProcI *DecodeTree::getPktProcessor(DecodeTreeElement *pElem)
+{
+    // handle is the packet decoder, with the packet processor associated, or packet processor only.
+    TraceComponent *pPktProc = pElem->getDecoderHandle()->getAssocComponent();
+    if (!pPktProc)
+        pPktProc = pElem->getDecoderHandle();
+    return dynamic_cast<TrcPktProcI *>(pPktProc);
+}
+
+ocsd_err_t DecodeTree::getSkimSummary(const uint8_t CSID, ocsd_skim_summary_t *p_summary)
+{
+    DecodeTreeElement *pElem = getDecoderElement(CSID);
+    TrcPktProcI *pSkimProc;
+
+    if (!pElem)
+        return OCSD_ERR_INVALID_ID;
+
+    pSkimProc = getPktProcessor(pElem);
+    if (!pSkimProc)
+        return OCSD_ERR_DCD_INTERFACE_UNUSED;
+    return pSkimProc->getSkimSummary(p_summary);
+}
+
+ocsd_err_t DecodeTree::attachPktBatchSink(const uint8_t CSID, IPktBatchIn *pBatchSink, const uint32_t max_pkts)
+{
+    DecodeTreeElement *pElem = getDecoderElement(CSID);
+    TrcPktProcI *pPktProc;
+    ocsd_err_t err;
+
+    if (!pElem)
+        return OCSD_ERR_INVALID_ID;
+
+    pPktProc = getPktProcessor(pElem);
+    if (!pPktProc)
+        return OCSD_ERR_DCD_INTERFACE_UNUSED;
+
+    err = pBatchSink ? pPktProc->setPacketBatchSize(max_pkts) : OCSD_OK;
+    if (err == OCSD_OK)
+        err = pPktProc->getPacketBatchOutAttachPt()->replace_first(pBatchSink);
+    return err;
+}
+
+static void addStageTimes(ocsd_stage_times_t *p_times, const ocsd_stage_times_t &add)
+{
+    for (int i = 0; i < OCSD_TSTAGE_NUM; i++)
+    {
+        p_times->stage[i].calls += add.stage[i].calls;
+        p_times->stage[i].total_ns += add.stage[i].total_ns;
+        p_times->stage[i].self_ns += add.stage[i].self_ns;
+    }
+}
+
+static void addElemStageTimes(ocsd_stage_times_t *p_times, DecodeTreeElement *pElem)
+{
+    TraceComponent *pComp = pElem->getDecoderHandle();
+    addStageTimes(p_times, pComp->getStageTimes());
+    if (pComp->getAssocComponent())
+        addStageTimes(p_times, pComp->getAssocComponent()->getStageTimes());
+}
+
+ocsd_err_t DecodeTree::getStageTimes(const uint8_t CSID, ocsd_stage_times_t *p_times)
+{
+    DecodeTreeElement *pElem = 0;
+    uint8_t elemID;
+
+    if (!p_times)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    memset(p_times, 0, sizeof(ocsd_stage_times_t));
+
+    if (CSID != OCSD_BAD_CS_SRC_ID)
+    {
+        pElem = getDecoderElement(CSID);
+        if (!pElem)
+            return OCSD_ERR_INVALID_ID;
+        addElemStageTimes(p_times, pElem);
+        return OCSD_OK;
+    }
+
+    if (m_frame_deformatter_root && m_frame_deformatter_root->getStageTimes())
+        addStageTimes(p_times, *m_frame_deformatter_root->getStageTimes());
+    pElem = getFirstElement(elemID);
+    while (pElem)
+    {
+        addElemStageTimes(p_times, pElem);
+        pElem = getNextElement(elemID);
+    }
+    return OCSD_OK;
+}
+
+void DecodeTree::resetStageTimes()
+{
+    DecodeTreeElement *pElem = 0;
+    TraceComponent *pComp;
+    uint8_t elemID;
+
+    if (m_frame_deformatter_root)
+        m_frame_deformatter_root->resetStageTimes();
+    pElem = getFirstElement(elemID);
+    while (pElem)
+    {
+        pComp = pElem->getDecoderHandle();
+        pComp->resetStageTimes();
+        if (pComp->getAssocComponent())
+            pComp->getAssocComponent()->resetStageTimes();
+        pElem = getNextElement(elemID);
+    }
+}
+
+static const char *s_stage_names[OCSD_TSTAGE_NUM] = {
+    "deformat",
+    "pkt proc",
+    "pkt decode",
+    "mem access",
+    "instr decode",
+    "elem out"
+};
+
+static void logCompStageTimes(ITraceErrorLog *pLog, const std::string &name, const ocsd_stage_times_t &times)
+{
+    std::ostringstream oss;
+    bool any = false;
+
+    oss << name << ":\n";
+    for (int i = 0; i < OCSD_TSTAGE_NUM; i++)
+    {
+        if (!times.stage[i].calls)
+            continue;
+        any = true;
+        oss << "  " << s_stage_names[i] << ": calls " << times.stage[i].calls;
+        oss << "; total " << times.stage[i].total_ns << " ns; self " << times.stage[i].self_ns << " ns\n";
+    }
+    if (any)
+        pLog->LogMessage(ITraceErrorLog::HANDLE_GEN_INFO, OCSD_ERR_SEV_INFO, oss.str());
+}
+
+void DecodeTree::logStageTimes()
+{
+    ITraceErrorLog *pLog = getCurrentErrorLogI();
+    DecodeTreeElement *pElem = 0;
+    TraceComponent *pComp;
+    ocsd_stage_times_t tree_times;
+    uint8_t elemID;
+
+    if (!pLog)
+        return;
+
+    pLog->LogMessage(ITraceErrorLog::HANDLE_GEN_INFO, OCSD_ERR_SEV_INFO, "Decode Stage Times\n");
+    if (!TraceComponent::stageTimingEnabled())
+    {
+        pLog->LogMessage(ITraceErrorLog::HANDLE_GEN_INFO, OCSD_ERR_SEV_INFO, "Not recorded - library not built with OCSD_STAGE_TIMING\n");
+        return;
+    }
+
+    if (m_frame_deformatter_root && m_frame_deformatter_root->getStageTimes())
+        logCompStageTimes(pLog, "Frame Deformatter", *m_frame_deformatter_root->getStageTimes());
+    pElem = getFirstElement(elemID);
+    while (pElem)
+    {
+        pComp = pElem->getDecoderHandle();
+        if (pComp->getAssocComponent())
+            logCompStageTimes(pLog, pComp->getAssocComponent()->getComponentName(), pComp->getAssocComponent()->getStageTimes());
+        logCompStageTimes(pLog, pComp->getComponentName(), pComp->getStageTimes());
+        pElem = getNextElement(elemID);
+    }
+    getStageTimes(OCSD_BAD_CS_SRC_ID, &tree_times);
+    logCompStageTimes(pLog, "Decode Tree Total", tree_times);
+    pLog->LogMessage(ITraceErrorLog::HANDLE_GEN_INFO, OCSD_ERR_SEV_INFO, "========================\n");
+}
+
 /** add a protocol packet printer */
 ocsd_err_t DecodeTree::addPacketPrinter(uint8_t CSID, bool bMonitor, ItemPrinter **ppPrinter)
 {
@@ -0,0 +1,116 @@
+/*
+ * \file       ocsd_dcd_tree_pool.cpp
+ * \brief      OpenCSD : Pool of pre-built decode trees.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#include <algorithm>
+#include "common/ocsd_dcd_tree_pool.h"
+#include "common/ocsd_dcd_tree.h"
+
+DecodeTreePool::~DecodeTreePool()
+{
+    std::vector<DecodeTree *>::iterator it;
+    for (it = m_trees.begin(); it != m_trees.end(); it++)
+        DecodeTree::DestroyDecodeTree(*it);
+    m_trees.clear();
+    m_free.clear();
+}
+
+ocsd_err_t DecodeTreePool::addTree(DecodeTree *p_tree)
+{
+    if (!p_tree)
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (std::find(m_trees.begin(), m_trees.end(), p_tree) != m_trees.end())
+            return OCSD_ERR_INVALID_PARAM_VAL;
+        m_trees.push_back(p_tree);
+        m_free.push_back(p_tree);
+    }
+    m_free_cond.notify_one();
+    return OCSD_OK;
+}
+
+DecodeTree *DecodeTreePool::checkOut(const bool wait /* = false */)
+{
+    DecodeTree *p_tree = 0;
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    if (wait)
+    {
+        while (m_free.empty() && !m_trees.empty())
+            m_free_cond.wait(lock);
+    }
+
+    if (!m_free.empty())
+    {
+        p_tree = m_free.back();
+        m_free.pop_back();
+    }
+    return p_tree;
+}
+
+ocsd_err_t DecodeTreePool::checkIn(DecodeTree *p_tree)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if ((std::find(m_trees.begin(), m_trees.end(), p_tree) == m_trees.end()) ||
+            (std::find(m_free.begin(), m_free.end(), p_tree) != m_free.end()))
+            return OCSD_ERR_INVALID_PARAM_VAL;
+    }
+
+    // reset outside the lock - tree is still owned by the caller.
+    ocsd_err_t err = p_tree->resetDecodeTree();
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_free.push_back(p_tree);
+    }
+    m_free_cond.notify_one();
+    return err;
+}
+
+const int DecodeTreePool::getNumTrees() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return (int)m_trees.size();
+}
+
+const int DecodeTreePool::getNumFree() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return (int)m_free.size();
+}
+
+/* End of File ocsd_dcd_tree_pool.cpp */
@@ -80,8 +80,8 @@ static const char *s_errorCodeDescs[][2] = {
     {"OCSD_ERR_MEM_ACC_OVERLAP","Attempted to set an overlapping range in memory access map."},
     {"OCSD_ERR_MEM_ACC_FILE_NOT_FOUND","Memory access file could not be opened."},
     {"OCSD_ERR_MEM_ACC_FILE_DIFF_RANGE","Attempt to re-use the same memory access file for a different address range."},
-    {"OCSD_ERR_MEM_ACC_BAD_LEN","Memory accessor returned a bad read length value (larger than requested."},
     {"OCSD_ERR_MEM_ACC_RANGE_INVALID","Address range in accessor set to invalid values."},
+    {"OCSD_ERR_MEM_ACC_BAD_LEN","Memory accessor returned a bad read length value (larger than requested."},
     /* test errors - errors generated only by the test code, not the library */
     {"OCSD_ERR_TEST_SNAPSHOT_PARSE", "Test snapshot file parse error"},
     {"OCSD_ERR_TEST_SNAPSHOT_PARSE_INFO", "Test snapshot file parse information"},
@@ -91,12 +91,24 @@ static const char *s_errorCodeDescs[][2] = {
     {"OCSD_ERR_DCDREG_NAME_REPEAT","Attempted to register a decoder with the same name as another one."},
     {"OCSD_ERR_DCDREG_NAME_UNKNOWN","Attempted to find a decoder with a name that is not known in the library."},
     {"OCSD_ERR_DCDREG_TYPE_UNKNOWN","Attempted to find a decoder with a type that is not known in the library."},
+    {"OCSD_ERR_DCDREG_TOOMANY","Attempted to register too many custom decoders"},
     /* decoder config */
     {"OCSD_ERR_DCD_INTERFACE_UNUSED","Attempt to connect or use and interface not supported by this decoder."},
+    /* decoder state save / restore */
+    {"OCSD_ERR_DCD_STATE_INVALID","Saved decoder state data invalid - wrong component, version or size."},
+    {"OCSD_ERR_DCD_STATE_BUSY","Decoder state cannot be saved - decoder has output pending."},
+    /* ELF memory accessor */
+    {"OCSD_ERR_MEM_ACC_ELF_INVALID","File is not a valid ELF file, or has no executable loadable segments."},
+    /* basic block maps */
+    {"OCSD_ERR_BB_MAP_INVALID","Basic block map file invalid, or map does not match the memory image."},
     /* end marker*/
     {"OCSD_ERR_LAST", "No error - error code end marker"}
 };
 
+// table is indexed by error code - must have an entry for every code.
+static_assert((sizeof(s_errorCodeDescs) / sizeof(s_errorCodeDescs[0])) == (OCSD_ERR_LAST + 1), 
+              "Error code description table out of step with ocsd_err_t");
+
 ocsdError::ocsdError(const ocsd_err_severity_t sev_type, const ocsd_err_t code) :
     m_error_code(code),
     m_sev(sev_type),
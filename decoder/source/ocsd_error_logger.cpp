@@ -37,11 +37,16 @@
 
 //#include <iostream>
 #include <sstream>
+#include <iomanip>
 
 ocsdDefaultErrorLogger::ocsdDefaultErrorLogger() :
     m_Verbosity(OCSD_ERR_SEV_ERROR),
     m_output_logger(0),
-    m_created_output_logger(false)
+    m_created_output_logger(false),
+    m_hist_next(0),
+    m_hist_count(0),
+    m_repeat_limit(OCSD_ERR_LOG_DEF_REPEAT_LIMIT),
+    m_num_suppressed(0)
 {
     m_lastErr = 0;
     for(int i = 0; i < 0x80; i++)
@@ -102,16 +107,23 @@ void ocsdDefaultErrorLogger::LogError(const ocsd_hndl_err_log_t handle, const oc
     // only log errors that match or exceed the current verbosity
     if(m_Verbosity >= Error->getErrorSeverity())
     {
-        // print out only if required
+        uint32_t repeats = recordError(handle, Error);
+
+        // print out only if required, and repeat limit not reached.
         if(m_output_logger)
         {
             if(m_output_logger->isLogging())
             {
-                std::string errStr = "unknown";
-                if(handle < m_error_sources.size())
-                    errStr = m_error_sources[handle];
-                errStr += " : " + ocsdError::getErrorString(Error);
-                m_output_logger->LogMsg(errStr);
+                if((m_repeat_limit == 0) || (repeats <= m_repeat_limit))
+                {
+                    std::string errStr = getSourceName(handle);
+                    errStr += " : " + ocsdError::getErrorString(Error);
+                    if(repeats == m_repeat_limit)
+                        errStr += " [repeat limit reached - further occurrences not printed]";
+                    m_output_logger->LogMsg(errStr);
+                }
+                else
+                    m_num_suppressed++;
             }
         }
 
@@ -156,4 +168,88 @@ void ocsdDefaultErrorLogger::CreateErrorObj(ocsdError **ppErr, const ocsdError *
     *ppErr = new (std::nothrow) ocsdError(p_from);
 }
 
+const std::string &ocsdDefaultErrorLogger::getSourceName(const ocsd_hndl_err_log_t handle) const
+{
+    static const std::string unknown = "unknown";
+    if(handle < m_error_sources.size())
+        return m_error_sources[handle];
+    return unknown;
+}
+
+// save compact error record to the history, return the number of occurrences of this error.
+const uint32_t ocsdDefaultErrorLogger::recordError(const ocsd_hndl_err_log_t handle, const ocsdError *Error)
+{
+    if(m_err_hist.size() == 0)
+        m_err_hist.resize(OCSD_ERR_LOG_HIST_SIZE);
+
+    // combine with the most recent record if the same error.
+    ocsd_err_log_rec_t *pRec = 0;
+    if(m_hist_count)
+    {
+        pRec = &m_err_hist[(m_hist_next + OCSD_ERR_LOG_HIST_SIZE - 1) % OCSD_ERR_LOG_HIST_SIZE];
+        if((pRec->handle != handle) || (pRec->code != Error->getErrorCode()) || 
+           (pRec->sev != Error->getErrorSeverity()) || (pRec->chan_id != Error->getErrorChanID()))
+            pRec = 0;
+    }
+
+    if(pRec)
+        pRec->count++;
+    else
+    {
+        pRec = &m_err_hist[m_hist_next];
+        pRec->handle = handle;
+        pRec->code = Error->getErrorCode();
+        pRec->sev = Error->getErrorSeverity();
+        pRec->idx = Error->getErrorIndex();
+        pRec->chan_id = Error->getErrorChanID();
+        pRec->count = 1;
+        m_hist_next = (m_hist_next + 1) % OCSD_ERR_LOG_HIST_SIZE;
+        if(m_hist_count < OCSD_ERR_LOG_HIST_SIZE)
+            m_hist_count++;
+    }
+
+    uint64_t key = ((uint64_t)handle << 40) | ((uint64_t)Error->getErrorCode() << 8) | Error->getErrorChanID();
+    return ++m_repeat_counts[key];
+}
+
+const ocsd_err_log_rec_t *ocsdDefaultErrorLogger::getErrRecord(const int n) const
+{
+    if((n < 0) || (n >= m_hist_count))
+        return 0;
+    return &m_err_hist[(m_hist_next + OCSD_ERR_LOG_HIST_SIZE - m_hist_count + n) % OCSD_ERR_LOG_HIST_SIZE];
+}
+
+const std::string ocsdDefaultErrorLogger::getErrRecordString(const ocsd_err_log_rec_t *p_rec) const
+{
+    std::ostringstream oss;
+    ocsdError err(p_rec->sev, p_rec->code, p_rec->idx, p_rec->chan_id);
+
+    oss << getSourceName(p_rec->handle) << " : " << ocsdError::getErrorString(err);
+    if(p_rec->count > 1)
+        oss << "(x" << p_rec->count << ")";
+    return oss.str();
+}
+
+void ocsdDefaultErrorLogger::logSuppressedErrors()
+{
+    if(!m_num_suppressed || !m_output_logger || !m_output_logger->isLogging())
+        return;
+
+    std::ostringstream oss;
+    oss << "Error logger : " << m_num_suppressed << " repeated errors not printed.\n";
+    std::map<uint64_t, uint32_t>::const_iterator it;
+    for(it = m_repeat_counts.begin(); it != m_repeat_counts.end(); it++)
+    {
+        if(it->second > m_repeat_limit)
+        {
+            ocsd_hndl_err_log_t handle = (ocsd_hndl_err_log_t)(it->first >> 40);
+            ocsd_err_t code = (ocsd_err_t)((it->first >> 8) & 0xFFFFFFFF);
+            oss << getSourceName(handle) << " : error 0x" << std::hex << std::setw(4) << std::setfill('0') << (int)code;
+            oss << std::dec << std::setfill(' ') << " on ID 0x" << std::hex << (int)(it->first & 0xFF) << std::dec;
+            oss << " occurred " << it->second << " times.\n";
+        }
+    }
+    m_output_logger->LogMsg(oss.str());
+}
+
 /* End of File ocsd_error_logger.cpp */
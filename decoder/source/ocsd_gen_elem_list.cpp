@@ -34,6 +34,7 @@
  */ 
 
 #include "common/ocsd_gen_elem_list.h"
+#include "common/ocsd_stage_timer.h"
 
 OcsdGenElemList::OcsdGenElemList()
 {
@@ -45,16 +46,16 @@ OcsdGenElemList::OcsdGenElemList()
     m_sendIf = 0;
     m_CSID = 0;
     m_pElemArray = 0;
+    m_pIdxArray = 0;
+    m_p_out_time = 0;
 }
 
 OcsdGenElemList::~OcsdGenElemList()
 {
-    for(int i = 0; i<m_elemArraySize; i++)
-    {
-        delete m_pElemArray[i].pElem;
-    }
     delete [] m_pElemArray;
     m_pElemArray = 0;
+    delete [] m_pIdxArray;
+    m_pIdxArray = 0;
 }
 
 void OcsdGenElemList::reset()
@@ -74,8 +75,8 @@ OcsdTraceElement *OcsdGenElemList::getNextElem(const ocsd_trc_index_t trc_pkt_id
     {
         m_numUsed++;
         int idx = getAdjustedIdx(m_firstElemIdx + m_numUsed - 1);
-        pElem = m_pElemArray[idx].pElem;
-        m_pElemArray[idx].trc_pkt_idx = trc_pkt_idx;
+        pElem = &m_pElemArray[idx];
+        m_pIdxArray[idx] = trc_pkt_idx;
     }
     return pElem;
 }
@@ -86,7 +87,7 @@ const ocsd_gen_trc_elem_t OcsdGenElemList::getElemType(const int entryN) const
     if(entryN < getNumElem())
     {
         int idx = getAdjustedIdx(m_firstElemIdx + entryN);
-        elem_type = m_pElemArray[idx].pElem->getType();
+        elem_type = m_pElemArray[idx].getType();
     }
     return elem_type;
 }
@@ -103,7 +104,10 @@ ocsd_datapath_resp_t OcsdGenElemList::sendElements()
 
     while(elemToSend() && OCSD_DATA_RESP_IS_CONT(resp))
     {
-        resp = m_sendIf->first()->TraceElemIn(m_pElemArray[m_firstElemIdx].trc_pkt_idx, m_CSID, *(m_pElemArray[m_firstElemIdx].pElem));
+        {
+            OCSD_STAGE_TIMER_PTR(m_p_out_time);
+            resp = m_sendIf->first()->TraceElemIn(m_pIdxArray[m_firstElemIdx], m_CSID, m_pElemArray[m_firstElemIdx]);
+        }
         m_firstElemIdx++;
         if(m_firstElemIdx >= m_elemArraySize)
             m_firstElemIdx = 0;
@@ -112,12 +116,13 @@ ocsd_datapath_resp_t OcsdGenElemList::sendElements()
     return resp;
 }
 
-// this function will enlarge the array, and create extra element objects.
-// existing objects will be moved to the front of the array
+// this function will enlarge the array.
+// existing elements will be moved to the front of the new array
 // called if all elements are in use. (sets indexes accordingly)
 void OcsdGenElemList::growArray()
 {
-    elemPtr_t *p_new_array = 0;
+    OcsdTraceElement *p_new_array = 0;
+    ocsd_trc_index_t *p_new_idx = 0;
 
     int increment;
     if(m_elemArraySize == 0)
@@ -126,43 +131,42 @@ void OcsdGenElemList::growArray()
     else
         increment = m_elemArraySize / 2;    // grow by 50%
 
-     
-    p_new_array = new (std::nothrow) elemPtr_t[m_elemArraySize+increment];
+    p_new_array = new (std::nothrow) OcsdTraceElement[m_elemArraySize+increment];
+    p_new_idx = new (std::nothrow) ocsd_trc_index_t[m_elemArraySize+increment];
     
-    if(p_new_array != 0)
+    if((p_new_array != 0) && (p_new_idx != 0))
     {
-        // fill the last increment elements with new objects
-        for(int i=0; i < increment; i++)
-        {
-            p_new_array[m_elemArraySize+i].pElem = new (std::nothrow) OcsdTraceElement();
-        }
-
-        // copy the existing objects from the old array to the start of the new one
+        // copy the existing elements from the old array to the start of the new one
         // and adjust the indices.
         if(m_elemArraySize > 0)
         {
             int inIdx = m_firstElemIdx;
             for(int i = 0; i < m_elemArraySize; i++)
             {
-                p_new_array[i].pElem = m_pElemArray[inIdx].pElem;
-                p_new_array[i].trc_pkt_idx = m_pElemArray[inIdx].trc_pkt_idx;
+                p_new_array[i] = m_pElemArray[inIdx];
+                p_new_idx[i] = m_pIdxArray[inIdx];
                 inIdx++; 
                 if(inIdx >= m_elemArraySize)
                     inIdx = 0;
             }
         }
-
-        // delete the old pointer array.
-        delete [] m_pElemArray;
         m_elemArraySize += increment;
     }
     else
-         m_elemArraySize = 0;
+    {
+        delete [] p_new_array;
+        delete [] p_new_idx;
+        p_new_array = 0;
+        p_new_idx = 0;
+        m_elemArraySize = 0;
+    }
 
-    // update the internal array pointers to the new array
-    if(m_firstElemIdx >= 0)
-        m_firstElemIdx = 0;   
+    // delete the old arrays and update to the new ones
+    delete [] m_pElemArray;
+    delete [] m_pIdxArray;
+    m_firstElemIdx = 0;   
     m_pElemArray = p_new_array;
+    m_pIdxArray = p_new_idx;
 }
 
 /* End of File ocsd_gen_elem_list.cpp */
@@ -34,14 +34,17 @@
 */
 
 #include "common/ocsd_gen_elem_stack.h"
+#include "common/ocsd_stage_timer.h"
 
 OcsdGenElemStack::OcsdGenElemStack() :
     m_pElemArray(0),
+    m_pIdxArray(0),
     m_elemArraySize(0),
     m_elem_to_send(0),
     m_curr_elem_idx(0),
     m_send_elem_idx(0),
     m_CSID(0),
+    m_p_out_time(0),
     m_is_init(false)
 {
 
@@ -49,12 +52,10 @@ OcsdGenElemStack::OcsdGenElemStack() :
 
 OcsdGenElemStack::~OcsdGenElemStack()
 {
-    for (int i = 0; i<m_elemArraySize; i++)
-    {
-        delete m_pElemArray[i].pElem;
-    }
     delete [] m_pElemArray;
     m_pElemArray = 0;
+    delete [] m_pIdxArray;
+    m_pIdxArray = 0;
 }
 
 ocsd_err_t OcsdGenElemStack::addElem(const ocsd_trc_index_t trc_pkt_idx)
@@ -75,7 +76,7 @@ ocsd_err_t OcsdGenElemStack::addElem(const ocsd_trc_index_t trc_pkt_idx)
         copyPersistentData(m_curr_elem_idx, m_curr_elem_idx + 1);
         m_curr_elem_idx++;
     }
-    m_pElemArray[m_curr_elem_idx].trc_pkt_idx = trc_pkt_idx;
+    m_pIdxArray[m_curr_elem_idx] = trc_pkt_idx;
     m_elem_to_send++;
     return err;
 }
@@ -125,7 +126,10 @@ ocsd_datapath_resp_t OcsdGenElemStack::sendElements()
 
     while (m_elem_to_send && OCSD_DATA_RESP_IS_CONT(resp))
     {
-        resp = m_sendIf->first()->TraceElemIn(m_pElemArray[m_send_elem_idx].trc_pkt_idx, m_CSID, *(m_pElemArray[m_send_elem_idx].pElem));
+        {
+            OCSD_STAGE_TIMER_PTR(m_p_out_time);
+            resp = m_sendIf->first()->TraceElemIn(m_pIdxArray[m_send_elem_idx], m_CSID, m_pElemArray[m_send_elem_idx]);
+        }
         m_send_elem_idx++;
         m_elem_to_send--;
     }
@@ -138,49 +142,40 @@ ocsd_datapath_resp_t OcsdGenElemStack::sendElements()
 
 ocsd_err_t OcsdGenElemStack::growArray()
 {
-    elemPtr_t *p_new_array = 0;
     const int increment = 4;
-    
-    p_new_array = new (std::nothrow) elemPtr_t[m_elemArraySize + increment];
+    OcsdTraceElement *p_new_array = new (std::nothrow) OcsdTraceElement[m_elemArraySize + increment];
+    ocsd_trc_index_t *p_new_idx = new (std::nothrow) ocsd_trc_index_t[m_elemArraySize + increment];
 
-    if (p_new_array != 0)
+    if (!p_new_array || !p_new_idx)
     {
-        OcsdTraceElement *pElem = 0;
-
-        // fill the last increment elements with new objects
-        for (int i = 0; i < increment; i++)
-        {
-            pElem = new (std::nothrow) OcsdTraceElement();
-            if (!pElem)
-                return OCSD_ERR_MEM;
-            pElem->init();
-            p_new_array[m_elemArraySize + i].pElem = pElem;
-        }
+        delete [] p_new_array;
+        delete [] p_new_idx;
+        return OCSD_ERR_MEM;
+    }
 
-        // copy the existing objects from the old array to the start of the new one
-        if (m_elemArraySize > 0)
-        {            
-            for (int i = 0; i < m_elemArraySize; i++)
-            {
-                p_new_array[i].pElem = m_pElemArray[i].pElem;
-                p_new_array[i].trc_pkt_idx = m_pElemArray[i].trc_pkt_idx;
-            }
-        }
+    // init the new elements
+    for (int i = 0; i < increment; i++)
+        p_new_array[m_elemArraySize + i].init();
 
-        // delete the old pointer array.
-        delete[] m_pElemArray;
-        m_elemArraySize += increment;
-        m_pElemArray = p_new_array;
+    // copy the existing elements from the old array to the start of the new one
+    for (int i = 0; i < m_elemArraySize; i++)
+    {
+        p_new_array[i] = m_pElemArray[i];
+        p_new_idx[i] = m_pIdxArray[i];
     }
-    else
-        return OCSD_ERR_MEM;
 
+    // delete the old arrays.
+    delete [] m_pElemArray;
+    delete [] m_pIdxArray;
+    m_elemArraySize += increment;
+    m_pElemArray = p_new_array;
+    m_pIdxArray = p_new_idx;
     return OCSD_OK;
 }
 
 void OcsdGenElemStack::copyPersistentData(int src, int dst)
 {
-    m_pElemArray[dst].pElem->copyPersistentData(*(m_pElemArray[src].pElem));
+    m_pElemArray[dst].copyPersistentData(m_pElemArray[src]);
 }
 
 const bool OcsdGenElemStack::isInit()
@@ -33,10 +33,14 @@
  */ 
 
 #include <sstream>
+#include <cstring>
 #include "opencsd/ptm/trc_pkt_decode_ptm.h"
+#include "common/trc_state_blob.h"
 
 #define DCD_NAME "DCD_PTM"
 
+static const uint32_t PTM_SUPPORTED_DECODE_OP_FLAGS = OCSD_OPFLG_PKTDEC_MERGE_RANGES;
+
 TrcPktDecodePtm::TrcPktDecodePtm()
     : TrcPktDecodeBase(DCD_NAME)
 {
@@ -168,15 +172,13 @@ ocsd_err_t TrcPktDecodePtm::onProtocolConfig()
 
     // static config - copy of CSID for easy reference
     m_CSID = m_config->getTraceID();
+    m_unsync_info = UNSYNC_INIT_DECODER;  // new config - unsynced as on creation.
 
-    // handle return stack implementation
-    if (m_config->hasRetStack())
-    {
-        m_return_stack.set_active(m_config->enaRetStack());
+    // handle return stack implementation - set both ways as a reconfigured decoder may have had it enabled.
+    m_return_stack.set_active(m_config->hasRetStack() && m_config->enaRetStack());
 #ifdef TRC_RET_STACK_DEBUG
-        m_return_stack.set_dbg_logger(this);
+    m_return_stack.set_dbg_logger(this);
 #endif
-    }
     
     // config options affecting decode
     m_instr_info.pe_type.profile = m_config->coreProfile();
@@ -190,14 +192,113 @@ ocsd_err_t TrcPktDecodePtm::onProtocolConfig()
 
 void TrcPktDecodePtm::initDecoder()
 {
+    // set the operational modes supported.
+    m_supported_op_flags = PTM_SUPPORTED_DECODE_OP_FLAGS;
+
     m_CSID = 0;
     m_instr_info.pe_type.profile = profile_Unknown;
     m_instr_info.pe_type.arch = ARCH_UNKNOWN;
     m_instr_info.dsb_dmb_waypoints = 0;
     m_unsync_info = UNSYNC_INIT_DECODER;
+    m_filter_active = false;
     resetDecoder();
 }
 
+ocsd_err_t TrcPktDecodePtm::setPeFilter(const OcsdPeFilter &filter)
+{
+    m_pe_filter = filter;
+    m_filter_active = m_pe_filter.isActive();
+    m_filter_out_sent = false;
+    updateFilterCtxt();
+    return OCSD_OK;
+}
+
+void TrcPktDecodePtm::updateFilterCtxt()
+{
+    // PTM has no exception level in the trace - EL predicates do not match.
+    m_filter_ctxt_out = m_filter_active && 
+        !m_pe_filter.matchContext(m_pe_context.ctxt_id_valid ? m_pe_context.context_id : 0,
+                                  m_pe_context.vmid_valid ? m_pe_context.vmid : 0,
+                                  m_pe_context.exception_level, m_pe_context.security_level);
+}
+
+/* state save and restore */
+#define PTM_DCD_STATE_TAG OCSD_STATE_TAG('P','T','D','C')
+#define PTM_DCD_STATE_VER 3
+
+ocsd_err_t TrcPktDecodePtm::saveState(std::vector<uint8_t> &state)
+{
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    // cannot save part way through a packet after a WAIT.
+    if (processStateIsCont())
+        return OCSD_ERR_DCD_STATE_BUSY;
+
+    TrcStateWriter wr(state, PTM_DCD_STATE_TAG, PTM_DCD_STATE_VER);
+    wr.put(m_curr_state);
+    wr.put(m_unsync_info);
+    wr.put(m_index_curr_pkt);
+    wr.put(m_curr_pe_state);
+    wr.put(m_pe_context);
+    wr.put(m_need_isync);
+    wr.put(m_instr_info);
+    wr.put(m_mem_nacc_pending);
+    wr.put(m_nacc_addr);
+    wr.put(m_i_sync_pe_ctxt);
+    m_return_stack.saveState(wr);
+    wr.put(m_filter_ctxt_out);
+    wr.put(m_filter_out_sent);
+
+    // data persistent between output elements
+    wr.put(m_output_elem.isa);
+    wr.put(m_output_elem.context);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcPktDecodePtm::restoreState(const uint8_t *p_state, const size_t size)
+{
+    ocsd_err_t err;
+
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    const unsync_info_t unsync_info = m_unsync_info;   // current reason kept if restore fails.
+    TrcStateReader rd(p_state, size, PTM_DCD_STATE_TAG, PTM_DCD_STATE_VER);
+    rd.get(m_curr_state);
+    rd.get(m_unsync_info);
+    rd.get(m_index_curr_pkt);
+    rd.get(m_curr_pe_state);
+    rd.get(m_pe_context);
+    rd.get(m_need_isync);
+    rd.get(m_instr_info);
+    rd.get(m_mem_nacc_pending);
+    rd.get(m_nacc_addr);
+    rd.get(m_i_sync_pe_ctxt);
+    m_return_stack.restoreState(rd);
+    rd.get(m_filter_ctxt_out);
+    rd.get(m_filter_out_sent);
+    m_output_elem.init();
+    rd.get(m_output_elem.isa);
+    rd.get(m_output_elem.context);
+
+    if (processStateIsCont())
+        rd.setInvalid();
+
+    err = rd.end();
+    if (err != OCSD_OK)
+    {
+        // bad state data - back to unsynced start state.
+        m_unsync_info = unsync_info;
+        resetDecoder();
+        m_return_stack.flush();
+    }
+    m_atoms.clearAll();
+    m_range_held = false;
+    return err;
+}
+
 void TrcPktDecodePtm::resetDecoder()
 {
     m_curr_state = NO_SYNC;
@@ -218,7 +319,11 @@ void TrcPktDecodePtm::resetDecoder()
     m_curr_pe_state.valid = false;
 
     m_atoms.clearAll();
+    m_range_held = false;
     m_output_elem.init();
+
+    m_filter_out_sent = false;
+    updateFilterCtxt();
 }
 
 ocsd_datapath_resp_t TrcPktDecodePtm::decodePacket()
@@ -275,6 +380,7 @@ ocsd_datapath_resp_t TrcPktDecodePtm::decodePacket()
             {
                 m_pe_context.context_id = m_curr_packet_in->context.ctxtID;
                 m_pe_context.ctxt_id_valid = 1;
+                updateFilterCtxt();
                 m_output_elem.setType(OCSD_GEN_TRC_ELEM_PE_CONTEXT);
                 m_output_elem.setContext(m_pe_context);
                 resp = outputTraceElement(m_output_elem);
@@ -292,6 +398,7 @@ ocsd_datapath_resp_t TrcPktDecodePtm::decodePacket()
             {
                 m_pe_context.vmid = m_curr_packet_in->context.VMID;
                 m_pe_context.vmid_valid = 1;
+                updateFilterCtxt();
                 m_output_elem.setType(OCSD_GEN_TRC_ELEM_PE_CONTEXT);
                 m_output_elem.setContext(m_pe_context);
                 resp = outputTraceElement(m_output_elem);
@@ -350,6 +457,7 @@ ocsd_datapath_resp_t TrcPktDecodePtm::processIsync()
             m_i_sync_pe_ctxt = true;
         }
         m_pe_context.security_level = m_curr_packet_in->getNS() ? ocsd_sec_nonsecure : ocsd_sec_secure;
+        updateFilterCtxt();
         
         if(m_need_isync || (m_curr_packet_in->iSyncReason() != iSync_Periodic))
         {
@@ -510,13 +618,43 @@ ocsd_datapath_resp_t TrcPktDecodePtm::processAtomRange(const ocsd_atm_val A, con
     std::ostringstream oss;
     ocsd_err_t err = OCSD_OK;
 
+    // outside the PE filter - no instruction walk, one marker until back inside.
+    // Return stack will not be valid without the walk - resync on the next address packet.
+    if(isFilteredOut())
+    {
+        m_curr_pe_state.valid = false;
+        m_return_stack.flush();
+        if(!m_filter_out_sent)
+        {
+            m_filter_out_sent = true;
+            m_output_elem.setType(OCSD_GEN_TRC_ELEM_FILTERED_OUT);
+            m_output_elem.st_addr = m_curr_pe_state.instr_addr;
+            resp = outputTraceElementIdx(m_index_curr_pkt,m_output_elem);
+        }
+        return resp;
+    }
+    m_filter_out_sent = false;
+
+    // held range from the previous atom continues at the current address.
+    const bool bMerge = m_range_held;
+    const ocsd_vaddr_t held_st_addr = m_output_elem.st_addr;
+    const uint32_t held_num_instr = m_output_elem.num_instr_range;
+    m_range_held = false;
+
     m_instr_info.instr_addr = m_curr_pe_state.instr_addr;
     m_instr_info.isa = m_curr_pe_state.isa;
 
     // set type (which resets out-elem) before traceInstrToWP modifies out-elem values
-    m_output_elem.setType(OCSD_GEN_TRC_ELEM_INSTR_RANGE); 
+    if(!bMerge)
+        m_output_elem.setType(OCSD_GEN_TRC_ELEM_INSTR_RANGE); 
     
     err = traceInstrToWP(bWPFound,traceWPOp,nextAddrMatch);
+    if(bMerge)
+    {
+        m_output_elem.st_addr = held_st_addr;
+        m_output_elem.num_instr_range += held_num_instr;
+    }
+
     if(err != OCSD_OK)
     {
         if(err == OCSD_ERR_UNSUPPORTED_ISA)
@@ -524,8 +662,10 @@ ocsd_datapath_resp_t TrcPktDecodePtm::processAtomRange(const ocsd_atm_val A, con
                 m_curr_pe_state.valid = false; // need a new address packet
                 oss << "Warning: unsupported instruction set processing " << pkt_msg << " packet.";
                 LogError(ocsdError(OCSD_ERR_SEV_WARN,err,m_index_curr_pkt,m_CSID,oss.str()));  
+                if(bMerge)
+                    resp = outputTraceElementIdx(m_index_curr_pkt,m_output_elem);
                 // wait for next address
-                return OCSD_RESP_WARN_CONT;
+                return OCSD_DATA_RESP_IS_CONT(resp) ? OCSD_RESP_WARN_CONT : resp;
         }
         else
         {
@@ -589,7 +729,11 @@ ocsd_datapath_resp_t TrcPktDecodePtm::processAtomRange(const ocsd_atm_val A, con
         if(m_curr_packet_in->hasCC())
             m_output_elem.setCycleCount(m_curr_packet_in->getCCVal());
         m_output_elem.setLastInstrCond(m_instr_info.is_conditional);
-        resp = outputTraceElementIdx(m_index_curr_pkt,m_output_elem);
+
+        // N atom falls through to the next instruction - hold the range to merge with the next atom in the packet.
+        m_range_held = canHoldRange(A);
+        if(!m_range_held)
+            resp = outputTraceElementIdx(m_index_curr_pkt,m_output_elem);
 
         m_curr_pe_state.instr_addr = m_instr_info.instr_addr;
         m_curr_pe_state.isa = m_instr_info.next_isa;
@@ -599,7 +743,7 @@ ocsd_datapath_resp_t TrcPktDecodePtm::processAtomRange(const ocsd_atm_val A, con
         // no waypoint - likely inaccessible memory range.
         m_curr_pe_state.valid = false; // need an address update 
 
-        if(m_output_elem.st_addr != m_output_elem.en_addr)
+        if(m_output_elem.en_addr != m_curr_pe_state.instr_addr)
         {
             // some trace before we were out of memory access range
             m_output_elem.setLastInstrInfo(true,m_instr_info.type, m_instr_info.sub_type,m_instr_info.instr_size);
@@ -607,35 +751,92 @@ ocsd_datapath_resp_t TrcPktDecodePtm::processAtomRange(const ocsd_atm_val A, con
             m_output_elem.setLastInstrCond(m_instr_info.is_conditional);
             resp = outputTraceElementIdx(m_index_curr_pkt,m_output_elem);
         }
+        else if(bMerge)
+            resp = outputTraceElementIdx(m_index_curr_pkt,m_output_elem);  // nothing more traced - send the held range.
     }
     return resp;
 }
 
+// merge mode - hold an N atom range if there are further atoms in this packet without cycle counts.
+// Not with a PE filter, as the next range may be filtered out.
+bool TrcPktDecodePtm::canHoldRange(const ocsd_atm_val A)
+{
+    return (getComponentOpMode() & OCSD_OPFLG_PKTDEC_MERGE_RANGES) &&
+           !m_filter_active &&
+           (A == ATOM_N) &&
+           (m_curr_packet_in->getType() == PTM_PKT_ATOM) &&
+           !m_curr_packet_in->hasCC() &&
+           (m_atoms.numAtoms() > 1);
+}
+
 ocsd_err_t TrcPktDecodePtm::traceInstrToWP(bool &bWPFound, const waypoint_trace_t traceWPOp /*= TRACE_WAYPOINT*/, const ocsd_vaddr_t nextAddrMatch /*= 0*/)
 {
-    uint32_t opcode;
+    uint8_t span[OCSD_DCD_WP_SCAN_BYTES];
     uint32_t bytesReq;
+    uint32_t span_offset, num_skipped;
     ocsd_err_t err = OCSD_OK;
     ocsd_vaddr_t curr_op_address;
 
     ocsd_mem_space_acc_t mem_space = (m_pe_context.security_level == ocsd_sec_secure) ? OCSD_MEM_SPACE_S : OCSD_MEM_SPACE_N;
 
+    // when looking for a waypoint, read a span of memory and skip instructions that cannot be waypoints.
+    const uint32_t readSize = (traceWPOp == TRACE_WAYPOINT) ? OCSD_DCD_WP_SCAN_BYTES : 4;
+
     m_output_elem.st_addr = m_output_elem.en_addr = m_instr_info.instr_addr;
     m_output_elem.num_instr_range = 0;
 
     bWPFound = false;
 
+    // range may be resolved from a precomputed basic block map.
+    if((traceWPOp == TRACE_WAYPOINT) && !m_mem_nacc_pending && 
+       instrFindBasicBlock(mem_space, &m_instr_info, &num_skipped))
+    {
+        // whole range, including the waypoint.
+        m_output_elem.en_addr = m_instr_info.instr_addr;
+        m_output_elem.num_instr_range = num_skipped;
+        m_output_elem.last_i_type = m_instr_info.type;
+        bWPFound = true;
+        return OCSD_OK;
+    }
+
     while(!bWPFound && !m_mem_nacc_pending)
     {
-        // start off by reading next opcode;
-        bytesReq = 4;
+        // start off by reading next opcode(s);
+        bytesReq = readSize;
         curr_op_address = m_instr_info.instr_addr;  // save the start address for the current opcode
-        err = accessMemory(m_instr_info.instr_addr,mem_space,&bytesReq,(uint8_t *)&opcode);
+        err = accessMemory(m_instr_info.instr_addr,mem_space,&bytesReq,span);
         if(err != OCSD_OK) break;
 
-        if(bytesReq == 4) // got data back
+        // full span may not be accessible - fall back to a single opcode read.
+        if((bytesReq < 4) && (readSize > 4))
         {
-            m_instr_info.opcode = opcode;
+            bytesReq = 4;
+            err = accessMemory(m_instr_info.instr_addr,mem_space,&bytesReq,span);
+            if(err != OCSD_OK) break;
+        }
+
+        if(bytesReq >= 4) // got data back
+        {
+            span_offset = 0;
+            if(traceWPOp == TRACE_WAYPOINT)
+            {
+                err = instrFindNextWaypoint(&m_instr_info, span, bytesReq, &num_skipped);
+                if(err != OCSD_OK) break;
+                if(num_skipped)
+                {
+                    m_output_elem.en_addr = m_instr_info.instr_addr;
+                    m_output_elem.num_instr_range += num_skipped;
+                    m_output_elem.last_i_type = m_instr_info.type;
+                }
+
+                // next opcode not in the span - read again from the current address
+                span_offset = (uint32_t)(m_instr_info.instr_addr - curr_op_address);
+                if(span_offset + 4 > bytesReq)
+                    continue;
+                curr_op_address = m_instr_info.instr_addr;
+            }
+
+            memcpy(&m_instr_info.opcode, span + span_offset, sizeof(uint32_t));
             err = instrDecode(&m_instr_info);
             if(err != OCSD_OK) break;
 
@@ -33,8 +33,6 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
  */ 
 
-#include <sstream>
-#include <iomanip>
 
 #include "opencsd/ptm/trc_pkt_elem_ptm.h"
 
@@ -152,51 +150,63 @@ void PtmTrcPacket::SetAtomFromPHdr(const uint8_t pHdr)
     // printing
 void PtmTrcPacket::toString(std::string &str) const
 {
-    std::string temp1, temp2;
-    std::ostringstream oss;
+    char szBuffer[512];
+    toStringBuf(szBuffer, sizeof(szBuffer));
+    str = szBuffer;
+}
+
+int PtmTrcPacket::toStringBuf(char *buffer, const int buf_size) const
+{
+    trcPrintBuffer buf(buffer, buf_size);
+    const char *name;
+    const char *desc;
 
-    packetTypeName(type, temp1,temp2);
-    oss << temp1 << " : " << temp2 << "; ";
+    name = packetTypeName(type, &desc);
+    buf.addStr(name);
+    buf.addStr(" : ");
+    buf.addStr(desc);
+    buf.addStr("; ");
 
     // some packets require additional data.
     switch(type)
     {
     case PTM_PKT_BAD_SEQUENCE:
-        packetTypeName(err_type, temp1,temp2);
-        oss << "[" << temp1 << "]; ";
+        name = packetTypeName(err_type, 0);
+        buf.addChar('[');
+        buf.addStr(name);
+        buf.addStr("]; ");
         break;
 
     case PTM_PKT_ATOM:
-        getAtomStr(temp1);
-        oss << temp1;
+        getAtomStr(buf);
         break;
 
     case PTM_PKT_CONTEXT_ID:
-        oss << "CtxtID=0x" << std::hex << std::setw(8) << std::setfill('0') << context.ctxtID << "; ";
+        buf.addStr("CtxtID=0x");
+        buf.addHex(context.ctxtID, 8);
+        buf.addStr("; ");
         break;
 
     case PTM_PKT_VMID:
-        oss << "VMID=0x" << std::hex << std::setw(2) << std::setfill('0') << context.VMID << "; ";
+        buf.addStr("VMID=0x");
+        buf.addHex(context.VMID, 2);
+        buf.addStr("; ");
         break;
 
     case PTM_PKT_WPOINT_UPDATE:
     case PTM_PKT_BRANCH_ADDRESS:
-        getBranchAddressStr(temp1);
-        oss << temp1;
+        getBranchAddressStr(buf);
         break;
 
     case PTM_PKT_I_SYNC:
-        getISyncStr(temp1);
-        oss << temp1;
+        getISyncStr(buf);
         break;
 
     case PTM_PKT_TIMESTAMP:
-        getTSStr(temp1);
-        oss << temp1;
+        getTSStr(buf);
         break;
     }
-
-    str = oss.str();
+    return buf.length();
 }
 
 void PtmTrcPacket::toStringFmt(const uint32_t fmtFlags, std::string &str) const
@@ -204,105 +214,87 @@ void PtmTrcPacket::toStringFmt(const uint32_t fmtFlags, std::string &str) const
     toString(str);
 }
 
-void PtmTrcPacket::getAtomStr(std::string &valStr) const
+void PtmTrcPacket::getAtomStr(trcPrintBuffer &buf) const
 {   
-    std::ostringstream oss;
     uint32_t bitpattern = atom.En_bits; // arranged LSBit oldest, MSbit newest
 
     if(cc_valid)    // cycle accurate trace - single atom
     {
-        std::string subStr;
-        oss << ((bitpattern & 0x1) ? "E" : "N"); // in spec read L->R, oldest->newest
-        oss << "; ";
-        getCycleCountStr(subStr);
-        oss << subStr;
+        buf.addChar((bitpattern & 0x1) ? 'E' : 'N'); // in spec read L->R, oldest->newest
+        buf.addStr("; ");
+        getCycleCountStr(buf);
     }
     else
     {
         // none cycle count
         for(int i = 0; i < atom.num; i++)
         {
-            oss << ((bitpattern & 0x1) ? "E" : "N"); // in spec read L->R, oldest->newest
+            buf.addChar((bitpattern & 0x1) ? 'E' : 'N'); // in spec read L->R, oldest->newest
             bitpattern >>= 1;
         } 
-        oss << "; ";
+        buf.addStr("; ");
     }
-    valStr = oss.str();
 }
 
-void PtmTrcPacket::getBranchAddressStr(std::string &valStr) const
+void PtmTrcPacket::getBranchAddressStr(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
-    std::string subStr;
-
     // print address.
-    trcPrintableElem::getValStr(subStr,32,addr.valid_bits,addr.val,true,addr.pkt_bits);
-    oss << "Addr=" << subStr << "; ";
+    buf.addStr("Addr=");
+    trcPrintableElem::getValStr(buf,32,addr.valid_bits,addr.val,true,addr.pkt_bits);
+    buf.addStr("; ");
 
     // current ISA if changed.
     if(curr_isa != prev_isa)
-    {
-        getISAStr(subStr);
-        oss << subStr;
-    }
+        getISAStr(buf);
 
     // S / NS etc if changed.
     if(context.updated)
     {
-        oss << (context.curr_NS ? "NS; " : "S; ");
-        oss << (context.curr_Hyp ? "Hyp; " : "");
+        buf.addStr(context.curr_NS ? "NS; " : "S; ");
+        buf.addStr(context.curr_Hyp ? "Hyp; " : "");
     }
     
     // exception? 
     if(exception.bits.present)
-    {
-        getExcepStr(subStr);
-        oss << subStr;
-    }
+        getExcepStr(buf);
 
     if(cc_valid)
-    {
-        getCycleCountStr(subStr);
-        oss << subStr;
-    }
-    valStr = oss.str();
+        getCycleCountStr(buf);
 }
 
-void PtmTrcPacket::getISAStr(std::string &isaStr) const
+void PtmTrcPacket::getISAStr(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
-    oss << "ISA=";
+    buf.addStr("ISA=");
     switch(curr_isa)
     {
     case ocsd_isa_arm: 
-        oss << "ARM(32); ";
+        buf.addStr("ARM(32); ");
         break;
 
     case ocsd_isa_thumb2:
-        oss << "Thumb2; ";
+        buf.addStr("Thumb2; ");
         break;
 
     case ocsd_isa_aarch64:
-        oss << "AArch64; ";
+        buf.addStr("AArch64; ");
         break;
 
     case ocsd_isa_tee:
-        oss << "ThumbEE; ";
+        buf.addStr("ThumbEE; ");
         break;
 
     case ocsd_isa_jazelle:
-        oss << "Jazelle; ";
+        buf.addStr("Jazelle; ");
         break;
 
     default:
     case ocsd_isa_unknown:
-        oss << "Unknown; ";
+        buf.addStr("Unknown; ");
         break;
     }
-    isaStr = oss.str();
 }
 
-void PtmTrcPacket::getExcepStr(std::string &excepStr) const
+void PtmTrcPacket::getExcepStr(trcPrintBuffer &buf) const
 {
     static const char *ARv7Excep[] = {
         "No Exception", "Debug Halt", "SMC", "Hyp", 
@@ -311,163 +303,163 @@ void PtmTrcPacket::getExcepStr(std::string &excepStr) const
         "Data Fault", "Generic", "IRQ", "FIQ"
     };
 
-    std::ostringstream oss;
-    oss << "Excep=";
+    buf.addStr("Excep=");
     if(exception.number < 16)
-        oss << ARv7Excep[exception.number];
+        buf.addStr(ARv7Excep[exception.number]);
     else
-        oss << "Unknown";
-    oss << " [" << std::hex << std::setw(2) << std::setfill('0') << exception.number << "]; ";
-    excepStr = oss.str();
+        buf.addStr("Unknown");
+    buf.addStr(" [");
+    buf.addHex(exception.number, 2);
+    buf.addStr("]; ");
 }
 
-void PtmTrcPacket::getISyncStr(std::string &valStr) const
+void PtmTrcPacket::getISyncStr(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
-    std::string tmpStr;
     static const char *reason[] = { "Periodic", "Trace Enable", "Restart Overflow", "Debug Exit" };
     
     // reason.
-    oss << "(" << reason[(int)i_sync_reason] << "); ";
+    buf.addChar('(');
+    buf.addStr(reason[(int)i_sync_reason]);
+    buf.addStr("); ");
 
     // full address.
-    oss << "Addr=0x" << std::hex << std::setfill('0') << std::setw(8) << (uint32_t)addr.val << "; ";
+    buf.addStr("Addr=0x");
+    buf.addHex((uint32_t)addr.val, 8);
+    buf.addStr("; ");
         
-    oss << (context.curr_NS ? "NS; " : "S; ");
-    oss << (context.curr_Hyp ? "Hyp; " : " ");
+    buf.addStr(context.curr_NS ? "NS; " : "S; ");
+    buf.addStr(context.curr_Hyp ? "Hyp; " : " ");
     
     if(context.updated_c)
     {
-        oss << "CtxtID=" << std::hex  << std::setw(8) << std::setfill('0') << context.ctxtID << "; ";
+        buf.addStr("CtxtID=");
+        buf.addHex(context.ctxtID, 8);
+        buf.addStr("; ");
     }
     
-    getISAStr(tmpStr);
-    oss << tmpStr;
+    getISAStr(buf);
 
     if(cc_valid)
-    {
-        getCycleCountStr(tmpStr);
-        oss << tmpStr;
-    } 
-    valStr = oss.str();
+        getCycleCountStr(buf);
 }
 
-void PtmTrcPacket::getTSStr(std::string &valStr) const
+void PtmTrcPacket::getTSStr(trcPrintBuffer &buf) const
 {
-    std::string tmpStr;
-    std::ostringstream oss;
-
-    trcPrintableElem::getValStr(tmpStr,64,64,timestamp,true,ts_update_bits);
-    oss << "TS=" << tmpStr + "(" << std::dec << timestamp << "); ";
+    buf.addStr("TS=");
+    trcPrintableElem::getValStr(buf,64,64,timestamp,true,ts_update_bits);
+    buf.addChar('(');
+    buf.addDec(timestamp);
+    buf.addStr("); ");
     if(cc_valid)
-    {
-        getCycleCountStr(tmpStr);
-        oss << tmpStr;
-    } 
-    valStr = oss.str();
+        getCycleCountStr(buf);
 }
 
 
-void PtmTrcPacket::getCycleCountStr(std::string &subStr) const
+void PtmTrcPacket::getCycleCountStr(trcPrintBuffer &buf) const
 {
-    std::ostringstream oss;
-    oss << "Cycles=" << std::dec << cycle_count << "; ";
-    subStr = oss.str();
+    buf.addStr("Cycles=");
+    buf.addDec(cycle_count);
+    buf.addStr("; ");
 }
 
 
-void PtmTrcPacket::packetTypeName(const ocsd_ptm_pkt_type pkt_type, std::string &name, std::string &desc) const
+const char *PtmTrcPacket::packetTypeName(const ocsd_ptm_pkt_type pkt_type, const char **ppDesc) const
 {
+    const char *pName;
+    const char *pDesc;
+
     switch(pkt_type)
     {
     case PTM_PKT_NOTSYNC:        //!< no sync found yet
-        name = "NOTSYNC";
-        desc = "PTM Not Synchronised";
+        pName = "NOTSYNC";
+        pDesc = "PTM Not Synchronised";
         break;
 
     case PTM_PKT_INCOMPLETE_EOT:
-        name = "INCOMPLETE_EOT";
-        desc = "Incomplete packet flushed at end of trace";
+        pName = "INCOMPLETE_EOT";
+        pDesc = "Incomplete packet flushed at end of trace";
         break;
 
     case PTM_PKT_NOERROR:
-        name = "NO_ERROR";
-        desc = "Error type not set";
+        pName = "NO_ERROR";
+        pDesc = "Error type not set";
         break;
 
     case PTM_PKT_BAD_SEQUENCE:
-        name = "BAD_SEQUENCE";
-        desc = "Invalid sequence in packet";
+        pName = "BAD_SEQUENCE";
+        pDesc = "Invalid sequence in packet";
         break;
 
     case PTM_PKT_RESERVED:
-        name = "RESERVED";
-        desc = "Reserved Packet Header";
+        pName = "RESERVED";
+        pDesc = "Reserved Packet Header";
         break;
 
     case PTM_PKT_BRANCH_ADDRESS:
-        name = "BRANCH_ADDRESS";
-        desc = "Branch address packet";
+        pName = "BRANCH_ADDRESS";
+        pDesc = "Branch address packet";
         break;
 
     case PTM_PKT_A_SYNC:
-        name = "ASYNC";
-        desc = "Alignment Synchronisation Packet";
+        pName = "ASYNC";
+        pDesc = "Alignment Synchronisation Packet";
         break;
 
 	case PTM_PKT_I_SYNC:
-        name = "ISYNC";
-        desc = "Instruction Synchronisation packet";
+        pName = "ISYNC";
+        pDesc = "Instruction Synchronisation packet";
         break;
 
     case PTM_PKT_TRIGGER:
-        name = "TRIGGER";
-        desc = "Trigger Event packet";
+        pName = "TRIGGER";
+        pDesc = "Trigger Event packet";
         break;
 
 	case PTM_PKT_WPOINT_UPDATE:
-        name = "WP_UPDATE";
-        desc = "Waypoint update packet";
+        pName = "WP_UPDATE";
+        pDesc = "Waypoint update packet";
         break;
 
 	case PTM_PKT_IGNORE:
-        name = "IGNORE";
-        desc = "Ignore packet";
+        pName = "IGNORE";
+        pDesc = "Ignore packet";
         break;
 
 	case PTM_PKT_CONTEXT_ID:
-        name = "CTXTID";
-        desc = "Context ID packet";
+        pName = "CTXTID";
+        pDesc = "Context ID packet";
         break;
 
     case PTM_PKT_VMID:
-        name = "VMID";
-        desc = "VM ID packet";
+        pName = "VMID";
+        pDesc = "VM ID packet";
         break;
 
 	case PTM_PKT_ATOM:
-        name = "ATOM";
-        desc = "Atom packet";
+        pName = "ATOM";
+        pDesc = "Atom packet";
         break;
 
 	case PTM_PKT_TIMESTAMP:
-        name = "TIMESTAMP";
-        desc = "Timestamp packet";
+        pName = "TIMESTAMP";
+        pDesc = "Timestamp packet";
         break;
 
 	case PTM_PKT_EXCEPTION_RET:
-        name = "ERET";
-        desc = "Exception return packet";
+        pName = "ERET";
+        pDesc = "Exception return packet";
         break;
 
     default:
-        name = "UNKNOWN";
-        desc = "Unknown packet type";
+        pName = "UNKNOWN";
+        pDesc = "Unknown packet type";
         break;
 
 	//PTM_PKT_BRANCH_OR_BYPASS_EOT, 
     //PTM_PKT_TPIU_PAD_EOB,  
     }
+    if(ppDesc) *ppDesc = pDesc;
+    return pName;
 }
 
 /* End of File trc_pkt_elem_ptm.cpp */
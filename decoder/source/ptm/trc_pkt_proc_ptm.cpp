@@ -35,6 +35,7 @@
 #include "opencsd/ptm/trc_pkt_proc_ptm.h"
 #include "opencsd/ptm/trc_cmp_cfg_ptm.h"
 #include "common/ocsd_error.h"
+#include "common/trc_state_blob.h"
 
 
 #ifdef __GNUC__
@@ -74,6 +75,114 @@ ocsd_err_t TrcPktProcPtm::onProtocolConfig()
     return err;
 }
 
+/* state save and restore */
+#define PTM_PROC_STATE_TAG OCSD_STATE_TAG('P','T','P','P')
+#define PTM_PROC_STATE_VER 1
+
+ocsd_err_t TrcPktProcPtm::saveState(std::vector<uint8_t> &state)
+{
+    uint16_t fn_idx = 0x100;    // packet function saved as index into the header table.
+
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    for (uint16_t i = 0; i < 256; i++)
+    {
+        if (m_i_table[i].pptkFn == m_pIPktFn)
+        {
+            fn_idx = i;
+            break;
+        }
+    }
+    if (fn_idx == 0x100)
+        return OCSD_ERR_FAIL;
+
+    TrcStateWriter wr(state, PTM_PROC_STATE_TAG, PTM_PROC_STATE_VER);
+
+    // processor state
+    wr.put(m_process_state);
+    wr.putVec(m_currPacketData);
+    wr.put(m_currPktIdx);
+    wr.put((const ocsd_ptm_pkt &)m_curr_packet);
+    wr.put(m_curr_pkt_index);
+    wr.put(m_waitASyncSOPkt);
+    wr.put(m_bAsyncRawOp);
+    wr.put(m_bOPNotSyncPkt);
+    wr.put(m_async_0);
+    wr.put(m_part_async);
+    wr.put(fn_idx);
+
+    // current packet progress
+    wr.put(m_numPktBytesReq);
+    wr.put(m_needCycleCount);
+    wr.put(m_gotCycleCount);
+    wr.put(m_gotCCBytes);
+    wr.put(m_numCtxtIDBytes);
+    wr.put(m_gotCtxtIDBytes);
+    wr.put(m_gotTSBytes);
+    wr.put(m_tsByteMax);
+    wr.put(m_gotAddrBytes);
+    wr.put(m_numAddrBytes);
+    wr.put(m_gotExcepBytes);
+    wr.put(m_numExcepBytes);
+    wr.put(m_addrPktIsa);
+    wr.put(m_excepAltISA);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcPktProcPtm::restoreState(const uint8_t *p_state, const size_t size)
+{
+    uint16_t fn_idx = 0x100;
+    ocsd_ptm_pkt pkt;
+    ocsd_err_t err;
+
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    TrcStateReader rd(p_state, size, PTM_PROC_STATE_TAG, PTM_PROC_STATE_VER);
+
+    rd.get(m_process_state);
+    rd.getVec(m_currPacketData);
+    rd.get(m_currPktIdx);
+    rd.get(pkt);
+    rd.get(m_curr_pkt_index);
+    rd.get(m_waitASyncSOPkt);
+    rd.get(m_bAsyncRawOp);
+    rd.get(m_bOPNotSyncPkt);
+    rd.get(m_async_0);
+    rd.get(m_part_async);
+    rd.get(fn_idx);
+
+    rd.get(m_numPktBytesReq);
+    rd.get(m_needCycleCount);
+    rd.get(m_gotCycleCount);
+    rd.get(m_gotCCBytes);
+    rd.get(m_numCtxtIDBytes);
+    rd.get(m_gotCtxtIDBytes);
+    rd.get(m_gotTSBytes);
+    rd.get(m_tsByteMax);
+    rd.get(m_gotAddrBytes);
+    rd.get(m_numAddrBytes);
+    rd.get(m_gotExcepBytes);
+    rd.get(m_numExcepBytes);
+    rd.get(m_addrPktIsa);
+    rd.get(m_excepAltISA);
+
+    if (fn_idx >= 256)
+        rd.setInvalid();
+
+    err = rd.end();
+    if (err == OCSD_OK)
+    {
+        m_pIPktFn = m_i_table[fn_idx].pptkFn;
+        m_curr_packet = &pkt;
+    }
+    else
+        InitProcessorState();   // bad state data - back to unsynced start state.
+    return err;
+}
+
 ocsd_datapath_resp_t TrcPktProcPtm::processData(  const ocsd_trc_index_t index,
                                                 const uint32_t dataBlockSize,
                                                 const uint8_t *pDataBlock,
@@ -33,6 +33,7 @@
  */ 
 
 #include "opencsd/stm/trc_pkt_decode_stm.h"
+#include "common/trc_state_blob.h"
 #define DCD_NAME "DCD_STM"
 
 TrcPktDecodeStm::TrcPktDecodeStm()
@@ -118,6 +119,7 @@ ocsd_err_t TrcPktDecodeStm::onProtocolConfig()
 
     // static config - copy of CSID for easy reference
     m_CSID = m_config->getTraceID();
+    m_unsync_info = UNSYNC_INIT_DECODER;  // new config - unsynced as on creation.
     return OCSD_OK;
 }
 
@@ -145,6 +147,52 @@ void TrcPktDecodeStm::resetDecoder()
     initPayloadBuffer();
 }
 
+/* state save and restore */
+#define STM_DCD_STATE_TAG OCSD_STATE_TAG('S','T','D','C')
+#define STM_DCD_STATE_VER 2
+
+ocsd_err_t TrcPktDecodeStm::saveState(std::vector<uint8_t> &state)
+{
+    if (!isInit())
+        return OCSD_ERR_NOT_INIT;
+
+    // payload buffer only valid for the packet being output - master / channel state persists.
+    TrcStateWriter wr(state, STM_DCD_STATE_TAG, STM_DCD_STATE_VER);
+    wr.put(m_curr_state);
+    wr.put(m_unsync_info);
+    wr.put(m_index_curr_pkt);
+    wr.put(m_swt_packet_info);
+    wr.put(m_payload_odd_nibble);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcPktDecodeStm::restoreState(const uint8_t *p_state, const size_t size)
+{
+    ocsd_err_t err;
+
+    if (!isInit())
+        return OCSD_ERR_NOT_INIT;
+
+    const unsync_info_t unsync_info = m_unsync_info;   // current reason kept if restore fails.
+    TrcStateReader rd(p_state, size, STM_DCD_STATE_TAG, STM_DCD_STATE_VER);
+    rd.get(m_curr_state);
+    rd.get(m_unsync_info);
+    rd.get(m_index_curr_pkt);
+    rd.get(m_swt_packet_info);
+    rd.get(m_payload_odd_nibble);
+    m_payload_used = 0;
+
+    err = rd.end();
+    if (err != OCSD_OK)
+    {
+        // bad state data - back to unsynced start state.
+        m_unsync_info = unsync_info;
+        resetDecoder();
+    }
+    return err;
+}
+
 void TrcPktDecodeStm::initPayloadBuffer()
 {
     // set up the payload buffer. If we are correlating indentical packets then 
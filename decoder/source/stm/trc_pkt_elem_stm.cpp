@@ -32,8 +32,6 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
  */
 
-#include <sstream>
-#include <iomanip>
 #include "opencsd/stm/trc_pkt_elem_stm.h"
 
 StmTrcPacket::StmTrcPacket()
@@ -84,79 +82,86 @@ void StmTrcPacket::setTS(const uint64_t ts_val, const uint8_t updatedBits)
 // printing
 void StmTrcPacket::toString(std::string &str) const
 {
-    std::string name, desc;
-    std::ostringstream oss;
+    char szBuffer[512];
+    toStringBuf(szBuffer, sizeof(szBuffer));
+    str = szBuffer;
+}
+
+int StmTrcPacket::toStringBuf(char *buffer, const int buf_size) const
+{
+    trcPrintBuffer buf(buffer, buf_size);
 
-    pktTypeName(type,name, desc);
-    str = name + ":" + desc;
+    pktTypeName(buf, type, true);
 
     // extended information
     switch(type)
     {
     case STM_PKT_INCOMPLETE_EOT:
     case STM_PKT_BAD_SEQUENCE:
-        pktTypeName(err_type,name, desc);
-        str+= "[" + name + "]";
+        buf.addChar('[');
+        pktTypeName(buf, err_type, false);
+        buf.addChar(']');
         break;
 
     case STM_PKT_VERSION:
-        oss << "; Ver=" << (uint16_t)payload.D8;
-        str+= oss.str();
+        buf.addStr("; Ver=");
+        buf.addDec(payload.D8);
         break;
 
     case STM_PKT_FREQ:
-        oss << "; Freq=" << std::dec << payload.D32 << "Hz";
-        str+= oss.str();
+        buf.addStr("; Freq=");
+        buf.addDec(payload.D32);
+        buf.addStr("Hz");
         break;
 
     case STM_PKT_TRIG:
-        oss << "; TrigData=0x" << std::hex << std::setw(2) << std::setfill('0') << (uint16_t)payload.D8;
-        str+= oss.str();
+        buf.addStr("; TrigData=0x");
+        buf.addHex(payload.D8, 2);
         break;
 
     case STM_PKT_M8:
-        oss << "; Master=0x" << std::hex << std::setw(2) << std::setfill('0') << (uint16_t)master;
-        str+= oss.str();
+        buf.addStr("; Master=0x");
+        buf.addHex(master, 2);
         break;
        
     case STM_PKT_C8:
     case STM_PKT_C16:
-        oss << "; Chan=0x" << std::hex << std::setw(4) << std::setfill('0') << channel;
-        str+= oss.str();
+        buf.addStr("; Chan=0x");
+        buf.addHex(channel, 4);
         break;
 
     case STM_PKT_D4: 
-        oss << "; Data=0x" << std::hex << std::setw(1) << (uint16_t)(payload.D8 & 0xF);
-        str+= oss.str();
+        buf.addStr("; Data=0x");
+        buf.addHex(payload.D8 & 0xF);
         break;
 
     case STM_PKT_D8: 
-        oss << "; Data=0x" << std::hex << std::setw(2) << std::setfill('0') << (uint16_t)payload.D8;
-        str+= oss.str();
+        buf.addStr("; Data=0x");
+        buf.addHex(payload.D8, 2);
         break;
 
     case STM_PKT_D16:
-        oss << "; Data=0x" << std::hex << std::setw(4) << std::setfill('0') << payload.D16;
-        str+= oss.str();
+        buf.addStr("; Data=0x");
+        buf.addHex(payload.D16, 4);
         break;
 
     case STM_PKT_D32:
-        oss << "; Data=0x" << std::hex << std::setw(8) << std::setfill('0') << payload.D32;
-        str+= oss.str();
+        buf.addStr("; Data=0x");
+        buf.addHex(payload.D32, 8);
         break;
 
     case STM_PKT_D64:
-        oss << "; Data=0x" << std::hex << std::setw(16) << std::setfill('0') << payload.D64;
-        str+= oss.str();
+        buf.addStr("; Data=0x");
+        buf.addHex(payload.D64, 16);
         break;
     }
 
     if(isTSPkt())
     {
-        std::string valStr;
-        trcPrintableElem::getValStr(valStr,64,64,timestamp,true,pkt_ts_bits);
-        str += "; TS=" + valStr;
+        buf.addStr("; TS=");
+        trcPrintableElem::getValStr(buf,64,64,timestamp,true,pkt_ts_bits);
     }
+    return buf.length();
 }
 
 void StmTrcPacket::toStringFmt(const uint32_t fmtFlags, std::string &str) const
@@ -165,149 +170,151 @@ void StmTrcPacket::toStringFmt(const uint32_t fmtFlags, std::string &str) const
     toString(str);
 }
 
-void StmTrcPacket::pktTypeName(const ocsd_stm_pkt_type pkt_type, std::string &name, std::string &desc) const
+void StmTrcPacket::pktTypeName(trcPrintBuffer &buf, const ocsd_stm_pkt_type pkt_type, const bool incDesc) const
 {
-    std::ostringstream oss_name;
-    std::ostringstream oss_desc;
+    const char *pName;
+    const char *pDesc;
     bool addMarkerTS = false;
 
 
     switch(pkt_type)
     {
     case STM_PKT_RESERVED: 
-        oss_name << "RESERVED";
-        oss_desc << "Reserved Packet Header";
+        pName = "RESERVED";
+        pDesc = "Reserved Packet Header";
         break;
 
     case STM_PKT_NOTSYNC:
-        oss_name << "NOTSYNC";
-        oss_desc << "STM not synchronised";
+        pName = "NOTSYNC";
+        pDesc = "STM not synchronised";
         break;
 
     case STM_PKT_INCOMPLETE_EOT:
-        oss_name << "INCOMPLETE_EOT";
-        oss_desc << "Incomplete packet flushed at end of trace";
+        pName = "INCOMPLETE_EOT";
+        pDesc = "Incomplete packet flushed at end of trace";
         break;
 
     case STM_PKT_NO_ERR_TYPE:
-        oss_name << "NO_ERR_TYPE";
-        oss_desc << "Error type not set";
+        pName = "NO_ERR_TYPE";
+        pDesc = "Error type not set";
         break;
 
     case STM_PKT_BAD_SEQUENCE:
-        oss_name << "BAD_SEQUENCE";
-        oss_desc << "Invalid sequence in packet";
+        pName = "BAD_SEQUENCE";
+        pDesc = "Invalid sequence in packet";
         break;
 
     case STM_PKT_ASYNC:
-        oss_name << "ASYNC";
-        oss_desc << "Alignment synchronisation packet";
+        pName = "ASYNC";
+        pDesc = "Alignment synchronisation packet";
         break;
 
     case STM_PKT_VERSION:
-        oss_name << "VERSION";
-        oss_desc << "Version packet";
+        pName = "VERSION";
+        pDesc = "Version packet";
         break;
 
     case STM_PKT_FREQ:
-        oss_name << "FREQ";
-        oss_desc << "Frequency packet";
+        pName = "FREQ";
+        pDesc = "Frequency packet";
         break;
 
     case STM_PKT_NULL:
-        oss_name << "NULL";
-        oss_desc << "Null packet";
+        pName = "NULL";
+        pDesc = "Null packet";
         break;
 
     case STM_PKT_TRIG:
-        oss_name << "TRIG";
-        oss_desc << "Trigger packet";
+        pName = "TRIG";
+        pDesc = "Trigger packet";
         addMarkerTS = true;
         break;
 
     case STM_PKT_GERR:
-        oss_name << "GERR";
-        oss_desc << "Global Error";
+        pName = "GERR";
+        pDesc = "Global Error";
         break;
 
     case STM_PKT_MERR:
-        oss_name << "MERR";
-        oss_desc << "Master Error";
+        pName = "MERR";
+        pDesc = "Master Error";
         break;
 
     case STM_PKT_M8:
-        oss_name << "M8";
-        oss_desc << "Set current master";
+        pName = "M8";
+        pDesc = "Set current master";
         break;
 
     case STM_PKT_C8:
-        oss_name << "C8";
-        oss_desc << "Set current channel";
+        pName = "C8";
+        pDesc = "Set current channel";
         break;
 
     case STM_PKT_C16:
-        oss_name << "C16";
-        oss_desc << "Set current channel";
+        pName = "C16";
+        pDesc = "Set current channel";
         break;
 
     case STM_PKT_FLAG:
-        oss_name << "FLAG";
-        oss_desc << "Flag packet";
+        pName = "FLAG";
+        pDesc = "Flag packet";
         addMarkerTS = true;
         break;
 
     case STM_PKT_D4:
-        oss_name << "D4";
-        oss_desc << "4 bit data";
+        pName = "D4";
+        pDesc = "4 bit data";
         addMarkerTS = true;
         break;
 
     case STM_PKT_D8:
-        oss_name << "D8";
-        oss_desc << "8 bit data";
+        pName = "D8";
+        pDesc = "8 bit data";
         addMarkerTS = true;
         break;
 
     case STM_PKT_D16:
-        oss_name << "D16";
-        oss_desc << "16 bit data";
+        pName = "D16";
+        pDesc = "16 bit data";
         addMarkerTS = true;
         break;
 
     case STM_PKT_D32:
-        oss_name << "D32";
-        oss_desc << "32 bit data";
+        pName = "D32";
+        pDesc = "32 bit data";
         addMarkerTS = true;
         break;
 
     case STM_PKT_D64:
-        oss_name << "D64";
-        oss_desc << "64 bit data";
+        pName = "D64";
+        pDesc = "64 bit data";
         addMarkerTS = true;
         break;
 
     default:
-        oss_name << "UNKNOWN";
-        oss_desc << "ERROR: unknown packet type";
+        pName = "UNKNOWN";
+        pDesc = "ERROR: unknown packet type";
         break;
     }
 
-    if(addMarkerTS)
+    const bool addMarker = addMarkerTS && isMarkerPkt();
+    const bool addTS = addMarkerTS && isTSPkt();
+
+    buf.addStr(pName);
+    if(addMarker)
+        buf.addChar('M');
+    if(addTS)
+        buf.addStr("TS");
+
+    if(incDesc)
     {
-        if(isMarkerPkt())
-        {
-            oss_name << "M";
-            oss_desc << " + marker";
-        }
-
-        if(isTSPkt())
-        {
-            oss_name << "TS";
-            oss_desc << " + timestamp";
-        }
+        buf.addChar(':');
+        buf.addStr(pDesc);
+        if(addMarker)
+            buf.addStr(" + marker");
+        if(addTS)
+            buf.addStr(" + timestamp");
     }
-    desc = oss_desc.str();
-    name =  oss_name.str();
 }
 
 
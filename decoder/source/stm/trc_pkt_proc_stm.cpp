@@ -33,6 +33,7 @@
  */ 
 
 #include "opencsd/stm/trc_pkt_proc_stm.h"
+#include "common/trc_state_blob.h"
 
 
 // processor object construction
@@ -70,6 +71,119 @@ void TrcPktProcStm::initObj()
     buildOpTables();
 }
 
+#define STM_PROC_STATE_TAG OCSD_STATE_TAG('S','T','P','P')
+#define STM_PROC_STATE_VER 1
+
+ocsd_err_t TrcPktProcStm::saveState(std::vector<uint8_t> &state)
+{
+    std::vector<PPKTFN> fn_list;
+    uint16_t fn_idx;
+
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    getStateFnList(fn_list);
+    for (fn_idx = 0; fn_idx < fn_list.size(); fn_idx++)
+    {
+        if (fn_list[fn_idx] == m_pCurrPktFn)
+            break;
+    }
+    if (fn_idx == fn_list.size())
+        return OCSD_ERR_FAIL;
+
+    TrcStateWriter wr(state, STM_PROC_STATE_TAG, STM_PROC_STATE_VER);
+
+    // processor state
+    wr.put(m_proc_state);
+    wr.put((const ocsd_stm_pkt &)m_curr_packet);
+    wr.put(m_bNeedsTS);
+    wr.put(m_bIsMarker);
+    wr.put(m_bStreamSync);
+    wr.put(fn_idx);
+
+    // partial packet and nibble state
+    wr.put(m_num_nibbles);
+    wr.put(m_nibble);
+    wr.put(m_nibble_2nd);
+    wr.put(m_nibble_2nd_valid);
+    wr.put(m_num_data_nibbles);
+    wr.put(m_packet_index);
+    wr.putVec(m_packet_data);
+    wr.put(m_bWaitSyncSaveSuppressed);
+    wr.put(m_val8);
+    wr.put(m_val16);
+    wr.put(m_val32);
+    wr.put(m_val64);
+    wr.put(m_req_ts_nibbles);
+    wr.put(m_curr_ts_nibbles);
+    wr.put(m_ts_update_value);
+    wr.put(m_ts_req_set);
+
+    // sync search
+    wr.put(m_num_F_nibbles);
+    wr.put(m_sync_start);
+    wr.put(m_is_sync);
+    wr.put(m_sync_index);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcPktProcStm::restoreState(const uint8_t *p_state, const size_t size)
+{
+    std::vector<PPKTFN> fn_list;
+    uint16_t fn_idx = 0;
+    ocsd_stm_pkt pkt;
+    ocsd_err_t err;
+
+    if (!m_config)
+        return OCSD_ERR_NOT_INIT;
+
+    TrcStateReader rd(p_state, size, STM_PROC_STATE_TAG, STM_PROC_STATE_VER);
+
+    rd.get(m_proc_state);
+    rd.get(pkt);
+    rd.get(m_bNeedsTS);
+    rd.get(m_bIsMarker);
+    rd.get(m_bStreamSync);
+    rd.get(fn_idx);
+
+    rd.get(m_num_nibbles);
+    rd.get(m_nibble);
+    rd.get(m_nibble_2nd);
+    rd.get(m_nibble_2nd_valid);
+    rd.get(m_num_data_nibbles);
+    rd.get(m_packet_index);
+    rd.getVec(m_packet_data);
+    rd.get(m_bWaitSyncSaveSuppressed);
+    rd.get(m_val8);
+    rd.get(m_val16);
+    rd.get(m_val32);
+    rd.get(m_val64);
+    rd.get(m_req_ts_nibbles);
+    rd.get(m_curr_ts_nibbles);
+    rd.get(m_ts_update_value);
+    rd.get(m_ts_req_set);
+
+    rd.get(m_num_F_nibbles);
+    rd.get(m_sync_start);
+    rd.get(m_is_sync);
+    rd.get(m_sync_index);
+
+    getStateFnList(fn_list);
+    if (fn_idx >= fn_list.size())
+        rd.setInvalid();
+
+    err = rd.end();
+    if (err == OCSD_OK)
+    {
+        m_pCurrPktFn = fn_list[fn_idx];
+        m_curr_packet = &pkt;
+    }
+    else
+        initProcessorState();   // bad state data - back to unsynced start state.
+    return err;
+}
+
 // implementation packet processing interface overrides 
 // ************************
 ocsd_datapath_resp_t TrcPktProcStm::processData(  const ocsd_trc_index_t index,
@@ -218,6 +332,7 @@ void TrcPktProcStm::initProcessorState()
     m_nibble_2nd_valid = false;
     initNextPacket();
     m_bWaitSyncSaveSuppressed = false;
+    m_pCurrPktFn = &TrcPktProcStm::stmPktNull;
 
     m_packet_data.clear();
 }
@@ -1040,4 +1155,14 @@ void TrcPktProcStm::buildOpTables()
 
 }
 
+void TrcPktProcStm::getStateFnList(std::vector<PPKTFN> &fn_list)
+{
+    // all op table entries, plus the timestamp extraction that packet fns may chain to.
+    fn_list.clear();
+    fn_list.insert(fn_list.end(), m_1N_ops, m_1N_ops + 0x10);
+    fn_list.insert(fn_list.end(), m_2N_ops, m_2N_ops + 0x10);
+    fn_list.insert(fn_list.end(), m_3N_ops, m_3N_ops + 0x10);
+    fn_list.push_back(&TrcPktProcStm::stmExtractTS);
+}
+
 /* End of File trc_pkt_proc_stm.cpp */
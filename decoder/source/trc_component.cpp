@@ -32,8 +32,14 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
  */ 
 
+#include <cstring>
+
 #include "common/trc_component.h"
 
+#ifdef OCSD_STAGE_TIMING
+thread_local OcsdStageTimer *OcsdStageTimer::s_active = 0;
+#endif
+
 class errLogAttachMonitor : public IComponentAttachNotifier
 {
 public:
@@ -92,12 +98,27 @@ void TraceComponent::Init(const std::string &name)
     m_supported_op_flags = 0;
     m_op_flags = 0;
     m_assocComp = 0;
+    resetStageTimes();
 
     m_pErrAttachMon = new (std::nothrow) errLogAttachMonitor();
     if(m_pErrAttachMon)
         m_pErrAttachMon->Init(this);
 }
 
+void TraceComponent::resetStageTimes()
+{
+    memset(&m_stage_times, 0, sizeof(ocsd_stage_times_t));
+}
+
+const bool TraceComponent::stageTimingEnabled()
+{
+#ifdef OCSD_STAGE_TIMING
+    return true;
+#else
+    return false;
+#endif
+}
+
 void TraceComponent::LogError(const ocsdError &Error) 
 {
     if((m_errLogHandle != OCSD_INVALID_HANDLE) && 
@@ -109,6 +130,18 @@ void TraceComponent::LogError(const ocsdError &Error)
     }
 }
 
+void TraceComponent::LogError(const ocsd_err_severity_t sev, const ocsd_err_t code, const ocsd_trc_index_t idx, const uint8_t chan_id, const char *msg)
+{
+    if ((m_errLogHandle != OCSD_INVALID_HANDLE) &&
+        isLoggingErrorLevel(sev) && m_error_logger.first())
+    {
+        ocsdError err(sev, code, idx, chan_id);
+        if (msg)
+            err.setMessage(msg);
+        m_error_logger.first()->LogError(m_errLogHandle, &err);
+    }
+}
+
 void TraceComponent::LogMessage(const ocsd_err_severity_t filter_level, const std::string &msg)
 {
     if ((m_errLogHandle != OCSD_INVALID_HANDLE) &&
@@ -35,6 +35,7 @@
 
 #include "common/trc_frame_deformatter.h"
 #include "trc_frame_deformatter_impl.h"
+#include "common/trc_state_blob.h"
 
 /***************************************************************/
 /* Implementation */
@@ -83,6 +84,7 @@ ocsd_datapath_resp_t TraceFmtDcdImpl::TraceDataIn(
     uint32_t *numBytesProcessed)
 {
     ocsd_datapath_resp_t resp = OCSD_RESP_FATAL_INVALID_OP;
+    OCSD_STAGE_TIMER(OCSD_TSTAGE_DEFORMAT);
     InitCollateDataPathResp();
 
     m_b_output_packed_raw = m_RawTraceFrame.num_attached() && ((m_cfgFlags & OCSD_DFRMTR_PACKED_RAW_OUT) != 0);
@@ -118,6 +120,70 @@ ocsd_datapath_resp_t TraceFmtDcdImpl::TraceDataIn(
     return resp;
 }
 
+ocsd_datapath_resp_t TraceFmtDcdImpl::TraceDataInSG(const ocsd_trc_index_t index,
+                                                    const ocsd_trc_data_seg_t *segs,
+                                                    const int num_segs,
+                                                    const uint32_t seg_offset,
+                                                    uint32_t *numBytesProcessed)
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+    uint8_t straddle[OCSD_DFRMTR_FRAME_SIZE];   // aligned unit split across segments
+    ocsd_trc_index_t seg_index = index;         // index of start of current segment
+    uint32_t pos = seg_offset;                  // position in current segment
+    uint32_t block_size, used, copied, n, gpos;
+    int seg = 0, gseg;
+
+    *numBytesProcessed = 0;
+    while ((seg < num_segs) && OCSD_DATA_RESP_IS_CONT(resp))
+    {
+        // move on to the segment containing the current position.
+        if (pos >= segs[seg].size)
+        {
+            pos -= segs[seg].size;
+            seg_index += segs[seg].size;
+            seg++;
+            continue;
+        }
+
+        used = 0;
+        block_size = segs[seg].size - pos;
+        if (block_size >= m_alignment)
+        {
+            // pass aligned data directly from the segment.
+            block_size -= (block_size % m_alignment);
+            resp = TraceDataIn(OCSD_OP_DATA, seg_index + pos, block_size, segs[seg].p_data + pos, &used);
+        }
+        else
+        {
+            // copy a single aligned unit from the end of this segment and the start of the following ones.
+            copied = 0;
+            gseg = seg;
+            gpos = pos;
+            while ((copied < m_alignment) && (gseg < num_segs))
+            {
+                n = segs[gseg].size - gpos;
+                if (n > (m_alignment - copied))
+                    n = m_alignment - copied;
+                memcpy(straddle + copied, segs[gseg].p_data + gpos, n);
+                copied += n;
+                gpos += n;
+                if (gpos == segs[gseg].size)
+                {
+                    gseg++;
+                    gpos = 0;
+                }
+            }
+            resp = TraceDataIn(OCSD_OP_DATA, seg_index + pos, copied, straddle, &used);
+        }
+
+        if (!used && OCSD_DATA_RESP_IS_CONT(resp))
+            break;  // no progress possible.
+        pos += used;
+        *numBytesProcessed += used;
+    }
+    return resp;
+}
+
 /* enable / disable ID streams - default as all enabled */
 ocsd_err_t TraceFmtDcdImpl::OutputFilterIDs(std::vector<uint8_t> &id_list, bool bEnable)
 {
@@ -347,6 +413,45 @@ void TraceFmtDcdImpl::resetStateParams()
     m_trc_curr_idx_sof = OCSD_BAD_TRC_INDEX;
 }
 
+#define DFMT_STATE_TAG OCSD_STATE_TAG('D','F','M','T')
+#define DFMT_STATE_VER 1
+
+ocsd_err_t TraceFmtDcdImpl::saveState(std::vector<uint8_t> &state)
+{
+    TrcStateWriter wr(state, DFMT_STATE_TAG, DFMT_STATE_VER);
+    wr.put(m_trc_curr_idx);
+    wr.put(m_frame_synced);
+    wr.put(m_first_data);
+    wr.put(m_curr_src_ID);
+    wr.put(m_ex_frm_n_bytes);
+    wr.put(m_trc_curr_idx_sof);
+    wr.putBytes(m_ex_frm_data, OCSD_DFRMTR_FRAME_SIZE);
+    wr.end();
+    return OCSD_OK;
+}
+
+ocsd_err_t TraceFmtDcdImpl::restoreState(const uint8_t *p_state, const size_t size)
+{
+    ocsd_err_t err;
+
+    TrcStateReader rd(p_state, size, DFMT_STATE_TAG, DFMT_STATE_VER);
+    rd.get(m_trc_curr_idx);
+    rd.get(m_frame_synced);
+    rd.get(m_first_data);
+    rd.get(m_curr_src_ID);
+    rd.get(m_ex_frm_n_bytes);
+    rd.get(m_trc_curr_idx_sof);
+    rd.getBytes(m_ex_frm_data, OCSD_DFRMTR_FRAME_SIZE);
+
+    if ((m_ex_frm_n_bytes < 0) || (m_ex_frm_n_bytes > OCSD_DFRMTR_FRAME_SIZE))
+        rd.setInvalid();
+
+    err = rd.end();
+    if (err != OCSD_OK)
+        resetStateParams();
+    return err;
+}
+
 bool TraceFmtDcdImpl::checkForSync()
 {
     // we can sync on:-
@@ -793,6 +898,15 @@ ocsd_datapath_resp_t TraceFormatterFrameDecoder::TraceDataIn(  const ocsd_datapa
     return (m_pDecoder == 0) ? OCSD_RESP_FATAL_NOT_INIT : m_pDecoder->TraceDataIn(op,index,dataBlockSize,pDataBlock,numBytesProcessed);
 }
 
+ocsd_datapath_resp_t TraceFormatterFrameDecoder::TraceDataInSG(const ocsd_trc_index_t index,
+                                                               const ocsd_trc_data_seg_t *segs,
+                                                               const int num_segs,
+                                                               const uint32_t seg_offset,
+                                                               uint32_t *numBytesProcessed)
+{
+    return (m_pDecoder == 0) ? OCSD_RESP_FATAL_NOT_INIT : m_pDecoder->TraceDataInSG(index, segs, num_segs, seg_offset, numBytesProcessed);
+}
+
 /* attach a data processor to a stream ID output */
 componentAttachPt<ITrcDataIn> *TraceFormatterFrameDecoder::getIDStreamAttachPt(uint8_t ID)
 {
@@ -842,6 +956,17 @@ const uint32_t TraceFormatterFrameDecoder::getConfigFlags() const
     return flags;
 }
 
+const ocsd_stage_times_t *TraceFormatterFrameDecoder::getStageTimes() const
+{
+    return (m_pDecoder != 0) ? &m_pDecoder->getStageTimes() : 0;
+}
+
+void TraceFormatterFrameDecoder::resetStageTimes()
+{
+    if(m_pDecoder)
+        m_pDecoder->resetStageTimes();
+}
+
 
 /* enable / disable ID streams - default as all enabled */
 ocsd_err_t TraceFormatterFrameDecoder::OutputFilterIDs(std::vector<uint8_t> &id_list, bool bEnable)
@@ -865,5 +990,15 @@ ocsd_datapath_resp_t TraceFormatterFrameDecoder::Flush()
     return (m_pDecoder == 0) ? OCSD_RESP_FATAL_NOT_INIT : m_pDecoder->Flush();
 }
 
+ocsd_err_t TraceFormatterFrameDecoder::saveState(std::vector<uint8_t> &state)
+{
+    return (m_pDecoder == 0) ? OCSD_ERR_NOT_INIT : m_pDecoder->saveState(state);
+}
+
+ocsd_err_t TraceFormatterFrameDecoder::restoreState(const uint8_t *p_state, const size_t size)
+{
+    return (m_pDecoder == 0) ? OCSD_ERR_NOT_INIT : m_pDecoder->restoreState(p_state, size);
+}
+
 
 /* End of File trc_frame_deformatter.cpp */
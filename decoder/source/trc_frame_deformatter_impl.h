@@ -65,6 +65,13 @@ private:
                                                 const uint8_t *pDataBlock, 
                                                 uint32_t *numBytesProcessed);
 
+    /* scatter-gather data input - gathers frames straddling segment boundaries */
+    virtual ocsd_datapath_resp_t TraceDataInSG(const ocsd_trc_index_t index,
+                                               const ocsd_trc_data_seg_t *segs,
+                                               const int num_segs,
+                                               const uint32_t seg_offset,
+                                               uint32_t *numBytesProcessed);
+
     /* enable / disable ID streams - default as all enabled */
     ocsd_err_t OutputFilterIDs(std::vector<uint8_t> &id_list, bool bEnable);
     ocsd_err_t OutputFilterAllIDs(bool bEnable);
@@ -75,6 +82,10 @@ private:
     ocsd_err_t DecodeConfigure(uint32_t flags);
     ocsd_err_t SetForcedSyncIndex(ocsd_trc_index_t index, bool bSet);
 
+    /* dynamic state save and restore */
+    virtual ocsd_err_t saveState(std::vector<uint8_t> &state);
+    virtual ocsd_err_t restoreState(const uint8_t *p_state, const size_t size);
+
 private:
     ocsd_datapath_resp_t executeNoneDataOpAllIDs(ocsd_datapath_op_t op, const ocsd_trc_index_t index = 0);
     ocsd_datapath_resp_t processTraceData(const ocsd_trc_index_t index, 
@@ -35,8 +35,6 @@
 #include "common/trc_gen_elem.h"
 
 #include <string>
-#include <sstream>
-#include <iomanip>
 
 static const char *s_elem_descs[][2] =  
 {
@@ -55,7 +53,8 @@ static const char *s_elem_descs[][2] =
     {"OCSD_GEN_TRC_ELEM_CYCLE_COUNT","Cycle count - cycles since last cycle count value - associated with a preceding instruction range."},
     {"OCSD_GEN_TRC_ELEM_EVENT","Event - numbered event or trigger"},
     {"OCSD_GEN_TRC_ELEM_SWTRACE","Software trace packet - may contain data payload."},
-    {"OCSD_GEN_TRC_ELEM_CUSTOM","Fully custom packet type."}
+    {"OCSD_GEN_TRC_ELEM_CUSTOM","Fully custom packet type."},
+    {"OCSD_GEN_TRC_ELEM_FILTERED_OUT","PE executing outside the decode filter."}
 };
 
 static const char *instr_type[] = {
@@ -96,6 +95,11 @@ static const char *s_isa_str[] = {
    "Unk"       /**< ISA not yet known */
 };
 
+static inline const char *isaStr(const ocsd_isa isa)
+{
+    return s_isa_str[(isa < ocsd_isa_unknown) ? (int)isa : (int)ocsd_isa_unknown];
+}
+
 static const char *s_unsync_reason[] = {
     "undefined",            // UNSYNC_UNKNOWN - unknown /undefined
     "init-decoder",         // UNSYNC_INIT_DECODER - decoder intialisation - start of trace.
@@ -108,99 +112,154 @@ static const char *s_unsync_reason[] = {
 
 void OcsdTraceElement::toString(std::string &str) const
 {
-    std::ostringstream oss;
+    char szBuffer[512];
+    toStringBuf(szBuffer, sizeof(szBuffer));
+    str = szBuffer;
+}
+
+int OcsdTraceElement::toStringBuf(char *buffer, const int buf_size) const
+{
+    trcPrintBuffer buf(buffer, buf_size);
     int num_str = ((sizeof(s_elem_descs) / sizeof(const char *)) / 2);
     int typeIdx = (int)this->elem_type;
     if(typeIdx < num_str)
     {
-        oss << s_elem_descs[typeIdx][0] << "(";
+        buf.addStr(s_elem_descs[typeIdx][0]);
+        buf.addChar('(');
         switch(elem_type)
         {
         case OCSD_GEN_TRC_ELEM_INSTR_RANGE:
-            oss << "exec range=0x" << std::hex << st_addr << ":[0x" << en_addr << "] ";
-            oss << "num_i(" << std::dec << num_instr_range << ") ";
-            oss << "last_sz(" << last_instr_sz << ") ";
-            oss << "(ISA=" << s_isa_str[(int)isa] << ") ";
-            oss << ((last_instr_exec == 1) ? "E " : "N ");
+            buf.addStr("exec range=0x");
+            buf.addHex(st_addr);
+            buf.addStr(":[0x");
+            buf.addHex(en_addr);
+            buf.addStr("] num_i(");
+            buf.addDec(num_instr_range);
+            buf.addStr(") last_sz(");
+            buf.addDec(last_instr_sz);
+            buf.addStr(") (ISA=");
+            buf.addStr(isaStr(isa));
+            buf.addStr(") ");
+            buf.addStr((last_instr_exec == 1) ? "E " : "N ");
             if((int)last_i_type < T_SIZE)
-                oss << instr_type[last_i_type];
+                buf.addStr(instr_type[last_i_type]);
             if((last_i_subtype != OCSD_S_INSTR_NONE) && ((int)last_i_subtype < ST_SIZE))
-                oss << instr_sub_type[last_i_subtype];
+                buf.addStr(instr_sub_type[last_i_subtype]);
             if (last_instr_cond)
-                oss << " <cond>";
+                buf.addStr(" <cond>");
             break;
 
         case OCSD_GEN_TRC_ELEM_ADDR_NACC:
-            oss << " 0x" << std::hex << st_addr << " ";
+        case OCSD_GEN_TRC_ELEM_FILTERED_OUT:
+            buf.addStr(" 0x");
+            buf.addHex(st_addr);
+            buf.addChar(' ');
             break;
 
         case OCSD_GEN_TRC_ELEM_I_RANGE_NOPATH:
-            oss << "first 0x" << std::hex << st_addr << ":[next 0x" << en_addr << "] ";
-            oss << "num_i(" << std::dec << num_instr_range << ") ";
+            buf.addStr("first 0x");
+            buf.addHex(st_addr);
+            buf.addStr(":[next 0x");
+            buf.addHex(en_addr);
+            buf.addStr("] num_i(");
+            buf.addDec(num_instr_range);
+            buf.addStr(") ");
             break;
 
         case OCSD_GEN_TRC_ELEM_EXCEPTION:
             if (excep_ret_addr == 1)
             {
-                oss << "pref ret addr:0x" << std::hex << en_addr; 
+                buf.addStr("pref ret addr:0x");
+                buf.addHex(en_addr);
                 if (excep_ret_addr_br_tgt)
                 {
-                    oss << " [addr also prev br tgt]";
+                    buf.addStr(" [addr also prev br tgt]");
                 }
-                oss << "; ";
+                buf.addStr("; ");
             }
-            oss << "excep num (0x" << std::setfill('0') << std::setw(2) << std::hex << exception_number << ") ";
+            buf.addStr("excep num (0x");
+            buf.addHex(exception_number, 2);
+            buf.addStr(") ");
             break;
 
         case OCSD_GEN_TRC_ELEM_PE_CONTEXT:
-            oss << "(ISA=" << s_isa_str[(int)isa] << ") ";
+            buf.addStr("(ISA=");
+            buf.addStr(isaStr(isa));
+            buf.addStr(") ");
             if((context.exception_level > ocsd_EL_unknown) && (context.el_valid))
             {
-                oss << "EL" << std::dec << (int)(context.exception_level);
+                buf.addStr("EL");
+                buf.addDecSigned((int)(context.exception_level));
             }
-            oss << (context.security_level == ocsd_sec_secure ? "S; " : "N; ") << (context.bits64 ? "64-bit; " : "32-bit; ");
+            buf.addStr(context.security_level == ocsd_sec_secure ? "S; " : "N; ");
+            buf.addStr(context.bits64 ? "64-bit; " : "32-bit; ");
             if(context.vmid_valid)
-                oss << "VMID=0x" << std::hex << context.vmid << "; ";
+            {
+                buf.addStr("VMID=0x");
+                buf.addHex(context.vmid);
+                buf.addStr("; ");
+            }
             if(context.ctxt_id_valid)
-                oss << "CTXTID=0x" << std::hex << context.context_id << "; ";
+            {
+                buf.addStr("CTXTID=0x");
+                buf.addHex(context.context_id);
+                buf.addStr("; ");
+            }
             break;
 
         case  OCSD_GEN_TRC_ELEM_TRACE_ON:
-            oss << " [" << s_trace_on_reason[trace_on_reason] << "]";
+            buf.addStr(" [");
+            if ((int)trace_on_reason < (int)(sizeof(s_trace_on_reason) / sizeof(const char *)))
+                buf.addStr(s_trace_on_reason[trace_on_reason]);
+            buf.addChar(']');
             break;
 
         case OCSD_GEN_TRC_ELEM_TIMESTAMP:
-            oss << " [ TS=0x" << std::setfill('0') << std::setw(12) << std::hex << timestamp << "]; "; 
+            buf.addStr(" [ TS=0x");
+            buf.addHex(timestamp, 12);
+            buf.addStr("]; ");
             break;
 
         case OCSD_GEN_TRC_ELEM_SWTRACE:
-            printSWInfoPkt(oss);
+            printSWInfoPkt(buf);
             break;
 
         case OCSD_GEN_TRC_ELEM_EVENT:
             if(trace_event.ev_type == EVENT_TRIGGER)
-                oss << " Trigger; ";
+                buf.addStr(" Trigger; ");
             else if(trace_event.ev_type == EVENT_NUMBERED)
-                oss << " Numbered:" << std::dec << trace_event.ev_number << "; ";
+            {
+                buf.addStr(" Numbered:");
+                buf.addDec(trace_event.ev_number);
+                buf.addStr("; ");
+            }
             break;
 
         case OCSD_GEN_TRC_ELEM_EO_TRACE:
         case OCSD_GEN_TRC_ELEM_NO_SYNC:
             if (unsync_eot_info <= UNSYNC_EOT)
-                oss << " [" << s_unsync_reason[unsync_eot_info] << "]";
+            {
+                buf.addStr(" [");
+                buf.addStr(s_unsync_reason[unsync_eot_info]);
+                buf.addChar(']');
+            }
             break;
 
         default: break;
         }
         if(has_cc)
-            oss << std::dec << " [CC=" << cycle_count << "]; ";
-        oss << ")";
+        {
+            buf.addStr(" [CC=");
+            buf.addDec(cycle_count);
+            buf.addStr("]; ");
+        }
+        buf.addChar(')');
     }
     else
     {
-        oss << "OCSD_GEN_TRC_ELEM??: index out of range.";
+        buf.addStr("OCSD_GEN_TRC_ELEM??: index out of range.");
     }
-    str = oss.str();
+    return buf.length();
 }
 
 OcsdTraceElement &OcsdTraceElement::operator =(const ocsd_generic_trace_elem* p_elem)
@@ -210,64 +269,72 @@ OcsdTraceElement &OcsdTraceElement::operator =(const ocsd_generic_trace_elem* p_
 }
 
 
-void OcsdTraceElement::printSWInfoPkt(std::ostringstream & oss) const
+void OcsdTraceElement::printSWInfoPkt(trcPrintBuffer &buf) const
 {
     if (!sw_trace_info.swt_global_err)
     {
         if (sw_trace_info.swt_id_valid)
         {
-            oss << " (Ma:0x" << std::setfill('0') << std::setw(2) << std::hex << sw_trace_info.swt_master_id << "; ";
-            oss << "Ch:0x" << std::setfill('0') << std::setw(2) << std::hex << sw_trace_info.swt_channel_id << ") ";
+            buf.addStr(" (Ma:0x");
+            buf.addHex(sw_trace_info.swt_master_id, 2);
+            buf.addStr("; Ch:0x");
+            buf.addHex(sw_trace_info.swt_channel_id, 2);
+            buf.addStr(") ");
         }
         else
-            oss << "(Ma:0x??; Ch:0x??" << ") ";
+        {
+            buf.addStr("(Ma:0x??; Ch:0x??");
+            buf.addStr(") ");
+        }
 
         if (sw_trace_info.swt_payload_pkt_bitsize > 0)
         {
-            oss << "0x" << std::setfill('0') << std::hex;
+            buf.addStr("0x");
             if (sw_trace_info.swt_payload_pkt_bitsize == 4)
             {
-                oss << std::setw(1);
-                oss << (uint16_t)(((uint8_t *)ptr_extended_data)[0] & 0xF);
+                buf.addHex(((uint8_t *)ptr_extended_data)[0] & 0xF, 1);
             }
             else
             {
                 switch (sw_trace_info.swt_payload_pkt_bitsize)
                 {
                 case 8:
-                    // force uint8 to uint16 so oss 'sees' them as something to be stringised, rather than absolute char values
-                    oss << std::setw(2) << (uint16_t)((uint8_t *)ptr_extended_data)[0];
+                    buf.addHex(((uint8_t *)ptr_extended_data)[0], 2);
                     break;
                 case 16:
-                    oss << std::setw(4) << ((uint16_t *)ptr_extended_data)[0];
+                    buf.addHex(((uint16_t *)ptr_extended_data)[0], 4);
                     break;
                 case 32:
-                    oss << std::setw(8) << ((uint32_t *)ptr_extended_data)[0];
+                    buf.addHex(((uint32_t *)ptr_extended_data)[0], 8);
                     break;
                 case 64:
-                    oss << std::setw(16) << ((uint64_t *)ptr_extended_data)[0];
+                    buf.addHex(((uint64_t *)ptr_extended_data)[0], 16);
                     break;
                 default:
-                    oss << "{Data Error : unsupported bit width.}";
+                    buf.addStr("{Data Error : unsupported bit width.}");
                     break;
                 }
             }
-            oss << "; ";
+            buf.addStr("; ");
         }
         if (sw_trace_info.swt_marker_packet)
-            oss << "+Mrk ";
+            buf.addStr("+Mrk ");
         if (sw_trace_info.swt_trigger_event)
-            oss << "Trig ";
+            buf.addStr("Trig ");
         if (sw_trace_info.swt_has_timestamp)
-            oss << " [ TS=0x" << std::setfill('0') << std::setw(12) << std::hex << timestamp << "]; ";
+        {
+            buf.addStr(" [ TS=0x");
+            buf.addHex(timestamp, 12);
+            buf.addStr("]; ");
+        }
         if (sw_trace_info.swt_frequency)
-            oss << "Freq";
+            buf.addStr("Freq");
         if (sw_trace_info.swt_master_err)
-            oss << "{Master Error.}";
+            buf.addStr("{Master Error.}");
     }
     else
     {
-        oss << "{Global Error.}";
+        buf.addStr("{Global Error.}");
     }
 }
 
@@ -0,0 +1,412 @@
+/*
+ * \file       trc_gen_elem_coverage.cpp
+ * \brief      OpenCSD : Code coverage bitmap generic element sink.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#include "common/trc_gen_elem_coverage.h"
+
+#include <fstream>
+#include <iterator>
+#include <cstring>
+
+static inline int bitCount(uint64_t val)
+{
+    val = val - ((val >> 1) & 0x5555555555555555ULL);
+    val = (val & 0x3333333333333333ULL) + ((val >> 2) & 0x3333333333333333ULL);
+    val = (val + (val >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((val * 0x0101010101010101ULL) >> 56);
+}
+
+static void putVarint(std::vector<uint8_t> &buffer, uint64_t val)
+{
+    while (val >= 0x80)
+    {
+        buffer.push_back((uint8_t)(val | 0x80));
+        val >>= 7;
+    }
+    buffer.push_back((uint8_t)val);
+}
+
+static bool getVarint(const std::vector<uint8_t> &buffer, size_t &pos, uint64_t &val)
+{
+    int shift = 0;
+    val = 0;
+    while ((pos < buffer.size()) && (shift < 64))
+    {
+        uint8_t byte = buffer[pos++];
+        val |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+        shift += 7;
+    }
+    return false;
+}
+
+TrcGenElemCoverage::TrcGenElemCoverage() : 
+    m_last_region(-1),
+    m_num_unmapped(0)
+{
+}
+
+ocsd_err_t TrcGenElemCoverage::addRegion(const ocsd_vaddr_t st_addr, const ocsd_vaddr_t en_addr, const int granule /* = OCSD_COV_GRANULE_T32 */)
+{
+    if ((en_addr < st_addr) || ((en_addr - st_addr) >= OCSD_COV_MAX_REGION_SIZE) ||
+        ((granule != OCSD_COV_GRANULE_T32) && (granule != OCSD_COV_GRANULE_A64)))
+        return OCSD_ERR_MEM_ACC_RANGE_INVALID;
+
+    // regions are sorted and do not overlap - insert before the first region ending after the new start.
+    std::vector<cov_region_t>::iterator it = m_regions.begin();
+    while ((it != m_regions.end()) && (it->en_addr < st_addr))
+        it++;
+    if ((it != m_regions.end()) && (it->st_addr <= en_addr))
+        return OCSD_ERR_MEM_ACC_OVERLAP;
+
+    cov_region_t region;
+    region.st_addr = st_addr;
+    region.en_addr = en_addr;
+    region.granule_shift = (granule == OCSD_COV_GRANULE_A64) ? 2 : 1;
+    uint64_t num_bits = (en_addr >> region.granule_shift) - (st_addr >> region.granule_shift) + 1;
+    m_regions.insert(it, region)->bits.assign((size_t)((num_bits + 63) / 64), 0);
+    m_last_region = -1;
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcGenElemCoverage::addRegions(const std::vector<std::pair<ocsd_vaddr_t, ocsd_vaddr_t> > &ranges, const int granule /* = OCSD_COV_GRANULE_T32 */)
+{
+    ocsd_err_t err = OCSD_OK;
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        ocsd_err_t add_err = addRegion(ranges[i].first, ranges[i].second, granule);
+        if ((add_err != OCSD_OK) && (err == OCSD_OK))
+            err = add_err;
+    }
+    return err;
+}
+
+void TrcGenElemCoverage::clear()
+{
+    m_regions.clear();
+    m_last_region = -1;
+    m_num_unmapped = 0;
+}
+
+void TrcGenElemCoverage::clearCoverage()
+{
+    for (size_t i = 0; i < m_regions.size(); i++)
+        m_regions[i].bits.assign(m_regions[i].bits.size(), 0);
+    m_num_unmapped = 0;
+}
+
+ocsd_datapath_resp_t TrcGenElemCoverage::TraceElemIn(const ocsd_trc_index_t index_sop,
+                                                      const uint8_t trc_chan_id,
+                                                      const OcsdTraceElement &elem)
+{
+    if (elem.getType() == OCSD_GEN_TRC_ELEM_INSTR_RANGE)
+    {
+        if (findRegion(elem.st_addr) < 0)
+            m_num_unmapped++;
+        markRange(elem.st_addr, elem.en_addr);
+    }
+    return OCSD_RESP_CONT;
+}
+
+size_t TrcGenElemCoverage::firstRegionFrom(const ocsd_vaddr_t addr) const
+{
+    // regions do not overlap so end addresses are also sorted.
+    size_t lo = 0, hi = m_regions.size();
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (m_regions[mid].en_addr < addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int TrcGenElemCoverage::findRegion(const ocsd_vaddr_t addr) const
+{
+    if ((m_last_region >= 0) && (m_regions[m_last_region].st_addr <= addr) && (m_regions[m_last_region].en_addr >= addr))
+        return m_last_region;
+
+    size_t idx = firstRegionFrom(addr);
+    if ((idx < m_regions.size()) && (m_regions[idx].st_addr <= addr))
+    {
+        m_last_region = (int)idx;
+        return m_last_region;
+    }
+    return -1;
+}
+
+void TrcGenElemCoverage::markRange(const ocsd_vaddr_t st_addr, const ocsd_vaddr_t en_addr)
+{
+    if (en_addr <= st_addr)
+        return;
+
+    ocsd_vaddr_t last_addr = en_addr - 1;
+    int idx = findRegion(st_addr);
+
+    // common case - range entirely within one region.
+    if ((idx >= 0) && (m_regions[idx].en_addr >= last_addr))
+    {
+        cov_region_t &region = m_regions[idx];
+        ocsd_vaddr_t base = region.st_addr >> region.granule_shift;
+        setBits(region, (st_addr >> region.granule_shift) - base, (last_addr >> region.granule_shift) - base);
+        return;
+    }
+
+    // mark the parts of the range in each region it overlaps.
+    for (size_t i = firstRegionFrom(st_addr); (i < m_regions.size()) && (m_regions[i].st_addr <= last_addr); i++)
+    {
+        cov_region_t &region = m_regions[i];
+        ocsd_vaddr_t base = region.st_addr >> region.granule_shift;
+        ocsd_vaddr_t first = (st_addr > region.st_addr) ? st_addr : region.st_addr;
+        ocsd_vaddr_t last = (last_addr < region.en_addr) ? last_addr : region.en_addr;
+        setBits(region, (first >> region.granule_shift) - base, (last >> region.granule_shift) - base);
+    }
+}
+
+void TrcGenElemCoverage::setBits(cov_region_t &region, const uint64_t first_bit, const uint64_t last_bit)
+{
+    size_t first_word = (size_t)(first_bit >> 6);
+    size_t last_word = (size_t)(last_bit >> 6);
+    uint64_t first_mask = ~(uint64_t)0 << (first_bit & 0x3F);
+    uint64_t last_mask = ~(uint64_t)0 >> (63 - (last_bit & 0x3F));
+
+    if (first_word == last_word)
+        region.bits[first_word] |= first_mask & last_mask;
+    else
+    {
+        region.bits[first_word] |= first_mask;
+        for (size_t i = first_word + 1; i < last_word; i++)
+            region.bits[i] = ~(uint64_t)0;
+        region.bits[last_word] |= last_mask;
+    }
+}
+
+uint64_t TrcGenElemCoverage::countBits(const cov_region_t &region, const uint64_t first_bit, const uint64_t last_bit) const
+{
+    size_t first_word = (size_t)(first_bit >> 6);
+    size_t last_word = (size_t)(last_bit >> 6);
+    uint64_t first_mask = ~(uint64_t)0 << (first_bit & 0x3F);
+    uint64_t last_mask = ~(uint64_t)0 >> (63 - (last_bit & 0x3F));
+
+    if (first_word == last_word)
+        return bitCount(region.bits[first_word] & first_mask & last_mask);
+
+    uint64_t count = bitCount(region.bits[first_word] & first_mask);
+    for (size_t i = first_word + 1; i < last_word; i++)
+        count += bitCount(region.bits[i]);
+    return count + bitCount(region.bits[last_word] & last_mask);
+}
+
+const bool TrcGenElemCoverage::isCovered(const ocsd_vaddr_t addr) const
+{
+    int idx = findRegion(addr);
+    if (idx < 0)
+        return false;
+    const cov_region_t &region = m_regions[idx];
+    uint64_t bit = (addr >> region.granule_shift) - (region.st_addr >> region.granule_shift);
+    return (bool)((region.bits[(size_t)(bit >> 6)] >> (bit & 0x3F)) & 0x1);
+}
+
+void TrcGenElemCoverage::merge(const TrcGenElemCoverage &other)
+{
+    for (size_t i = 0; i < other.m_regions.size(); i++)
+    {
+        const cov_region_t &src = other.m_regions[i];
+        int idx = findRegion(src.st_addr);
+        if ((idx >= 0) && (m_regions[idx].st_addr == src.st_addr) && (m_regions[idx].en_addr == src.en_addr) &&
+            (m_regions[idx].granule_shift == src.granule_shift))
+        {
+            std::vector<uint64_t> &bits = m_regions[idx].bits;
+            for (size_t w = 0; w < bits.size(); w++)
+                bits[w] |= src.bits[w];
+            continue;
+        }
+
+        // different layout - mark each run of set bits as an address range.
+        ocsd_vaddr_t base = src.st_addr >> src.granule_shift;
+        uint64_t num_bits = (uint64_t)src.bits.size() * 64;
+        uint64_t bit = 0;
+        while (bit < num_bits)
+        {
+            if (!src.bits[(size_t)(bit >> 6)])
+            {
+                bit = (bit | 0x3F) + 1;
+                continue;
+            }
+            if (!((src.bits[(size_t)(bit >> 6)] >> (bit & 0x3F)) & 0x1))
+            {
+                bit++;
+                continue;
+            }
+            uint64_t run_start = bit;
+            while ((bit < num_bits) && ((src.bits[(size_t)(bit >> 6)] >> (bit & 0x3F)) & 0x1))
+                bit++;
+            markRange((base + run_start) << src.granule_shift, (base + bit) << src.granule_shift);
+        }
+    }
+}
+
+void TrcGenElemCoverage::getFuncCoverage(std::vector<ocsd_cov_func_t> &funcs) const
+{
+    for (size_t f = 0; f < funcs.size(); f++)
+    {
+        ocsd_cov_func_t &func = funcs[f];
+        func.num_granules = 0;
+        func.num_covered = 0;
+        if (func.en_addr <= func.st_addr)
+            continue;
+
+        ocsd_vaddr_t last_addr = func.en_addr - 1;
+        for (size_t i = firstRegionFrom(func.st_addr); (i < m_regions.size()) && (m_regions[i].st_addr <= last_addr); i++)
+        {
+            const cov_region_t &region = m_regions[i];
+            ocsd_vaddr_t base = region.st_addr >> region.granule_shift;
+            ocsd_vaddr_t first = (func.st_addr > region.st_addr) ? func.st_addr : region.st_addr;
+            ocsd_vaddr_t last = (last_addr < region.en_addr) ? last_addr : region.en_addr;
+            uint64_t first_bit = (first >> region.granule_shift) - base;
+            uint64_t last_bit = (last >> region.granule_shift) - base;
+            func.num_granules += last_bit - first_bit + 1;
+            func.num_covered += countBits(region, first_bit, last_bit);
+        }
+    }
+}
+
+ocsd_err_t TrcGenElemCoverage::save(const std::string &filename) const
+{
+    std::vector<uint8_t> buffer;
+
+    for (int i = 0; i < 8; i++)
+        buffer.push_back((uint8_t)OCSD_COV_MAGIC[i]);
+    buffer.push_back(OCSD_COV_VERSION & 0xFF);
+    buffer.push_back((OCSD_COV_VERSION >> 8) & 0xFF);
+    buffer.push_back(OCSD_COV_HDR_SIZE & 0xFF);
+    buffer.push_back((OCSD_COV_HDR_SIZE >> 8) & 0xFF);
+    for (int i = 0; i < 4; i++)
+        buffer.push_back((uint8_t)(m_regions.size() >> (i * 8)));
+
+    for (size_t r = 0; r < m_regions.size(); r++)
+    {
+        const cov_region_t &region = m_regions[r];
+        putVarint(buffer, region.st_addr);
+        putVarint(buffer, region.en_addr);
+        buffer.push_back((uint8_t)(1 << region.granule_shift));
+
+        size_t w = 0;
+        while (w < region.bits.size())
+        {
+            size_t zeros = 0, literals = 0;
+            while (((w + zeros) < region.bits.size()) && !region.bits[w + zeros])
+                zeros++;
+            while (((w + zeros + literals) < region.bits.size()) && region.bits[w + zeros + literals])
+                literals++;
+            putVarint(buffer, zeros);
+            putVarint(buffer, literals);
+            w += zeros;
+            for (size_t l = 0; l < literals; l++, w++)
+            {
+                for (int i = 0; i < 8; i++)
+                    buffer.push_back((uint8_t)(region.bits[w] >> (i * 8)));
+            }
+        }
+    }
+
+    std::ofstream out_file(filename.c_str(), std::ofstream::binary | std::ofstream::trunc);
+    if (!out_file.is_open())
+        return OCSD_ERR_FILE_ERROR;
+    out_file.write((const char *)&buffer[0], buffer.size());
+    return out_file.good() ? OCSD_OK : OCSD_ERR_FILE_ERROR;
+}
+
+ocsd_err_t TrcGenElemCoverage::load(const std::string &filename)
+{
+    std::ifstream in_file(filename.c_str(), std::ifstream::binary);
+    if (!in_file.is_open())
+        return OCSD_ERR_FILE_ERROR;
+    std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(in_file)), std::istreambuf_iterator<char>());
+
+    clear();
+    if ((buffer.size() < OCSD_COV_HDR_SIZE) || (memcmp(&buffer[0], OCSD_COV_MAGIC, 8) != 0) ||
+        ((buffer[8] | (buffer[9] << 8)) != OCSD_COV_VERSION))
+        return OCSD_ERR_FILE_ERROR;
+
+    size_t pos = buffer[10] | (buffer[11] << 8);
+    uint32_t num_regions = buffer[12] | (buffer[13] << 8) | (buffer[14] << 16) | ((uint32_t)buffer[15] << 24);
+    ocsd_err_t err = OCSD_OK;
+
+    for (uint32_t r = 0; (r < num_regions) && (err == OCSD_OK); r++)
+    {
+        uint64_t st_addr, en_addr;
+        if (!getVarint(buffer, pos, st_addr) || !getVarint(buffer, pos, en_addr) || (pos >= buffer.size()))
+        {
+            err = OCSD_ERR_FILE_ERROR;
+            break;
+        }
+        if (addRegion(st_addr, en_addr, buffer[pos++]) != OCSD_OK)
+        {
+            err = OCSD_ERR_FILE_ERROR;
+            break;
+        }
+
+        std::vector<uint64_t> &bits = m_regions[findRegion(st_addr)].bits;
+        size_t w = 0;
+        while ((w < bits.size()) && (err == OCSD_OK))
+        {
+            uint64_t zeros, literals;
+            if (!getVarint(buffer, pos, zeros) || !getVarint(buffer, pos, literals) ||
+                ((zeros + literals) > (bits.size() - w)) || ((zeros + literals) == 0) ||
+                ((buffer.size() - pos) < (literals * 8)))
+            {
+                err = OCSD_ERR_FILE_ERROR;
+                break;
+            }
+            w += (size_t)zeros;
+            for (uint64_t l = 0; l < literals; l++, w++)
+            {
+                uint64_t word = 0;
+                for (int i = 0; i < 8; i++)
+                    word |= (uint64_t)buffer[pos++] << (i * 8);
+                bits[w] = word;
+            }
+        }
+    }
+
+    if (err != OCSD_OK)
+        clear();
+    return err;
+}
+
+/* End of File trc_gen_elem_coverage.cpp */
@@ -0,0 +1,277 @@
+/*
+ * \file       trc_gen_elem_cycle_prof.cpp
+ * \brief      OpenCSD : Cycle count profiler generic element sink.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#include "common/trc_gen_elem_cycle_prof.h"
+
+#include <algorithm>
+
+// bucket addresses are aligned so never match the empty marker.
+#define PROF_EMPTY_ADDR (~(ocsd_vaddr_t)0)
+#define PROF_INIT_TABLE_SIZE 1024
+
+static bool hotterBucket(const ocsd_cyc_prof_bucket_t &lhs, const ocsd_cyc_prof_bucket_t &rhs)
+{
+    if (lhs.cycles != rhs.cycles)
+        return lhs.cycles > rhs.cycles;
+    if (lhs.instr != rhs.instr)
+        return lhs.instr > rhs.instr;
+    return lhs.addr < rhs.addr;
+}
+
+TrcGenElemCycleProfile::TrcGenElemCycleProfile() :
+    m_bucket_shift(OCSD_CYC_PROF_DEF_BUCKET_SHIFT)
+{
+    clear();
+}
+
+ocsd_err_t TrcGenElemCycleProfile::setBucketShift(const int shift)
+{
+    if ((shift < 1) || (shift > 16))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    m_bucket_shift = shift;
+    clear();
+    return OCSD_OK;
+}
+
+void TrcGenElemCycleProfile::clear()
+{
+    ocsd_cyc_prof_bucket_t empty;
+    empty.addr = PROF_EMPTY_ADDR;
+    empty.hits = 0;
+    empty.instr = 0;
+    empty.cycles = 0;
+    m_table.assign(PROF_INIT_TABLE_SIZE, empty);
+    m_num_used = 0;
+
+    for (int i = 0; i < 256; i++)
+    {
+        m_pending[i].clear();
+        m_last_range[i].num_instr = 0;
+    }
+
+    m_total_cycles = 0;
+    m_unattrib_cycles = 0;
+    m_total_instr = 0;
+    m_unattrib_instr = 0;
+}
+
+ocsd_datapath_resp_t TrcGenElemCycleProfile::TraceElemIn(const ocsd_trc_index_t index_sop,
+                                                          const uint8_t trc_chan_id,
+                                                          const OcsdTraceElement &elem)
+{
+    std::vector<prof_range_t> &pending = m_pending[trc_chan_id];
+    prof_range_t &last_range = m_last_range[trc_chan_id];
+
+    switch (elem.getType())
+    {
+    case OCSD_GEN_TRC_ELEM_INSTR_RANGE:
+        {
+            if (pending.size() >= OCSD_CYC_PROF_MAX_PENDING)
+                flushPending(pending);
+            prof_range_t range;
+            range.st_addr = elem.st_addr;
+            range.en_addr = elem.en_addr;
+            range.num_instr = elem.num_instr_range;
+            pending.push_back(range);
+        }
+        break;
+
+    // discontinuity - following counts do not cover the held ranges.
+    case OCSD_GEN_TRC_ELEM_NO_SYNC:
+    case OCSD_GEN_TRC_ELEM_TRACE_ON:
+    case OCSD_GEN_TRC_ELEM_EO_TRACE:
+        flushPending(pending);
+        last_range.num_instr = 0;
+        break;
+
+    default:
+        break;
+    }
+
+    if (elem.has_cc)
+        attributeCycles(pending, last_range, elem.cycle_count);
+
+    return OCSD_RESP_CONT;
+}
+
+void TrcGenElemCycleProfile::flush()
+{
+    for (int i = 0; i < 256; i++)
+        flushPending(m_pending[i]);
+}
+
+void TrcGenElemCycleProfile::attributeCycles(std::vector<prof_range_t> &pending, prof_range_t &last_range, const uint32_t cycles)
+{
+    if (pending.empty())
+    {
+        // no instructions since the last count - cycles belong to the last range executed.
+        if (last_range.num_instr)
+        {
+            addCycles(last_range, (double)cycles);
+            m_total_cycles += cycles;
+        }
+        else
+            m_unattrib_cycles += cycles;
+        return;
+    }
+
+    // share the count across the ranges by instruction count.
+    uint64_t num_instr = 0;
+    for (size_t i = 0; i < pending.size(); i++)
+        num_instr += pending[i].num_instr;
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        double share = num_instr ? ((double)pending[i].num_instr / (double)num_instr) : (1.0 / (double)pending.size());
+        addRange(pending[i], share * (double)cycles);
+    }
+    m_total_cycles += cycles;
+    last_range = pending.back();
+    pending.clear();
+}
+
+void TrcGenElemCycleProfile::flushPending(std::vector<prof_range_t> &pending)
+{
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        addRange(pending[i], 0);
+        m_unattrib_instr += pending[i].num_instr;
+    }
+    pending.clear();
+}
+
+void TrcGenElemCycleProfile::addRange(const prof_range_t &range, const double cycles)
+{
+    m_total_instr += range.num_instr;
+    addToBuckets(range, range.num_instr, cycles, 1);
+}
+
+void TrcGenElemCycleProfile::addCycles(const prof_range_t &range, const double cycles)
+{
+    addToBuckets(range, 0, cycles, 0);
+}
+
+void TrcGenElemCycleProfile::addToBuckets(const prof_range_t &range, const uint32_t num_instr, const double cycles, const uint32_t hits)
+{
+    if (range.en_addr <= range.st_addr)
+        return;
+
+    ocsd_vaddr_t first = range.st_addr >> m_bucket_shift;
+    ocsd_vaddr_t last = (range.en_addr - 1) >> m_bucket_shift;
+    if (first == last)
+    {
+        ocsd_cyc_prof_bucket_t &bucket = getBucket(first << m_bucket_shift);
+        bucket.hits += hits;
+        bucket.instr += num_instr;
+        bucket.cycles += cycles;
+        return;
+    }
+
+    // share across the buckets by the number of bytes in each.
+    double size = (double)(range.en_addr - range.st_addr);
+    for (ocsd_vaddr_t b = first; b <= last; b++)
+    {
+        ocsd_vaddr_t st = (b == first) ? range.st_addr : (b << m_bucket_shift);
+        ocsd_vaddr_t en = (b == last) ? range.en_addr : ((b + 1) << m_bucket_shift);
+        double share = (double)(en - st) / size;
+        ocsd_cyc_prof_bucket_t &bucket = getBucket(b << m_bucket_shift);
+        bucket.hits += hits;
+        bucket.instr += share * num_instr;
+        bucket.cycles += share * cycles;
+    }
+}
+
+ocsd_cyc_prof_bucket_t &TrcGenElemCycleProfile::getBucket(const ocsd_vaddr_t addr)
+{
+    // keep the table at most half full.
+    if ((m_num_used * 2) >= m_table.size())
+        growTable();
+
+    size_t mask = m_table.size() - 1;
+    size_t idx = (size_t)(((addr >> m_bucket_shift) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while ((m_table[idx].addr != addr) && (m_table[idx].addr != PROF_EMPTY_ADDR))
+        idx = (idx + 1) & mask;
+
+    if (m_table[idx].addr == PROF_EMPTY_ADDR)
+    {
+        m_table[idx].addr = addr;
+        m_num_used++;
+    }
+    return m_table[idx];
+}
+
+void TrcGenElemCycleProfile::growTable()
+{
+    std::vector<ocsd_cyc_prof_bucket_t> old_table;
+    old_table.swap(m_table);
+
+    ocsd_cyc_prof_bucket_t empty;
+    empty.addr = PROF_EMPTY_ADDR;
+    empty.hits = 0;
+    empty.instr = 0;
+    empty.cycles = 0;
+    m_table.assign(old_table.size() * 2, empty);
+    m_num_used = 0;
+
+    for (size_t i = 0; i < old_table.size(); i++)
+    {
+        if (old_table[i].addr != PROF_EMPTY_ADDR)
+        {
+            ocsd_cyc_prof_bucket_t &bucket = getBucket(old_table[i].addr);
+            bucket = old_table[i];
+        }
+    }
+}
+
+void TrcGenElemCycleProfile::getHotspots(std::vector<ocsd_cyc_prof_bucket_t> &hotspots, const size_t max_num /* = 0 */) const
+{
+    hotspots.clear();
+    hotspots.reserve(m_num_used);
+    for (size_t i = 0; i < m_table.size(); i++)
+    {
+        if (m_table[i].addr != PROF_EMPTY_ADDR)
+            hotspots.push_back(m_table[i]);
+    }
+
+    if (max_num && (max_num < hotspots.size()))
+    {
+        std::partial_sort(hotspots.begin(), hotspots.begin() + max_num, hotspots.end(), hotterBucket);
+        hotspots.resize(max_num);
+    }
+    else
+        std::sort(hotspots.begin(), hotspots.end(), hotterBucket);
+}
+
+/* End of File trc_gen_elem_cycle_prof.cpp */
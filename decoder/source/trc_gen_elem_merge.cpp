@@ -0,0 +1,293 @@
+/*
+ * \file       trc_gen_elem_merge.cpp
+ * \brief      OpenCSD : Timestamp ordered merge of generic trace element streams.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+#include "common/trc_gen_elem_merge.h"
+
+// size of copied extended data - only SW trace payloads have a known size.
+static inline size_t extDataSize(const ocsd_generic_trace_elem &elem)
+{
+    if ((elem.elem_type == OCSD_GEN_TRC_ELEM_SWTRACE) && elem.extended_data && elem.ptr_extended_data)
+        return ((elem.sw_trace_info.swt_payload_pkt_bitsize * elem.sw_trace_info.swt_payload_num_packets) + 7) / 8;
+    return 0;
+}
+
+bool TrcGenElemMerge::merge_seg_key_t::operator>(const merge_seg_key_t &rhs) const
+{
+    if (ts != rhs.ts)
+        return ts > rhs.ts;
+    if (source_tag != rhs.source_tag)
+        return source_tag > rhs.source_tag;
+    if (trc_chan_id != rhs.trc_chan_id)
+        return trc_chan_id > rhs.trc_chan_id;
+    return seq > rhs.seq;
+}
+
+TrcGenElemMerge::TrcGenElemMerge() :
+    m_p_out(0),
+    m_max_buffered(OCSD_MERGE_DEF_MAX_BUFFERED)
+{
+    reset();
+}
+
+TrcGenElemMerge::~TrcGenElemMerge()
+{
+    std::map<int, MergeInput *>::iterator it;
+    for (it = m_inputs.begin(); it != m_inputs.end(); it++)
+        delete it->second;
+    m_inputs.clear();
+}
+
+ITrcGenElemIn *TrcGenElemMerge::getInput(const int source_tag)
+{
+    std::map<int, MergeInput *>::iterator it = m_inputs.find(source_tag);
+    if (it != m_inputs.end())
+        return it->second;
+
+    MergeInput *pInput = new (std::nothrow) MergeInput(this, source_tag);
+    if (pInput)
+        m_inputs[source_tag] = pInput;
+    return pInput;
+}
+
+void TrcGenElemMerge::setMaxBuffered(const size_t max_elem)
+{
+    m_max_buffered = max_elem;
+}
+
+void TrcGenElemMerge::reset()
+{
+    m_sources.clear();
+    m_source_map.clear();
+    while (!m_seg_heap.empty())
+        m_seg_heap.pop();
+    m_emit_src = 0;
+    m_emit_remaining = 0;
+    m_num_buffered = 0;
+    m_num_forced = 0;
+    m_seg_seq = 0;
+    m_finishing = false;
+}
+
+size_t TrcGenElemMerge::getSource(const int source_tag, const uint8_t trc_chan_id)
+{
+    std::pair<int, uint8_t> id(source_tag, trc_chan_id);
+    std::map<std::pair<int, uint8_t>, size_t>::iterator it = m_source_map.find(id);
+    if (it != m_source_map.end())
+        return it->second;
+
+    merge_source_t source;
+    source.source_tag = source_tag;
+    source.trc_chan_id = trc_chan_id;
+    source.num_open = 0;
+    source.last_ts = 0;
+    source.ts_seen = false;
+    source.done = false;
+    m_sources.push_back(source);
+    m_source_map[id] = m_sources.size() - 1;
+    return m_sources.size() - 1;
+}
+
+ocsd_datapath_resp_t TrcGenElemMerge::elemIn(const int source_tag, const ocsd_trc_index_t index_sop, const uint8_t trc_chan_id, const OcsdTraceElement &elem)
+{
+    if (!m_p_out)
+        return OCSD_RESP_FATAL_NOT_INIT;
+
+    size_t src_idx = getSource(source_tag, trc_chan_id);
+    merge_source_t &source = m_sources[src_idx];
+
+    source.elems.push_back(merge_elem_t());
+    merge_elem_t &entry = source.elems.back();
+    entry.index_sop = index_sop;
+    entry.elem = elem;
+    size_t ext_size = extDataSize(elem);
+    if (ext_size)
+    {
+        const uint8_t *p_data = (const uint8_t *)elem.ptr_extended_data;
+        entry.ext_data.assign(p_data, p_data + ext_size);
+    }
+    source.num_open++;
+    source.done = false;
+    m_num_buffered++;
+
+    // timestamp closes the segment containing all the preceding elements.
+    if ((elem.getType() == OCSD_GEN_TRC_ELEM_TIMESTAMP) || elem.has_ts)
+        closeSegment(src_idx, elem.timestamp);
+    else if (elem.getType() == OCSD_GEN_TRC_ELEM_EO_TRACE)
+    {
+        closeSegment(src_idx, source.last_ts);
+        source.done = true;
+    }
+
+    return outputElems();
+}
+
+void TrcGenElemMerge::closeSegment(const size_t src_idx, const uint64_t ts)
+{
+    merge_source_t &source = m_sources[src_idx];
+
+    // segment keys never decrease within a source - elements are not re-ordered within a source.
+    if (!source.ts_seen || (ts > source.last_ts))
+        source.last_ts = ts;
+    source.ts_seen = true;
+
+    if (source.num_open)
+    {
+        merge_seg_key_t key;
+        key.ts = source.last_ts;
+        key.source_tag = source.source_tag;
+        key.trc_chan_id = source.trc_chan_id;
+        key.seq = m_seg_seq++;
+        key.src_idx = src_idx;
+        source.seg_sizes.push_back(source.num_open);
+        source.num_open = 0;
+        m_seg_heap.push(key);
+    }
+}
+
+// segment can be output if no other active source can still produce an earlier segment.
+bool TrcGenElemMerge::segmentReady(const merge_seg_key_t &key) const
+{
+    if (m_finishing)
+        return true;
+
+    for (size_t i = 0; i < m_sources.size(); i++)
+    {
+        const merge_source_t &source = m_sources[i];
+        if ((i == key.src_idx) || source.done || !source.seg_sizes.empty())
+            continue;   // closed segments of other sources are already ordered in the heap.
+
+        // open or future elements will have a key of at least the last timestamp seen.
+        if (!source.ts_seen || (source.last_ts < key.ts))
+            return false;
+    }
+    return true;
+}
+
+ocsd_datapath_resp_t TrcGenElemMerge::outputElems()
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+
+    while (OCSD_DATA_RESP_IS_CONT(resp))
+    {
+        if (m_emit_remaining)
+        {
+            resp = emitCurrent();
+            continue;
+        }
+
+        bool over_limit = (m_num_buffered > m_max_buffered);
+        if (!m_seg_heap.empty())
+        {
+            merge_seg_key_t key = m_seg_heap.top();
+            bool ready = segmentReady(key);
+            if (!ready && !over_limit)
+                break;
+            if (!ready)
+                m_num_forced++;
+
+            m_seg_heap.pop();
+            merge_source_t &source = m_sources[key.src_idx];
+            m_emit_src = key.src_idx;
+            m_emit_remaining = source.seg_sizes.front();
+            source.seg_sizes.pop_front();
+        }
+        else if (over_limit)
+        {
+            // no closed segments - force out the open segment that is earliest by timestamp.
+            size_t src_idx = m_sources.size();
+            for (size_t i = 0; i < m_sources.size(); i++)
+            {
+                if (m_sources[i].num_open && 
+                    ((src_idx == m_sources.size()) || (m_sources[i].last_ts < m_sources[src_idx].last_ts)))
+                    src_idx = i;
+            }
+            if (src_idx == m_sources.size())
+                break;
+
+            m_num_forced++;
+            m_emit_src = src_idx;
+            m_emit_remaining = m_sources[src_idx].num_open;
+            m_sources[src_idx].num_open = 0;
+        }
+        else
+            break;
+    }
+    return resp;
+}
+
+ocsd_datapath_resp_t TrcGenElemMerge::emitCurrent()
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+    merge_source_t &source = m_sources[m_emit_src];
+
+    while (m_emit_remaining && OCSD_DATA_RESP_IS_CONT(resp))
+    {
+        merge_elem_t &entry = source.elems.front();
+        static_cast<ocsd_generic_trace_elem &>(m_out_elem) = entry.elem;
+        if (!entry.ext_data.empty())
+            m_out_elem.ptr_extended_data = &entry.ext_data[0];
+        resp = m_p_out->TraceMergedElemIn(source.source_tag, entry.index_sop, source.trc_chan_id, m_out_elem);
+        source.elems.pop_front();
+        m_emit_remaining--;
+        m_num_buffered--;
+    }
+    return resp;
+}
+
+ocsd_datapath_resp_t TrcGenElemMerge::drain()
+{
+    if (!m_p_out)
+        return OCSD_RESP_FATAL_NOT_INIT;
+    return outputElems();
+}
+
+ocsd_datapath_resp_t TrcGenElemMerge::finish()
+{
+    if (!m_p_out)
+        return OCSD_RESP_FATAL_NOT_INIT;
+
+    if (!m_finishing)
+    {
+        for (size_t i = 0; i < m_sources.size(); i++)
+        {
+            closeSegment(i, m_sources[i].last_ts);
+            m_sources[i].done = true;
+        }
+        m_finishing = true;
+    }
+    return outputElems();
+}
+
+/* End of File trc_gen_elem_merge.cpp */
@@ -0,0 +1,224 @@
+/*
+ * \file       trc_gen_elem_queue.cpp
+ * \brief      OpenCSD : Queue generic trace elements to a sink on a consumer thread.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+
+#include "common/trc_gen_elem_queue.h"
+
+#include <chrono>
+
+TrcGenElemQueue::TrcGenElemQueue() :
+    m_size(0),
+    m_mask(0),
+    m_wake_level(1),
+    m_p_out(0),
+    m_head(0),
+    m_tail(0),
+    m_out_resp(OCSD_RESP_CONT),
+    m_stop(false),
+    m_consumer_idle(false),
+    m_num_waits(0),
+    m_num_blocked(0)
+{
+}
+
+TrcGenElemQueue::~TrcGenElemQueue()
+{
+    stop();
+}
+
+ocsd_err_t TrcGenElemQueue::start(ITrcGenElemIn *p_out, const uint32_t queue_size)
+{
+    if (m_thread.joinable())
+        return OCSD_ERR_INVALID_PARAM_VAL;
+    if (!p_out || !queue_size || (queue_size > 0x80000000))
+        return OCSD_ERR_INVALID_PARAM_VAL;
+
+    m_size = 1;
+    while (m_size < queue_size)
+        m_size <<= 1;
+    m_mask = m_size - 1;
+    m_wake_level = (m_size >= 4) ? m_size / 4 : 1;
+    m_ring.resize(m_size);
+
+    m_p_out = p_out;
+    m_head.store(0);
+    m_tail.store(0);
+    m_out_resp.store(OCSD_RESP_CONT);
+    m_stop.store(false);
+    m_consumer_idle.store(false);
+    m_num_waits = 0;
+    m_num_blocked = 0;
+
+    try {
+        m_thread = std::thread(&TrcGenElemQueue::consumerThread, this);
+    }
+    catch (...) {
+        return OCSD_ERR_FAIL;
+    }
+    return OCSD_OK;
+}
+
+void TrcGenElemQueue::flush()
+{
+    if (!m_thread.joinable())
+        return;
+    wakeConsumer();
+    while (m_tail.load(std::memory_order_acquire) != m_head.load(std::memory_order_relaxed))
+        std::this_thread::yield();
+}
+
+void TrcGenElemQueue::stop()
+{
+    if (!m_thread.joinable())
+        return;
+    m_stop.store(true, std::memory_order_release);
+    wakeConsumer();
+    m_thread.join();    // consumer empties the ring before exiting.
+}
+
+ocsd_datapath_resp_t TrcGenElemQueue::TraceElemIn(const ocsd_trc_index_t index_sop,
+                                                  const uint8_t trc_chan_id,
+                                                  const OcsdTraceElement &elem)
+{
+    if (!m_thread.joinable())
+        return OCSD_RESP_FATAL_NOT_INIT;
+
+    ocsd_datapath_resp_t out_resp = m_out_resp.load(std::memory_order_relaxed);
+    if (OCSD_DATA_RESP_IS_FATAL(out_resp))
+        return out_resp;
+
+    // decoder continued without waiting for space - block until the consumer catches up.
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (ringFull(head))
+    {
+        m_num_blocked++;
+        while (ringFull(head))
+            std::this_thread::yield();
+    }
+
+    queue_elem_t &entry = m_ring[head & m_mask];
+    entry.index_sop = index_sop;
+    entry.trc_chan_id = trc_chan_id;
+    entry.elem = elem;
+
+    // only SW trace payloads have a known size.
+    entry.ext_data.clear();
+    if ((elem.elem_type == OCSD_GEN_TRC_ELEM_SWTRACE) && elem.extended_data && elem.ptr_extended_data)
+    {
+        size_t size = ((elem.sw_trace_info.swt_payload_pkt_bitsize * elem.sw_trace_info.swt_payload_num_packets) + 7) / 8;
+        const uint8_t *p_data = (const uint8_t *)elem.ptr_extended_data;
+        entry.ext_data.assign(p_data, p_data + size);
+    }
+
+    head++;
+    m_head.store(head, std::memory_order_release);
+
+    // wake an idle consumer once a batch is queued, rather than per element.
+    if ((head - m_tail.load(std::memory_order_acquire)) >= m_wake_level)
+        wakeConsumer();
+
+    if (ringFull(head))
+    {
+        m_num_waits++;
+        return OCSD_RESP_WAIT;
+    }
+    return OCSD_RESP_CONT;
+}
+
+void TrcGenElemQueue::wakeConsumer()
+{
+    if (m_consumer_idle.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(m_idle_mutex);
+        m_idle_cv.notify_one();
+    }
+}
+
+void TrcGenElemQueue::waitForElems(const uint32_t tail)
+{
+    // brief spin before sleeping - the decoder is usually mid block.
+    for (int i = 0; i < 64; i++)
+    {
+        if (m_head.load(std::memory_order_acquire) != tail)
+            return;
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(m_idle_mutex);
+    m_consumer_idle.store(true, std::memory_order_release);
+
+    // timeout covers a notify between the empty check and setting the idle flag, 
+    // and bounds the latency of a part batch.
+    m_idle_cv.wait_for(lock, std::chrono::milliseconds(1), [this, tail] {
+        return (m_head.load(std::memory_order_acquire) != tail) || m_stop.load(std::memory_order_acquire);
+    });
+    m_consumer_idle.store(false, std::memory_order_release);
+}
+
+void TrcGenElemQueue::consumerThread()
+{
+    OcsdTraceElement out_elem;
+    ocsd_datapath_resp_t resp;
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        if (tail == m_head.load(std::memory_order_acquire))
+        {
+            // ring empty - done if stopping, otherwise wait for more elements.
+            if (m_stop.load(std::memory_order_acquire))
+            {
+                if (tail == m_head.load(std::memory_order_acquire))
+                    break;
+                continue;
+            }
+            waitForElems(tail);
+            continue;
+        }
+
+        queue_elem_t &entry = m_ring[tail & m_mask];
+        static_cast<ocsd_generic_trace_elem &>(out_elem) = entry.elem;
+        out_elem.ptr_extended_data = entry.ext_data.empty() ? 0 : &entry.ext_data[0];
+
+        resp = m_p_out->TraceElemIn(entry.index_sop, entry.trc_chan_id, out_elem);
+        if (OCSD_DATA_RESP_IS_FATAL(resp))
+            m_out_resp.store(resp, std::memory_order_relaxed);
+
+        tail++;
+        m_tail.store(tail, std::memory_order_release);
+    }
+}
+
+/* End of File trc_gen_elem_queue.cpp */
@@ -0,0 +1,519 @@
+/*
+ * \file       trc_gen_elem_serial.cpp
+ * \brief      OpenCSD : Compact binary serialisation of generic trace elements.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+#include "common/trc_gen_elem_serial.h"
+
+#include <cstring>
+
+// staging buffer flushed to file when this size reached.
+#define SER_FLUSH_SIZE (64 * 1024)
+
+// payload union is written as a single 64 bit value - sw_trace_info is the largest member.
+static_assert(sizeof(ocsd_swt_info_t) == sizeof(uint64_t), "Unexpected generic element payload size");
+
+static inline uint64_t zigzagEncode(const int64_t val)
+{
+    return ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+}
+
+static inline int64_t zigzagDecode(const uint64_t val)
+{
+    return (int64_t)(val >> 1) ^ -(int64_t)(val & 0x1);
+}
+
+// dictionary key for a PE context - all the fields with the valid flags.
+static inline std::pair<uint64_t, uint32_t> contextKey(const ocsd_pe_context &context)
+{
+    uint64_t ids = ((uint64_t)context.context_id << 32) | context.vmid;
+    uint32_t state = ((uint32_t)context.security_level & 0xFF) | 
+                     (((uint32_t)context.exception_level & 0xFF) << 8) |
+                     (context.bits64 << 16) | (context.ctxt_id_valid << 17) |
+                     (context.vmid_valid << 18) | (context.el_valid << 19);
+    return std::make_pair(ids, state);
+}
+
+static inline uint64_t getPayload(const ocsd_generic_trace_elem &elem)
+{
+    uint64_t payload;
+    memcpy(&payload, &elem.sw_trace_info, sizeof(payload));
+    return payload;
+}
+
+static inline void setPayload(ocsd_generic_trace_elem &elem, const uint64_t payload)
+{
+    memcpy(&elem.sw_trace_info, &payload, sizeof(payload));
+}
+
+// size of serialisable extended data - only SW trace payloads have a known size.
+static inline size_t extDataSize(const ocsd_generic_trace_elem &elem)
+{
+    if ((elem.elem_type == OCSD_GEN_TRC_ELEM_SWTRACE) && elem.extended_data && elem.ptr_extended_data)
+        return ((elem.sw_trace_info.swt_payload_pkt_bitsize * elem.sw_trace_info.swt_payload_num_packets) + 7) / 8;
+    return 0;
+}
+
+/***************************************************************/
+/* Writer */
+
+TrcGenElemSerialWriter::TrcGenElemSerialWriter()
+{
+    m_buffer.reserve(SER_FLUSH_SIZE + 256);
+    resetState();
+}
+
+TrcGenElemSerialWriter::~TrcGenElemSerialWriter()
+{
+    close();
+}
+
+void TrcGenElemSerialWriter::resetState()
+{
+    memset(m_prev_elem, 0, sizeof(m_prev_elem));
+    m_prev_index = 0;
+    m_prev_chan_id = 0;
+    m_num_elem = 0;
+    m_ctxt_dict.clear();
+    m_buffer.clear();
+}
+
+ocsd_err_t TrcGenElemSerialWriter::open(const std::string &filename)
+{
+    if (m_out_file.is_open())
+        close();
+
+    m_out_file.open(filename.c_str(), std::ofstream::binary | std::ofstream::trunc);
+    if (!m_out_file.is_open())
+        return OCSD_ERR_FILE_ERROR;
+
+    resetState();
+    for (int i = 0; i < 8; i++)
+        putByte((uint8_t)OCSD_SER_MAGIC[i]);
+    putByte(OCSD_SER_VERSION & 0xFF);
+    putByte((OCSD_SER_VERSION >> 8) & 0xFF);
+    putByte(OCSD_SER_HDR_SIZE & 0xFF);
+    putByte((OCSD_SER_HDR_SIZE >> 8) & 0xFF);
+    for (int i = 0; i < 4; i++)
+        putByte(0);
+    return flushBuffer();
+}
+
+ocsd_err_t TrcGenElemSerialWriter::close()
+{
+    ocsd_err_t err = OCSD_OK;
+    if (m_out_file.is_open())
+    {
+        err = flushBuffer();
+        m_out_file.close();
+    }
+    return err;
+}
+
+ocsd_err_t TrcGenElemSerialWriter::flushBuffer()
+{
+    if (m_buffer.size())
+    {
+        m_out_file.write((const char *)m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+        if (m_out_file.fail())
+            return OCSD_ERR_FILE_ERROR;
+    }
+    return OCSD_OK;
+}
+
+ocsd_datapath_resp_t TrcGenElemSerialWriter::TraceElemIn(const ocsd_trc_index_t index_sop,
+                                                          const uint8_t trc_chan_id,
+                                                          const OcsdTraceElement &elem)
+{
+    if (!m_out_file.is_open())
+        return OCSD_RESP_FATAL_NOT_INIT;
+
+    writeElem(index_sop, trc_chan_id, elem);
+    if ((m_buffer.size() >= SER_FLUSH_SIZE) && (flushBuffer() != OCSD_OK))
+        return OCSD_RESP_FATAL_SYS_ERR;
+    return OCSD_RESP_CONT;
+}
+
+void TrcGenElemSerialWriter::putVarint(uint64_t val)
+{
+    while (val >= 0x80)
+    {
+        putByte((uint8_t)(val | 0x80));
+        val >>= 7;
+    }
+    putByte((uint8_t)val);
+}
+
+void TrcGenElemSerialWriter::writeElem(const ocsd_trc_index_t index_sop, const uint8_t trc_chan_id, const ocsd_generic_trace_elem &elem)
+{
+    ocsd_generic_trace_elem &prev = m_prev_elem[trc_chan_id];
+    size_t ext_size = extDataSize(elem);
+    uint32_t mask = 0;
+    uint8_t rec_hdr = (uint8_t)elem.elem_type & OCSD_SER_REC_TYPE_MASK;
+
+    // extended data that cannot be sized is not written - clear the flag so the reader does not expect a pointer.
+    ocsd_generic_trace_elem flags;
+    flags.flag_bits = elem.flag_bits;
+    if (!ext_size)
+        flags.extended_data = 0;
+    const uint32_t flag_bits = flags.flag_bits;
+
+    // record header, trace ID and index
+    if (trc_chan_id == m_prev_chan_id)
+        rec_hdr |= OCSD_SER_REC_SAME_ID;
+    if (index_sop == m_prev_index)
+        rec_hdr |= OCSD_SER_REC_SAME_IDX;
+    putByte(rec_hdr);
+    if (!(rec_hdr & OCSD_SER_REC_SAME_ID))
+        putByte(trc_chan_id);
+    if (!(rec_hdr & OCSD_SER_REC_SAME_IDX))
+        putVarint(zigzagEncode((int64_t)(index_sop - m_prev_index)));
+    m_prev_chan_id = trc_chan_id;
+    m_prev_index = index_sop;
+
+    // field mask - only fields changed from the previous element on this ID.
+    if (elem.isa != prev.isa)
+        mask |= OCSD_SER_F_ISA;
+    if (elem.st_addr != prev.st_addr)
+        mask |= OCSD_SER_F_ST_ADDR;
+    if (elem.en_addr != prev.en_addr)
+        mask |= OCSD_SER_F_EN_ADDR;
+    if (contextKey(elem.context) != contextKey(prev.context))
+        mask |= OCSD_SER_F_CONTEXT;
+    if (elem.timestamp != prev.timestamp)
+        mask |= OCSD_SER_F_TS;
+    if (elem.cycle_count != prev.cycle_count)
+        mask |= OCSD_SER_F_CC;
+    if ((elem.last_i_type != prev.last_i_type) || (elem.last_i_subtype != prev.last_i_subtype))
+        mask |= OCSD_SER_F_LAST_I;
+    if (flag_bits != prev.flag_bits)
+        mask |= OCSD_SER_F_FLAGS;
+    if (getPayload(elem) != getPayload(prev))
+        mask |= OCSD_SER_F_PAYLOAD;
+    if (ext_size)
+        mask |= OCSD_SER_F_EXT_DATA;
+    putVarint(mask);
+
+    // changed fields
+    if (mask & OCSD_SER_F_ISA)
+        putByte((uint8_t)elem.isa);
+    if (mask & OCSD_SER_F_ST_ADDR)
+        putVarint(zigzagEncode((int64_t)(elem.st_addr - prev.en_addr)));
+    if (mask & OCSD_SER_F_EN_ADDR)
+        putVarint(zigzagEncode((int64_t)(elem.en_addr - elem.st_addr)));
+    if (mask & OCSD_SER_F_CONTEXT)
+        writeContext(elem.context);
+    if (mask & OCSD_SER_F_TS)
+        putVarint(zigzagEncode((int64_t)(elem.timestamp - prev.timestamp)));
+    if (mask & OCSD_SER_F_CC)
+        putVarint(elem.cycle_count);
+    if (mask & OCSD_SER_F_LAST_I)
+    {
+        putByte((uint8_t)elem.last_i_type);
+        putByte((uint8_t)elem.last_i_subtype);
+    }
+    if (mask & OCSD_SER_F_FLAGS)
+        putVarint(flag_bits);
+    if (mask & OCSD_SER_F_PAYLOAD)
+        putVarint(getPayload(elem));
+    if (mask & OCSD_SER_F_EXT_DATA)
+    {
+        const uint8_t *p_data = (const uint8_t *)elem.ptr_extended_data;
+        putVarint(ext_size);
+        m_buffer.insert(m_buffer.end(), p_data, p_data + ext_size);
+    }
+
+    prev = elem;
+    prev.flag_bits = flag_bits;
+    m_num_elem++;
+}
+
+void TrcGenElemSerialWriter::writeContext(const ocsd_pe_context &context)
+{
+    std::pair<uint64_t, uint32_t> key = contextKey(context);
+    ctxt_dict_t::const_iterator it = m_ctxt_dict.find(key);
+
+    if (it != m_ctxt_dict.end())
+    {
+        putVarint(it->second);
+        return;
+    }
+
+    // new dictionary entry - index == current size, followed by the context.
+    uint32_t dict_idx = (uint32_t)m_ctxt_dict.size();
+    m_ctxt_dict[key] = dict_idx;
+    putVarint(dict_idx);
+    putVarint(key.second);
+    putVarint(context.context_id);
+    putVarint(context.vmid);
+}
+
+/***************************************************************/
+/* Reader */
+
+TrcGenElemSerialReader::TrcGenElemSerialReader() :
+    m_p_data(0),
+    m_size(0),
+    m_pos(0)
+{
+    resetState();
+}
+
+void TrcGenElemSerialReader::resetState()
+{
+    memset(m_prev_elem, 0, sizeof(m_prev_elem));
+    m_prev_index = 0;
+    m_prev_chan_id = 0;
+    m_ctxt_dict.clear();
+    m_elem.init();
+}
+
+ocsd_err_t TrcGenElemSerialReader::open(const std::string &filename)
+{
+    std::ifstream in_file(filename.c_str(), std::ifstream::binary | std::ifstream::ate);
+
+    close();
+    if (!in_file.is_open())
+        return OCSD_ERR_FILE_ERROR;
+
+    std::streamoff file_size = in_file.tellg();
+    if (file_size < 0)
+        return OCSD_ERR_FILE_ERROR;
+    m_file_data.resize((size_t)file_size);
+    in_file.seekg(0, std::ifstream::beg);
+    if (file_size && !in_file.read((char *)m_file_data.data(), file_size))
+    {
+        m_file_data.clear();
+        return OCSD_ERR_FILE_ERROR;
+    }
+    return setBuffer(m_file_data.data(), m_file_data.size());
+}
+
+ocsd_err_t TrcGenElemSerialReader::setBuffer(const uint8_t *p_buffer, const size_t size)
+{
+    if (p_buffer != m_file_data.data())
+        m_file_data.clear();
+
+    m_p_data = p_buffer;
+    m_size = size;
+    return rewind();
+}
+
+void TrcGenElemSerialReader::close()
+{
+    m_file_data.clear();
+    m_p_data = 0;
+    m_size = m_pos = 0;
+    resetState();
+}
+
+ocsd_err_t TrcGenElemSerialReader::rewind()
+{
+    uint16_t version, hdr_size;
+
+    resetState();
+    m_pos = m_size;     // nothing to read if header invalid.
+    if (!m_p_data || (m_size < OCSD_SER_HDR_SIZE) || memcmp(m_p_data, OCSD_SER_MAGIC, 8))
+        return OCSD_ERR_FILE_ERROR;
+
+    version = m_p_data[8] | ((uint16_t)m_p_data[9] << 8);
+    hdr_size = m_p_data[10] | ((uint16_t)m_p_data[11] << 8);
+    if ((version != OCSD_SER_VERSION) || (hdr_size < OCSD_SER_HDR_SIZE) || (hdr_size > m_size))
+        return OCSD_ERR_FILE_ERROR;
+    m_pos = hdr_size;
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcGenElemSerialReader::getVarint(uint64_t &val)
+{
+    int shift = 0;
+    uint8_t byte;
+
+    val = 0;
+    do {
+        if ((m_pos >= m_size) || (shift > 63))
+            return OCSD_ERR_FILE_ERROR;
+        byte = m_p_data[m_pos++];
+        val |= (uint64_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcGenElemSerialReader::readContext(ocsd_pe_context &context)
+{
+    uint64_t dict_idx, state, ctxt_id, vmid;
+
+    if (getVarint(dict_idx) != OCSD_OK)
+        return OCSD_ERR_FILE_ERROR;
+
+    if (dict_idx < m_ctxt_dict.size())
+    {
+        context = m_ctxt_dict[(size_t)dict_idx];
+        return OCSD_OK;
+    }
+
+    // new entries must be added in sequence.
+    if ((dict_idx != m_ctxt_dict.size()) ||
+        (getVarint(state) != OCSD_OK) ||
+        (getVarint(ctxt_id) != OCSD_OK) ||
+        (getVarint(vmid) != OCSD_OK))
+        return OCSD_ERR_FILE_ERROR;
+
+    context.security_level = (ocsd_sec_level)(state & 0xFF);
+    context.exception_level = (ocsd_ex_level)((state >> 8) & 0xFF);
+    context.bits64 = (state >> 16) & 0x1;
+    context.ctxt_id_valid = (state >> 17) & 0x1;
+    context.vmid_valid = (state >> 18) & 0x1;
+    context.el_valid = (state >> 19) & 0x1;
+    context.context_id = (uint32_t)ctxt_id;
+    context.vmid = (uint32_t)vmid;
+    m_ctxt_dict.push_back(context);
+    return OCSD_OK;
+}
+
+ocsd_err_t TrcGenElemSerialReader::nextElem(ocsd_trc_index_t &index_sop, uint8_t &trc_chan_id, const OcsdTraceElement *&p_elem)
+{
+    uint8_t rec_hdr;
+    uint64_t val, mask;
+
+    p_elem = 0;
+    if (atEnd())
+        return OCSD_OK;
+
+    // record header, trace ID and index
+    rec_hdr = m_p_data[m_pos++];
+    if (!(rec_hdr & OCSD_SER_REC_SAME_ID))
+    {
+        if (atEnd())
+            return OCSD_ERR_FILE_ERROR;
+        m_prev_chan_id = m_p_data[m_pos++];
+    }
+    if (!(rec_hdr & OCSD_SER_REC_SAME_IDX))
+    {
+        if (getVarint(val) != OCSD_OK)
+            return OCSD_ERR_FILE_ERROR;
+        m_prev_index += (ocsd_trc_index_t)zigzagDecode(val);
+    }
+    if (getVarint(mask) != OCSD_OK)
+        return OCSD_ERR_FILE_ERROR;
+
+    // start from the previous element on this ID and update the changed fields.
+    ocsd_generic_trace_elem &elem = m_prev_elem[m_prev_chan_id];
+    elem.elem_type = (ocsd_gen_trc_elem_t)(rec_hdr & OCSD_SER_REC_TYPE_MASK);
+    elem.ptr_extended_data = 0;
+
+    if (mask & OCSD_SER_F_ISA)
+    {
+        if (atEnd())
+            return OCSD_ERR_FILE_ERROR;
+        elem.isa = (ocsd_isa)m_p_data[m_pos++];
+    }
+    if (mask & OCSD_SER_F_ST_ADDR)
+    {
+        if (getVarint(val) != OCSD_OK)
+            return OCSD_ERR_FILE_ERROR;
+        elem.st_addr = elem.en_addr + (ocsd_vaddr_t)zigzagDecode(val);
+    }
+    if (mask & OCSD_SER_F_EN_ADDR)
+    {
+        if (getVarint(val) != OCSD_OK)
+            return OCSD_ERR_FILE_ERROR;
+        elem.en_addr = elem.st_addr + (ocsd_vaddr_t)zigzagDecode(val);
+    }
+    if ((mask & OCSD_SER_F_CONTEXT) && (readContext(elem.context) != OCSD_OK))
+        return OCSD_ERR_FILE_ERROR;
+    if (mask & OCSD_SER_F_TS)
+    {
+        if (getVarint(val) != OCSD_OK)
+            return OCSD_ERR_FILE_ERROR;
+        elem.timestamp += (uint64_t)zigzagDecode(val);
+    }
+    if (mask & OCSD_SER_F_CC)
+    {
+        if (getVarint(val) != OCSD_OK)
+            return OCSD_ERR_FILE_ERROR;
+        elem.cycle_count = (uint32_t)val;
+    }
+    if (mask & OCSD_SER_F_LAST_I)
+    {
+        if ((m_size - m_pos) < 2)
+            return OCSD_ERR_FILE_ERROR;
+        elem.last_i_type = (ocsd_instr_type)m_p_data[m_pos++];
+        elem.last_i_subtype = (ocsd_instr_subtype)m_p_data[m_pos++];
+    }
+    if (mask & OCSD_SER_F_FLAGS)
+    {
+        if (getVarint(val) != OCSD_OK)
+            return OCSD_ERR_FILE_ERROR;
+        elem.flag_bits = (uint32_t)val;
+    }
+    if (mask & OCSD_SER_F_PAYLOAD)
+    {
+        if (getVarint(val) != OCSD_OK)
+            return OCSD_ERR_FILE_ERROR;
+        setPayload(elem, val);
+    }
+    if (mask & OCSD_SER_F_EXT_DATA)
+    {
+        if ((getVarint(val) != OCSD_OK) || (val > (m_size - m_pos)))
+            return OCSD_ERR_FILE_ERROR;
+        elem.ptr_extended_data = m_p_data + m_pos;
+        m_pos += (size_t)val;
+    }
+
+    m_elem = &elem;
+    index_sop = m_prev_index;
+    trc_chan_id = m_prev_chan_id;
+    p_elem = &m_elem;
+    return OCSD_OK;
+}
+
+ocsd_datapath_resp_t TrcGenElemSerialReader::replay(ITrcGenElemIn *p_sink)
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+    const OcsdTraceElement *p_elem;
+    ocsd_trc_index_t index_sop;
+    uint8_t trc_chan_id;
+
+    while (OCSD_DATA_RESP_IS_CONT(resp) && !atEnd())
+    {
+        if (nextElem(index_sop, trc_chan_id, p_elem) != OCSD_OK)
+            return OCSD_RESP_FATAL_SYS_ERR;
+        if (p_elem)
+            resp = p_sink->TraceElemIn(index_sop, trc_chan_id, *p_elem);
+    }
+    return resp;
+}
+
+/* End of File trc_gen_elem_serial.cpp */
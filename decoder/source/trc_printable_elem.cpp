@@ -34,27 +34,67 @@
 
 #include "common/trc_printable_elem.h"
 #include <cassert>
-#include <cstring>
-#if defined(_MSC_VER) && (_MSC_VER < 1900)
- /** VS2010 does not support inttypes - remove when VS2010 support is dropped */
-#define __PRI64_PREFIX "ll"
-#define PRIX64 __PRI64_PREFIX "X"
-#define PRIu64 __PRI64_PREFIX "u"
-#define PRIu32 "u"
-#else
-#include <cinttypes>
-#endif
+
+static const char s_hex_lower[] = "0123456789abcdef";
+static const char s_hex_upper[] = "0123456789ABCDEF";
+
+void trcPrintBuffer::addHex(const uint64_t value, const int min_digits /* = 1 */, const bool upper /* = false */)
+{
+    const char *digits = upper ? s_hex_upper : s_hex_lower;
+    char szDigits[16];
+    int numDigits = 0;
+    uint64_t val = value;
+
+    do {
+        szDigits[numDigits++] = digits[val & 0xF];
+        val >>= 4;
+    } while(val);
+
+    addFill('0', min_digits - numDigits);
+    while(numDigits)
+        addChar(szDigits[--numDigits]);
+}
+
+void trcPrintBuffer::addDec(const uint64_t value)
+{
+    char szDigits[20];
+    int numDigits = 0;
+    uint64_t val = value;
+
+    do {
+        szDigits[numDigits++] = (char)('0' + (val % 10));
+        val /= 10;
+    } while(val);
+
+    while(numDigits)
+        addChar(szDigits[--numDigits]);
+}
+
+void trcPrintBuffer::addDecSigned(const int64_t value)
+{
+    if(value < 0)
+    {
+        addChar('-');
+        addDec(0 - (uint64_t)value);
+    }
+    else
+        addDec((uint64_t)value);
+}
 
 void trcPrintableElem::getValStr(std::string &valStr, const int valTotalBitSize, const int valValidBits, const uint64_t value, const bool asHex /* = true*/, const int updateBits /* = 0*/)
 {
-    static char szStrBuffer[128];
-    static char szFormatBuffer[32];
+    char szStrBuffer[128];
+    trcPrintBuffer valBuf(szStrBuffer, sizeof(szStrBuffer));
+    getValStr(valBuf, valTotalBitSize, valValidBits, value, asHex, updateBits);
+    valStr = szStrBuffer;
+}
 
+void trcPrintableElem::getValStr(trcPrintBuffer &valBuf, const int valTotalBitSize, const int valValidBits, const uint64_t value, const bool asHex /* = true*/, const int updateBits /* = 0*/)
+{
     assert((valTotalBitSize >= 4) && (valTotalBitSize <= 64));
 
-    uint64_t LimitMask = ~0ULL;
-    LimitMask >>= 64-valTotalBitSize;
-    valStr = "0x";
+    // values with 32 or fewer valid bits are printed from the lower 32 bits only
+    const uint64_t printVal = (valValidBits > 32) ? value : (uint32_t)value;
 
     if(asHex)
     {
@@ -63,58 +103,38 @@ void trcPrintableElem::getValStr(std::string &valStr, const int valTotalBitSize,
 
         int validChars = valValidBits / 4;
         if((valValidBits % 4) > 0) validChars++; 
-		if (validChars < numHexChars)
-		{
-			int QM = numHexChars - validChars;
-			while (QM)
-			{
-				QM--;
-				valStr += "?";
-			}
-		}
-        if(valValidBits > 32)
-        {
-            sprintf(szFormatBuffer,"%%0%dllX",validChars);  // create the format
-            sprintf(szStrBuffer,szFormatBuffer,value); // fill the buffer
-        }
-        else
-        {
-            sprintf(szFormatBuffer,"%%0%dlX",validChars);  // create the format
-            sprintf(szStrBuffer,szFormatBuffer,(uint32_t)value); // fill the buffer
-        }
-        valStr+=szStrBuffer;
+
+        valBuf.addStr("0x");
+        if (validChars < numHexChars)
+            valBuf.addFill('?', numHexChars - validChars);
+        valBuf.addHex(printVal, validChars, true);
+
         if(valValidBits < valTotalBitSize)
         {
-            sprintf(szStrBuffer," (%d:0)", valValidBits-1);
-            valStr+=szStrBuffer;
+            valBuf.addStr(" (");
+            valBuf.addDecSigned(valValidBits - 1);
+            valBuf.addStr(":0)");
         }
         
         if(updateBits)
         {
             uint64_t updateMask = ~0ULL;
             updateMask >>= 64-updateBits;
-            sprintf(szStrBuffer," ~[0x%" PRIX64 "]",value & updateMask);
-            valStr+=szStrBuffer;
+            valBuf.addStr(" ~[0x");
+            valBuf.addHex(value & updateMask, 1, true);
+            valBuf.addChar(']');
         }
     }
     else
     {
-        valStr = "";
         if(valValidBits < valTotalBitSize)
-            valStr += "??";
-        if(valValidBits > 32)
-        {
-            sprintf(szStrBuffer,"%" PRIu64 ,value);
-        }
-        else
-        {
-            sprintf(szStrBuffer,"%" PRIu32 ,(uint32_t)value);
-        }
-        valStr +=  szStrBuffer;
+            valBuf.addStr("??");
+        valBuf.addDec(printVal);
         if(valValidBits < valTotalBitSize)
         {
-            sprintf(szStrBuffer," (%d:0)", valValidBits-1);
-            valStr+=szStrBuffer;
+            valBuf.addStr(" (");
+            valBuf.addDecSigned(valValidBits - 1);
+            valBuf.addStr(":0)");
         }
     }
 }
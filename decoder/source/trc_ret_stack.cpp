@@ -106,6 +106,31 @@ void  TrcAddrReturnStack::flush()
     LOG_FLUSH();
 }
 
+void TrcAddrReturnStack::saveState(TrcStateWriter &wr) const
+{
+    wr.put(m_active);
+    wr.put(m_pop_pending);
+    wr.put(head_idx);
+    wr.put(num_entries);
+    wr.put(m_stack);
+}
+
+void TrcAddrReturnStack::restoreState(TrcStateReader &rd)
+{
+    rd.get(m_active);
+    rd.get(m_pop_pending);
+    rd.get(head_idx);
+    rd.get(num_entries);
+    rd.get(m_stack);
+
+    // indexes must be in range for the stack
+    if ((head_idx < 0) || (head_idx > 15) || (num_entries > 16))
+    {
+        rd.setInvalid();
+        flush();
+    }
+}
+
 #ifdef TRC_RET_STACK_DEBUG
 void TrcAddrReturnStack::LogOp(const char * pszOpString, ocsd_vaddr_t addr, int head_off, ocsd_isa isa)
 {
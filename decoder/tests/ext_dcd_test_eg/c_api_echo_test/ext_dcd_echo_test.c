@@ -78,6 +78,7 @@ static ocsd_datapath_resp_t send_gen_packet(echo_decoder_t *decoder);
 static ocsd_datapath_resp_t analyse_packet(echo_decoder_t *decoder);
 static ocsd_datapath_resp_t send_none_data_op(echo_decoder_t *decoder, const ocsd_datapath_op_t op);
 static void print_init_test_message(echo_decoder_t *decoder);
+static void test_trace_to_wp(echo_decoder_t *decoder);
 
 /******Infrastructure testing functionality *********************/
 /* As this is a test decoder we want to check which of the callbacks or call-ins are covered for a given test run 
@@ -93,6 +94,7 @@ enum {
     TEST_COV_PKTSINK_CB,
     TEST_COV_INDATA,
     TEST_COV_INCBFLAGS,
+    TEST_COV_TRACE_WP_CB,
     /**/
     TEST_COV_END
 };
@@ -225,6 +227,7 @@ ocsd_datapath_resp_t echo_dcd_process_data(echo_decoder_t *decoder,
             resp = send_gen_packet(decoder);
             decoder->state = DCD_WAIT_SYNC; /* wait for the first sync point */
             print_init_test_message(decoder);  /* because this is in fact a test decoder - print verification messages */
+            test_trace_to_wp(decoder);
             break;
 
         case DCD_WAIT_SYNC:
@@ -304,6 +307,84 @@ void print_init_test_message(echo_decoder_t * decoder)
         UPDATE_COVERAGE(TEST_COV_ERRORLOG_CB, TEST_RES_FAIL)
 }
 
+/* Number of waypoint walks to check from the test address */
+#define WP_TEST_WALKS 64
+
+/* Check the trace to waypoint callback against walking the same code one instruction at a time using the
+   memory access and instruction decode callbacks - the method used by a decoder without the callback.
+   Walks follow the code sequentially from the test address, not taking branches, until the end of the 
+   accessible memory or the number of test walks.
+*/
+void test_trace_to_wp(echo_decoder_t *decoder)
+{
+    ocsd_extern_dcd_cb_fns *p_fns = &(decoder->lib_fns);
+    const uint8_t cs_id = decoder->reg_config.cs_id;
+    ocsd_instr_info wp_info, addr_info, ref_info;
+    ocsd_wp_walk_res_t res;
+    ocsd_vaddr_t st_addr;
+    uint32_t num_instr, num_bytes;
+    ocsd_err_t err = OCSD_OK;
+    int walks = 0, pass = 1;
+    char msg[128];
+
+    /* memory access and instruction decode only available to a full decoder */
+    if (!decoder->reg_config.wp_test_addr || !(decoder->createFlags & OCSD_CREATE_FLG_FULL_DECODER))
+        return;
+
+    memset(&ref_info, 0, sizeof(ocsd_instr_info));
+    ref_info.pe_type.arch = ARCH_V8;
+    ref_info.pe_type.profile = profile_CortexA;
+    ref_info.isa = ocsd_isa_aarch64;
+    ref_info.instr_addr = decoder->reg_config.wp_test_addr;
+    memcpy(&wp_info, &ref_info, sizeof(ocsd_instr_info));
+
+    while (pass && (walks < WP_TEST_WALKS))
+    {
+        /* reference walk */
+        st_addr = ref_info.instr_addr;
+        num_instr = 0;
+        do {
+            num_bytes = 4;
+            err = lib_cb_MemAccess(p_fns, ref_info.instr_addr, cs_id, OCSD_MEM_SPACE_ANY, &num_bytes, (uint8_t *)&ref_info.opcode);
+            if ((err == OCSD_OK) && (num_bytes != 4))
+                err = OCSD_ERR_MEM_NACC;
+            if (err == OCSD_OK)
+                err = lib_cb_DecodeArmInst(p_fns, &ref_info);
+            if (err == OCSD_OK)
+            {
+                ref_info.instr_addr += ref_info.instr_size;
+                num_instr++;
+            }
+        } while ((err == OCSD_OK) && (ref_info.type == OCSD_INSTR_OTHER));
+        
+        /* end of the accessible code */
+        if (err != OCSD_OK)
+            break;
+
+        /* same walk in a single callback */
+        err = lib_cb_TraceToWaypoint(p_fns, cs_id, OCSD_MEM_SPACE_ANY, OCSD_WP_WALK_TO_WP, 0, &wp_info, &res);
+        if ((err != OCSD_OK) || !res.wp_found || (res.st_addr != st_addr) || (res.en_addr != ref_info.instr_addr) ||
+            (res.num_instr != num_instr) || (wp_info.instr_addr != ref_info.instr_addr) || (wp_info.type != ref_info.type) ||
+            (wp_info.sub_type != ref_info.sub_type) || ((ref_info.type == OCSD_INSTR_BR) && (wp_info.branch_addr != ref_info.branch_addr)))
+            pass = 0;
+
+        /* walk the range again to the end address */
+        memcpy(&addr_info, &ref_info, sizeof(ocsd_instr_info));
+        addr_info.instr_addr = st_addr;
+        err = lib_cb_TraceToWaypoint(p_fns, cs_id, OCSD_MEM_SPACE_ANY, OCSD_WP_WALK_TO_ADDR, ref_info.instr_addr, &addr_info, &res);
+        if ((err != OCSD_OK) || !res.wp_found || (res.en_addr != ref_info.instr_addr) || (res.num_instr != num_instr))
+            pass = 0;
+
+        walks++;
+    }
+
+    if (!walks)
+        pass = 0;
+    UPDATE_COVERAGE(TEST_COV_TRACE_WP_CB, (pass ? TEST_RES_OK : TEST_RES_FAIL))
+    sprintf(msg, "Echo_Test_Decoder: Trace to waypoint CB test - %d walks checked from 0x%" PRIX64 ".\n", walks, (uint64_t)decoder->reg_config.wp_test_addr);
+    lib_cb_LogMsg(p_fns, OCSD_ERR_SEV_ERROR, msg);
+}
+
 void print_test_cov_results(echo_decoder_t *decoder)
 {
     int i;
@@ -320,7 +401,8 @@ void print_test_cov_results(echo_decoder_t *decoder)
         "PKTMON_CB",
         "PKTSINK_CB",
         "INDATA",
-        "INCBFLAGS"
+        "INCBFLAGS",
+        "TRACE_WP_CB"
     };
     char coverage_message[256];
 
@@ -50,6 +50,7 @@
 
 typedef struct _echo_dcd_cfg {
     unsigned char cs_id;
+    ocsd_vaddr_t wp_test_addr;  /** AArch64 code address to test the trace to waypoint callback from - 0 to skip test */
 } echo_dcd_cfg_t;
 
 typedef struct _echo_dcd_pkt {
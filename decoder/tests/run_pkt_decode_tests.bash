@@ -87,3 +87,17 @@ ${BIN_DIR}/c_api_pkt_print_test -ss_path ${SNAPSHOT_DIR} -decode > /dev/null
 echo "Done : Return $?"
 echo "moving result file."
 mv ./c_api_test.log ./${OUT_DIR}/c_api_test.ppl
+
+# === test ETMv4 bulk atom mode - generic elements and indices must match the standard decode ===
+declare -a test_dirs_bulk_atoms=( "juno-ret-stck"
+                                  "juno_r1_1"
+                                )
+
+for test_dir in "${test_dirs_bulk_atoms[@]}"
+do
+    echo "Testing $test_dir bulk atoms..."
+    ${BIN_DIR}/trc_pkt_lister -ss_dir "${SNAPSHOT_DIR}/$test_dir" -decode_only -logfilename "${OUT_DIR}/$test_dir-elem.ppl"
+    ${BIN_DIR}/trc_pkt_lister -ss_dir "${SNAPSHOT_DIR}/$test_dir" -decode_only -bulk_atoms -logfilename "${OUT_DIR}/$test_dir-bulk_atoms.ppl"
+    diff -q <(grep "^Idx:" "${OUT_DIR}/$test_dir-elem.ppl") <(grep "^Idx:" "${OUT_DIR}/$test_dir-bulk_atoms.ppl") > /dev/null
+    echo "Done : Compare $?"
+done
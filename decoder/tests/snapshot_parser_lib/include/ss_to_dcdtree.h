@@ -36,6 +36,7 @@
 #define ARM_SS_TO_DCDTREE_H_INCLUDED
 
 #include <string>
+#include <set>
 
 #include "opencsd.h"
 #include "snapshot_parser.h"
@@ -54,12 +55,23 @@ public:
 
     bool createDecodeTree(const std::string &SourceBufferName, bool bPacketProcOnly);
     void destroyDecodeTree();
+
+    // apply the decoder configurations and memory images for the buffer to an existing tree, 
+    // with decoders for the same trace sources. Tree remains owned by the caller.
+    bool reconfigureDecodeTree(DecodeTree *pTree, const std::string &SourceBufferName);
     DecodeTree *getDecodeTree() const { return m_pDecodeTree; };
+    DecodeTree *releaseDecodeTree();    // caller takes ownership of the tree.
     const char *getBufferFileName() const { return m_BufferFileName.c_str(); };
 
+    // map dump files that are ELF files with the ELF accessor - executable segments only.
+    void setElfMemAcc(const bool bElfMemAcc) { m_bElfMemAcc = bElfMemAcc; };
+
     // TBD: add in filters for ID list, first ID found.
 
 private:
+    // create the decoder on the tree, or reconfigure the existing decoder.
+    ocsd_err_t applyDecoderConfig(const char *decoderName, const CSConfig *pConfig);
+
     // create a decoder related to a core source (ETM, PTM)
     bool createPEDecoder(const std::string &coreName, Parser::Parsed *devSrc);
     // protocol specific core source decoders
@@ -100,8 +112,13 @@ private:
     ocsd_hndl_err_log_t m_errlog_handle;
 
     bool m_bPacketProcOnly;
+    bool m_bReconfigure;    // applying configuration to an existing tree.
     std::string m_BufferFileName;
 
+    bool m_bElfMemAcc;
+    std::set<std::string> m_ElfFiles;   // ELF files mapped in the current tree.
+    std::set<std::string> m_BinFiles;   // binary dump files mapped in the current tree.
+
     CoreArchProfileMap m_arch_profiles;
 };
 
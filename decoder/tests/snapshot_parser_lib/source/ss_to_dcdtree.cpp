@@ -42,7 +42,9 @@ CreateDcdTreeFromSnapShot::CreateDcdTreeFromSnapShot() :
     m_pReader(0),
     m_pErrLogInterface(0),    
     m_bPacketProcOnly(false),
-    m_BufferFileName("")
+    m_bReconfigure(false),
+    m_BufferFileName(""),
+    m_bElfMemAcc(false)
 {
     m_errlog_handle = 0;
 }
@@ -89,21 +91,39 @@ bool CreateDcdTreeFromSnapShot::createDecodeTree(const std::string &SourceName,
             if (tree.buffer_info.dataFormat == "dstream_coresight")
                 formatter_flags = OCSD_DFRMTR_HAS_FSYNCS;
 
-            /* create the initial device tree */
-            // TBD:     handle syncs / hsyncs data from TPIU
-            m_pDecodeTree = DecodeTree::CreateDecodeTree(src_format, formatter_flags);
-            if(m_pDecodeTree == 0)
+            if(m_bReconfigure)
             {
-                LogError("Failed to create decode tree object\n");
-                return false;
+                // existing tree must match the buffer format - memory images replaced.
+                if((m_pDecodeTree->getFrameDeformatter() != 0) != (src_format == OCSD_TRC_SRC_FRAME_FORMATTED))
+                {
+                    LogError("Decode tree format does not match buffer format\n");
+                    return false;
+                }
+                if(!bPacketProcOnly)
+                    m_pDecodeTree->getMemAccMapper()->RemoveAllAccessors();
             }
+            else
+            {
+                /* create the initial device tree */
+                // TBD:     handle syncs / hsyncs data from TPIU
+                m_pDecodeTree = DecodeTree::CreateDecodeTree(src_format, formatter_flags);
+                if(m_pDecodeTree == 0)
+                {
+                    LogError("Failed to create decode tree object\n");
+                    return false;
+                }
+
+                // use our error logger - don't use the tree default.
+                m_pDecodeTree->setAlternateErrorLogger(m_pErrLogInterface);
 
-            // use our error logger - don't use the tree default.
-            m_pDecodeTree->setAlternateErrorLogger(m_pErrLogInterface);
+                if(!bPacketProcOnly)
+                    m_pDecodeTree->createMemAccMapper();
+            }
 
             if(!bPacketProcOnly)
             {
-                m_pDecodeTree->createMemAccMapper();
+                m_ElfFiles.clear();
+                m_BinFiles.clear();
             }
 
             /* run through each protocol source to this buffer... */
@@ -178,6 +198,8 @@ bool CreateDcdTreeFromSnapShot::createDecodeTree(const std::string &SourceName,
             if(numDecodersCreated == 0)
             {
                 // nothing useful found 
+                if(m_bReconfigure)
+                    return false;
                 destroyDecodeTree();
             }
         }
@@ -191,6 +213,29 @@ bool CreateDcdTreeFromSnapShot::createDecodeTree(const std::string &SourceName,
     return (bool)(m_pDecodeTree != 0);
 }
 
+DecodeTree *CreateDcdTreeFromSnapShot::releaseDecodeTree()
+{
+    DecodeTree *pTree = m_pDecodeTree;
+    m_pDecodeTree = 0;
+    return pTree;
+}
+
+bool CreateDcdTreeFromSnapShot::reconfigureDecodeTree(DecodeTree *pTree, const std::string &SourceName)
+{
+    bool bReconfigOK = false;
+
+    // cannot use while this object owns a tree.
+    if(m_bInit && pTree && !m_pDecodeTree)
+    {
+        m_pDecodeTree = pTree;
+        m_bReconfigure = true;
+        bReconfigOK = createDecodeTree(SourceName, !pTree->hasMemAccMapper());
+        m_bReconfigure = false;
+        m_pDecodeTree = 0;
+    }
+    return bReconfigOK;
+}
+
 void CreateDcdTreeFromSnapShot::destroyDecodeTree()
 {
     if(m_pDecodeTree)
@@ -213,6 +258,13 @@ void CreateDcdTreeFromSnapShot::LogError(const ocsdError &err)
     m_pErrLogInterface->LogError(m_errlog_handle,&err);
 }
 
+ocsd_err_t CreateDcdTreeFromSnapShot::applyDecoderConfig(const char *decoderName, const CSConfig *pConfig)
+{
+    if(m_bReconfigure)
+        return m_pDecodeTree->reconfigureDecoder(pConfig);
+    return m_pDecodeTree->createDecoder(decoderName, m_bPacketProcOnly ? OCSD_CREATE_FLG_PACKET_PROC : OCSD_CREATE_FLG_FULL_DECODER, pConfig);
+}
+
 bool CreateDcdTreeFromSnapShot::createPEDecoder(const std::string &coreName, Parser::Parsed *devSrc)
 {
     bool bCreatedDecoder = false;
@@ -277,7 +329,7 @@ bool CreateDcdTreeFromSnapShot::createETMv4Decoder(const std::string &coreName,
         EtmV4Config configObj(&config);
         const char *decoderName = bDataChannel ? OCSD_BUILTIN_DCD_ETMV4D : OCSD_BUILTIN_DCD_ETMV4I;
 
-        err = m_pDecodeTree->createDecoder(decoderName, m_bPacketProcOnly ? OCSD_CREATE_FLG_PACKET_PROC : OCSD_CREATE_FLG_FULL_DECODER,&configObj);
+        err = applyDecoderConfig(decoderName, &configObj);
         
         if(err ==  OCSD_OK)
             createdDecoder = true;
@@ -319,7 +371,7 @@ bool CreateDcdTreeFromSnapShot::createETMv3Decoder(const std::string &coreName,
     {
         EtmV3Config config(&cfg_regs);
         ocsd_err_t err = OCSD_OK;
-        err = m_pDecodeTree->createDecoder(OCSD_BUILTIN_DCD_ETMV3, m_bPacketProcOnly ? OCSD_CREATE_FLG_PACKET_PROC : OCSD_CREATE_FLG_FULL_DECODER,&config);
+        err = applyDecoderConfig(OCSD_BUILTIN_DCD_ETMV3, &config);
 
         if(err ==  OCSD_OK)
             createdDecoder = true;
@@ -357,7 +409,7 @@ bool CreateDcdTreeFromSnapShot::createPTMDecoder(const std::string &coreName, Pa
     {
         PtmConfig configObj(&config);
         ocsd_err_t err = OCSD_OK;
-        err = m_pDecodeTree->createDecoder(OCSD_BUILTIN_DCD_PTM, m_bPacketProcOnly ? OCSD_CREATE_FLG_PACKET_PROC : OCSD_CREATE_FLG_FULL_DECODER,&configObj);
+        err = applyDecoderConfig(OCSD_BUILTIN_DCD_PTM, &configObj);
 
         if(err ==  OCSD_OK)
             createdDecoder = true;
@@ -404,7 +456,7 @@ bool CreateDcdTreeFromSnapShot::createSTMDecoder(Parser::Parsed *devSrc)
         ocsd_err_t err = OCSD_OK;
         STMConfig configObj(&config);
 
-        err = m_pDecodeTree->createDecoder(OCSD_BUILTIN_DCD_STM, m_bPacketProcOnly ? OCSD_CREATE_FLG_PACKET_PROC : OCSD_CREATE_FLG_FULL_DECODER,&configObj);
+        err = applyDecoderConfig(OCSD_BUILTIN_DCD_STM, &configObj);
 
         if(err ==  OCSD_OK)
             createdDecoder = true;
@@ -518,10 +570,34 @@ void CreateDcdTreeFromSnapShot::processDumpfiles(std::vector<Parser::DumpDef> &d
         region.file_offset = it->offset;
         region.region_size = it->length;
 
+        // an ELF accessor maps all the executable segments of the file - the bias is set from the first dump.
+        if(m_bElfMemAcc && TrcMemAccElf::isElfFile(dumpFilePathName))
+        {
+            ocsd_vaddr_t load_bias;
+            if(m_ElfFiles.find(dumpFilePathName) != m_ElfFiles.end())
+            {
+                it++;
+                continue;
+            }
+            if((TrcMemAccElf::getLoadBias(dumpFilePathName, it->address, it->offset, load_bias) == OCSD_OK) &&
+               (m_pDecodeTree->addElfFileMemAcc(dumpFilePathName, load_bias, OCSD_MEM_SPACE_ANY) == OCSD_OK))
+            {
+                m_ElfFiles.insert(dumpFilePathName);
+                it++;
+                continue;
+            }
+            // otherwise map the dump as a binary file.
+        }
+
         // ensure we respect optional length and offset parameter and
-        // allow multiple dump entries with same file name to define regions
-        if (!TrcMemAccessorFile::isExistingFileAccessor(dumpFilePathName))
+        // allow multiple dump entries with same file name to define regions.
+        // file accessors are shared between trees - first dump of a file attaches it to this tree.
+        if (m_BinFiles.find(dumpFilePathName) == m_BinFiles.end())
+        {
             err = m_pDecodeTree->addBinFileRegionMemAcc(&region, 1, OCSD_MEM_SPACE_ANY, dumpFilePathName);
+            if (err == OCSD_OK)
+                m_BinFiles.insert(dumpFilePathName);
+        }
         else
             err = m_pDecodeTree->updateBinFileRegionMemAcc(&region, 1, OCSD_MEM_SPACE_ANY, dumpFilePathName);
         if(err != OCSD_OK)
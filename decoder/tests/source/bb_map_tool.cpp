@@ -0,0 +1,333 @@
+/*
+ * \file       bb_map_tool.cpp
+ * \brief      OpenCSD : Build basic block map sidecar files for code images.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+/* Disassembles the executable regions of a code image once, and saves a sidecar file of 
+ * basic block maps for the decode tree to attach to the memory accessors for the image.
+ *
+ * Input is either the executable segments of an ELF file, or a region of a binary file.
+ * Maps are built at the address the image is decoded at - the ELF link address plus -bias, 
+ * or the -addr of the binary region - so the map file may be attached with no load bias.
+ *
+ * -verify reloads the saved file, and checks each map lookup against an instruction walk 
+ * of the image, as a PE decoder would run, at the mapped and a relocated address.
+ *
+ * Usage: bb_map_tool (-elf <file> [-bias <addr>] | -bin <file> -addr <addr> [-offset <n>] [-size <n>])
+ *                    [-isa a64|a32|t32] [-arch v7|v8|v8r3] [-dsb_dmb] [-wfi_wfe] [-threads <n>] 
+ *                    [-o <mapfile>] [-verify]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "opencsd.h"
+
+static void print_usage()
+{
+    printf("Usage: bb_map_tool (-elf <file> [-bias <addr>] | -bin <file> -addr <addr> [-offset <n>] [-size <n>])\n");
+    printf("                   [-isa a64|a32|t32] [-arch v7|v8|v8r3] [-dsb_dmb] [-wfi_wfe] [-threads <n>]\n");
+    printf("                   [-o <mapfile>] [-verify]\n");
+}
+
+/* image region to map */
+typedef struct img_region {
+    ocsd_vaddr_t address;
+    std::vector<uint8_t> data;
+} img_region_t;
+
+static ocsd_err_t read_elf_regions(const std::string &path, const ocsd_vaddr_t bias, std::vector<img_region_t> &regions)
+{
+    TrcMemAccessorBase *p_acc = 0;
+    std::vector<TrcMemAccessorBase::addr_range_t> ranges;
+
+    ocsd_err_t err = TrcMemAccFactory::CreateElfAccessor(&p_acc, path, bias);
+    if (err != OCSD_OK)
+        return err;
+
+    p_acc->getAddrRanges(ranges);
+    for (size_t i = 0; (i < ranges.size()) && (err == OCSD_OK); i++)
+    {
+        img_region_t region;
+        uint32_t size = (uint32_t)(ranges[i].second - ranges[i].first + 1);
+        region.address = ranges[i].first;
+        region.data.resize(size);
+        if (p_acc->readBytes(region.address, OCSD_MEM_SPACE_ANY, 0, size, region.data.data()) != size)
+            err = OCSD_ERR_FILE_ERROR;
+        else
+            regions.push_back(region);
+    }
+    TrcMemAccFactory::DestroyAccessor(p_acc);
+    return err;
+}
+
+static ocsd_err_t read_bin_region(const std::string &path, const ocsd_vaddr_t address, const size_t offset, const size_t size, std::vector<img_region_t> &regions)
+{
+    TrcMemImagePtr image;
+    ocsd_err_t err = TrcMemImage::createFromFile(path, path, address, offset, size, image);
+    if (err == OCSD_OK)
+    {
+        img_region_t region;
+        region.address = address;
+        region.data.assign(image->getData(), image->getData() + image->getSize());
+        regions.push_back(region);
+    }
+    return err;
+}
+
+/* walk from an address to the next waypoint as the PE decoders do - span scan then decode. */
+static bool walk_to_wp(TrcIDecode &idecode, const img_region_t &region, const ocsd_vaddr_t base, ocsd_instr_info &info, uint32_t &num_instr)
+{
+    num_instr = 0;
+    while (true)
+    {
+        const uint32_t offset = (uint32_t)(info.instr_addr - base);
+        if (region.data.size() - offset < 4)
+            return false;   // not accessible - no waypoint.
+
+        uint32_t span_bytes = (uint32_t)(region.data.size() - offset);
+        if (span_bytes > OCSD_DCD_WP_SCAN_BYTES)
+            span_bytes = OCSD_DCD_WP_SCAN_BYTES;
+        const uint8_t *span = &region.data[offset];
+
+        uint32_t num_skipped = 0;
+        idecode.FindNextWaypoint(&info, span, span_bytes, &num_skipped);
+        num_instr += num_skipped;
+
+        // next opcode not in the span - read again from the current address
+        const uint32_t span_offset = (uint32_t)(info.instr_addr - base) - offset;
+        if (span_offset + 4 > span_bytes)
+            continue;
+
+        memcpy(&info.opcode, span + span_offset, sizeof(uint32_t));
+        idecode.DecodeInstruction(&info);
+        info.instr_addr += info.instr_size;
+        num_instr++;
+        if (info.type != OCSD_INSTR_OTHER)
+            return true;
+    }
+}
+
+/* check map lookups against the walk for every A64 / A32 instruction, or every T32 block start */
+static int verify_map(const TrcBBMap &map, const img_region_t &region, const ocsd_vaddr_t base, const ocsd_instr_info &cfg)
+{
+    TrcIDecode idecode;
+    int errors = 0;
+    const uint32_t step = (cfg.isa == ocsd_isa_thumb2) ? 2 : 4;
+
+    for (uint32_t offset = 0; (offset < region.data.size()) && (errors < 10); offset += step)
+    {
+        ocsd_instr_info map_info = cfg, walk_info = cfg;
+        uint32_t map_num = 0, walk_num = 0;
+        
+        map_info.instr_addr = walk_info.instr_addr = base + offset;
+        bool map_found = map.lookup(base, &map_info, &map_num);
+        if (!map_found && (cfg.isa == ocsd_isa_thumb2))
+            continue;   // not a block start.
+        bool walk_found = walk_to_wp(idecode, region, base, walk_info, walk_num);
+
+        bool match = (map_found == walk_found);
+        if (match && map_found)
+        {
+            match = (map_num == walk_num) &&
+                    (map_info.instr_addr == walk_info.instr_addr) &&
+                    (map_info.type == walk_info.type) &&
+                    (map_info.sub_type == walk_info.sub_type) &&
+                    (map_info.instr_size == walk_info.instr_size) &&
+                    (map_info.next_isa == walk_info.next_isa) &&
+                    (map_info.is_link == walk_info.is_link) &&
+                    (map_info.is_conditional == walk_info.is_conditional) &&
+                    ((map_info.type != OCSD_INSTR_BR) || (map_info.branch_addr == walk_info.branch_addr));
+        }
+        if (!match)
+        {
+            printf("BB map tool: ERROR : lookup mismatch at 0x%llx (map %d, %u instr; walk %d, %u instr)\n", 
+                (unsigned long long)(base + offset), map_found, map_num, walk_found, walk_num);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string elf_path = "", bin_path = "", map_path = "";
+    ocsd_vaddr_t bias = 0, address = 0;
+    size_t offset = 0, size = 0;
+    int num_threads = 0;
+    bool verify = false, addr_set = false;
+    ocsd_instr_info cfg;
+
+    memset(&cfg, 0, sizeof(ocsd_instr_info));
+    cfg.isa = ocsd_isa_aarch64;
+    cfg.pe_type.arch = ARCH_V8;
+    cfg.pe_type.profile = profile_CortexA;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-elf") && (i + 1 < argc))
+            elf_path = argv[++i];
+        else if (!strcmp(argv[i], "-bias") && (i + 1 < argc))
+            bias = (ocsd_vaddr_t)strtoull(argv[++i], 0, 0);
+        else if (!strcmp(argv[i], "-bin") && (i + 1 < argc))
+            bin_path = argv[++i];
+        else if (!strcmp(argv[i], "-addr") && (i + 1 < argc))
+        {
+            address = (ocsd_vaddr_t)strtoull(argv[++i], 0, 0);
+            addr_set = true;
+        }
+        else if (!strcmp(argv[i], "-offset") && (i + 1 < argc))
+            offset = (size_t)strtoull(argv[++i], 0, 0);
+        else if (!strcmp(argv[i], "-size") && (i + 1 < argc))
+            size = (size_t)strtoull(argv[++i], 0, 0);
+        else if (!strcmp(argv[i], "-isa") && (i + 1 < argc))
+        {
+            i++;
+            if (!strcmp(argv[i], "a64"))
+                cfg.isa = ocsd_isa_aarch64;
+            else if (!strcmp(argv[i], "a32"))
+                cfg.isa = ocsd_isa_arm;
+            else if (!strcmp(argv[i], "t32"))
+                cfg.isa = ocsd_isa_thumb2;
+            else
+            {
+                print_usage();
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-arch") && (i + 1 < argc))
+        {
+            i++;
+            if (!strcmp(argv[i], "v7"))
+                cfg.pe_type.arch = ARCH_V7;
+            else if (!strcmp(argv[i], "v8"))
+                cfg.pe_type.arch = ARCH_V8;
+            else if (!strcmp(argv[i], "v8r3"))
+                cfg.pe_type.arch = ARCH_V8r3;
+            else
+            {
+                print_usage();
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-dsb_dmb"))
+            cfg.dsb_dmb_waypoints = 1;
+        else if (!strcmp(argv[i], "-wfi_wfe"))
+            cfg.wfi_wfe_branch = 1;
+        else if (!strcmp(argv[i], "-threads") && (i + 1 < argc))
+            num_threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && (i + 1 < argc))
+            map_path = argv[++i];
+        else if (!strcmp(argv[i], "-verify"))
+            verify = true;
+        else
+        {
+            print_usage();
+            return 1;
+        }
+    }
+    if ((elf_path.size() == 0) == (bin_path.size() == 0) || (bin_path.size() && !addr_set))
+    {
+        print_usage();
+        return 1;
+    }
+    if (!map_path.size())
+        map_path = (elf_path.size() ? elf_path : bin_path) + ".bbmap";
+
+    std::vector<img_region_t> regions;
+    ocsd_err_t err;
+    if (elf_path.size())
+        err = read_elf_regions(elf_path, bias, regions);
+    else
+        err = read_bin_region(bin_path, address, offset, size, regions);
+    if (err != OCSD_OK)
+    {
+        printf("BB map tool: ERROR : failed to read image (%s)\n", ocsdError::getErrorString(ocsdError(OCSD_ERR_SEV_ERROR, err)).c_str());
+        return 1;
+    }
+
+    // build the maps.
+    std::vector<TrcBBMapPtr> maps;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; (i < regions.size()) && (err == OCSD_OK); i++)
+    {
+        TrcBBMapPtr map;
+        err = TrcBBMap::build(regions[i].data.data(), (uint32_t)regions[i].data.size(), regions[i].address, cfg, num_threads, map);
+        if (err == OCSD_OK)
+            maps.push_back(map);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    if (err == OCSD_OK)
+        err = TrcBBMap::saveFile(map_path, maps);
+    if (err != OCSD_OK)
+    {
+        printf("BB map tool: ERROR : failed to build map file %s (%s)\n", map_path.c_str(), ocsdError::getErrorString(ocsdError(OCSD_ERR_SEV_ERROR, err)).c_str());
+        return 1;
+    }
+
+    for (size_t i = 0; i < maps.size(); i++)
+    {
+        std::string mapStr;
+        maps[i]->getMapString(mapStr);
+        printf("%s\n", mapStr.c_str());
+    }
+    printf("BB map tool: %s : %u maps built in %.2f ms\n", map_path.c_str(), (uint32_t)maps.size(), elapsed.count());
+
+    if (verify)
+    {
+        std::vector<TrcBBMapPtr> loaded;
+        int errors = 0;
+
+        err = TrcBBMap::loadFile(map_path, loaded);
+        if ((err != OCSD_OK) || (loaded.size() != regions.size()))
+        {
+            printf("BB map tool: ERROR : failed to reload map file %s\n", map_path.c_str());
+            errors++;
+        }
+        for (size_t i = 0; (i < loaded.size()) && !errors; i++)
+        {
+            // branch destinations must follow the map when attached at another address.
+            errors += verify_map(*loaded[i], regions[i], regions[i].address, cfg);
+            errors += verify_map(*loaded[i], regions[i], regions[i].address + 0x100000, cfg);
+        }
+        printf("BB map tool: verify %s\n", errors ? "FAILED" : "PASSED");
+        return errors ? 1 : 0;
+    }
+    return 0;
+}
+
+/* End of File bb_map_tool.cpp */
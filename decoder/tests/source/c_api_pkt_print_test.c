@@ -86,6 +86,7 @@ const ocsd_vaddr_t mem_dump_address_tc2=0xC0008000;
 static int using_mem_acc_cb = 0;    /* test the memory access callback function */
 static int use_region_file = 0;     /* test multi region memory files */
 static int using_mem_acc_cb_id = 0; /* test the mem acc callback with trace ID parameter */
+static int use_mem_image = 0;       /* test the shared memory image registry */
 
 /* buffer to handle a packet string */
 #define PACKET_STR_LEN 1024
@@ -116,6 +117,12 @@ static int test_printstr = 0;
 /* test the library printer API */
 static int test_lib_printers = 0;
 
+/* test the batched packet callback API - packets per batch, 0 for per packet callback */
+static uint32_t test_pkt_batch = 0;
+
+/* test the decoder reconfigure API - create with a different config then reconfigure (ETMv4 only) */
+static int test_reconfig = 0;
+
 /* Process command line options - choose the operation to use for the test. */
 static int process_cmd_line(int argc, char *argv[])
 {
@@ -174,6 +181,12 @@ static int process_cmd_line(int argc, char *argv[])
             use_region_file = 1;
             using_mem_acc_cb = 0;
         }
+        else if(strcmp(argv[idx],"-test_mem_image") == 0)
+        {
+            use_mem_image = 1;
+            use_region_file = 0;
+            using_mem_acc_cb = 0;
+        }
         else if (strcmp(argv[idx], "-extern") == 0)
         {
             test_extern_decoder = 1;
@@ -194,6 +207,21 @@ static int process_cmd_line(int argc, char *argv[])
         {
             test_lib_printers = 1;
         }
+        else if (strcmp(argv[idx], "-test_pkt_batch") == 0)
+        {
+            idx++;
+            if (idx < argc)
+                test_pkt_batch = (uint32_t)strtoul(argv[idx], 0, 0);
+            if (test_pkt_batch == 0)
+            {
+                printf("-test_pkt_batch: Missing or zero batch size\n");
+                return -1;
+            }
+        }
+        else if (strcmp(argv[idx], "-test_reconfig") == 0)
+        {
+            test_reconfig = 1;
+        }
         else if(strcmp(argv[idx],"-ss_path") == 0)
         {
             idx++;
@@ -232,7 +260,10 @@ static void print_cmd_line_help()
     printf("-decode | -decode_only : full decode + trace packets / full decode packets only (default trace packets only)\n");
     printf("-raw / -raw_packed: print raw unpacked / packed data;\n");
     printf("-test_printstr | -test_libprint : ttest lib printstr callback | test lib based packet printers\n");
-    printf("-test_region_file | -test_cb | -test_cb_id : mem accessor - test multi region file API | test callback API [with trcid] (default single memory file)\n\n");
+    printf("-test_region_file | -test_cb | -test_cb_id : mem accessor - test multi region file API | test callback API [with trcid] (default single memory file)\n");
+    printf("-test_mem_image : mem accessor - test shared memory image registry API\n");
+    printf("-test_pkt_batch <N> : packet print using the batched packet callback API, N packets per batch\n");
+    printf("-test_reconfig : create etmv4 decoder with return stack enabled, then reconfigure with the snapshot config\n\n");
     printf("-ss_path <path> : path from cwd to /snapshots/ directory. Test prog will append required test subdir\n");
 }
 
@@ -400,6 +431,15 @@ static ocsd_err_t create_test_memory_acc(dcd_tree_handle_t handle)
         else 
             ret  = OCSD_ERR_MEM_ACC_FILE_NOT_FOUND;
     }
+    /* shared memory image - publish, add to tree, then withdraw - tree keeps its reference to the image */
+    else if(use_mem_image)
+    {
+        ret = ocsd_publish_mem_image_file("kernel_dump", mem_dump_address, mem_file_path, 0, 0);
+        if(ret == OCSD_OK)
+            ret = ocsd_dt_add_mem_image_acc(handle, "kernel_dump", OCSD_MEM_SPACE_ANY);
+        if(ret == OCSD_OK)
+            ret = ocsd_withdraw_mem_image("kernel_dump");
+    }
     /* create a memory file accessor - simple contiguous full binary file */
     else
     {        
@@ -457,6 +497,35 @@ ocsd_datapath_resp_t packet_handler(void *context, const ocsd_datapath_op_t op,
     return resp;
 }
 
+/* 
+* Callback function to process batches of packets from the packet processor output stream - 
+* print each packet in turn using the single packet handler.
+*/
+ocsd_datapath_resp_t packet_batch_handler(const void *context, const ocsd_datapath_op_t op, const uint32_t num_pkts, const ocsd_trc_index_t *p_indexes, const void *p_packets)
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+    const uint8_t *p_pkt = (const uint8_t *)p_packets;
+    size_t pkt_size = 0;
+    uint32_t i;
+
+    if (op != OCSD_OP_DATA)
+        return packet_handler((void *)context, op, 0, 0);
+
+    /* packet structures in the batch are the C-API structure for the protocol */
+    switch (test_protocol)
+    {
+    case OCSD_PROTOCOL_ETMV4I: pkt_size = sizeof(ocsd_etmv4_i_pkt); break;
+    case OCSD_PROTOCOL_ETMV3: pkt_size = sizeof(ocsd_etmv3_pkt); break;
+    case OCSD_PROTOCOL_PTM: pkt_size = sizeof(ocsd_ptm_pkt); break;
+    case OCSD_PROTOCOL_STM: pkt_size = sizeof(ocsd_stm_pkt); break;
+    default: return OCSD_RESP_FATAL_INVALID_PARAM;
+    }
+
+    for (i = 0; (i < num_pkts) && OCSD_DATA_RESP_IS_CONT(resp); i++)
+        resp = packet_handler((void *)context, OCSD_OP_DATA, p_indexes[i], p_pkt + (i * pkt_size));
+    return resp;
+}
+
 /* print an array of hex data - used by the packet monitor to print hex data from packet.*/
 static int print_data_array(const uint8_t *p_array, const int array_size, char *p_buffer, int buf_size)
 {
@@ -583,6 +652,8 @@ static ocsd_err_t create_generic_decoder(dcd_tree_handle_t handle, const char *p
             /* Attach the packet handler to the output of the packet processor - referenced by CSID */
             if (test_lib_printers)
                 ret = ocsd_dt_set_pkt_protocol_printer(handle, CSID, 0);
+            else if (test_pkt_batch)
+                ret = ocsd_dt_attach_packet_batch_callback(handle, CSID, test_pkt_batch, packet_batch_handler, p_context);
             else
                 ret = ocsd_dt_attach_packet_callback(handle,CSID, OCSD_C_API_CB_PKT_SINK,&packet_handler,p_context);
             if(ret != OCSD_OK)
@@ -652,6 +723,20 @@ static ocsd_err_t create_decoder_etmv4(dcd_tree_handle_t dcd_tree_h)
     trace_config.reg_idr12  = 0x0;
     trace_config.reg_idr13  = 0x0;
 
+    if(test_reconfig)
+    {
+        /* create with the return stack enabled, then reconfigure the existing decoder - output must match the normal run. */
+        ocsd_err_t err;
+        uint32_t reg_configr = trace_config.reg_configr;
+
+        trace_config.reg_configr |= 0x1000; /* RS bit */
+        err = create_generic_decoder(dcd_tree_h,OCSD_BUILTIN_DCD_ETMV4I,(void *)&trace_config,0);
+        trace_config.reg_configr = reg_configr;
+        if(err == OCSD_OK)
+            err = ocsd_dt_reconfig_decoder(dcd_tree_h,OCSD_BUILTIN_DCD_ETMV4I,(void *)&trace_config);
+        return err;
+    }
+
     /* create an ETMV4 decoder - no context needed as we have a single stream to a single handler. */
     return create_generic_decoder(dcd_tree_h,OCSD_BUILTIN_DCD_ETMV4I,(void *)&trace_config,0);
 }
@@ -743,6 +828,7 @@ static ocsd_err_t create_decoder_extern(dcd_tree_handle_t dcd_tree_h)
 
     /* setup the custom configuration */
     trace_cfg_ext.cs_id = 0x010;
+    trace_cfg_ext.wp_test_addr = mem_dump_address;  /* start of the AArch64 code in the memory dump */
     if (test_trc_id_override != 0)
     {
         trace_cfg_ext.cs_id = (uint32_t)test_trc_id_override;
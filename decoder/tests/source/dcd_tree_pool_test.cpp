@@ -0,0 +1,312 @@
+/*
+* \file     dcd_tree_pool_test.cpp
+* \brief    OpenCSD: check decode trees reused from a pool and reconfigured between snapshots.
+*
+* \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+*/
+
+/*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Checks that decode trees reused through a DecodeTreePool, and reconfigured for each
+ * capture with DecodeTree::reconfigureDecoder(), decode identically to new trees.
+ *
+ * Snapshots are tested in groups that have the same trace sources. Each snapshot in a
+ * group is first decoded by a tree created for that snapshot. A pool of trees is then
+ * created from the first snapshot in the group. For a number of passes, each snapshot
+ * is decoded again by a tree from the pool, with the decoder configurations and memory
+ * images for the snapshot applied to it. The trees are used in turn so each is moved
+ * between snapshots. The generic element output must match the new tree output.
+ *
+ * Usage: dcd_tree_pool_test [-ss_path <dir>] [-trees <n>] [-passes <n>]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include "opencsd.h"
+#include "ss_to_dcdtree.h"
+
+#ifdef _WIN32
+static const char *default_ss_path = "..\\..\\..\\snapshots";
+#else
+static const char *default_ss_path = "../../snapshots";
+#endif
+
+/* snapshots with the same trace sources - pooled trees are moved between these */
+static const char *ss_groups[][2] = {
+    { "juno_r1_1", "juno-ret-stck" },
+    { "juno-uname-002", "bugfix-exact-match" },
+    { "tc2-ptm-rstk-t32", "trace_cov_a15" },
+};
+
+/* collect the generic element output as strings for comparison */
+class ElemCapture : public ITrcGenElemIn
+{
+public:
+    ElemCapture() {};
+    virtual ~ElemCapture() {};
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                             const uint8_t trc_chan_id,
+                                             const OcsdTraceElement &elem)
+    {
+        std::ostringstream oss;
+        std::string elemStr;
+        elem.toString(elemStr);
+        oss << "Idx:" << index_sop << "; ID:" << std::hex << (uint32_t)trc_chan_id << "; " << elemStr;
+        m_elems.push_back(oss.str());
+        return OCSD_RESP_CONT;
+    };
+
+    std::vector<std::string> m_elems;
+};
+
+/* snapshot and the reference output from a new tree */
+struct ss_test_t {
+    std::string name;
+    SnapShotReader reader;
+    std::string buffer_name;
+    std::vector<std::string> ref_elems;
+    bool ref_decode_ok;     // some snapshots end in a fatal decode error - pooled tree must match.
+};
+
+static bool read_snapshot(ss_test_t &ss, const std::string &ss_path, ITraceErrorLog *err_log)
+{
+    std::vector<std::string> buffers;
+
+    ss.reader.setSnapshotDir(ss_path + "/" + ss.name);
+    ss.reader.setErrorLogger(err_log);
+    if (!ss.reader.snapshotFound() || !ss.reader.readSnapShot() || !ss.reader.getSourceBufferNameList(buffers))
+        return false;
+    ss.buffer_name = buffers[0];
+    return true;
+}
+
+/* push the buffer file through the tree, then end of trace */
+static bool decode_buffer(DecodeTree *tree, const char *buffer_file)
+{
+    std::ifstream in(buffer_file, std::ifstream::in | std::ifstream::binary);
+    uint8_t trace_buffer[1024];
+    ocsd_trc_index_t trace_index = 0;
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+
+    if (!in.is_open())
+        return false;
+
+    while (!in.eof() && !OCSD_DATA_RESP_IS_FATAL(resp))
+    {
+        uint32_t nBuffRead, nBuffProcessed = 0, nUsedThisTime;
+
+        in.read((char *)&trace_buffer[0], sizeof(trace_buffer));
+        nBuffRead = (uint32_t)in.gcount();
+
+        while ((nBuffProcessed < nBuffRead) && !OCSD_DATA_RESP_IS_FATAL(resp))
+        {
+            if (OCSD_DATA_RESP_IS_CONT(resp))
+            {
+                nUsedThisTime = 0;
+                resp = tree->TraceDataIn(OCSD_OP_DATA, trace_index, nBuffRead - nBuffProcessed,
+                                         &trace_buffer[0] + nBuffProcessed, &nUsedThisTime);
+                nBuffProcessed += nUsedThisTime;
+                trace_index += nUsedThisTime;
+            }
+            else
+                resp = tree->TraceDataIn(OCSD_OP_FLUSH, 0, 0, 0, 0);
+        }
+    }
+    if (!OCSD_DATA_RESP_IS_FATAL(resp))
+        resp = tree->TraceDataIn(OCSD_OP_EOT, 0, 0, 0, 0);
+    return !OCSD_DATA_RESP_IS_FATAL(resp);
+}
+
+static bool compare_output(const ss_test_t &ss, const ElemCapture &capture, const bool decode_ok)
+{
+    size_t i;
+
+    for (i = 0; (i < ss.ref_elems.size()) && (i < capture.m_elems.size()); i++)
+    {
+        if (ss.ref_elems[i] != capture.m_elems[i])
+            break;
+    }
+    if ((i == ss.ref_elems.size()) && (i == capture.m_elems.size()))
+    {
+        if (decode_ok == ss.ref_decode_ok)
+            return true;
+        printf("%s: decode %s on pooled tree, %s on new tree\n", ss.name.c_str(),
+            decode_ok ? "completed" : "failed", ss.ref_decode_ok ? "completed" : "failed");
+        return false;
+    }
+
+    printf("%s: output differs at element %d of %d\n", ss.name.c_str(), (int)i, (int)ss.ref_elems.size());
+    if (i < ss.ref_elems.size())
+        printf("  new tree    : %s\n", ss.ref_elems[i].c_str());
+    if (i < capture.m_elems.size())
+        printf("  pooled tree : %s\n", capture.m_elems[i].c_str());
+    return false;
+}
+
+static int test_group(const char **names, const int num_ss, const std::string &ss_path, const int num_trees,
+                      const int passes, ocsdDefaultErrorLogger &err_log)
+{
+    std::vector<ss_test_t> snapshots(num_ss);
+    ElemCapture capture;    // attached to all pool trees - must outlive the pool.
+    DecodeTreePool pool;
+    int errors = 0, decodes = 0;
+
+    // reference output from a new tree for each snapshot.
+    for (int i = 0; i < num_ss; i++)
+    {
+        ElemCapture ref_capture;
+        CreateDcdTreeFromSnapShot tree_creator;
+
+        snapshots[i].name = names[i];
+        if (!read_snapshot(snapshots[i], ss_path, &err_log))
+        {
+            printf("%s: failed to read snapshot.\n", names[i]);
+            return 1;
+        }
+        tree_creator.initialise(&snapshots[i].reader, &err_log);
+        if (!tree_creator.createDecodeTree(snapshots[i].buffer_name, false))
+        {
+            printf("%s: failed to create decode tree.\n", names[i]);
+            return 1;
+        }
+        tree_creator.getDecodeTree()->setGenTraceElemOutI(&ref_capture);
+        snapshots[i].ref_decode_ok = decode_buffer(tree_creator.getDecodeTree(), tree_creator.getBufferFileName());
+        snapshots[i].ref_elems = ref_capture.m_elems;
+    }
+
+    // pool trees created from the first snapshot.
+    for (int i = 0; i < num_trees; i++)
+    {
+        CreateDcdTreeFromSnapShot tree_creator;
+        tree_creator.initialise(&snapshots[0].reader, &err_log);
+        if (!tree_creator.createDecodeTree(snapshots[0].buffer_name, false))
+        {
+            printf("%s: failed to create pool decode tree.\n", names[0]);
+            return 1;
+        }
+        tree_creator.getDecodeTree()->setGenTraceElemOutI(&capture);
+        if (pool.addTree(tree_creator.releaseDecodeTree()) != OCSD_OK)
+        {
+            printf("%s: failed to add tree to pool.\n", names[0]);
+            return 1;
+        }
+    }
+
+    // check out all the trees and use them in turn - trees move between snapshots on each pass.
+    for (int step = 0; step < passes * num_ss; step++)
+    {
+        std::vector<DecodeTree *> trees;
+        DecodeTree *tree;
+        ss_test_t &ss = snapshots[step % num_ss];
+        CreateDcdTreeFromSnapShot tree_creator;
+
+        while ((tree = pool.checkOut()) != 0)
+            trees.push_back(tree);
+        if (((int)trees.size() != num_trees) || (pool.getNumFree() != 0))
+        {
+            printf("Pool check out: %d trees of %d available.\n", (int)trees.size(), num_trees);
+            errors++;
+        }
+
+        if (trees.size())
+        {
+            tree = trees[step % trees.size()];
+            tree_creator.initialise(&ss.reader, &err_log);
+            if (tree_creator.reconfigureDecodeTree(tree, ss.buffer_name))
+            {
+                capture.m_elems.clear();
+                if (!compare_output(ss, capture, decode_buffer(tree, tree_creator.getBufferFileName())))
+                    errors++;
+                decodes++;
+            }
+            else
+            {
+                printf("%s: failed to reconfigure pool decode tree.\n", ss.name.c_str());
+                errors++;
+            }
+        }
+
+        for (size_t i = 0; i < trees.size(); i++)
+        {
+            if (pool.checkIn(trees[i]) != OCSD_OK)
+                errors++;
+        }
+    }
+
+    printf("%s, %s: %d elements; %d pooled tree decodes; %d errors.\n", names[0], names[1],
+        (int)(snapshots[0].ref_elems.size() + snapshots[1].ref_elems.size()), decodes, errors);
+    return errors;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string ss_path = default_ss_path;
+    int num_trees = 3;
+    int passes = 3;
+    int errors = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-ss_path") && (i + 1 < argc))
+            ss_path = argv[++i];
+        else if (!strcmp(argv[i], "-trees") && (i + 1 < argc))
+            num_trees = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-passes") && (i + 1 < argc))
+            passes = atoi(argv[++i]);
+        else
+        {
+            printf("Usage: dcd_tree_pool_test [-ss_path <dir>] [-trees <n>] [-passes <n>]\n");
+            return 1;
+        }
+    }
+    if (num_trees < 1)
+        num_trees = 1;
+
+    ocsdMsgLogger logger;
+    ocsdDefaultErrorLogger err_log;
+    logger.setLogOpts(ocsdMsgLogger::OUT_STDOUT);
+    err_log.initErrorLogger(OCSD_ERR_SEV_ERROR);
+    err_log.setOutputLogger(&logger);
+
+    printf("Decode tree pool test: %d trees, %d passes.\n", num_trees, passes);
+
+    for (size_t i = 0; i < sizeof(ss_groups) / sizeof(ss_groups[0]); i++)
+        errors += test_group(ss_groups[i], 2, ss_path, num_trees, passes, err_log);
+
+    printf("Decode tree pool test: %s\n", errors ? "FAILED" : "PASSED");
+    return errors ? 1 : 0;
+}
+
+/* End of File dcd_tree_pool_test.cpp */
@@ -0,0 +1,260 @@
+/*
+ * \file       elem_queue_bench.cpp
+ * \brief      OpenCSD : Benchmark element output through the consumer thread queue.
+ * 
+ * \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+ */
+
+/* 
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution. 
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND 
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. 
+ */ 
+
+
+
+/* Compares decoding a snapshot with an expensive element analysis sink called inline on the 
+ * decode thread, against the same sink run on a consumer thread through a TrcGenElemQueue.
+ * Both runs must see the same elements in the same order, checked by a hash of the elements.
+ *
+ * The sink work per element is synthetic - set with -work to model the cost of a real 
+ * analysis such as a profiler or coverage tool.
+ *
+ * Usage: elem_queue_bench -ss_dir <dir> [-loops <n>] [-work <n>] [-queue <n>]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "opencsd.h"
+#include "trace_snapshots.h"
+
+/* element sink hashing the element fields, repeated to set the cost per element */
+class HashElemSink : public ITrcGenElemIn
+{
+public:
+    HashElemSink(const int work) : m_work(work), m_hash(0), m_num_elem(0) {};
+    virtual ~HashElemSink() {};
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                             const uint8_t trc_chan_id,
+                                             const OcsdTraceElement &elem)
+    {
+        uint64_t vals[5] = { index_sop, trc_chan_id, (uint64_t)elem.elem_type, 0, 0 };
+        if (elem.elem_type == OCSD_GEN_TRC_ELEM_INSTR_RANGE)
+        {
+            // addresses are left over from previous elements on other types.
+            vals[3] = elem.st_addr;
+            vals[4] = elem.en_addr;
+        }
+        else if (elem.elem_type == OCSD_GEN_TRC_ELEM_SWTRACE)
+        {
+            // STM packet index can move by a byte when a _WAIT splits a data block.
+            vals[0] = 0;
+        }
+        uint64_t hash = m_hash;
+
+        for (int i = 0; i < m_work; i++)
+        {
+            // FNV-1a style mix of the element values
+            for (int j = 0; j < 5; j++)
+            {
+                hash ^= vals[j];
+                hash *= 0x100000001b3ULL;
+            }
+        }
+        m_hash = hash;
+        m_num_elem++;
+        return OCSD_RESP_CONT;
+    };
+
+    void reset() { m_hash = 0; m_num_elem = 0; };
+    const uint64_t getHash() const { return m_hash; };
+    const uint64_t getNumElem() const { return m_num_elem; };
+
+private:
+    int m_work;
+    uint64_t m_hash;
+    uint64_t m_num_elem;
+};
+
+typedef struct bench_result {
+    uint64_t hash;
+    uint64_t num_elem;
+    uint64_t num_waits;
+    double   time_ms;
+} bench_result_t;
+
+/* push the trace buffer through the tree - restarting after each _WAIT with a flush. */
+static ocsd_datapath_resp_t decode_buffer(DecodeTree *dcd_tree, const std::vector<uint8_t> &trace)
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+    uint32_t processed = 0, used = 0;
+
+    while ((processed < trace.size()) && !OCSD_DATA_RESP_IS_FATAL(resp))
+    {
+        if (OCSD_DATA_RESP_IS_CONT(resp))
+        {
+            resp = dcd_tree->TraceDataIn(OCSD_OP_DATA, processed, (uint32_t)(trace.size() - processed), &trace[processed], &used);
+            processed += used;
+        }
+        else
+            resp = dcd_tree->TraceDataIn(OCSD_OP_FLUSH, 0, 0, 0, 0);
+    }
+
+    if (!OCSD_DATA_RESP_IS_FATAL(resp))
+        resp = dcd_tree->TraceDataIn(OCSD_OP_EOT, 0, 0, 0, 0);
+    return resp;
+}
+
+static void run_decode(DecodeTree *dcd_tree, const std::vector<uint8_t> &trace, HashElemSink &sink,
+                       const int loops, const uint32_t queue_size, bench_result_t &res)
+{
+    TrcGenElemQueue elemQueue;
+
+    memset(&res, 0, sizeof(bench_result_t));
+    sink.reset();
+    if (queue_size)
+    {
+        elemQueue.start(&sink, queue_size);
+        dcd_tree->setGenTraceElemOutI(&elemQueue);
+    }
+    else
+        dcd_tree->setGenTraceElemOutI(&sink);
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < loops; i++)
+    {
+        dcd_tree->resetDecodeTree();
+        decode_buffer(dcd_tree, trace);
+    }
+    if (queue_size)
+        elemQueue.stop();   // all elements analysed before the time is taken.
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    dcd_tree->setGenTraceElemOutI(0);
+    res.time_ms = elapsed.count();
+    res.hash = sink.getHash();
+    res.num_elem = sink.getNumElem();
+    res.num_waits = elemQueue.getNumWaits();
+}
+
+int main(int argc, char* argv[])
+{
+    std::string ss_path = "";
+    int loops = 10, work = 64;
+    uint32_t queue_size = OCSD_ELEM_QUEUE_DEF_SIZE;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-ss_dir") && (i + 1 < argc))
+            ss_path = argv[++i];
+        else if (!strcmp(argv[i], "-loops") && (i + 1 < argc))
+            loops = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-work") && (i + 1 < argc))
+            work = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-queue") && (i + 1 < argc))
+            queue_size = (uint32_t)strtoul(argv[++i], 0, 0);
+        else
+        {
+            printf("Usage: elem_queue_bench -ss_dir <dir> [-loops <n>] [-work <n>] [-queue <n>]\n");
+            return 1;
+        }
+    }
+    if (!ss_path.size())
+    {
+        printf("Usage: elem_queue_bench -ss_dir <dir> [-loops <n>] [-work <n>] [-queue <n>]\n");
+        return 1;
+    }
+    if (loops < 1)
+        loops = 1;
+    if (work < 1)
+        work = 1;
+    if (queue_size < 1)
+        queue_size = 1;
+
+    // load the snapshot and create a full decode tree for the first trace buffer.
+    ocsdDefaultErrorLogger err_log;
+    err_log.initErrorLogger(OCSD_ERR_SEV_ERROR);
+
+    SnapShotReader ss_reader;
+    std::vector<std::string> sourceBuffList;
+    ss_reader.setSnapshotDir(ss_path);
+    ss_reader.setErrorLogger(&err_log);
+    if (!ss_reader.snapshotFound() || !ss_reader.readSnapShot() || !ss_reader.getSourceBufferNameList(sourceBuffList))
+    {
+        printf("Element queue benchmark: ERROR : failed to read snapshot %s\n", ss_path.c_str());
+        return 1;
+    }
+
+    CreateDcdTreeFromSnapShot tree_creator;
+    tree_creator.initialise(&ss_reader, &err_log);
+    if (!tree_creator.createDecodeTree(sourceBuffList[0], false))
+    {
+        printf("Element queue benchmark: ERROR : failed to create decode tree for %s\n", sourceBuffList[0].c_str());
+        return 1;
+    }
+
+    // trace buffer read into memory so file access is not timed.
+    std::ifstream in(tree_creator.getBufferFileName(), std::ifstream::in | std::ifstream::binary);
+    std::vector<uint8_t> trace((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!trace.size())
+    {
+        printf("Element queue benchmark: ERROR : no trace data in %s\n", tree_creator.getBufferFileName());
+        tree_creator.destroyDecodeTree();
+        return 1;
+    }
+
+    HashElemSink sink(work);
+    bench_result_t inline_res, queue_res;
+    DecodeTree *dcd_tree = tree_creator.getDecodeTree();
+
+    run_decode(dcd_tree, trace, sink, loops, 0, inline_res);
+    run_decode(dcd_tree, trace, sink, loops, queue_size, queue_res);
+    tree_creator.destroyDecodeTree();
+
+    printf("Element queue benchmark: %s, %u bytes trace, %d passes, work %d, queue %u elements, %u hardware threads\n", 
+        sourceBuffList[0].c_str(), (uint32_t)trace.size(), loops, work, queue_size, std::thread::hardware_concurrency());
+    printf("%llu elements per pass; %llu queue waits\n",
+        (unsigned long long)(inline_res.num_elem / loops), (unsigned long long)queue_res.num_waits);
+    printf("inline sink %8.2f ms; queued sink %8.2f ms; speedup x%.2f\n",
+        inline_res.time_ms, queue_res.time_ms, queue_res.time_ms > 0 ? inline_res.time_ms / queue_res.time_ms : 0.0);
+
+    if ((inline_res.hash != queue_res.hash) || (inline_res.num_elem != queue_res.num_elem))
+    {
+        printf("Element queue benchmark: ERROR : queued elements do not match inline elements.\n");
+        printf("Element queue benchmark: FAILED\n");
+        return 1;
+    }
+    printf("Element queue benchmark: PASSED\n");
+    return 0;
+}
+
+/* End of File elem_queue_bench.cpp */
@@ -0,0 +1,146 @@
+/*
+* \file     idec_lut_test.cpp
+* \brief    OpenCSD: exhaustive check of the instruction decoder lookup tables.
+* 
+* \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+*/
+
+/*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Checks the lookup table pre-classification in the instruction decoder against the
+ * full opcode queries, across the full 32 bit opcode space for each ISA. 
+ * Any opcode rejected by the lookup table must be rejected by every query used in the 
+ * instruction decoder. 
+ *
+ * Usage: idec_lut_test [-a32] [-t32] [-a64]  (default all ISAs)
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "opencsd/ocsd_if_types.h"
+#include "i_dec/trc_idec_arminst.h"
+
+typedef int (*fn_maybe_wp_t)(uint32_t inst);
+typedef int (*fn_full_check_t)(uint32_t inst);
+
+static int a32_full_check(uint32_t inst)
+{
+    return inst_ARM_is_indirect_branch(inst) ||
+           inst_ARM_is_direct_branch(inst) ||
+           (inst_ARM_barrier(inst) != ARM_BARRIER_NONE) ||
+           inst_ARM_wfiwfe(inst);
+}
+
+static int t32_full_check(uint32_t inst)
+{
+    return inst_Thumb_is_direct_branch(inst) ||
+           inst_Thumb_is_indirect_branch(inst) ||
+           (inst_Thumb_barrier(inst) != ARM_BARRIER_NONE) ||
+           inst_Thumb_wfiwfe(inst) ||
+           inst_Thumb_is_conditional(inst) ||
+           (inst_Thumb_is_IT(inst) != 0);
+}
+
+static int a64_full_check(uint32_t inst)
+{
+    return inst_A64_is_indirect_branch(inst) ||
+           inst_A64_is_direct_branch(inst) ||
+           (inst_A64_barrier(inst) != ARM_BARRIER_NONE) ||
+           inst_A64_wfiwfe(inst) ||
+           inst_A64_is_conditional(inst);
+}
+
+static int check_isa(const char *name, fn_maybe_wp_t maybe_wp, fn_full_check_t full_check)
+{
+    uint64_t num_candidates = 0;
+    uint64_t num_waypoints = 0;
+    uint64_t num_errors = 0;
+    uint32_t inst = 0;
+
+    printf("%s : checking all opcodes...\n", name);
+    do {
+        int is_wp = full_check(inst);
+        if (maybe_wp(inst))
+            num_candidates++;
+        else if (is_wp)
+        {
+            if (num_errors < 16)
+                printf("%s : ERROR : opcode 0x%08X rejected by lookup table but matches full decode.\n", name, inst);
+            num_errors++;
+        }
+        if (is_wp)
+            num_waypoints++;
+        inst++;
+    } while (inst != 0);
+
+    printf("%s : %llu full decode matches; %llu lookup table candidates (%.2f%% of opcodes); %llu errors.\n",
+        name, (unsigned long long)num_waypoints, (unsigned long long)num_candidates, 
+        (double)num_candidates * 100.0 / 4294967296.0, (unsigned long long)num_errors);
+    return num_errors ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+    bool test_a32 = true, test_t32 = true, test_a64 = true;
+    int errors = 0;
+
+    if (argc > 1)
+    {
+        test_a32 = test_t32 = test_a64 = false;
+        for (int i = 1; i < argc; i++)
+        {
+            if (!strcmp(argv[i], "-a32"))
+                test_a32 = true;
+            else if (!strcmp(argv[i], "-t32"))
+                test_t32 = true;
+            else if (!strcmp(argv[i], "-a64"))
+                test_a64 = true;
+            else
+            {
+                printf("Usage: idec_lut_test [-a32] [-t32] [-a64]\n");
+                return 1;
+            }
+        }
+    }
+
+    /* latest architecture version enables the largest set of branch encodings */
+    set_arch_version(0x0803);
+
+    if (test_a32)
+        errors += check_isa("A32", inst_ARM_maybe_waypoint, a32_full_check);
+    if (test_t32)
+        errors += check_isa("T32", inst_Thumb_maybe_waypoint, t32_full_check);
+    if (test_a64)
+        errors += check_isa("A64", inst_A64_maybe_waypoint, a64_full_check);
+
+    printf("Instruction decode lookup table test: %s\n", errors ? "FAILED" : "PASSED");
+    return errors ? 1 : 0;
+}
+
+/* End of File idec_lut_test.cpp */
@@ -0,0 +1,210 @@
+/*
+* \file     idec_wp_scan_bench.cpp
+* \brief    OpenCSD: benchmark of the instruction decoder waypoint scan.
+* 
+* \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+*/
+
+/*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Compares walking a memory image to each waypoint one instruction at a time, as the 
+ * PE decoders did originally, against scanning spans of the image with FindNextWaypoint().
+ * Both walks must find the same waypoints, with the same instruction counts.
+ *
+ * The image is pseudo-random opcodes, with a waypoint density set by the opcode distribution
+ * rather than by real code - the relative timings are the point of interest.
+ *
+ * Usage: idec_wp_scan_bench [-size <KB>] [-loops <n>] [-a32] [-t32] [-a64]  (default all ISAs)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include "opencsd/ocsd_if_types.h"
+#include "i_dec/trc_i_decode.h"
+
+#define SPAN_BYTES 64   /* same span as the PE decoders */
+
+typedef struct walk_result {
+    uint64_t num_instr;     // total instructions walked
+    uint64_t num_wp;        // total waypoints found
+    uint64_t wp_addr_sum;   // sum of waypoint addresses - quick check walks match.
+    double   time_ms;
+} walk_result_t;
+
+static void init_instr_info(ocsd_instr_info &instr_info, const ocsd_isa isa)
+{
+    memset(&instr_info, 0, sizeof(ocsd_instr_info));
+    instr_info.pe_type.arch = ARCH_V8r3;
+    instr_info.pe_type.profile = profile_CortexA;
+    instr_info.isa = isa;
+    instr_info.dsb_dmb_waypoints = 0;
+    instr_info.wfi_wfe_branch = 1;
+}
+
+/* walk image one opcode at a time */
+static void walk_single(TrcIDecode &idec, const std::vector<uint8_t> &image, const ocsd_isa isa, walk_result_t &res)
+{
+    ocsd_instr_info instr_info;
+    uint32_t opcode;
+    
+    init_instr_info(instr_info, isa);
+    while (instr_info.instr_addr + 4 <= image.size())
+    {
+        memcpy(&opcode, &image[(size_t)instr_info.instr_addr], sizeof(uint32_t));
+        instr_info.opcode = opcode;
+        idec.DecodeInstruction(&instr_info);
+        instr_info.instr_addr += instr_info.instr_size;
+        res.num_instr++;
+        if (instr_info.type != OCSD_INSTR_OTHER)
+        {
+            res.num_wp++;
+            res.wp_addr_sum += instr_info.instr_addr;
+        }
+    }
+}
+
+/* walk image using the span scan */
+static void walk_span(TrcIDecode &idec, const std::vector<uint8_t> &image, const ocsd_isa isa, walk_result_t &res)
+{
+    ocsd_instr_info instr_info;
+    uint32_t opcode, span_bytes, num_skipped;
+
+    init_instr_info(instr_info, isa);
+    while (instr_info.instr_addr + 4 <= image.size())
+    {
+        const uint8_t *span = &image[(size_t)instr_info.instr_addr];
+        span_bytes = (uint32_t)(image.size() - instr_info.instr_addr);
+        if (span_bytes > SPAN_BYTES)
+            span_bytes = SPAN_BYTES;
+
+        idec.FindNextWaypoint(&instr_info, span, span_bytes, &num_skipped);
+        res.num_instr += num_skipped;
+        if (instr_info.instr_addr + 4 > image.size())
+            break;
+
+        memcpy(&opcode, &image[(size_t)instr_info.instr_addr], sizeof(uint32_t));
+        instr_info.opcode = opcode;
+        idec.DecodeInstruction(&instr_info);
+        instr_info.instr_addr += instr_info.instr_size;
+        res.num_instr++;
+        if (instr_info.type != OCSD_INSTR_OTHER)
+        {
+            res.num_wp++;
+            res.wp_addr_sum += instr_info.instr_addr;
+        }
+    }
+}
+
+typedef void (*fn_walk_t)(TrcIDecode &idec, const std::vector<uint8_t> &image, const ocsd_isa isa, walk_result_t &res);
+
+static void run_walk(fn_walk_t walk, const std::vector<uint8_t> &image, const ocsd_isa isa, const int loops, walk_result_t &res)
+{
+    TrcIDecode idec;
+
+    memset(&res, 0, sizeof(walk_result_t));
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < loops; i++)
+        walk(idec, image, isa, res);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    res.time_ms = elapsed.count();
+}
+
+static int bench_isa(const char *name, const ocsd_isa isa, const std::vector<uint8_t> &image, const int loops)
+{
+    walk_result_t single, span;
+
+    run_walk(walk_single, image, isa, loops, single);
+    run_walk(walk_span, image, isa, loops, span);
+
+    printf("%s : %llu instructions, %llu waypoints per pass\n", name,
+        (unsigned long long)(single.num_instr / loops), (unsigned long long)(single.num_wp / loops));
+    printf("%s : single opcode walk %8.2f ms; span scan walk %8.2f ms; speedup x%.2f\n", name,
+        single.time_ms, span.time_ms, span.time_ms > 0 ? single.time_ms / span.time_ms : 0.0);
+
+    if ((single.num_instr != span.num_instr) || (single.num_wp != span.num_wp) || (single.wp_addr_sum != span.wp_addr_sum))
+    {
+        printf("%s : ERROR : span scan walk does not match single opcode walk.\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    bool test_a32 = false, test_t32 = false, test_a64 = false;
+    int size_kb = 1024, loops = 10;
+    int errors = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-a32"))
+            test_a32 = true;
+        else if (!strcmp(argv[i], "-t32"))
+            test_t32 = true;
+        else if (!strcmp(argv[i], "-a64"))
+            test_a64 = true;
+        else if (!strcmp(argv[i], "-size") && (i + 1 < argc))
+            size_kb = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-loops") && (i + 1 < argc))
+            loops = atoi(argv[++i]);
+        else
+        {
+            printf("Usage: idec_wp_scan_bench [-size <KB>] [-loops <n>] [-a32] [-t32] [-a64]\n");
+            return 1;
+        }
+    }
+    if (!test_a32 && !test_t32 && !test_a64)
+        test_a32 = test_t32 = test_a64 = true;
+    if (size_kb < 1)
+        size_kb = 1;
+    if (loops < 1)
+        loops = 1;
+
+    // fixed seed so runs are repeatable
+    std::vector<uint8_t> image((size_t)size_kb * 1024);
+    srand(0x5eed);
+    for (size_t i = 0; i < image.size(); i++)
+        image[i] = (uint8_t)(rand() >> 4);
+
+    printf("Waypoint scan benchmark: %d KB image, %d passes\n", size_kb, loops);
+    if (test_a32)
+        errors += bench_isa("A32", ocsd_isa_arm, image, loops);
+    if (test_t32)
+        errors += bench_isa("T32", ocsd_isa_thumb2, image, loops);
+    if (test_a64)
+        errors += bench_isa("A64", ocsd_isa_aarch64, image, loops);
+
+    printf("Waypoint scan benchmark: %s\n", errors ? "FAILED" : "PASSED");
+    return errors ? 1 : 0;
+}
+
+/* End of File idec_wp_scan_bench.cpp */
@@ -0,0 +1,279 @@
+/*
+* \file     mem_image_mt_test.cpp
+* \brief    OpenCSD: multi-threaded check of the shared memory image registry.
+*
+* \copyright  Copyright (c) 2020, ARM Limited. All Rights Reserved.
+*/
+
+/*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 'AS IS' AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Checks the global memory image registry while images are updated on one thread
+ * and read through decode tree memory accessors on a number of other threads.
+ *
+ * The writer thread republishes a numbered version of one image, and publishes and
+ * withdraws a second image, for each iteration. Each reader thread repeatedly attaches
+ * the images to its own decode tree, reads them back through the memory accessor
+ * mapper and removes them again. Every read must see a complete single version of an
+ * image, and the versions seen by a reader must never go backwards. Each reader also
+ * holds an accessor attached before the writer starts, which must still read the
+ * original image once the registry has moved on.
+ *
+ * Usage: mem_image_mt_test [-threads <n>] [-iter <n>]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "opencsd.h"
+
+static const char *IMG_NAME = "mt_image";          // always published - new version each iteration
+static const char *IMG_WD_NAME = "mt_image_wd";    // published and withdrawn on alternate iterations
+static const ocsd_vaddr_t IMG_ADDR = 0x80000;
+static const ocsd_vaddr_t IMG_WD_ADDR = 0x90000;
+static const uint32_t IMG_SIZE = 0x1000;
+static const uint32_t READ_SIZE = 64;
+
+static std::atomic<bool> writer_done(false);
+
+/* image contents: version number in the first word, then bytes that depend on version and offset */
+static uint8_t img_byte(const uint32_t version, const uint32_t offset)
+{
+    return (uint8_t)((version * 7) + offset);
+}
+
+static ocsd_err_t publish_version(const char *name, const ocsd_vaddr_t address, const uint32_t version)
+{
+    std::vector<uint8_t> data(IMG_SIZE);
+    TrcMemImagePtr image;
+
+    for (uint32_t i = 0; i < IMG_SIZE; i++)
+        data[i] = img_byte(version, i);
+    memcpy(data.data(), &version, sizeof(uint32_t));
+
+    ocsd_err_t err = TrcMemImage::createFromBuffer(name, address, data.data(), IMG_SIZE, image);
+    if (err == OCSD_OK)
+        err = TrcMemImageRegistry::getGlobal().publishImage(image);
+    return err;
+}
+
+/* read a whole image through the tree memory accessors, returns version read or -1 on error */
+static int64_t read_image(DecodeTree *tree, const ocsd_vaddr_t address)
+{
+    uint8_t buffer[READ_SIZE];
+    uint32_t version = 0;
+
+    for (uint32_t offset = 0; offset < IMG_SIZE; offset += READ_SIZE)
+    {
+        uint32_t num_bytes = READ_SIZE;
+        if ((tree->getMemAccMapper()->ReadTargetMemory(address + offset, 0, OCSD_MEM_SPACE_ANY, &num_bytes, buffer) != OCSD_OK) ||
+            (num_bytes != READ_SIZE))
+            return -1;
+
+        uint32_t i = 0;
+        if (offset == 0)
+        {
+            memcpy(&version, buffer, sizeof(uint32_t));
+            i = sizeof(uint32_t);
+        }
+        for (; i < READ_SIZE; i++)
+        {
+            if (buffer[i] != img_byte(version, offset + i))
+                return -1;
+        }
+    }
+    return version;
+}
+
+struct reader_result {
+    uint64_t reads;
+    uint64_t wd_reads;
+    uint64_t errors;
+};
+
+static void reader_thread(DecodeTree *pinned_tree, DecodeTree *tree, const uint32_t pinned_version, reader_result *result)
+{
+    int64_t last_version = 0;
+    ocsd_err_t err;
+
+    do
+    {
+        err = tree->addImageMemAcc(IMG_NAME, OCSD_MEM_SPACE_ANY);
+        if (err == OCSD_OK)
+        {
+            int64_t version = read_image(tree, IMG_ADDR);
+            if ((version < 0) || (version < last_version))
+                result->errors++;
+            else
+                last_version = version;
+            result->reads++;
+            if (tree->removeMemAccByAddress(IMG_ADDR, OCSD_MEM_SPACE_ANY) != OCSD_OK)
+                result->errors++;
+        }
+        else
+            result->errors++;
+
+        // withdrawn image may or may not be present - if attached it must read correctly.
+        err = tree->addImageMemAcc(IMG_WD_NAME, OCSD_MEM_SPACE_ANY);
+        if (err == OCSD_OK)
+        {
+            if (read_image(tree, IMG_WD_ADDR) < 0)
+                result->errors++;
+            result->wd_reads++;
+            if (tree->removeMemAccByAddress(IMG_WD_ADDR, OCSD_MEM_SPACE_ANY) != OCSD_OK)
+                result->errors++;
+        }
+        else if (err != OCSD_ERR_INVALID_PARAM_VAL)
+            result->errors++;
+    } while (!writer_done.load());
+
+    // accessor attached before the updates still holds the original image.
+    if (read_image(pinned_tree, IMG_ADDR) != (int64_t)pinned_version)
+        result->errors++;
+}
+
+static void writer_thread(const uint32_t first_version, const int iterations, uint64_t *errors)
+{
+    for (int i = 0; i < iterations; i++)
+    {
+        const uint32_t version = first_version + (uint32_t)i + 1;
+        if (publish_version(IMG_NAME, IMG_ADDR, version) != OCSD_OK)
+            (*errors)++;
+        if (i & 0x1)
+        {
+            if (TrcMemImageRegistry::getGlobal().withdrawImage(IMG_WD_NAME) != OCSD_OK)
+                (*errors)++;
+        }
+        else if (publish_version(IMG_WD_NAME, IMG_WD_ADDR, version) != OCSD_OK)
+            (*errors)++;
+    }
+    writer_done.store(true);
+}
+
+static DecodeTree *create_tree()
+{
+    DecodeTree *tree = DecodeTree::CreateDecodeTree(OCSD_TRC_SRC_SINGLE, 0);
+    if (tree && (tree->createMemAccMapper() != OCSD_OK))
+    {
+        DecodeTree::DestroyDecodeTree(tree);
+        tree = 0;
+    }
+    return tree;
+}
+
+int main(int argc, char* argv[])
+{
+    int num_threads = 4;
+    int iterations = 20000;
+    const uint32_t first_version = 1;
+    uint64_t writer_errors = 0;
+    uint64_t errors = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-threads") && (i + 1 < argc))
+            num_threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-iter") && (i + 1 < argc))
+            iterations = atoi(argv[++i]);
+        else
+        {
+            printf("Usage: mem_image_mt_test [-threads <n>] [-iter <n>]\n");
+            return 1;
+        }
+    }
+    if (num_threads < 1)
+        num_threads = 1;
+
+    printf("Memory image registry test: %d reader threads, %d updates.\n", num_threads, iterations);
+
+    // initial image and per thread decode trees - tree creation is not thread safe so done here.
+    if (publish_version(IMG_NAME, IMG_ADDR, first_version) != OCSD_OK)
+    {
+        printf("Failed to publish initial image.\n");
+        return 1;
+    }
+
+    std::vector<DecodeTree *> trees;
+    std::vector<reader_result> results(num_threads);
+    for (int i = 0; i < num_threads * 2; i++)
+    {
+        DecodeTree *tree = create_tree();
+        if (!tree)
+        {
+            printf("Failed to create decode tree.\n");
+            return 1;
+        }
+        trees.push_back(tree);
+    }
+    for (int i = 0; i < num_threads; i++)
+    {
+        if (trees[i * 2]->addImageMemAcc(IMG_NAME, OCSD_MEM_SPACE_ANY) != OCSD_OK)
+        {
+            printf("Failed to attach initial image.\n");
+            return 1;
+        }
+        memset(&results[i], 0, sizeof(reader_result));
+    }
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < num_threads; i++)
+        readers.push_back(std::thread(reader_thread, trees[i * 2], trees[i * 2 + 1], first_version, &results[i]));
+    std::thread writer(writer_thread, first_version, iterations, &writer_errors);
+
+    writer.join();
+    for (int i = 0; i < num_threads; i++)
+    {
+        readers[i].join();
+        printf("Reader %d: %llu image reads; %llu withdrawn image reads; %llu errors.\n", i,
+            (unsigned long long)results[i].reads, (unsigned long long)results[i].wd_reads,
+            (unsigned long long)results[i].errors);
+        errors += results[i].errors;
+    }
+    printf("Writer: %llu errors.\n", (unsigned long long)writer_errors);
+    errors += writer_errors;
+
+    // the final version must be the one in the registry.
+    DecodeTree *tree = create_tree();
+    if (!tree || (tree->addImageMemAcc(IMG_NAME, OCSD_MEM_SPACE_ANY) != OCSD_OK) ||
+        (read_image(tree, IMG_ADDR) != (int64_t)(first_version + iterations)))
+        errors++;
+    if (tree)
+        DecodeTree::DestroyDecodeTree(tree);
+
+    for (size_t i = 0; i < trees.size(); i++)
+        DecodeTree::DestroyDecodeTree(trees[i]);
+    TrcMemImageRegistry::getGlobal().clear();
+
+    printf("Memory image registry test: %s\n", errors ? "FAILED" : "PASSED");
+    return errors ? 1 : 0;
+}
+
+/* End of File mem_image_mt_test.cpp */
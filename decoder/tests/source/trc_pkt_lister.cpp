@@ -37,8 +37,10 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
 #include <iostream>
 #include <sstream>
+#include <iomanip>
 #include <cstring>
 
 #include "opencsd.h"              // the library
@@ -66,6 +68,8 @@ static std::string logfileName = "trc_pkt_lister.ppl";
 static bool outRawPacked = false;
 static bool outRawUnpacked = false;
 static bool ss_verbose = false;
+static bool elf_mem = false;            // map ELF dump files with the ELF memory accessor
+static std::vector<std::string> bb_map_files;   // basic block map files to attach to the memory images
 static bool decode = false;
 static bool no_undecoded_packets = false;
 static bool pkt_mon = false;
@@ -73,6 +77,21 @@ static int test_waits = 0;
 static bool dstream_format = false;
 static bool tpiu_format = false;
 static bool has_hsync = false;
+static bool merge_ranges = false;
+static OcsdPeFilter pe_filter;          // PE context / address filter for decode
+static bool bulk_atoms = false;         // combine ETMv4 atom runs into single packets
+static bool skim = false;               // skim packet headers into per ID summaries
+static bool merge_ts = false;           // merge decode output from all IDs in timestamp order
+static std::string coverage_file = "";  // record decode coverage and save to this file
+static std::string serial_file = "";    // serialise decode output to this file and check the replay
+static bool cycle_prof = false;         // profile cycle counts by address
+static int cycle_prof_top = 20;         // number of hotspots to print
+static uint32_t sg_seg_size = 0;        // split input buffers into scatter-gather segments of this size
+static int pull_batch = 0;              // decode using the pull iterator with this batch size
+static uint32_t elem_queue_size = 0;    // output elements through a consumer thread queue of this size
+static bool stage_times = false;        // log the decode stage times at the end of the run
+static uint32_t err_repeat_limit = 0;   // printed repeats of the same error - 0 for no limit
+static uint32_t checkpoint_offset = 0;  // checkpoint the tree and restore into a new tree at this trace offset
 
 int main(int argc, char* argv[])
 {
@@ -100,6 +119,7 @@ int main(int argc, char* argv[])
 
     if(!process_cmd_line_opts(argc, argv))
         return -1;
+    err_log.setRepeatLimit(err_repeat_limit);
 
     moss.str("");
     moss << "Trace Packet Lister : reading snapshot from path " << ss_path << "\n";
@@ -182,6 +202,8 @@ void print_help()
     oss << "Snapshot:\n\n";
     oss << "-ss_dir <dir>       Set the directory path to a trace snapshot\n";
     oss << "-ss_verbose         Verbose output when reading the snapshot\n";
+    oss << "-elf_mem            Map memory dump files that are ELF files using the executable segments\n";
+    oss << "-bb_map <file>      Attach basic block maps from file to the memory images (may be used multiple times)\n";
     oss << "\nDecode:\n\n";
     oss << "-id <n>             Set an ID to list (may be used multiple times) - default if no id set is for all IDs to be printed\n";
     oss << "-src_name <name>    List packets from a given snapshot source name (defaults to first source found)\n";
@@ -190,9 +212,26 @@ void print_help()
     oss << "-tpiu_hsync         Input from TPIU - sync by FSYNC and HSYNC.";
     oss << "-decode             Full decode of the packets from the trace snapshot (default is to list undecoded packets only\n";
     oss << "-decode_only        Does not list the undecoded packets, just the trace decode.\n";
+    oss << "-merge_ranges       Merge address contiguous instruction range elements in the decode output.\n";
+    oss << "-filter_ctxtid <n>  Decode instruction trace only for context ID n (may be used multiple times)\n";
+    oss << "-filter_vmid <n>    Decode instruction trace only for VMID n (may be used multiple times)\n";
+    oss << "-filter_el <mask>   Decode instruction trace only for ELs in mask (bit N = ELN)\n";
+    oss << "-filter_range <st> <en> Decode instruction trace only in address range st to en (may be used multiple times)\n";
+    oss << "-bulk_atoms         Combine runs of ETMv4 atom packets into single packets.\n";
+    oss << "-skim               Skim packet headers and print a summary per ID - no packet listing or decode\n";
+    oss << "-coverage <file>    Record executed code coverage of the mapped memory images and save to file (use with -decode)\n";
+    oss << "-serial_check <file> Serialise the decode output to file, then replay and check against the decode (use with -decode)\n";
+    oss << "-checkpoint <N>     Checkpoint the decode tree at the first input block at or after offset N, restore into a new tree and continue decode\n";
+    oss << "-cycle_prof <N>     Attribute cycle counts to code addresses and print the top N hotspots (use with -decode)\n";
+    oss << "-sg_seg <N>         Split each input buffer into N byte segments and use scatter-gather data input\n";
+    oss << "-pull <N>           Decode using the pull iterator, fetching elements in batches of N (use with -decode)\n";
+    oss << "-elem_queue <N>     Output decoded elements on a consumer thread through a queue of N elements (use with -decode_only)\n";
+    oss << "-merge_ts           Merge the decode output from all IDs into a single timestamp ordered stream (use with -decode)\n";
+    oss << "-stage_times        Log the time spent in each decode stage (library built with STAGE_TIMING=1)\n";
     oss << "-o_raw_packed       Output raw packed trace frames\n";
     oss << "-o_raw_unpacked     Output raw unpacked trace data per ID\n";
     oss << "-test_waits <N>     Force wait from packet printer for N packets - test the wait/flush mechanisms for the decoder\n";
+    oss << "-err_repeat <N>     Print each repeated error at most N times, then summarise the count at the end\n";
     oss << "\nOutput:\n";
     oss << "   Setting any of these options cancels the default output to file & stdout,\n   using _only_ the options supplied.\n\n";
     oss << "-logstdout          Output to stdout -> console.\n";
@@ -365,6 +404,18 @@ bool process_cmd_line_opts(int argc, char* argv[])
                     bOptsOK = false;
                 }
             }
+            else if(strcmp(argv[optIdx], "-err_repeat") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                    err_repeat_limit = (uint32_t)strtoul(argv[optIdx],0,0);
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: repeat count value on -err_repeat option\n");
+                    bOptsOK = false;
+                }
+            }
             else if(strcmp(argv[optIdx], "-o_raw_packed") == 0)
             {
                 outRawPacked = true;     
@@ -377,6 +428,22 @@ bool process_cmd_line_opts(int argc, char* argv[])
             {
                 ss_verbose = true;
             }
+            else if(strcmp(argv[optIdx], "-elf_mem") == 0)
+            {
+                elf_mem = true;
+            }
+            else if(strcmp(argv[optIdx], "-bb_map") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                    bb_map_files.push_back(argv[optIdx]);
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing file name on -bb_map option\n");
+                    bOptsOK = false;
+                }
+            }
             else if(strcmp(argv[optIdx], "-decode") == 0)
             {
                 decode = true;              
@@ -390,6 +457,149 @@ bool process_cmd_line_opts(int argc, char* argv[])
                 no_undecoded_packets = true;
                 decode = true; 
             }
+            else if(strcmp(argv[optIdx], "-merge_ranges") == 0)
+            {
+                merge_ranges = true;
+            }
+            else if(strcmp(argv[optIdx], "-bulk_atoms") == 0)
+            {
+                bulk_atoms = true;
+            }
+            else if(strcmp(argv[optIdx], "-coverage") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                    coverage_file = argv[optIdx];
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing file name on -coverage option\n");
+                    bOptsOK = false;
+                }
+            }
+            else if(strcmp(argv[optIdx], "-cycle_prof") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                {
+                    cycle_prof = true;
+                    cycle_prof_top = (int)strtol(argv[optIdx], 0, 0);
+                }
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing hotspot count on -cycle_prof option\n");
+                    bOptsOK = false;
+                }
+            }
+            else if(strcmp(argv[optIdx], "-sg_seg") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                    sg_seg_size = (uint32_t)strtoul(argv[optIdx], 0, 0);
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing segment size on -sg_seg option\n");
+                    bOptsOK = false;
+                }
+            }
+            else if(strcmp(argv[optIdx], "-pull") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                    pull_batch = (int)strtol(argv[optIdx], 0, 0);
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing batch size on -pull option\n");
+                    bOptsOK = false;
+                }
+            }
+            else if(strcmp(argv[optIdx], "-elem_queue") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                    elem_queue_size = (uint32_t)strtoul(argv[optIdx], 0, 0);
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing queue size on -elem_queue option\n");
+                    bOptsOK = false;
+                }
+            }
+            else if(strcmp(argv[optIdx], "-merge_ts") == 0)
+            {
+                merge_ts = true;
+            }
+            else if(strcmp(argv[optIdx], "-serial_check") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                    serial_file = argv[optIdx];
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing file name on -serial_check option\n");
+                    bOptsOK = false;
+                }
+            }
+            else if(strcmp(argv[optIdx], "-checkpoint") == 0)
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                    checkpoint_offset = (uint32_t)strtoul(argv[optIdx],0,0);
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing offset value on -checkpoint option\n");
+                    bOptsOK = false;
+                }
+            }
+            else if(strcmp(argv[optIdx], "-skim") == 0)
+            {
+                skim = true;
+            }
+            else if(strcmp(argv[optIdx], "-stage_times") == 0)
+            {
+                stage_times = true;
+            }
+            else if((opt == "-filter_ctxtid") || (opt == "-filter_vmid") || (opt == "-filter_el"))
+            {
+                options_to_process--;
+                optIdx++;
+                if(options_to_process)
+                {
+                    uint32_t val = (uint32_t)strtoul(argv[optIdx],0,0);
+                    if(opt == "-filter_ctxtid")
+                        pe_filter.addContextID(val);
+                    else if(opt == "-filter_vmid")
+                        pe_filter.addVMID(val);
+                    else
+                        pe_filter.setELMask((uint8_t)val);
+                }
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: No value on " + opt + " option\n");
+                    bOptsOK = false;
+                }
+            }
+            else if(opt == "-filter_range")
+            {
+                if(options_to_process > 2)
+                {
+                    ocsd_vaddr_t st_addr = (ocsd_vaddr_t)strtoull(argv[optIdx+1],0,0);
+                    ocsd_vaddr_t en_addr = (ocsd_vaddr_t)strtoull(argv[optIdx+2],0,0);
+                    pe_filter.addAddrRange(st_addr, en_addr);
+                    options_to_process -= 2;
+                    optIdx += 2;
+                }
+                else
+                {
+                    logger.LogMsg("Trace Packet Lister : Error: Missing addresses on -filter_range option\n");
+                    bOptsOK = false;
+                }
+            }
             else if((strcmp(argv[optIdx], "-help") == 0) || (strcmp(argv[optIdx], "--help") == 0) || (strcmp(argv[optIdx], "-h") == 0))
             {
                 print_help();
@@ -529,11 +739,386 @@ void ConfigureFrameDeMux(DecodeTree *dcd_tree, RawFramePrinter **framePrinter)
     }
 }
 
+void ConfigureDecoders(DecodeTree *dcd_tree)
+{
+    std::ostringstream oss;
+
+    if(merge_ranges)
+    {
+        // set the merge option on the full decoders in the tree.
+        uint8_t elemID;
+        DecodeTreeElement *pElement = dcd_tree->getFirstElement(elemID);
+        while(pElement)
+        {
+            TraceComponent *pDecoder = pElement->getDecoderHandle();
+            pDecoder->setComponentOpMode(pDecoder->getComponentOpMode() | OCSD_OPFLG_PKTDEC_MERGE_RANGES);
+            pElement = dcd_tree->getNextElement(elemID);
+        }
+    }
+
+    if(pe_filter.isActive())
+        dcd_tree->setPeFilter(pe_filter);
+
+    // maps are built at the address the images are decoded at - no load bias.
+    for(std::vector<std::string>::const_iterator it = bb_map_files.begin(); it != bb_map_files.end(); it++)
+    {
+        ocsd_err_t err = dcd_tree->attachBBMapFile(*it, 0, OCSD_MEM_SPACE_ANY);
+        oss.str("");
+        if(err == OCSD_OK)
+            oss << "Trace Packet Lister : Attached basic block maps from " << *it << "\n";
+        else
+            oss << "Trace Packet Lister : Error: Failed to attach basic block maps from " << *it << " : " << ocsdError::getErrorString(ocsdError(OCSD_ERR_SEV_ERROR, err)) << "\n";
+        logger.LogMsg(oss.str());
+    }
+}
+
+void ConfigurePacketProcessors(DecodeTree *dcd_tree)
+{
+    if(bulk_atoms)
+    {
+        // set bulk atom mode on the ETMv4 packet processors in the tree - flag is protocol specific.
+        uint8_t elemID;
+        DecodeTreeElement *pElement = dcd_tree->getFirstElement(elemID);
+        while(pElement)
+        {
+            TraceComponent *pProc = pElement->getDecoderHandle();
+            if(pProc->getAssocComponent())
+                pProc = pProc->getAssocComponent();
+            if(pElement->getProtocol() == OCSD_PROTOCOL_ETMV4I)
+                pProc->setComponentOpMode(pProc->getComponentOpMode() | ETMV4_OPFLG_PKTPROC_BULK_ATOMS);
+            pElement = dcd_tree->getNextElement(elemID);
+        }
+    }
+
+    if(skim && !decode)
+    {
+        // set skim mode on the packet processors in the tree.
+        uint8_t elemID;
+        DecodeTreeElement *pElement = dcd_tree->getFirstElement(elemID);
+        while(pElement)
+        {
+            TraceComponent *pProc = pElement->getDecoderHandle();
+            pProc->setComponentOpMode(pProc->getComponentOpMode() | OCSD_OPFLG_PKTPROC_SKIM);
+            pElement = dcd_tree->getNextElement(elemID);
+        }
+    }
+}
+
+void PrintSkimSummaries(DecodeTree *dcd_tree)
+{
+    uint8_t elemID;
+    ocsd_skim_summary_t summary;
+    DecodeTreeElement *pElement = dcd_tree->getFirstElement(elemID);
+
+    while(pElement)
+    {
+        std::ostringstream oss;
+        oss << "Trace Packet Lister : Skim summary ID 0x" << std::hex << (uint32_t)elemID << std::dec << ": ";
+        if(dcd_tree->getSkimSummary(elemID, &summary) == OCSD_OK)
+        {
+            oss << summary.num_bytes << " bytes (" << summary.unsync_bytes << " unsynced); ";
+            oss << summary.num_packets << " packets; " << summary.num_sync << " sync; ";
+            oss << summary.num_overflow << " overflow; " << summary.num_bad << " bad; ";
+            if(summary.ts_valid)
+                oss << "TS 0x" << std::hex << summary.ts_first << " - 0x" << summary.ts_last << std::dec;
+            else
+                oss << "no TS";
+            oss << "\n";
+            for(int i = 0; i < 256; i++)
+            {
+                if(summary.hdr_counts[i])
+                    oss << "    hdr 0x" << std::hex << std::setw(2) << std::setfill('0') << i << std::dec << " : " << summary.hdr_counts[i] << "\n";
+            }
+        }
+        else
+            oss << "skim not supported for protocol.\n";
+        logger.LogMsg(oss.str());
+        pElement = dcd_tree->getNextElement(elemID);
+    }
+}
+
+// pass the time ordered merged elements on to the generic element printer.
+class MergedElemPrinter : public ITrcMergedElemIn
+{
+public:
+    MergedElemPrinter() : m_p_printer(0) {};
+    virtual ~MergedElemPrinter() {};
+
+    void setPrinter(ITrcGenElemIn *p_printer) { m_p_printer = p_printer; };
+
+    virtual ocsd_datapath_resp_t TraceMergedElemIn(const int source_tag,
+                                                    const ocsd_trc_index_t index_sop,
+                                                    const uint8_t trc_chan_id,
+                                                    const OcsdTraceElement &elem)
+    {
+        return m_p_printer->TraceElemIn(index_sop, trc_chan_id, elem);
+    };
+
+private:
+    ITrcGenElemIn *m_p_printer;
+};
+
+// send the decoded elements to the analysis sinks as well as the printer.
+class AnalysisElemTee : public ITrcGenElemIn
+{
+public:
+    AnalysisElemTee() : m_p_printer(0) {};
+    virtual ~AnalysisElemTee() {};
+
+    void setPrinter(ITrcGenElemIn *p_printer) { m_p_printer = p_printer; };
+    void addSink(ITrcGenElemIn *p_sink) { m_sinks.push_back(p_sink); };
+    const bool hasSinks() const { return m_sinks.size() > 0; };
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                              const uint8_t trc_chan_id,
+                                              const OcsdTraceElement &elem)
+    {
+        for(size_t i = 0; i < m_sinks.size(); i++)
+            m_sinks[i]->TraceElemIn(index_sop, trc_chan_id, elem);
+        return m_p_printer->TraceElemIn(index_sop, trc_chan_id, elem);
+    };
+
+private:
+    ITrcGenElemIn *m_p_printer;
+    std::vector<ITrcGenElemIn *> m_sinks;
+};
+
+// records the printed form of each decoded element, then checks the elements replayed 
+// from the serialised stream against the record.
+class SerialReplayCheck : public ITrcGenElemIn
+{
+public:
+    SerialReplayCheck() : m_replay(false), m_num_checked(0), m_num_errs(0) {};
+    virtual ~SerialReplayCheck() {};
+
+    void startReplay() { m_replay = true; m_num_checked = 0; m_num_errs = 0; };
+
+    virtual ocsd_datapath_resp_t TraceElemIn(const ocsd_trc_index_t index_sop,
+                                              const uint8_t trc_chan_id,
+                                              const OcsdTraceElement &elem)
+    {
+        std::ostringstream oss;
+        std::string elemStr;
+
+        elem.toString(elemStr);
+        oss << "Idx:" << index_sop << "; ID:" << std::hex << (uint32_t)trc_chan_id << "; " << elemStr;
+        if(!m_replay)
+            m_elems.push_back(oss.str());
+        else
+        {
+            if((m_num_checked >= m_elems.size()) || (m_elems[m_num_checked] != oss.str()))
+            {
+                if(m_num_errs++ < 10)
+                {
+                    std::ostringstream err;
+                    err << "Trace Packet Lister : Serial replay mismatch at element " << std::dec << m_num_checked << "\n";
+                    err << "  decoded : " << ((m_num_checked < m_elems.size()) ? m_elems[m_num_checked] : "<none>") << "\n";
+                    err << "  replayed: " << oss.str() << "\n";
+                    logger.LogMsg(err.str());
+                }
+            }
+            m_num_checked++;
+        }
+        return OCSD_RESP_CONT;
+    };
+
+    const size_t getNumElem() const { return m_elems.size(); };
+    const size_t getNumChecked() const { return m_num_checked; };
+    const bool passed() const { return (m_num_errs == 0) && (m_num_checked == m_elems.size()); };
+
+private:
+    bool m_replay;
+    std::vector<std::string> m_elems;
+    size_t m_num_checked;
+    size_t m_num_errs;
+};
+
+// trace data source for pull mode decode - reads blocks from the trace buffer file.
+class FileTraceSrc : public ITrcDataSrc
+{
+public:
+    FileTraceSrc(std::ifstream &in) : m_in(in), m_bytes_read(0) {};
+    virtual ~FileTraceSrc() {};
+
+    virtual ocsd_err_t ReadTraceData(const uint8_t **pp_data, uint32_t *p_size)
+    {
+        *p_size = 0;
+        if(!m_in.eof())
+        {
+            m_in.read((char *)&m_buffer[0], sizeof(m_buffer));
+            *p_size = (uint32_t)m_in.gcount();
+        }
+        *pp_data = &m_buffer[0];
+        m_bytes_read += *p_size;
+        return OCSD_OK;
+    };
+
+    const uint32_t getBytesRead() const { return m_bytes_read; };
+
+private:
+    std::ifstream &m_in;
+    uint8_t m_buffer[1024];
+    uint32_t m_bytes_read;
+};
+
+// decode the trace file with the pull iterator, passing the element batches on to the output.
+ocsd_datapath_resp_t PullDecode(DecodeTree *dcd_tree, std::ifstream &in, TrcGenericElementPrinter *genElemPrinter, 
+                                TrcGenElemMerge *pElemMerge, uint32_t &trace_index)
+{
+    ocsd_datapath_resp_t resp = OCSD_RESP_CONT;
+    ITrcGenElemIn *pElemOut = dcd_tree->getGenTraceElemOutI();
+    FileTraceSrc src(in);
+    std::vector<ocsd_gen_elem_rec_t> batch(pull_batch);
+    OcsdTraceElement elem;
+    ocsd_err_t err;
+    int num_elems = 0;
+
+    // elements decoded before an error are still returned - continue until none left.
+    dcd_tree->setPullSource(&src);
+    do
+    {
+        err = dcd_tree->nextElements(&batch[0], pull_batch, &num_elems);
+        for(int i = 0; i < num_elems; i++)
+        {
+            static_cast<ocsd_generic_trace_elem &>(elem) = batch[i].elem;
+            resp = pElemOut->TraceElemIn(batch[i].index_sop, batch[i].trc_chan_id, elem);
+
+            // no flush needed - acknowledge any test wait and output held merged elements.
+            while(OCSD_DATA_RESP_IS_WAIT(resp))
+            {
+                if(genElemPrinter->needAckWait())
+                    genElemPrinter->ackWait();
+                resp = pElemMerge ? pElemMerge->drain() : OCSD_RESP_CONT;
+            }
+        }
+    } while(num_elems);
+    trace_index = src.getBytesRead();
+    dcd_tree->setPullSource(0);
+    return (err == OCSD_OK) ? OCSD_RESP_CONT : OCSD_RESP_FATAL_INVALID_DATA;
+}
+
+void PrintCoverage(TrcGenElemCoverage &coverage, std::vector<TrcMemAccessorBase::addr_range_t> &ranges)
+{
+    std::ostringstream oss;
+    std::vector<ocsd_cov_func_t> regions(ranges.size());
+
+    // summarise per mapped range.
+    for(size_t i = 0; i < ranges.size(); i++)
+    {
+        regions[i].st_addr = ranges[i].first;
+        regions[i].en_addr = ranges[i].second + 1;
+    }
+    coverage.getFuncCoverage(regions);
+
+    oss << "Trace Packet Lister : Coverage saved to " << coverage_file << "\n";
+    for(size_t i = 0; i < regions.size(); i++)
+    {
+        oss << "Range 0x" << std::hex << regions[i].st_addr << "-0x" << regions[i].en_addr << std::dec;
+        oss << " : covered " << regions[i].num_covered << " of " << regions[i].num_granules << " granules\n";
+    }
+    oss << "Instruction ranges outside mapped memory: " << coverage.getNumUnmapped() << "\n";
+    logger.LogMsg(oss.str());
+}
+
+void PrintCycleProfile(TrcGenElemCycleProfile &profile)
+{
+    std::ostringstream oss;
+    std::vector<ocsd_cyc_prof_bucket_t> hotspots;
+
+    profile.flush();
+    profile.getHotspots(hotspots, cycle_prof_top);
+
+    oss << "Trace Packet Lister : Cycle profile - " << profile.getTotalCycles() << " cycles over " << profile.getTotalInstr() << " instructions";
+    oss << " (" << profile.getUnattribCycles() << " cycles, " << profile.getUnattribInstr() << " instructions unattributed)\n";
+    oss << std::fixed << std::setprecision(1);
+    for(size_t i = 0; i < hotspots.size(); i++)
+    {
+        oss << "0x" << std::hex << std::setw(16) << std::setfill('0') << hotspots[i].addr << std::dec << std::setfill(' ');
+        oss << " : cycles " << std::setw(12) << hotspots[i].cycles << "; instr " << std::setw(12) << hotspots[i].instr << "; hits " << hotspots[i].hits << "\n";
+    }
+    logger.LogMsg(oss.str());
+}
+
+// replay the serialised decode output and check against the elements recorded during decode.
+static void CheckSerialReplay(SerialReplayCheck &check)
+{
+    TrcGenElemSerialReader reader;
+    std::ostringstream oss;
+    ocsd_datapath_resp_t resp = OCSD_RESP_FATAL_SYS_ERR;
+
+    if(reader.open(serial_file) == OCSD_OK)
+    {
+        check.startReplay();
+        resp = reader.replay(&check);
+    }
+
+    std::ifstream in(serial_file.c_str(), std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+    oss << "Trace Packet Lister : Serial replay check " << (check.passed() && OCSD_DATA_RESP_IS_CONT(resp) ? "passed" : "FAILED");
+    oss << "; " << check.getNumChecked() << " of " << check.getNumElem() << " elements replayed from " << serial_file;
+    oss << " (" << (in.is_open() ? (long long)in.tellg() : 0) << " bytes)\n";
+    logger.LogMsg(oss.str());
+}
+
+/* Save a checkpoint of the decode tree, then create a new tree from the snapshot, set up as the original, 
+   and restore the checkpoint into it. Decode continues in the new tree - output should match an 
+   uninterrupted decode. Returns the new tree, or 0 if the checkpoint is to be retried at the next block. */
+static DecodeTree *RestoreCheckpointToNewTree(CreateDcdTreeFromSnapShot &tree_creator, DecodeTree *dcd_tree, ocsdDefaultErrorLogger &err_logger, const std::string &trace_buffer_name, const ocsd_trc_index_t trace_index, bool &done)
+{
+    std::vector<uint8_t> checkpoint;
+    std::ostringstream oss;
+    RawFramePrinter *framePrinter = 0;
+    DecodeTree *new_tree = 0;
+
+    // decoder has output pending - try again at next block
+    ocsd_err_t err = dcd_tree->saveCheckpoint(checkpoint);
+    if(err == OCSD_ERR_DCD_STATE_BUSY)
+        return 0;
+
+    done = true;
+    if((err == OCSD_OK) && tree_creator.createDecodeTree(trace_buffer_name, (decode == false)))
+    {
+        new_tree = tree_creator.getDecodeTree();
+        new_tree->setAlternateErrorLogger(&err_logger);
+        AttachPacketPrinters(new_tree);
+        ConfigureFrameDeMux(new_tree, &framePrinter);
+        if(decode)
+        {
+            new_tree->setGenTraceElemOutI(dcd_tree->getGenTraceElemOutI());
+            ConfigureDecoders(new_tree);
+        }
+        ConfigurePacketProcessors(new_tree);
+        if(!all_source_ids)
+            new_tree->setIDFilter(id_list);
+        else
+            new_tree->clearIDFilter();
+
+        err = new_tree->restoreCheckpoint(checkpoint.data(), checkpoint.size());
+    }
+    else if(err == OCSD_OK)
+        err = OCSD_ERR_FAIL;
+
+    if(err == OCSD_OK)
+        oss << "Trace Packet Lister : Checkpoint at index " << trace_index << " (" << checkpoint.size() << " bytes) restored to new decode tree.\n";
+    else
+    {
+        oss << "Trace Packet Lister : Error: Checkpoint at index " << trace_index << " failed : " << ocsdError::getErrorString(ocsdError(OCSD_ERR_SEV_ERROR, err)) << "\n";
+        if(new_tree)
+            tree_creator.destroyDecodeTree();
+        new_tree = 0;
+    }
+    logger.LogMsg(oss.str());
+    return new_tree;
+}
+
 void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader, const std::string &trace_buffer_name)
 {
     CreateDcdTreeFromSnapShot tree_creator;
+    CreateDcdTreeFromSnapShot ckpt_tree_creator;    // tree restored from a checkpoint
 
     tree_creator.initialise(&reader, &err_logger);
+    tree_creator.setElfMemAcc(elf_mem);
+    ckpt_tree_creator.initialise(&reader, &err_logger);
+    ckpt_tree_creator.setElfMemAcc(elf_mem);
 
     if(tree_creator.createDecodeTree(trace_buffer_name, (decode == false)))
     {
@@ -542,6 +1127,15 @@ void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader
 
         RawFramePrinter *framePrinter = 0;
         TrcGenericElementPrinter *genElemPrinter = 0;
+        TrcGenElemMerge elemMerge;
+        MergedElemPrinter mergedPrinter;
+        TrcGenElemCoverage coverage;
+        TrcGenElemCycleProfile cycleProfile;
+        AnalysisElemTee analysisTee;
+        TrcGenElemQueue elemQueue;
+        std::vector<TrcMemAccessorBase::addr_range_t> mappedRanges;
+        TrcGenElemSerialWriter serialWriter;
+        SerialReplayCheck serialCheck;
 
         AttachPacketPrinters(dcd_tree);
 
@@ -556,8 +1150,59 @@ void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader
             oss << "Trace Packet Lister : Set trace element decode printer\n";
             logger.LogMsg(oss.str());
             genElemPrinter->setTestWaits(test_waits);
+
+            ConfigureDecoders(dcd_tree);
+
+            ITrcGenElemIn *pElemOut = genElemPrinter;
+            if(coverage_file.size())
+            {
+                // record coverage for all the mapped memory.
+                dcd_tree->getMappedRanges(mappedRanges);
+                coverage.addRegions(mappedRanges);
+                analysisTee.addSink(&coverage);
+            }
+            if(cycle_prof)
+                analysisTee.addSink(&cycleProfile);
+            if(serial_file.size())
+            {
+                if(serialWriter.open(serial_file) == OCSD_OK)
+                {
+                    analysisTee.addSink(&serialWriter);
+                    analysisTee.addSink(&serialCheck);
+                }
+                else
+                    logger.LogMsg("Trace Packet Lister : Error: Unable to create serial element file.\n");
+            }
+            if(analysisTee.hasSinks())
+            {
+                analysisTee.setPrinter(genElemPrinter);
+                pElemOut = &analysisTee;
+                dcd_tree->setGenTraceElemOutI(pElemOut);
+            }
+
+            if(merge_ts)
+            {
+                // tree output goes through the merge to the printer.
+                mergedPrinter.setPrinter(pElemOut);
+                elemMerge.setOutput(&mergedPrinter);
+                dcd_tree->setGenTraceElemOutI(elemMerge.getInput(0));
+            }
+
+            // queue the output to the consumer thread - merge, pull and test waits drive the 
+            // output from this thread so cannot be used with the queue.
+            if(elem_queue_size)
+            {
+                if(merge_ts || (pull_batch > 0) || test_waits)
+                    logger.LogMsg("Trace Packet Lister : Warning: -elem_queue ignored with -merge_ts, -pull or -test_waits\n");
+                else if(elemQueue.start(pElemOut, elem_queue_size) == OCSD_OK)
+                    dcd_tree->setGenTraceElemOutI(&elemQueue);
+                else
+                    logger.LogMsg("Trace Packet Lister : Error: Failed to start element queue\n");
+            }
         }
 
+        ConfigurePacketProcessors(dcd_tree);
+
         if(decode)
             dcd_tree->logMappedRanges();    // print out the mapped ranges
 
@@ -580,9 +1225,24 @@ void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader
                 uint8_t trace_buffer[bufferSize];   // temporary buffer to load blocks of data from the file
                 uint32_t trace_index = 0;           // index into the overall trace buffer (file).
 
+                // pull mode decode reads the file through the decode tree data source.
+                bool pull_mode = decode && (pull_batch > 0) && !dstream_format;
+                if(pull_mode)
+                    dataPathResp = PullDecode(dcd_tree, in, genElemPrinter, merge_ts ? &elemMerge : 0, trace_index);
+
+                bool checkpoint_done = (checkpoint_offset == 0);
+
                 // process the file, a buffer load at a time
-                while(!in.eof() && !OCSD_DATA_RESP_IS_FATAL(dataPathResp))
+                while(!pull_mode && !in.eof() && !OCSD_DATA_RESP_IS_FATAL(dataPathResp))
                 {
+                    // checkpoint between input blocks and continue in the restored tree.
+                    if(!checkpoint_done && (trace_index >= checkpoint_offset) && OCSD_DATA_RESP_IS_CONT(dataPathResp))
+                    {
+                        DecodeTree *restored_tree = RestoreCheckpointToNewTree(ckpt_tree_creator, dcd_tree, err_logger, trace_buffer_name, trace_index, checkpoint_done);
+                        if(restored_tree)
+                            dcd_tree = restored_tree;
+                    }
+
                     if (dstream_format)
                     { 
                         in.read((char *)&trace_buffer[0], 512 - 8);
@@ -593,18 +1253,40 @@ void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader
                     std::streamsize nBuffRead = in.gcount();    // get count of data loaded.
                     std::streamsize nBuffProcessed = 0;         // amount processed in this buffer.
                     uint32_t nUsedThisTime = 0;
+                    ocsd_trc_index_t block_index = trace_index;
+
+                    // optionally split the buffer into segments to test the scatter-gather input
+                    std::vector<ocsd_trc_data_seg_t> segs;
+                    if (sg_seg_size)
+                    {
+                        for (std::streamsize pos = 0; pos < nBuffRead; pos += sg_seg_size)
+                        {
+                            ocsd_trc_data_seg_t seg;
+                            seg.p_data = &(trace_buffer[0]) + pos;
+                            seg.size = (uint32_t)(((nBuffRead - pos) < sg_seg_size) ? (nBuffRead - pos) : sg_seg_size);
+                            segs.push_back(seg);
+                        }
+                    }
 
                     // process the current buffer load until buffer done, or fatal error occurs
                     while((nBuffProcessed < nBuffRead) && !OCSD_DATA_RESP_IS_FATAL(dataPathResp))
                     {
                         if(OCSD_DATA_RESP_IS_CONT(dataPathResp))
                         {
-                            dataPathResp = dcd_tree->TraceDataIn(
-                                OCSD_OP_DATA,
-                                trace_index,
-                                (uint32_t)(nBuffRead - nBuffProcessed),
-                                &(trace_buffer[0])+nBuffProcessed,
-                                &nUsedThisTime);
+                            if (sg_seg_size)
+                                dataPathResp = dcd_tree->TraceDataInSG(
+                                    block_index,
+                                    &segs[0],
+                                    (int)segs.size(),
+                                    (uint32_t)nBuffProcessed,
+                                    &nUsedThisTime);
+                            else
+                                dataPathResp = dcd_tree->TraceDataIn(
+                                    OCSD_OP_DATA,
+                                    trace_index,
+                                    (uint32_t)(nBuffRead - nBuffProcessed),
+                                    &(trace_buffer[0])+nBuffProcessed,
+                                    &nUsedThisTime);
 
                             nBuffProcessed += nUsedThisTime;
                             trace_index += nUsedThisTime;
@@ -627,6 +1309,14 @@ void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader
                             if(genElemPrinter->needAckWait())
                                 genElemPrinter->ackWait();
 
+                            // output any merged elements held by the wait before flushing the tree.
+                            if(decode && merge_ts)
+                            {
+                                dataPathResp = elemMerge.drain();
+                                if(!OCSD_DATA_RESP_IS_CONT(dataPathResp))
+                                    continue;
+                            }
+
                             // dataPathResp not continue or fatal so must be wait...
                             dataPathResp = dcd_tree->TraceDataIn(OCSD_OP_FLUSH,0,0,0,0);
                         }
@@ -650,7 +1340,26 @@ void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader
                 }
 
                 // fatal error - no futher processing
-                if(OCSD_DATA_RESP_IS_FATAL(dataPathResp))
+                const bool dataPathFatal = OCSD_DATA_RESP_IS_FATAL(dataPathResp);
+
+                // mark end of trace into the data path - pull iterator has already done this.
+                if(!dataPathFatal && !pull_mode)
+                    dcd_tree->TraceDataIn(OCSD_OP_EOT,0,0,0,0);
+
+                if(decode && merge_ts)
+                {
+                    // output all the remaining merged elements - including those decoded before any fatal error.
+                    while(OCSD_DATA_RESP_IS_WAIT(elemMerge.finish()))
+                    {
+                        if(genElemPrinter->needAckWait())
+                            genElemPrinter->ackWait();
+                    }
+                    std::ostringstream oss;
+                    oss << "Trace Packet Lister : Timestamp merge done, " << elemMerge.getNumForced() << " segments output early at buffer limit.\n";
+                    logger.LogMsg(oss.str());
+                }
+
+                if(dataPathFatal)
                 {
                     std::ostringstream oss;
                     oss << "Trace Packet Lister : Data Path fatal error\n";
@@ -660,10 +1369,14 @@ void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader
                         logger.LogMsg(ocsdError::getErrorString(perr));
 
                 }
-                else
+
+                if(decode && elem_queue_size)
                 {
-                    // mark end of trace into the data path
-                    dcd_tree->TraceDataIn(OCSD_OP_EOT,0,0,0,0);
+                    // wait for the consumer thread to output all the queued elements.
+                    elemQueue.stop();
+                    std::ostringstream oss;
+                    oss << "Trace Packet Lister : Element queue done, " << elemQueue.getNumWaits() << " waits, " << elemQueue.getNumBlocked() << " blocked.\n";
+                    logger.LogMsg(oss.str());
                 }
 
                 // close the input file.
@@ -673,6 +1386,32 @@ void ListTracePackets(ocsdDefaultErrorLogger &err_logger, SnapShotReader &reader
                 oss << "Trace Packet Lister : Trace buffer done, processed " << trace_index << " bytes.\n";
                 logger.LogMsg(oss.str());
 
+                if(skim && !decode)
+                    PrintSkimSummaries(dcd_tree);
+
+                if(decode && coverage_file.size())
+                {
+                    if(coverage.save(coverage_file) == OCSD_OK)
+                        PrintCoverage(coverage, mappedRanges);
+                    else
+                        logger.LogMsg("Trace Packet Lister : Error : Unable to save coverage file.\n");
+                }
+
+                if(decode && cycle_prof)
+                    PrintCycleProfile(cycleProfile);
+
+                if(decode && serialWriter.isOpen())
+                {
+                    serialWriter.close();
+                    CheckSerialReplay(serialCheck);
+                }
+
+                if(stage_times)
+                    dcd_tree->logStageTimes();
+
+                // summarise any errors not printed once the repeat limit was reached
+                err_logger.logSuppressedErrors();
+
             }
             else
             {